@@ -25,7 +25,7 @@ echo "✓ Backend compilado"
 
 # 4. Verificar executáveis
 echo "4. Verificando executáveis..."
-executables=("pipe_demo" "socket_demo" "shm_demo")
+executables=("pipe_demo" "socket_demo" "shm_demo" "ipc_daemon")
 for exe in "${executables[@]}"; do
     if [ -f "build/$exe" ]; then
         echo "✓ $exe encontrado"
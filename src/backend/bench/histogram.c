@@ -0,0 +1,69 @@
+#include "histogram.h"
+#include <string.h>
+
+// Faixa de um valor: exato abaixo de SUB_BUCKETS; acima, o expoente escolhe
+// a potência de 2 e os SUB_BITS bits mais altos escolhem a sub-faixa
+static unsigned bucket_index(uint64_t value) {
+    if (value < IPC_HIST_SUB_BUCKETS) {
+        return (unsigned)value;
+    }
+    unsigned msb = 63 - (unsigned)__builtin_clzll(value);
+    unsigned shift = msb - (IPC_HIST_SUB_BITS - 1);
+    unsigned sub = (unsigned)(value >> shift);  // Em [SUB_BUCKETS/2, SUB_BUCKETS)
+    return shift * (IPC_HIST_SUB_BUCKETS / 2) + sub;
+}
+
+// Maior valor que cai na mesma faixa de index
+static uint64_t bucket_highest(unsigned index) {
+    if (index < IPC_HIST_SUB_BUCKETS) {
+        return index;
+    }
+    unsigned shift = index / (IPC_HIST_SUB_BUCKETS / 2) - 1;
+    uint64_t sub = index % (IPC_HIST_SUB_BUCKETS / 2) + IPC_HIST_SUB_BUCKETS / 2;
+    return ((sub + 1) << shift) - 1;
+}
+
+void ipc_hist_init(ipc_histogram_t *hist) {
+    memset(hist, 0, sizeof(*hist));
+    hist->min = UINT64_MAX;
+}
+
+void ipc_hist_record(ipc_histogram_t *hist, uint64_t value) {
+    hist->counts[bucket_index(value)]++;
+    hist->total++;
+    hist->sum += (double)value;
+    if (value < hist->min) {
+        hist->min = value;
+    }
+    if (value > hist->max) {
+        hist->max = value;
+    }
+}
+
+uint64_t ipc_hist_percentile(const ipc_histogram_t *hist, double percentile) {
+    if (hist->total == 0) {
+        return 0;
+    }
+    if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+
+    // Posição (1-based) da amostra procurada na ordem crescente
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)hist->total + 0.5);
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < IPC_HIST_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            uint64_t value = bucket_highest(i);
+            return value < hist->max ? value : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+double ipc_hist_mean(const ipc_histogram_t *hist) {
+    return hist->total ? hist->sum / (double)hist->total : 0.0;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file histogram.h
+ * @brief Histograma de latências no estilo HDR (log-linear, precisão relativa fixa)
+ * 
+ * Cada potência de 2 é dividida em IPC_HIST_SUB_BUCKETS/2 faixas iguais, então
+ * qualquer valor de 1 ns a 2^63 ns é registrado com erro relativo menor que
+ * 2 / IPC_HIST_SUB_BUCKETS (< 1,6%) em memória fixa, sem alocação e com custo
+ * O(1) por amostra. Valores abaixo de IPC_HIST_SUB_BUCKETS são exatos.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+// Bits de sub-divisão: 64 faixas por potência de 2 (erro relativo < 1,6%)
+#define IPC_HIST_SUB_BITS 7
+#define IPC_HIST_SUB_BUCKETS (1 << IPC_HIST_SUB_BITS)
+
+// Total de faixas para cobrir valores de 64 bits
+#define IPC_HIST_BUCKETS ((64 - IPC_HIST_SUB_BITS + 1) * (IPC_HIST_SUB_BUCKETS / 2) + IPC_HIST_SUB_BUCKETS / 2)
+
+/**
+ * @brief Histograma de valores inteiros (tipicamente nanossegundos).
+ * 
+ * Não contém ponteiros: pode ficar em memória compartilhada (MAP_SHARED)
+ * para que um processo filho registre e o pai leia.
+ */
+typedef struct {
+    uint64_t counts[IPC_HIST_BUCKETS];
+    uint64_t total;     // Número de amostras
+    uint64_t min;       // Menor valor registrado
+    uint64_t max;       // Maior valor registrado
+    double sum;         // Soma (para a média)
+} ipc_histogram_t;
+
+/**
+ * @brief Zera o histograma.
+ * 
+ * @param hist Ponteiro para o histograma.
+ */
+void ipc_hist_init(ipc_histogram_t *hist);
+
+/**
+ * @brief Registra uma amostra.
+ * 
+ * @param hist Ponteiro para o histograma.
+ * @param value Valor da amostra.
+ */
+void ipc_hist_record(ipc_histogram_t *hist, uint64_t value);
+
+/**
+ * @brief Valor no percentil pedido.
+ * 
+ * Retorna o maior valor equivalente da faixa que contém o percentil (como o
+ * HdrHistogram), limitado ao máximo registrado.
+ * 
+ * @param hist Ponteiro para o histograma.
+ * @param percentile Percentil entre 0 e 100 (ex: 99.9).
+ * @return Valor no percentil, ou 0 se o histograma estiver vazio.
+ */
+uint64_t ipc_hist_percentile(const ipc_histogram_t *hist, double percentile);
+
+/**
+ * @brief Média das amostras registradas.
+ * 
+ * @param hist Ponteiro para o histograma.
+ * @return Média, ou 0 se o histograma estiver vazio.
+ */
+double ipc_hist_mean(const ipc_histogram_t *hist);
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,361 @@
+/**
+ * @file ipc_bench.c
+ * @brief Benchmark comparativo de latência e vazão entre pipes, sockets AF_UNIX e SHM.
+ *
+ * Para cada transporte, modo e tamanho de mensagem, o pai e um filho criado
+ * com fork() trocam mensagens e o resultado é impresso como uma linha JSON
+ * do tipo "metrics":
+ *
+ *   - pingpong: o pai envia, o filho devolve a mensagem inteira; a latência
+ *     registrada é o tempo de ida e volta (RTT) de cada troca.
+ *   - stream: o pai envia N mensagens seguidas; cada uma carrega o instante
+ *     de envio e o filho registra a latência de mão única. A vazão é medida
+ *     até o filho confirmar o recebimento da última mensagem.
+ *
+ * As latências vão para um histograma HDR (histogram.h) e são reportadas
+ * como p50/p99/p99.9/max, junto com msgs/s e GB/s.
+ *
+ * Os transportes são os canais da libipc (ipc_channel.h): o mesmo código de
+ * envio e recepção mede todos. Com --batch N o modo stream envia e recebe
+ * em lotes de até N mensagens (send_batch/recv_batch).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "../common/json_output.h"
+#include "../common/affinity.h"
+#include "../common/ipc_channel.h"
+#include "histogram.h"
+
+// Faixa de tamanhos aceita e lista padrão (8 B a 16 MB, fator 8)
+#define BENCH_MIN_SIZE 8
+#define BENCH_MAX_SIZE (16UL * 1024 * 1024)
+#define BENCH_MAX_SIZES 32
+static const size_t default_sizes[] = { 8, 64, 512, 4096, 32768, 262144, 2097152, 16777216 };
+
+// Mensagens por caso; para mensagens grandes o total é limitado a BENCH_BYTE_BUDGET
+#define BENCH_DEFAULT_COUNT 10000
+#define BENCH_BYTE_BUDGET (512UL * 1024 * 1024)
+#define BENCH_MIN_COUNT 16
+
+// Capacidade por sentido de todos os transportes (no shm: ring de 8 MB, registros de até 4 MB;
+// maiores são fatiados; pipes e sockets ficam no limite do kernel, se menor)
+#define BENCH_CHANNEL_CAPACITY (8UL * 1024 * 1024)
+
+// Lote do modo stream (--batch): mensagens por send_batch/recv_batch e memória máxima do lote
+#define BENCH_MAX_BATCH IPC_CHANNEL_MAX_BATCH
+#define BENCH_BATCH_BUDGET (64UL * 1024 * 1024)
+
+typedef enum {
+    BENCH_PINGPONG,
+    BENCH_STREAM
+} bench_mode_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Lado do filho: ecoa (pingpong) ou consome em lotes de até batch e mede (stream).
+ */
+static int bench_child(ipc_channel_t *ch, bench_mode_t mode, size_t size, long count, long warmup,
+                       int batch, char *buf, ipc_histogram_t *hist) {
+    ipc_channel_msg_t msgs[BENCH_MAX_BATCH];
+    size_t len;
+
+    for (int j = 0; j < batch; j++) {
+        msgs[j].buf = buf + (size_t)j * size;
+        msgs[j].cap = size;
+    }
+    for (long i = 0; i < count;) {
+        if (mode == BENCH_PINGPONG) {
+            if (ipc_channel_recv(ch, buf, size, &len) != 1 || len != size ||
+                ipc_channel_send(ch, buf, size) == -1) {
+                return -1;
+            }
+            i++;
+            continue;
+        }
+        int n = ipc_channel_recv_batch(ch, msgs, count - i < batch ? (int)(count - i) : batch);
+        if (n <= 0) {
+            return -1;
+        }
+        uint64_t arrived = now_ns();
+        for (int j = 0; j < n; j++, i++) {
+            if (msgs[j].len != size) {
+                return -1;
+            }
+            if (i >= warmup) {
+                uint64_t sent_at;
+                memcpy(&sent_at, msgs[j].buf, sizeof(sent_at));
+                ipc_hist_record(hist, arrived - sent_at);
+            }
+        }
+    }
+    if (mode == BENCH_STREAM) {
+        // Confirma a última mensagem para o pai fechar a medição de vazão
+        char ack = 1;
+        return ipc_channel_send(ch, &ack, 1);
+    }
+    return 0;
+}
+
+/**
+ * @brief Lado do pai: gera a carga (em lotes de até batch no stream) e mede o tempo total.
+ */
+static int bench_parent(ipc_channel_t *ch, bench_mode_t mode, size_t size, long count, long warmup,
+                        int batch, char *buf, ipc_histogram_t *hist, uint64_t *elapsed_ns) {
+    ipc_channel_msg_t msgs[BENCH_MAX_BATCH];
+    uint64_t start = 0;
+    size_t len;
+
+    for (long i = 0; i < count;) {
+        int n = mode == BENCH_STREAM && count - i > batch ? batch : (mode == BENCH_STREAM ? (int)(count - i) : 1);
+        if (i <= warmup && warmup < i + n) {
+            start = now_ns();
+        }
+        uint64_t t0 = 0;
+        for (int j = 0; j < n; j++) {
+            t0 = now_ns();
+            msgs[j].buf = buf + (size_t)j * size;
+            msgs[j].len = size;
+            memcpy(msgs[j].buf, &t0, sizeof(t0));
+        }
+        if ((n == 1 ? ipc_channel_send(ch, buf, size) : ipc_channel_send_batch(ch, msgs, n)) == -1) {
+            return -1;
+        }
+        if (mode == BENCH_PINGPONG) {
+            if (ipc_channel_recv(ch, buf, size, &len) != 1 || len != size) {
+                return -1;
+            }
+            if (i >= warmup) {
+                ipc_hist_record(hist, now_ns() - t0);
+            }
+        }
+        i += n;
+    }
+    if (mode == BENCH_STREAM) {
+        char ack;
+        if (ipc_channel_recv(ch, &ack, 1, &len) != 1) {
+            return -1;
+        }
+    }
+    *elapsed_ns = now_ns() - start;
+    return 0;
+}
+
+/**
+ * @brief Executa um caso (transporte, modo, tamanho) e imprime suas métricas.
+ *
+ * @param hist Histograma em memória compartilhada (o filho registra no modo stream).
+ * @return 0 em sucesso, -1 em erro.
+ */
+static int run_case(const char *transport, bench_mode_t mode, size_t size, long max_count, int max_batch,
+                    ipc_histogram_t *hist) {
+    const char *mode_name = mode == BENCH_PINGPONG ? "pingpong" : "stream";
+    char case_name[96], status_msg[256], metrics[768];
+    ipc_channel_config_t cfg = { BENCH_CHANNEL_CAPACITY };
+    ipc_channel_t ch;
+    uint64_t elapsed_ns = 0;
+
+    // Mensagens grandes: limita o volume total, mantendo um mínimo de amostras
+    long count = max_count;
+    if ((uint64_t)count * size > BENCH_BYTE_BUDGET) {
+        count = (long)(BENCH_BYTE_BUDGET / size);
+    }
+    if (count < BENCH_MIN_COUNT) {
+        count = BENCH_MIN_COUNT;
+    }
+    long warmup = count / 10;
+
+    // Cada mensagem do lote tem buffer próprio (e seu instante de envio): o lote cabe em BENCH_BATCH_BUDGET
+    int batch = mode == BENCH_STREAM ? max_batch : 1;
+    if ((uint64_t)batch * size > BENCH_BATCH_BUDGET) {
+        batch = (int)(BENCH_BATCH_BUDGET / size);
+    }
+    if (batch < 1) {
+        batch = 1;
+    }
+
+    snprintf(case_name, sizeof(case_name), "%s_%s_%zu", transport, mode_name, size);
+    char *buf = malloc(size * (size_t)batch);
+    if (!buf) {
+        print_json_error("bench", "Falha ao alocar o buffer da mensagem", getpid());
+        return -1;
+    }
+    memset(buf, 'x', size * (size_t)batch);
+    if (ipc_channel_open(&ch, transport, &cfg) == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Falha ao abrir o transporte %s: %s", transport, strerror(errno));
+        print_json_error("bench", status_msg, getpid());
+        free(buf);
+        return -1;
+    }
+    ipc_hist_init(hist);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        print_json_error("bench", "Falha no fork()", getpid());
+        ipc_channel_close(&ch);
+        free(buf);
+        return -1;
+    }
+    if (pid == 0) {
+        ipc_affinity_pin(IPC_ROLE_CONSUMER);
+        ipc_channel_attach(&ch, 1);
+        int rc = bench_child(&ch, mode, size, count, warmup, batch, buf, hist);
+        ipc_channel_close(&ch);
+        _exit(rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    ipc_channel_attach(&ch, 0);
+    int rc = bench_parent(&ch, mode, size, count, warmup, batch, buf, hist, &elapsed_ns);
+    uint64_t syscalls = ch.syscalls;
+    ipc_channel_close(&ch);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    free(buf);
+    if (rc == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        snprintf(status_msg, sizeof(status_msg), "Caso %s falhou", case_name);
+        print_json_error("bench", status_msg, getpid());
+        return -1;
+    }
+
+    double secs = (double)elapsed_ns / 1e9;
+    long measured = count - warmup;
+    snprintf(metrics, sizeof(metrics),
+             "{\"transport\":\"%s\",\"mode\":\"%s\",\"size\":%zu,\"measured\":%ld,\"warmup\":%ld,"
+             "\"total\":%ld,\"latency\":\"%s\",\"min_ns\":%llu,\"mean_ns\":%.0f,\"p50_ns\":%llu,\"p99_ns\":%llu,"
+             "\"p999_ns\":%llu,\"max_ns\":%llu,\"msgs_per_sec\":%.0f,\"gb_per_sec\":%.4f,"
+             "\"batch\":%d,\"sender_syscalls_per_msg\":%.3f}",
+             transport, mode_name, size, measured, warmup, count,
+             mode == BENCH_PINGPONG ? "rtt" : "one_way",
+             (unsigned long long)(hist->total ? hist->min : 0), ipc_hist_mean(hist),
+             (unsigned long long)ipc_hist_percentile(hist, 50.0),
+             (unsigned long long)ipc_hist_percentile(hist, 99.0),
+             (unsigned long long)ipc_hist_percentile(hist, 99.9),
+             (unsigned long long)hist->max,
+             secs > 0 ? measured / secs : 0.0,
+             secs > 0 ? (double)measured * size / secs / 1e9 : 0.0,
+             batch, (double)syscalls / count);
+    print_json_metrics("bench", case_name, metrics, getpid());
+    return 0;
+}
+
+// Tamanho com sufixo opcional K/M (potências de 1024)
+static size_t parse_size(const char *text) {
+    char *end;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (*end == 'K' || *end == 'k') {
+        value *= 1024;
+        end++;
+    } else if (*end == 'M' || *end == 'm') {
+        value *= 1024 * 1024;
+        end++;
+    }
+    if (*end != '\0' || value < BENCH_MIN_SIZE || value > BENCH_MAX_SIZE) {
+        return 0;
+    }
+    return (size_t)value;
+}
+
+// Lista separada por vírgulas ("8,4K,1M"); retorna o número de tamanhos ou 0 se inválida
+static int parse_sizes(const char *list, size_t *sizes) {
+    char copy[256];
+    int n = 0;
+    snprintf(copy, sizeof(copy), "%s", list);
+    for (char *tok = strtok(copy, ","); tok; tok = strtok(NULL, ",")) {
+        if (n == BENCH_MAX_SIZES || (sizes[n] = parse_size(tok)) == 0) {
+            return 0;
+        }
+        n++;
+    }
+    return n;
+}
+
+int main(int argc, char *argv[]) {
+    // Sem --transport vale o transporte configurado no ambiente (IPC_TRANSPORT), ou todos
+    const char *transport = getenv(IPC_CHANNEL_ENV) ? ipc_channel_default_transport() : "all";
+    const char *mode = "all";
+    size_t sizes[BENCH_MAX_SIZES];
+    int n_sizes = (int)(sizeof(default_sizes) / sizeof(default_sizes[0]));
+    long count = BENCH_DEFAULT_COUNT;
+    int batch = 1;
+    int argi = 1;
+    char status_msg[256];
+
+    memcpy(sizes, default_sizes, sizeof(default_sizes));
+
+    // Opções: [--transport pipe|unix|shm|all] [--mode pingpong|stream|all] [--sizes 8,4K,16M] [--count N] [--batch N]
+    while (argi < argc) {
+        const char *opt = argv[argi];
+        const char *value = argi + 1 < argc ? argv[argi + 1] : NULL;
+        if (strcmp(opt, "--transport") == 0 && value) {
+            transport = value;
+        } else if (strcmp(opt, "--mode") == 0 && value &&
+                   (strcmp(value, "pingpong") == 0 || strcmp(value, "stream") == 0 || strcmp(value, "all") == 0)) {
+            mode = value;
+        } else if (strcmp(opt, "--sizes") == 0 && value && (n_sizes = parse_sizes(value, sizes)) > 0) {
+            // Tamanhos já lidos
+        } else if (strcmp(opt, "--count") == 0 && value && atol(value) > 0) {
+            count = atol(value);
+        } else if (strcmp(opt, "--batch") == 0 && value && atoi(value) > 0 && atoi(value) <= BENCH_MAX_BATCH) {
+            batch = atoi(value);
+        } else {
+            print_json_error("bench", "Uso: ./ipc_bench [--transport pipe|unix|shm|all] [--mode pingpong|stream|all] "
+                             "[--sizes 8,4K,16M] [--count <N>] [--batch <N>]", getpid());
+            return 1;
+        }
+        argi += 2;
+    }
+
+    // O histograma fica em memória compartilhada: no modo stream quem mede é o filho
+    ipc_histogram_t *hist = mmap(NULL, sizeof(ipc_histogram_t), PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (hist == MAP_FAILED) {
+        print_json_error("bench", "Falha ao mapear o histograma", getpid());
+        return 1;
+    }
+
+    snprintf(status_msg, sizeof(status_msg), "Benchmark: transporte=%s, modo=%s, %d tamanho(s), até %ld mensagens por caso, lote %d.",
+             transport, mode, n_sizes, count, batch);
+    print_json_status("bench", "start", status_msg, getpid());
+    ipc_affinity_apply("bench", IPC_ROLE_PRODUCER);
+
+    int cases = 0, failures = 0;
+    const ipc_channel_ops_t *ops;
+    for (int t = 0; (ops = ipc_channel_transport(t)) != NULL; t++) {
+        if (strcmp(transport, "all") != 0 && strcmp(transport, ops->name) != 0) {
+            continue;
+        }
+        for (int m = BENCH_PINGPONG; m <= BENCH_STREAM; m++) {
+            if (strcmp(mode, "all") != 0 && strcmp(mode, m == BENCH_PINGPONG ? "pingpong" : "stream") != 0) {
+                continue;
+            }
+            for (int s = 0; s < n_sizes; s++) {
+                cases++;
+                failures += run_case(ops->name, (bench_mode_t)m, sizes[s], count, batch, hist) != 0;
+            }
+        }
+    }
+    munmap(hist, sizeof(ipc_histogram_t));
+
+    if (cases == 0) {
+        print_json_error("bench", "Nenhum transporte corresponde a --transport", getpid());
+        return 1;
+    }
+    snprintf(status_msg, sizeof(status_msg), "Benchmark concluído: %d caso(s), %d falha(s).", cases, failures);
+    if (failures) {
+        print_json_error("bench", status_msg, getpid());
+        return 1;
+    }
+    print_json_status("bench", "success", status_msg, getpid());
+    return 0;
+}
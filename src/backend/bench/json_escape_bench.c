@@ -0,0 +1,153 @@
+/**
+ * @file json_escape_bench.c
+ * @brief Microbenchmark do escape de strings JSON: caminho antigo vs. varredura escalar/SSE2/AVX2.
+ *
+ * "legacy" reproduz o escape_json_string() original (duas passadas byte a
+ * byte e um malloc por chamada); as demais entradas usam a varredura de
+ * json_escape.h com cópia em bloco dos trechos limpos. Cada combinação de
+ * tamanho e densidade de escapes vira uma linha JSON "metrics".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../common/json_output.h"
+#include "../common/json_escape.h"
+
+// Bytes processados por caso (o número de chamadas se ajusta ao tamanho)
+#define BENCH_BYTES_PER_CASE (128UL * 1024 * 1024)
+
+static const size_t payload_sizes[] = { 64, 1024, 65536, 1048576 };
+
+/**
+ * @brief Densidade de bytes especiais no payload.
+ */
+typedef struct {
+    const char *name;
+    int every;      // Um byte especial a cada N bytes (0: nenhum)
+} density_t;
+
+static const density_t densities[] = { { "clean", 0 }, { "sparse", 100 }, { "dense", 8 } };
+
+// Cópia do escape original: conta, aloca e copia
+static char *legacy_escape(const char *input) {
+    int len = strlen(input);
+    int escaped_len = len;
+    for (int i = 0; i < len; i++) {
+        if (input[i] == '"' || input[i] == '\\' || input[i] == '\n' || input[i] == '\r' || input[i] == '\t') {
+            escaped_len += 1;
+        }
+    }
+    char *escaped = malloc(escaped_len + 1);
+    if (!escaped) return NULL;
+    int j = 0;
+    for (int i = 0; i < len; i++) {
+        switch (input[i]) {
+            case '"':  escaped[j++] = '\\'; escaped[j++] = '"';  break;
+            case '\\': escaped[j++] = '\\'; escaped[j++] = '\\'; break;
+            case '\n': escaped[j++] = '\\'; escaped[j++] = 'n';  break;
+            case '\r': escaped[j++] = '\\'; escaped[j++] = 'r';  break;
+            case '\t': escaped[j++] = '\\'; escaped[j++] = 't';  break;
+            default:   escaped[j++] = input[i]; break;
+        }
+    }
+    escaped[j] = '\0';
+    return escaped;
+}
+
+// Mesmo laço de json_escape_into(), com a implementação de varredura escolhida
+static size_t escape_with(const json_escape_impl_t *impl, char *dst, const char *src) {
+    char *out = dst;
+    for (;;) {
+        const char *stop = impl->scan(src);
+        memcpy(out, src, (size_t)(stop - src));
+        out += stop - src;
+        if (*stop == '\0') {
+            break;
+        }
+        out += json_escape_sequence((unsigned char)*stop, out);
+        src = stop + 1;
+    }
+    *out = '\0';
+    return (size_t)(out - dst);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Texto ASCII com um byte especial a cada d->every bytes
+static void fill_payload(char *buf, size_t size, const density_t *d) {
+    static const char specials[] = { '"', '\\', '\n', '\t' };
+    for (size_t i = 0; i < size; i++) {
+        buf[i] = (char)('a' + i % 26);
+        if (d->every && i % (size_t)d->every == (size_t)d->every - 1) {
+            buf[i] = specials[(i / (size_t)d->every) % sizeof(specials)];
+        }
+    }
+    buf[size] = '\0';
+}
+
+int main(void) {
+    size_t impl_count;
+    const json_escape_impl_t *impls = json_escape_impls(&impl_count);
+    size_t max_size = payload_sizes[sizeof(payload_sizes) / sizeof(payload_sizes[0]) - 1];
+    char *payload = malloc(max_size + 1);
+    char *out = malloc(max_size * JSON_ESCAPE_MAX_SEQ + 1);
+    char name[96], metrics[512], status_msg[256];
+    volatile size_t sink = 0;
+
+    if (!payload || !out) {
+        print_json_error("json_escape_bench", "Falha ao alocar buffers", getpid());
+        return 1;
+    }
+    snprintf(status_msg, sizeof(status_msg), "Implementação ativa: %s (%zu disponíveis nesta CPU)",
+             json_escape_impl_name(), impl_count);
+    print_json_status("json_escape_bench", "start", status_msg, getpid());
+
+    for (size_t d = 0; d < sizeof(densities) / sizeof(densities[0]); d++) {
+        for (size_t s = 0; s < sizeof(payload_sizes) / sizeof(payload_sizes[0]); s++) {
+            size_t size = payload_sizes[s];
+            long calls = (long)(BENCH_BYTES_PER_CASE / size);
+            double legacy_secs = 0;
+            fill_payload(payload, size, &densities[d]);
+
+            // Índice -1: caminho antigo; 0..n-1: varreduras disponíveis
+            for (long i = -1; i < (long)impl_count; i++) {
+                const char *impl_name = i < 0 ? "legacy" : impls[i].name;
+                double start = now_seconds();
+                for (long c = 0; c < calls; c++) {
+                    if (i < 0) {
+                        char *escaped = legacy_escape(payload);
+                        sink += escaped[0];
+                        free(escaped);
+                    } else {
+                        sink += escape_with(&impls[i], out, payload);
+                    }
+                }
+                double secs = now_seconds() - start;
+                if (i < 0) {
+                    legacy_secs = secs;
+                }
+
+                snprintf(name, sizeof(name), "%s_%s_%zu", impl_name, densities[d].name, size);
+                snprintf(metrics, sizeof(metrics),
+                         "{\"impl\":\"%s\",\"density\":\"%s\",\"size\":%zu,\"calls\":%ld,"
+                         "\"ns_per_call\":%.1f,\"gb_per_sec\":%.3f,\"speedup_vs_legacy\":%.2f}",
+                         impl_name, densities[d].name, size, calls,
+                         secs * 1e9 / calls, (double)size * calls / secs / 1e9,
+                         secs > 0 ? legacy_secs / secs : 0.0);
+                print_json_metrics("json_escape_bench", name, metrics, getpid());
+            }
+        }
+    }
+
+    free(payload);
+    free(out);
+    print_json_status("json_escape_bench", "success", "Microbenchmark de escape concluído.", getpid());
+    return 0;
+}
@@ -0,0 +1,158 @@
+#define _GNU_SOURCE
+#include "affinity.h"
+#include "json_output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+// Maior nó aceito no nodemask passado ao mbind()
+#define IPC_MAX_NUMA_NODES 1024
+
+// Lê uma variável de ambiente inteira não negativa; -1 se ausente ou inválida
+static int env_index(const char *name) {
+    const char *value = getenv(name);
+    char *end;
+    if (!value || !*value) {
+        return -1;
+    }
+    long index = strtol(value, &end, 10);
+    if (*end != '\0' || index < 0 || index > 65535) {
+        return -1;
+    }
+    return (int)index;
+}
+
+// Variável definida e não vazia (mesmo que inválida: quem a definiu quer ver o relato)
+static int env_set(const char *name) {
+    const char *value = getenv(name);
+    return value && *value;
+}
+
+int ipc_pin_cpu(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        errno = EINVAL;
+        return -1;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set);
+}
+
+int ipc_cpu_node(int cpu) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+
+    // Cada CPU tem um link "nodeN" para o nó ao qual pertence
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return -1;
+    }
+    int node = -1;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) == 0 && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+}
+
+int ipc_mbind_node(void *addr, size_t len, int node) {
+    unsigned long nodemask[IPC_MAX_NUMA_NODES / (8 * sizeof(unsigned long))];
+    const size_t bits = 8 * sizeof(unsigned long);
+
+    if (node < 0 || node >= IPC_MAX_NUMA_NODES) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(nodemask, 0, sizeof(nodemask));
+    nodemask[node / bits] |= 1UL << (node % bits);
+
+    // maxnode conta bits; o kernel ignora o último, daí o +1
+    if (syscall(SYS_mbind, addr, len, MPOL_BIND, nodemask, (unsigned long)IPC_MAX_NUMA_NODES + 1,
+                MPOL_MF_MOVE) == -1) {
+        return -1;
+    }
+    return 0;
+}
+
+int ipc_page_node(void *addr) {
+    void *pages[1];
+    int status[1] = { -1 };
+    // Alinha à página: move_pages() com nodes == NULL só consulta
+    pages[0] = (void *)((unsigned long)addr & ~((unsigned long)sysconf(_SC_PAGESIZE) - 1));
+    if (syscall(SYS_move_pages, 0, 1UL, pages, NULL, status, 0) == -1 || status[0] < 0) {
+        return -1;
+    }
+    return status[0];
+}
+
+int ipc_numa_node_from_env(void) {
+    return env_index(IPC_ENV_NUMA_NODE);
+}
+
+// Variável de ambiente com a CPU de cada papel
+static const char *role_env(ipc_role_t role) {
+    return role == IPC_ROLE_PRODUCER ? IPC_ENV_CPU_PRODUCER : IPC_ENV_CPU_CONSUMER;
+}
+
+int ipc_affinity_pin(ipc_role_t role) {
+    int wanted = env_index(role_env(role));
+    return wanted >= 0 ? ipc_pin_cpu(wanted) : 0;
+}
+
+int ipc_affinity_apply(const char *module, ipc_role_t role) {
+    const char *var = role_env(role);
+    const char *role_name = role == IPC_ROLE_PRODUCER ? "Produtor" : "Consumidor";
+    int wanted = env_index(var);
+    char status_msg[256];
+    int rc = 0;
+
+    if (wanted >= 0 && ipc_pin_cpu(wanted) == -1) {
+        snprintf(status_msg, sizeof(status_msg), "%s não pôde ser fixado na CPU %d (%s=%d): %s",
+                 role_name, wanted, var, wanted, strerror(errno));
+        print_json_error(module, status_msg, getpid());
+        rc = -1;
+    }
+
+    int cpu = sched_getcpu();
+    // Sem nenhuma variável de afinidade a posição é a do escalonador: nada a relatar
+    if (!env_set(IPC_ENV_CPU_PRODUCER) && !env_set(IPC_ENV_CPU_CONSUMER) && !env_set(IPC_ENV_NUMA_NODE)) {
+        return rc == 0 ? cpu : -1;
+    }
+    snprintf(status_msg, sizeof(status_msg), "%s na CPU %d (nó %d)%s", role_name, cpu, ipc_cpu_node(cpu),
+             wanted >= 0 && rc == 0 ? ", fixado via afinidade" : ", sem afinidade fixa");
+    print_json_status(module, "affinity", status_msg, getpid());
+    return rc == 0 ? cpu : -1;
+}
+
+int ipc_numa_bind_from_env(const char *module, void *addr, size_t len) {
+    int node = ipc_numa_node_from_env();
+    char status_msg[256];
+
+    if (node < 0) {
+        return 0;
+    }
+    if (ipc_mbind_node(addr, len, node) == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Falha ao vincular o segmento ao nó %d (%s=%d): %s",
+                 node, IPC_ENV_NUMA_NODE, node, strerror(errno));
+        print_json_error(module, status_msg, getpid());
+        return -1;
+    }
+
+    // Lê a primeira página para que ela fique residente e a consulta tenha o que informar
+    (void)*(volatile char *)addr;
+    snprintf(status_msg, sizeof(status_msg), "Segmento de %zu bytes vinculado ao nó %d (primeira página no nó %d)",
+             len, node, ipc_page_node(addr));
+    print_json_status(module, "numa", status_msg, getpid());
+    return 0;
+}
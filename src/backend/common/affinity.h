@@ -0,0 +1,118 @@
+/**
+ * @file affinity.h
+ * @brief Afinidade de CPU e posicionamento NUMA dos processos de demonstração
+ * 
+ * Após o fork() pai e filho ficam onde o escalonador os colocar, e as páginas
+ * de um segmento compartilhado vão para o nó NUMA de quem as tocar primeiro.
+ * Estas funções fixam cada papel (produtor/consumidor) numa CPU escolhida,
+ * vinculam uma região de memória a um nó e relatam em JSON onde cada processo
+ * e cada segmento ficaram. Usa syscalls diretas (sem libnuma).
+ * 
+ * A configuração vem de variáveis de ambiente, iguais para todos os demos:
+ *   IPC_CPU_PRODUCER=<cpu>  CPU do processo que envia os dados
+ *   IPC_CPU_CONSUMER=<cpu>  CPU do processo que recebe os dados
+ *   IPC_NUMA_NODE=<nó>      Nó NUMA dos segmentos de memória compartilhada
+ */
+
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+#include <stddef.h>
+
+// Variáveis de ambiente lidas por ipc_affinity_apply() e ipc_numa_node_from_env()
+#define IPC_ENV_CPU_PRODUCER "IPC_CPU_PRODUCER"
+#define IPC_ENV_CPU_CONSUMER "IPC_CPU_CONSUMER"
+#define IPC_ENV_NUMA_NODE    "IPC_NUMA_NODE"
+
+/**
+ * @brief Papel do processo na troca de dados (define qual CPU usar).
+ */
+typedef enum {
+    IPC_ROLE_PRODUCER,
+    IPC_ROLE_CONSUMER
+} ipc_role_t;
+
+/**
+ * @brief Fixa o processo atual em uma única CPU (sched_setaffinity).
+ * 
+ * @param cpu Índice da CPU.
+ * @return 0 em sucesso, -1 em erro (errno do kernel, ex: EINVAL para CPU inexistente).
+ */
+int ipc_pin_cpu(int cpu);
+
+/**
+ * @brief Descobre o nó NUMA de uma CPU (via /sys/devices/system/cpu).
+ * 
+ * @param cpu Índice da CPU.
+ * @return Número do nó, ou -1 se a topologia não estiver disponível.
+ */
+int ipc_cpu_node(int cpu);
+
+/**
+ * @brief Vincula uma região mapeada a um nó NUMA (mbind com MPOL_BIND).
+ * 
+ * Páginas já tocadas por este processo são migradas (MPOL_MF_MOVE); as
+ * seguintes já nascem no nó. Em segmentos compartilhados a política vale
+ * para todos os processos que os mapearem.
+ * 
+ * @param addr Início da região (alinhado à página).
+ * @param len Tamanho da região em bytes.
+ * @param node Nó NUMA de destino.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int ipc_mbind_node(void *addr, size_t len, int node);
+
+/**
+ * @brief Consulta em que nó NUMA está a página de um endereço (move_pages).
+ * 
+ * @param addr Endereço dentro de uma página já residente.
+ * @return Número do nó, ou -1 se não residente ou sem suporte.
+ */
+int ipc_page_node(void *addr);
+
+/**
+ * @brief Lê o nó NUMA configurado em IPC_NUMA_NODE.
+ * 
+ * @return Número do nó, ou -1 se a variável não estiver definida.
+ */
+int ipc_numa_node_from_env(void);
+
+/**
+ * @brief Fixa o processo na CPU configurada para o papel, sem relatar.
+ * 
+ * Para processos criados em laço (ex: um filho por caso de benchmark), onde
+ * um status por processo só poluiria a saída.
+ * 
+ * @param role Papel deste processo.
+ * @return 0 se nada foi pedido ou a fixação deu certo, -1 em erro.
+ */
+int ipc_affinity_pin(ipc_role_t role);
+
+/**
+ * @brief Aplica a afinidade configurada para o papel e relata a posição.
+ * 
+ * Se a variável do papel estiver definida, fixa o processo nessa CPU. O
+ * status JSON "affinity", com a CPU e o nó em que o processo está rodando,
+ * só é impresso quando alguma variável IPC_CPU_* ou IPC_NUMA_NODE está
+ * definida; erros de fixação são sempre relatados.
+ * 
+ * @param module Nome do módulo usado no JSON (ex: "pipes").
+ * @param role Papel deste processo.
+ * @return CPU atual, ou -1 se a fixação pedida falhou.
+ */
+int ipc_affinity_apply(const char *module, ipc_role_t role);
+
+/**
+ * @brief Vincula um segmento ao nó de IPC_NUMA_NODE (se definido) e relata.
+ * 
+ * Imprime um status JSON "numa" com o nó pedido e o nó em que a primeira
+ * página do segmento efetivamente está.
+ * 
+ * @param module Nome do módulo usado no JSON.
+ * @param addr Início do segmento mapeado.
+ * @param len Tamanho do segmento.
+ * @return 0 se nada foi pedido ou o vínculo deu certo, -1 em erro.
+ */
+int ipc_numa_bind_from_env(const char *module, void *addr, size_t len);
+
+#endif // AFFINITY_H
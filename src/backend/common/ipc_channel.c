@@ -0,0 +1,374 @@
+#define _GNU_SOURCE
+#include "ipc_channel.h"
+#include "ipc_io.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+static const ipc_channel_ops_t *const transports[] = {
+    &ipc_channel_pipe_ops,
+    &ipc_channel_unix_ops,
+    &ipc_channel_shm_ops,
+};
+#define CHANNEL_TRANSPORTS (int)(sizeof(transports) / sizeof(transports[0]))
+
+const ipc_channel_ops_t *ipc_channel_transport(int index) {
+    return index >= 0 && index < CHANNEL_TRANSPORTS ? transports[index] : NULL;
+}
+
+const ipc_channel_ops_t *ipc_channel_find(const char *name) {
+    for (int i = 0; i < CHANNEL_TRANSPORTS; i++) {
+        if (strcmp(transports[i]->name, name) == 0) {
+            return transports[i];
+        }
+    }
+    return NULL;
+}
+
+const char *ipc_channel_default_transport(void) {
+    const char *name = getenv(IPC_CHANNEL_ENV);
+    return name && ipc_channel_find(name) ? name : IPC_CHANNEL_DEFAULT_TRANSPORT;
+}
+
+static void channel_reset(ipc_channel_t *ch) {
+    memset(ch, 0, sizeof(*ch));
+    ch->side = -1;
+    ch->send_fd = ch->recv_fd = -1;
+    for (int i = 0; i < 4; i++) {
+        ch->fds[i] = -1;
+    }
+}
+
+int ipc_channel_open(ipc_channel_t *ch, const char *transport, const ipc_channel_config_t *cfg) {
+    const ipc_channel_ops_t *ops = ipc_channel_find(transport);
+    ipc_channel_config_t defaults = { IPC_CHANNEL_DEFAULT_CAPACITY };
+
+    channel_reset(ch);
+    if (!ops) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (cfg && cfg->capacity) {
+        defaults.capacity = cfg->capacity;
+    }
+    ch->ops = ops;
+    if (ops->open(ch, &defaults) == -1) {
+        int saved = errno;
+        channel_reset(ch);
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+int ipc_channel_adopt_fd(ipc_channel_t *ch, int fd) {
+    channel_reset(ch);
+    if (ipc_channel_fd_init(ch) == -1) {
+        // O canal assumiria fd: sem ele, quem chamou não teria como fechá-lo
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    ch->ops = &ipc_channel_unix_ops;
+    ch->side = 0;
+    ch->send_fd = ch->recv_fd = fd;
+    return 0;
+}
+
+int ipc_channel_attach(ipc_channel_t *ch, int side) {
+    if (!ch->ops || ch->side != -1 || (side != 0 && side != 1)) {
+        errno = EINVAL;
+        return -1;
+    }
+    ch->side = side;
+    ch->ops->attach(ch, side);
+    return 0;
+}
+
+int ipc_channel_send(ipc_channel_t *ch, const void *buf, size_t len) {
+    if (!ch->ops || ch->side == -1) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (len > IPC_FRAME_MAX_PAYLOAD) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    return ch->ops->send(ch, buf, len);
+}
+
+int ipc_channel_recv(ipc_channel_t *ch, void *buf, size_t cap, size_t *len) {
+    if (!ch->ops || ch->side == -1) {
+        errno = EINVAL;
+        return -1;
+    }
+    return ch->ops->recv(ch, buf, cap, len);
+}
+
+int ipc_channel_send_batch(ipc_channel_t *ch, const ipc_channel_msg_t *msgs, int count) {
+    if (!ch->ops || ch->side == -1 || count < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (msgs[i].len > IPC_FRAME_MAX_PAYLOAD) {
+            errno = EMSGSIZE;
+            return -1;
+        }
+    }
+    if (ch->ops->send_batch) {
+        return ch->ops->send_batch(ch, msgs, count);
+    }
+    for (int i = 0; i < count; i++) {
+        if (ch->ops->send(ch, msgs[i].buf, msgs[i].len) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int ipc_channel_recv_batch(ipc_channel_t *ch, ipc_channel_msg_t *msgs, int count) {
+    if (!ch->ops || ch->side == -1 || count <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (ch->ops->recv_batch) {
+        return ch->ops->recv_batch(ch, msgs, count);
+    }
+    int rc = ch->ops->recv(ch, msgs[0].buf, msgs[0].cap, &msgs[0].len);
+    return rc <= 0 ? rc : 1;
+}
+
+void ipc_channel_close(ipc_channel_t *ch) {
+    if (ch->ops) {
+        ch->ops->close(ch);
+    }
+    channel_reset(ch);
+}
+
+int ipc_channel_fd(const ipc_channel_t *ch) {
+    return ch->send_fd;
+}
+
+size_t ipc_channel_pending(const ipc_channel_t *ch) {
+    return ch->rlen - ch->rpos;
+}
+
+// --- Base dos transportes por descritor ---
+
+static uint32_t get_u32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+int ipc_channel_fd_init(ipc_channel_t *ch) {
+    ch->rbuf = malloc(IPC_CHANNEL_READ_BUFFER);
+    ch->rpos = ch->rlen = 0;
+    return ch->rbuf ? 0 : -1;
+}
+
+// writev() até o fim, avançando o vetor em escritas parciais
+static int writev_all(ipc_channel_t *ch, struct iovec *iov, int count) {
+    while (count > 0) {
+        ch->syscalls++;
+        ssize_t n = writev(ch->send_fd, iov, count > IOV_MAX ? IOV_MAX : count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+int ipc_channel_fd_send(ipc_channel_t *ch, const void *buf, size_t len) {
+    unsigned char header[IPC_FRAME_HEADER_SIZE];
+    struct iovec iov[2] = { { header, sizeof(header) }, { (void *)buf, len } };
+
+    put_u32(header, (uint32_t)len);
+    return writev_all(ch, iov, len ? 2 : 1);
+}
+
+int ipc_channel_fd_send_batch(ipc_channel_t *ch, const ipc_channel_msg_t *msgs, int count) {
+    unsigned char headers[IPC_CHANNEL_MAX_BATCH][IPC_FRAME_HEADER_SIZE];
+    struct iovec iov[2 * IPC_CHANNEL_MAX_BATCH];
+
+    while (count > 0) {
+        int chunk = count < IPC_CHANNEL_MAX_BATCH ? count : IPC_CHANNEL_MAX_BATCH, n = 0;
+        for (int i = 0; i < chunk; i++) {
+            put_u32(headers[i], (uint32_t)msgs[i].len);
+            iov[n].iov_base = headers[i];
+            iov[n++].iov_len = IPC_FRAME_HEADER_SIZE;
+            if (msgs[i].len) {
+                iov[n].iov_base = msgs[i].buf;
+                iov[n++].iov_len = msgs[i].len;
+            }
+        }
+        if (writev_all(ch, iov, n) == -1) {
+            return -1;
+        }
+        msgs += chunk;
+        count -= chunk;
+    }
+    return 0;
+}
+
+/**
+ * @brief Garante need bytes (até IPC_CHANNEL_READ_BUFFER) no buffer de leitura.
+ *
+ * @return 1 com os bytes disponíveis, 0 em EOF com o buffer vazio, -1 em erro (EPIPE: EOF no meio).
+ */
+static int fill(ipc_channel_t *ch, size_t need) {
+    if (ch->rlen - ch->rpos >= need) {
+        return 1;
+    }
+    // Compacta quando o que falta não cabe depois do que já está no buffer
+    if (ch->rpos + need > IPC_CHANNEL_READ_BUFFER) {
+        memmove(ch->rbuf, ch->rbuf + ch->rpos, ch->rlen - ch->rpos);
+        ch->rlen -= ch->rpos;
+        ch->rpos = 0;
+    }
+    while (ch->rlen - ch->rpos < need) {
+        ch->syscalls++;
+        ssize_t n = read(ch->recv_fd, ch->rbuf + ch->rlen, IPC_CHANNEL_READ_BUFFER - ch->rlen);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            if (ch->rlen == ch->rpos) {
+                return 0;
+            }
+            errno = EPIPE;
+            return -1;
+        }
+        ch->rlen += (size_t)n;
+    }
+    return 1;
+}
+
+// Copia len bytes da mensagem corrente: primeiro o que está no buffer, o resto direto do descritor
+static int take(ipc_channel_t *ch, unsigned char *dst, size_t len) {
+    size_t buffered = ch->rlen - ch->rpos;
+    size_t part = buffered < len ? buffered : len;
+
+    if (dst) {
+        memcpy(dst, ch->rbuf + ch->rpos, part);
+    }
+    ch->rpos += part;
+    len -= part;
+    if (ch->rpos == ch->rlen) {
+        ch->rpos = ch->rlen = 0;
+    }
+    while (len > 0) {
+        if (dst && len >= IPC_CHANNEL_READ_BUFFER) {
+            // Mensagem grande: sem passar pelo buffer
+            ch->syscalls++;
+            ssize_t n = read(ch->recv_fd, dst + part, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            if (n == 0) {
+                errno = EPIPE;
+                return -1;
+            }
+            part += (size_t)n;
+            len -= (size_t)n;
+            continue;
+        }
+        size_t want = len < IPC_CHANNEL_READ_BUFFER ? len : IPC_CHANNEL_READ_BUFFER;
+        int rc = fill(ch, want);
+        if (rc != 1) {
+            if (rc == 0) {
+                errno = EPIPE;
+            }
+            return -1;
+        }
+        if (dst) {
+            memcpy(dst + part, ch->rbuf + ch->rpos, want);
+        }
+        ch->rpos += want;
+        part += want;
+        len -= want;
+    }
+    return 0;
+}
+
+int ipc_channel_fd_recv(ipc_channel_t *ch, void *buf, size_t cap, size_t *len) {
+    int rc = fill(ch, IPC_FRAME_HEADER_SIZE);
+    if (rc <= 0) {
+        return rc;
+    }
+    uint32_t size = get_u32(ch->rbuf + ch->rpos);
+    if (size > IPC_FRAME_MAX_PAYLOAD) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    ch->rpos += IPC_FRAME_HEADER_SIZE;
+    if (size > cap) {
+        // Descarta a carga para o próximo recv começar num quadro inteiro
+        take(ch, NULL, size);
+        errno = EMSGSIZE;
+        return -1;
+    }
+    if (take(ch, buf, size) == -1) {
+        return -1;
+    }
+    *len = size;
+    return 1;
+}
+
+int ipc_channel_fd_recv_batch(ipc_channel_t *ch, ipc_channel_msg_t *msgs, int count) {
+    int rc = ipc_channel_fd_recv(ch, msgs[0].buf, msgs[0].cap, &msgs[0].len);
+    if (rc <= 0) {
+        return rc;
+    }
+    // As seguintes só se já estiverem inteiras no buffer: nenhum syscall a mais
+    int got = 1;
+    while (got < count && ch->rlen - ch->rpos >= IPC_FRAME_HEADER_SIZE) {
+        uint32_t size = get_u32(ch->rbuf + ch->rpos);
+        if (size > msgs[got].cap || ch->rlen - ch->rpos - IPC_FRAME_HEADER_SIZE < size) {
+            break;
+        }
+        memcpy(msgs[got].buf, ch->rbuf + ch->rpos + IPC_FRAME_HEADER_SIZE, size);
+        msgs[got].len = size;
+        ch->rpos += IPC_FRAME_HEADER_SIZE + size;
+        got++;
+    }
+    if (ch->rpos == ch->rlen) {
+        ch->rpos = ch->rlen = 0;
+    }
+    return got;
+}
+
+void ipc_channel_fd_close(ipc_channel_t *ch) {
+    if (ch->send_fd != -1) {
+        close(ch->send_fd);
+    }
+    if (ch->recv_fd != -1 && ch->recv_fd != ch->send_fd) {
+        close(ch->recv_fd);
+    }
+    ch->send_fd = ch->recv_fd = -1;
+    free(ch->rbuf);
+    ch->rbuf = NULL;
+    ch->rpos = ch->rlen = 0;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file ipc_channel.h
+ * @brief Canal de mensagens bidirecional com transporte plugável (pipe, AF_UNIX ou ring em SHM)
+ *
+ * Os dois extremos de um canal são criados juntos por ipc_channel_open()
+ * antes do fork(); depois dele cada processo chama ipc_channel_attach()
+ * com o seu lado (0 ou 1) e passa a usar a mesma API qualquer que seja o
+ * transporte:
+ *
+ *   - pipe: dois pipes anônimos, um por sentido (pipes/pipe_channel.c);
+ *   - unix: um socketpair() AF_UNIX SOCK_STREAM (sockets/socket_channel.c);
+ *   - shm:  dois rings SPSC em memória compartilhada (shared_memory/shm_channel.c).
+ *
+ * Toda mensagem preserva a fronteira: nos descritores ela vai como quadro de
+ * ipc_io.h, lido por um buffer interno para que mensagens pequenas em
+ * sequência custem um read() só; no ring, cada registro é uma mensagem (as
+ * maiores que o maior registro são fatiadas e remontadas). send_batch
+ * entrega várias mensagens num único writev(); recv_batch devolve, além da
+ * primeira, as que já estiverem no buffer, sem outro syscall.
+ *
+ * O transporte é escolhido por nome, o que permite trocá-lo por
+ * configuração (IPC_CHANNEL_ENV) e medir todos pelo mesmo código.
+ */
+
+#ifndef IPC_CHANNEL_H
+#define IPC_CHANNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Variável de ambiente com o transporte padrão de ipc_channel_default_transport()
+#define IPC_CHANNEL_ENV "IPC_TRANSPORT"
+#define IPC_CHANNEL_DEFAULT_TRANSPORT "pipe"
+
+// Buffer de leitura dos transportes por descritor (mensagens maiores são lidas direto no destino)
+#define IPC_CHANNEL_READ_BUFFER (64 * 1024)
+
+// Capacidade padrão de cada sentido (F_SETPIPE_SZ, SO_SNDBUF/SO_RCVBUF ou dados do ring)
+#define IPC_CHANNEL_DEFAULT_CAPACITY (1024 * 1024)
+
+// Mensagens por writev() em send_batch (metade de IOV_MAX: prefixo + carga)
+#define IPC_CHANNEL_MAX_BATCH 512
+
+struct ipc_channel;
+
+/**
+ * @brief Uma mensagem de um lote: buf/len na ida; na volta buf/cap são o destino e len o recebido.
+ */
+typedef struct {
+    void *buf;
+    size_t len;
+    size_t cap;
+} ipc_channel_msg_t;
+
+/**
+ * @brief Configuração de ipc_channel_open().
+ */
+typedef struct {
+    size_t capacity;                // Bytes por sentido (0: IPC_CHANNEL_DEFAULT_CAPACITY)
+} ipc_channel_config_t;
+
+/**
+ * @brief Operações de um transporte. side é 0 no pai e 1 no filho.
+ *
+ * send_batch e recv_batch podem ser NULL: a API recorre a send/recv um a um.
+ */
+typedef struct {
+    const char *name;
+    int (*open)(struct ipc_channel *ch, const ipc_channel_config_t *cfg);
+    void (*attach)(struct ipc_channel *ch, int side);        // Após o fork: fecha o que o lado não usa
+    int (*send)(struct ipc_channel *ch, const void *buf, size_t len);
+    int (*recv)(struct ipc_channel *ch, void *buf, size_t cap, size_t *len);
+    int (*send_batch)(struct ipc_channel *ch, const ipc_channel_msg_t *msgs, int count);
+    int (*recv_batch)(struct ipc_channel *ch, ipc_channel_msg_t *msgs, int count);
+    void (*close)(struct ipc_channel *ch);
+} ipc_channel_ops_t;
+
+/**
+ * @brief Estado de um canal. Os campos são dos transportes; o chamador só usa a API.
+ */
+typedef struct ipc_channel {
+    const ipc_channel_ops_t *ops;
+    int side;                       // -1 antes de ipc_channel_attach()
+    int fds[4];                     // pipe: [0..1] lado 0->1, [2..3] lado 1->0; unix: [0..1] socketpair
+    int send_fd, recv_fd;           // Descritores do lado corrente (transportes por descritor)
+    void *shm[2];                   // shm: ring 0->1 e ring 1->0 (shm_manager_t *)
+    // Buffer de leitura dos transportes por descritor
+    unsigned char *rbuf;
+    size_t rpos, rlen;
+    uint64_t syscalls;              // read()/write()/writev() feitos por este lado
+} ipc_channel_t;
+
+// Transportes disponíveis, na ordem de ipc_channel_transport()
+extern const ipc_channel_ops_t ipc_channel_pipe_ops;
+extern const ipc_channel_ops_t ipc_channel_unix_ops;
+extern const ipc_channel_ops_t ipc_channel_shm_ops;
+
+/**
+ * @brief Procura um transporte pelo nome ("pipe", "unix" ou "shm").
+ *
+ * @return Operações do transporte, ou NULL se o nome for desconhecido.
+ */
+const ipc_channel_ops_t *ipc_channel_find(const char *name);
+
+/**
+ * @brief i-ésimo transporte registrado, para percorrer todos.
+ *
+ * @return Operações do transporte, ou NULL depois do último.
+ */
+const ipc_channel_ops_t *ipc_channel_transport(int index);
+
+/**
+ * @brief Nome do transporte configurado em IPC_CHANNEL_ENV, ou IPC_CHANNEL_DEFAULT_TRANSPORT.
+ */
+const char *ipc_channel_default_transport(void);
+
+/**
+ * @brief Cria os dois extremos do canal (chamar antes do fork()).
+ *
+ * @param ch Canal a inicializar.
+ * @param transport Nome do transporte.
+ * @param cfg Configuração (NULL: padrões).
+ * @return 0 em sucesso, -1 em erro (EINVAL para transporte desconhecido).
+ */
+int ipc_channel_open(ipc_channel_t *ch, const char *transport, const ipc_channel_config_t *cfg);
+
+/**
+ * @brief Adota um socket AF_UNIX stream já conectado como canal unix do lado 0.
+ *
+ * Para conexões feitas por connect()/accept() em vez de ipc_channel_open().
+ * O canal passa a ser dono de fd: ipc_channel_close() o fecha e, em erro,
+ * ele já volta fechado.
+ *
+ * @return 0 em sucesso, -1 em erro.
+ */
+int ipc_channel_adopt_fd(ipc_channel_t *ch, int fd);
+
+/**
+ * @brief Escolhe o lado deste processo após o fork() (0 no pai, 1 no filho).
+ *
+ * Obrigatória: send/recv falham com EINVAL num canal ainda sem lado, e o
+ * attach fecha o que o lado escolhido não usa. Cada processo fica, portanto,
+ * com um único lado.
+ *
+ * @return 0 em sucesso, -1 em erro.
+ */
+int ipc_channel_attach(ipc_channel_t *ch, int side);
+
+/**
+ * @brief Envia uma mensagem ao outro lado (bloqueia enquanto o sentido estiver cheio).
+ *
+ * @return 0 em sucesso, -1 em erro (EMSGSIZE acima de IPC_FRAME_MAX_PAYLOAD).
+ */
+int ipc_channel_send(ipc_channel_t *ch, const void *buf, size_t len);
+
+/**
+ * @brief Recebe a próxima mensagem (bloqueia até ela chegar).
+ *
+ * @param buf Destino.
+ * @param cap Capacidade de buf.
+ * @param len Recebe o tamanho da mensagem.
+ * @return 1 com uma mensagem, 0 se o outro lado fechou o canal, -1 em erro
+ *         (EMSGSIZE se a mensagem não couber em cap).
+ */
+int ipc_channel_recv(ipc_channel_t *ch, void *buf, size_t cap, size_t *len);
+
+/**
+ * @brief Envia count mensagens, na ordem, com o menor número de syscalls do transporte.
+ *
+ * @return 0 em sucesso, -1 em erro.
+ */
+int ipc_channel_send_batch(ipc_channel_t *ch, const ipc_channel_msg_t *msgs, int count);
+
+/**
+ * @brief Recebe de 1 a count mensagens: espera a primeira e leva as que já tiverem chegado.
+ *
+ * @return Mensagens recebidas (msgs[i].len preenchido), 0 se o outro lado fechou o canal, -1 em erro.
+ */
+int ipc_channel_recv_batch(ipc_channel_t *ch, ipc_channel_msg_t *msgs, int count);
+
+/**
+ * @brief Fecha o lado corrente; o outro lado passa a ver fim do canal.
+ *
+ * No transporte shm o lado 0 (criador) também remove os segmentos.
+ */
+void ipc_channel_close(ipc_channel_t *ch);
+
+/**
+ * @brief Descritor do lado corrente nos transportes por descritor (-1 no shm).
+ *
+ * Usado para E/S fora do canal na mesma conexão (ex.: SCM_RIGHTS); só é
+ * seguro com o buffer de leitura vazio (ipc_channel_pending() == 0).
+ */
+int ipc_channel_fd(const ipc_channel_t *ch);
+
+/**
+ * @brief Bytes já lidos do descritor e ainda não entregues por recv.
+ */
+size_t ipc_channel_pending(const ipc_channel_t *ch);
+
+// --- Base dos transportes por descritor (pipe e unix) ---
+
+/**
+ * @brief Inicializa o buffer de leitura; chamado pelo open dos transportes por descritor.
+ */
+int ipc_channel_fd_init(ipc_channel_t *ch);
+
+int ipc_channel_fd_send(ipc_channel_t *ch, const void *buf, size_t len);
+int ipc_channel_fd_recv(ipc_channel_t *ch, void *buf, size_t cap, size_t *len);
+int ipc_channel_fd_send_batch(ipc_channel_t *ch, const ipc_channel_msg_t *msgs, int count);
+int ipc_channel_fd_recv_batch(ipc_channel_t *ch, ipc_channel_msg_t *msgs, int count);
+
+/**
+ * @brief Libera o buffer de leitura e fecha send_fd/recv_fd (uma vez, mesmo se forem o mesmo fd).
+ */
+void ipc_channel_fd_close(ipc_channel_t *ch);
+
+#endif // IPC_CHANNEL_H
@@ -0,0 +1,181 @@
+#define _GNU_SOURCE
+#include "ipc_io.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+// Caminho do limite de F_SETPIPE_SZ para processos sem CAP_SYS_RESOURCE
+#define PIPE_MAX_SIZE_PATH "/proc/sys/fs/pipe-max-size"
+
+// Cargas até este tamanho são copiadas junto do prefixo para sair num só write()
+#define FRAME_INLINE_MAX 4096
+
+int ipc_write_all(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int ipc_read_all(int fd, void *buf, size_t len) {
+    char *p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            errno = EPIPE;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static void put_u32(unsigned char *p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+int ipc_write_frame_header(int fd, size_t len) {
+    unsigned char header[IPC_FRAME_HEADER_SIZE];
+
+    if (len > IPC_FRAME_MAX_PAYLOAD) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    put_u32(header, (uint32_t)len);
+    return ipc_write_all(fd, header, sizeof(header));
+}
+
+int ipc_write_frame(int fd, const void *buf, size_t len) {
+    unsigned char header[IPC_FRAME_HEADER_SIZE + FRAME_INLINE_MAX];
+
+    if (len > IPC_FRAME_MAX_PAYLOAD) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    put_u32(header, (uint32_t)len);
+    if (len <= FRAME_INLINE_MAX) {
+        if (len > 0) {
+            memcpy(header + IPC_FRAME_HEADER_SIZE, buf, len);
+        }
+        return ipc_write_all(fd, header, IPC_FRAME_HEADER_SIZE + len);
+    }
+    if (ipc_write_all(fd, header, IPC_FRAME_HEADER_SIZE) == -1) {
+        return -1;
+    }
+    return ipc_write_all(fd, buf, len);
+}
+
+int ipc_read_frame_header(int fd, uint32_t *len) {
+    unsigned char header[IPC_FRAME_HEADER_SIZE];
+    size_t got = 0;
+
+    // O primeiro read() distingue EOF limpo de prefixo truncado
+    while (got == 0) {
+        ssize_t n = read(fd, header, sizeof(header));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            return 0;
+        }
+        got = (size_t)n;
+    }
+    if (got < sizeof(header) && ipc_read_all(fd, header + got, sizeof(header) - got) == -1) {
+        return -1;
+    }
+    *len = (uint32_t)header[0] | (uint32_t)header[1] << 8 |
+           (uint32_t)header[2] << 16 | (uint32_t)header[3] << 24;
+    if (*len > IPC_FRAME_MAX_PAYLOAD) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    return 1;
+}
+
+int ipc_read_frame(int fd, void *buf, size_t cap, size_t *len) {
+    uint32_t size;
+    int rc = ipc_read_frame_header(fd, &size);
+    if (rc <= 0) {
+        return rc;
+    }
+    if (size > cap) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    if (ipc_read_all(fd, buf, size) == -1) {
+        return -1;
+    }
+    *len = size;
+    return 1;
+}
+
+long ipc_pipe_set_size(int fd, size_t size) {
+    int rc = fcntl(fd, F_SETPIPE_SZ, (int)size);
+    if (rc == -1 && errno == EPERM) {
+        // Acima de pipe-max-size sem privilégio: usa o próprio limite
+        FILE *f = fopen(PIPE_MAX_SIZE_PATH, "r");
+        long max = 0;
+        if (f) {
+            if (fscanf(f, "%ld", &max) != 1) {
+                max = 0;
+            }
+            fclose(f);
+        }
+        if (max > 0 && (size_t)max < size) {
+            rc = fcntl(fd, F_SETPIPE_SZ, (int)max);
+        }
+    }
+    if (rc == -1) {
+        return -1;
+    }
+    return rc;
+}
+
+int ipc_vmsplice_all(int pipe_fd, const void *buf, size_t len) {
+    struct iovec iov = { (void *)buf, len };
+    while (iov.iov_len > 0) {
+        ssize_t n = vmsplice(pipe_fd, &iov, 1, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        iov.iov_base = (char *)iov.iov_base + n;
+        iov.iov_len -= (size_t)n;
+    }
+    return 0;
+}
+
+int ipc_splice_all(int in_fd, int out_fd, size_t len) {
+    while (len > 0) {
+        ssize_t n = splice(in_fd, NULL, out_fd, NULL, len, SPLICE_F_MOVE);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) {
+            errno = EPIPE;
+            return -1;
+        }
+        len -= (size_t)n;
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file ipc_io.h
+ * @brief E/S completa e quadros com prefixo de tamanho sobre descritores de stream
+ *
+ * read() e write() em pipes e sockets podem transferir menos bytes que o
+ * pedido (o pipe enche, chega um sinal, o outro lado escreveu em pedaços).
+ * Estas funções repetem a chamada até completar a transferência e montam
+ * sobre isso um enquadramento simples: cada mensagem é precedida pelo seu
+ * tamanho em 4 bytes little-endian, de modo que o leitor sabe exatamente
+ * quanto ler e nada é truncado.
+ */
+
+#ifndef IPC_IO_H
+#define IPC_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Tamanho do prefixo de um quadro (u32 little-endian)
+#define IPC_FRAME_HEADER_SIZE 4
+
+// Maior carga aceita em um quadro (protege o leitor de prefixos corrompidos)
+#define IPC_FRAME_MAX_PAYLOAD (256U * 1024 * 1024)
+
+/**
+ * @brief Escreve len bytes, repetindo write() em escritas parciais e EINTR.
+ *
+ * @param fd Descritor de destino.
+ * @param buf Dados a enviar.
+ * @param len Quantidade de bytes.
+ * @return 0 em sucesso, -1 em erro (errno de write()).
+ */
+int ipc_write_all(int fd, const void *buf, size_t len);
+
+/**
+ * @brief Lê exatamente len bytes, repetindo read() em leituras parciais e EINTR.
+ *
+ * @param fd Descritor de origem.
+ * @param buf Destino (ao menos len bytes).
+ * @param len Quantidade de bytes.
+ * @return 0 em sucesso, -1 em erro; EOF antes de len bytes vira errno = EPIPE.
+ */
+int ipc_read_all(int fd, void *buf, size_t len);
+
+/**
+ * @brief Envia um quadro: prefixo de tamanho seguido da carga.
+ *
+ * Cargas pequenas vão num único write() junto com o prefixo; um quadro de
+ * tamanho 0 é válido (usado como marcador de fim de stream).
+ *
+ * @param fd Descritor de destino.
+ * @param buf Carga do quadro.
+ * @param len Tamanho da carga (até IPC_FRAME_MAX_PAYLOAD).
+ * @return 0 em sucesso, -1 em erro (EMSGSIZE se len exceder o limite).
+ */
+int ipc_write_frame(int fd, const void *buf, size_t len);
+
+/**
+ * @brief Envia só o prefixo de um quadro; a carga segue por outro caminho
+ *        (ipc_write_all(), ipc_vmsplice_all() ou ipc_splice_all()).
+ *
+ * @param fd Descritor de destino.
+ * @param len Tamanho da carga que virá em seguida.
+ * @return 0 em sucesso, -1 em erro (EMSGSIZE se len exceder o limite).
+ */
+int ipc_write_frame_header(int fd, size_t len);
+
+/**
+ * @brief Lê o prefixo do próximo quadro.
+ *
+ * Separado de ipc_read_frame() para o chamador dimensionar o buffer antes
+ * de ler a carga com ipc_read_all().
+ *
+ * @param fd Descritor de origem.
+ * @param len Recebe o tamanho da carga.
+ * @return 1 com um prefixo lido, 0 em EOF limpo (nenhum byte), -1 em erro
+ *         (EPIPE para prefixo incompleto, EMSGSIZE acima do limite).
+ */
+int ipc_read_frame_header(int fd, uint32_t *len);
+
+/**
+ * @brief Lê um quadro inteiro para um buffer de capacidade conhecida.
+ *
+ * @param fd Descritor de origem.
+ * @param buf Destino da carga.
+ * @param cap Capacidade de buf.
+ * @param len Recebe o tamanho da carga.
+ * @return 1 com um quadro lido, 0 em EOF limpo, -1 em erro
+ *         (EMSGSIZE se a carga não couber em cap; o prefixo já foi consumido).
+ */
+int ipc_read_frame(int fd, void *buf, size_t cap, size_t *len);
+
+/**
+ * @brief Ajusta a capacidade de um pipe com F_SETPIPE_SZ.
+ *
+ * Sem privilégio o kernel limita o pedido a /proc/sys/fs/pipe-max-size;
+ * nesse caso a função tenta o limite em vez de falhar.
+ *
+ * @param fd Qualquer ponta do pipe.
+ * @param size Capacidade desejada em bytes (o kernel arredonda para potência de 2 em páginas).
+ * @return Capacidade efetiva em bytes, ou -1 em erro.
+ */
+long ipc_pipe_set_size(int fd, size_t size);
+
+/**
+ * @brief Mapeia len bytes do usuário num pipe com vmsplice(), sem cópia.
+ *
+ * O pipe passa a referenciar as páginas de buf: o chamador não pode
+ * alterá-las até o leitor consumir os dados (de preferência buf alinhado
+ * à página, para não arrastar vizinhos). Repete em transferências parciais.
+ *
+ * @param pipe_fd Ponta de escrita do pipe.
+ * @param buf Dados a enviar.
+ * @param len Quantidade de bytes.
+ * @return 0 em sucesso, -1 em erro (errno de vmsplice()).
+ */
+int ipc_vmsplice_all(int pipe_fd, const void *buf, size_t len);
+
+/**
+ * @brief Move len bytes entre descritores com splice(); ao menos um é pipe.
+ *
+ * Pipe para pipe, as páginas mudam de dono sem cópia; pipe para arquivo ou
+ * socket, o kernel escreve direto das páginas do pipe.
+ *
+ * @param in_fd Origem.
+ * @param out_fd Destino.
+ * @param len Quantidade de bytes.
+ * @return 0 em sucesso, -1 em erro; EOF antes de len bytes vira errno = EPIPE.
+ */
+int ipc_splice_all(int in_fd, int out_fd, size_t len);
+
+#endif // IPC_IO_H
@@ -0,0 +1,286 @@
+#define _GNU_SOURCE
+#include "ipc_uring.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#ifdef IPC_HAVE_IO_URING
+#include <linux/io_uring.h>
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, const void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+int ipc_uring_init(ipc_uring_t *ring, unsigned entries, int sqpoll) {
+    struct io_uring_params p;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&p, 0, sizeof(p));
+    if (sqpoll) {
+        p.flags |= IORING_SETUP_SQPOLL;
+        p.sq_thread_idle = IPC_URING_SQPOLL_IDLE_MS;
+    }
+    ring->ring_fd = sys_io_uring_setup(entries, &p);
+    if (ring->ring_fd == -1) {
+        return -1;
+    }
+    ring->sqpoll = sqpoll;
+    // Girar só faz sentido se a thread SQPOLL e o outro processo puderem rodar em paralelo
+    ring->spin_limit = sqpoll && sysconf(_SC_NPROCESSORS_ONLN) > 1 ? IPC_URING_SPIN_LIMIT : 0;
+    ring->sq_entries = p.sq_entries;
+    ring->cq_entries = p.cq_entries;
+
+    // Kernels >= 5.4 (IORING_FEAT_SINGLE_MMAP) expõem as duas filas num só mapeamento
+    ring->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && ring->cq_ring_size > ring->sq_ring_size) {
+        ring->sq_ring_size = ring->cq_ring_size;
+    }
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring->ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = NULL;
+        ipc_uring_close(ring);
+        return -1;
+    }
+    ring->cq_ring = single ? ring->sq_ring :
+                    mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring->ring_fd, IORING_OFF_CQ_RING);
+    if (ring->cq_ring == MAP_FAILED) {
+        ring->cq_ring = NULL;
+        ipc_uring_close(ring);
+        return -1;
+    }
+    ring->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        ipc_uring_close(ring);
+        return -1;
+    }
+
+    char *sq = ring->sq_ring, *cq = ring->cq_ring;
+    ring->sq_head = (unsigned *)(sq + p.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    ring->sq_flags = (unsigned *)(sq + p.sq_off.flags);
+    ring->sq_array = (unsigned *)(sq + p.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + p.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    ring->cqes = cq + p.cq_off.cqes;
+    ring->sq_local_tail = *ring->sq_tail;
+    return 0;
+}
+
+int ipc_uring_register_files(ipc_uring_t *ring, const int *fds, unsigned count) {
+    if (sys_io_uring_register(ring->ring_fd, IORING_REGISTER_FILES, fds, count) == -1) {
+        return -1;
+    }
+    ring->fixed_files = 1;
+    return 0;
+}
+
+int ipc_uring_register_buffer(ipc_uring_t *ring, void *buf, size_t len) {
+    struct iovec iov = { buf, len };
+    if (sys_io_uring_register(ring->ring_fd, IORING_REGISTER_BUFFERS, &iov, 1) == -1) {
+        return -1;
+    }
+    ring->fixed_buffer = 1;
+    return 0;
+}
+
+int ipc_uring_prep(ipc_uring_t *ring, ipc_uring_op_t op, int file, void *buf, unsigned len,
+                   uint64_t user_data, int link) {
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_local_tail - head >= ring->sq_entries) {
+        errno = EBUSY;
+        return -1;
+    }
+    unsigned index = ring->sq_local_tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = (struct io_uring_sqe *)ring->sqes + index;
+
+    memset(sqe, 0, sizeof(*sqe));
+    if (ring->fixed_buffer) {
+        sqe->opcode = op == IPC_URING_READ ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+        sqe->buf_index = 0;
+    } else {
+        sqe->opcode = op == IPC_URING_READ ? IORING_OP_READ : IORING_OP_WRITE;
+    }
+    sqe->fd = file;
+    sqe->off = (uint64_t)-1;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->user_data = user_data;
+    sqe->flags = (ring->fixed_files ? IOSQE_FIXED_FILE : 0) | (link ? IOSQE_IO_LINK : 0);
+    ring->sq_array[index] = index;
+    ring->sq_local_tail++;
+    return 0;
+}
+
+static unsigned cq_ready(const ipc_uring_t *ring) {
+    return __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE) - *ring->cq_head;
+}
+
+static int enter(ipc_uring_t *ring, unsigned to_submit, unsigned wait_nr, unsigned flags) {
+    for (;;) {
+        ring->syscalls++;
+        int rc = sys_io_uring_enter(ring->ring_fd, to_submit, wait_nr, flags);
+        if (rc >= 0) {
+            return rc;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+int ipc_uring_submit_and_wait(ipc_uring_t *ring, unsigned wait_nr) {
+    unsigned published = ring->sq_local_tail - *ring->sq_tail;
+
+    // Publica o novo tail depois dos SQEs escritos
+    __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+    ring->sq_unsubmitted += published;
+
+    if (!ring->sqpoll) {
+        unsigned flags = wait_nr ? IORING_ENTER_GETEVENTS : 0;
+        if (ring->sq_unsubmitted == 0 && (wait_nr == 0 || cq_ready(ring) >= wait_nr)) {
+            return 0;
+        }
+        int rc = enter(ring, ring->sq_unsubmitted, wait_nr, flags);
+        if (rc == -1) {
+            return -1;
+        }
+        ring->sq_unsubmitted -= (unsigned)rc;
+        return 0;
+    }
+
+    // SQPOLL: a thread do kernel lê o tail; só precisa de syscall se tiver dormido
+    ring->sq_unsubmitted = 0;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (published && (__atomic_load_n(ring->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP)) {
+        if (enter(ring, 0, 0, IORING_ENTER_SQ_WAKEUP) == -1) {
+            return -1;
+        }
+    }
+    for (unsigned spin = 0; spin < ring->spin_limit && cq_ready(ring) < wait_nr; spin++) {
+        cpu_relax();
+    }
+    while (cq_ready(ring) < wait_nr) {
+        if (enter(ring, 0, wait_nr - cq_ready(ring), IORING_ENTER_GETEVENTS) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int ipc_uring_pop(ipc_uring_t *ring, ipc_uring_cqe_t *cqe) {
+    unsigned head = *ring->cq_head;
+    if (__atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE) == head) {
+        return 0;
+    }
+    const struct io_uring_cqe *c = (const struct io_uring_cqe *)ring->cqes + (head & *ring->cq_mask);
+    cqe->user_data = c->user_data;
+    cqe->res = c->res;
+    // Libera a entrada para o kernel só depois de lida
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+void ipc_uring_close(ipc_uring_t *ring) {
+    if (ring->sqes) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->ring_fd > 0) {
+        close(ring->ring_fd);
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+}
+
+#else // !IPC_HAVE_IO_URING
+
+int ipc_uring_init(ipc_uring_t *ring, unsigned entries, int sqpoll) {
+    (void)entries;
+    (void)sqpoll;
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+    errno = ENOSYS;
+    return -1;
+}
+
+int ipc_uring_register_files(ipc_uring_t *ring, const int *fds, unsigned count) {
+    (void)ring;
+    (void)fds;
+    (void)count;
+    errno = ENOSYS;
+    return -1;
+}
+
+int ipc_uring_register_buffer(ipc_uring_t *ring, void *buf, size_t len) {
+    (void)ring;
+    (void)buf;
+    (void)len;
+    errno = ENOSYS;
+    return -1;
+}
+
+int ipc_uring_prep(ipc_uring_t *ring, ipc_uring_op_t op, int file, void *buf, unsigned len,
+                   uint64_t user_data, int link) {
+    (void)ring;
+    (void)op;
+    (void)file;
+    (void)buf;
+    (void)len;
+    (void)user_data;
+    (void)link;
+    errno = ENOSYS;
+    return -1;
+}
+
+int ipc_uring_submit_and_wait(ipc_uring_t *ring, unsigned wait_nr) {
+    (void)ring;
+    (void)wait_nr;
+    errno = ENOSYS;
+    return -1;
+}
+
+int ipc_uring_pop(ipc_uring_t *ring, ipc_uring_cqe_t *cqe) {
+    (void)ring;
+    (void)cqe;
+    return 0;
+}
+
+void ipc_uring_close(ipc_uring_t *ring) {
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+}
+
+#endif // IPC_HAVE_IO_URING
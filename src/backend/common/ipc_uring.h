@@ -0,0 +1,130 @@
+/**
+ * @file ipc_uring.h
+ * @brief Anel io_uring mínimo sobre syscalls diretas (sem liburing)
+ *
+ * Um io_uring são duas filas em memória compartilhada com o kernel: o
+ * processo escreve pedidos (SQEs) na fila de submissão e colhe resultados
+ * (CQEs) na de conclusão. Um único io_uring_enter() submete um lote inteiro
+ * e espera as conclusões; com SQPOLL uma thread do kernel consome a fila
+ * sozinha e a submissão não precisa de syscall algum.
+ *
+ * Este módulo cobre só o que os demos usam: criação (opcionalmente com
+ * SQPOLL), descritores fixos, um buffer registrado, leitura/escrita e a
+ * contagem dos syscalls feitos, para comparar com o caminho bloqueante.
+ * Sem <linux/io_uring.h> na compilação, ipc_uring_init() falha com ENOSYS.
+ */
+
+#ifndef IPC_URING_H
+#define IPC_URING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Ociosidade da thread SQPOLL antes de dormir (e exigir IORING_ENTER_SQ_WAKEUP)
+#define IPC_URING_SQPOLL_IDLE_MS 1000
+
+// Voltas de espera ativa pela conclusão antes de dormir em io_uring_enter() (só com SQPOLL e >1 CPU)
+#define IPC_URING_SPIN_LIMIT 4096
+
+/**
+ * @brief Operação de um pedido.
+ */
+typedef enum {
+    IPC_URING_READ,
+    IPC_URING_WRITE
+} ipc_uring_op_t;
+
+/**
+ * @brief Estado do anel. Os ponteiros apontam para as filas mapeadas do kernel.
+ */
+typedef struct {
+    int ring_fd;
+    int sqpoll;
+    int fixed_buffer;               // 1 depois de ipc_uring_register_buffer() bem-sucedido
+    int fixed_files;                // 1 depois de ipc_uring_register_files() bem-sucedido
+    unsigned spin_limit;            // Voltas de espera ativa (0 sem SQPOLL ou com uma só CPU)
+    unsigned sq_entries;
+    unsigned cq_entries;
+    // Fila de submissão
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_flags, *sq_array;
+    void *sqes;
+    unsigned sq_local_tail;         // SQEs preparados (ainda não publicados em *sq_tail)
+    unsigned sq_unsubmitted;        // Publicados e ainda não entregues ao kernel por io_uring_enter()
+    // Fila de conclusão
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    void *cqes;
+    // Mapeamentos, para o munmap()
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    uint64_t syscalls;              // io_uring_enter() feitos desde ipc_uring_init()
+} ipc_uring_t;
+
+/**
+ * @brief Resultado de um pedido concluído.
+ */
+typedef struct {
+    uint64_t user_data;
+    int32_t res;                    // Bytes transferidos, ou -errno
+} ipc_uring_cqe_t;
+
+/**
+ * @brief Cria o anel com ao menos entries pedidos simultâneos.
+ *
+ * @param ring Anel a inicializar.
+ * @param entries Profundidade da fila de submissão.
+ * @param sqpoll 1 para IORING_SETUP_SQPOLL (submissão sem syscall).
+ * @return 0 em sucesso, -1 em erro (ENOSYS sem suporte, EPERM se SQPOLL não for permitido).
+ */
+int ipc_uring_init(ipc_uring_t *ring, unsigned entries, int sqpoll);
+
+/**
+ * @brief Registra descritores fixos; os pedidos passam a usar o índice no lugar do fd.
+ *
+ * @return 0 em sucesso, -1 em erro.
+ */
+int ipc_uring_register_files(ipc_uring_t *ring, const int *fds, unsigned count);
+
+/**
+ * @brief Registra (fixa na memória) um buffer; leituras e escritas dentro dele usam READ/WRITE_FIXED.
+ *
+ * Páginas fixadas contam em RLIMIT_MEMLOCK: em ENOMEM/EPERM o chamador pode
+ * seguir sem buffer registrado (os pedidos viram READ/WRITE comuns).
+ *
+ * @return 0 em sucesso, -1 em erro.
+ */
+int ipc_uring_register_buffer(ipc_uring_t *ring, void *buf, size_t len);
+
+/**
+ * @brief Prepara um pedido de leitura ou escrita (offset -1: posição corrente do fd).
+ *
+ * @param file Índice em ipc_uring_register_files() (ou o fd, sem descritores fixos).
+ * @param link 1 para só iniciar o próximo pedido depois deste (IOSQE_IO_LINK).
+ * @return 0 em sucesso, -1 com a fila de submissão cheia (EBUSY).
+ */
+int ipc_uring_prep(ipc_uring_t *ring, ipc_uring_op_t op, int file, void *buf, unsigned len,
+                   uint64_t user_data, int link);
+
+/**
+ * @brief Entrega os pedidos preparados e espera ao menos wait_nr conclusões.
+ *
+ * Sem SQPOLL é um único io_uring_enter(). Com SQPOLL a submissão só custa
+ * syscall se a thread do kernel tiver dormido; a espera gira até
+ * IPC_URING_SPIN_LIMIT voltas (com mais de uma CPU) antes de dormir no kernel.
+ *
+ * @return 0 em sucesso, -1 em erro.
+ */
+int ipc_uring_submit_and_wait(ipc_uring_t *ring, unsigned wait_nr);
+
+/**
+ * @brief Retira uma conclusão disponível, sem syscall.
+ *
+ * @return 1 com cqe preenchido, 0 se a fila de conclusão estiver vazia.
+ */
+int ipc_uring_pop(ipc_uring_t *ring, ipc_uring_cqe_t *cqe);
+
+/**
+ * @brief Desfaz os mapeamentos e fecha o anel (os registros saem junto).
+ */
+void ipc_uring_close(ipc_uring_t *ring);
+
+#endif // IPC_URING_H
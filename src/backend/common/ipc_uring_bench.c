@@ -0,0 +1,364 @@
+#define _GNU_SOURCE
+#include "ipc_uring_bench.h"
+#include "ipc_uring.h"
+#include "ipc_io.h"
+#include "json_output.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/**
+ * @brief Caminho de E/S medido.
+ */
+typedef enum {
+    PATH_BLOCKING,
+    PATH_URING,
+    PATH_URING_SQPOLL
+} bench_path_t;
+
+static const char *path_names[] = { "blocking", "uring", "uring_sqpoll" };
+
+/**
+ * @brief Resposta do filho (leitor) ao fim de um caminho.
+ */
+typedef struct {
+    uint64_t received;          // Bytes recebidos
+    uint64_t errors;            // Mensagens com número de sequência errado
+    uint64_t syscalls;
+    uint64_t fixed_buffer;      // 1 se o buffer registrado foi aceito
+} uring_report_t;
+
+/**
+ * @brief Conferência do fluxo: os 8 primeiros bytes de cada mensagem são o seu número.
+ */
+typedef struct {
+    uint64_t offset;
+    unsigned char header[sizeof(uint64_t)];
+    uint64_t errors;
+} stream_check_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Confere um bloco lido; as mensagens podem vir partidas entre blocos
+static void check_chunk(stream_check_t *c, const unsigned char *p, size_t n, size_t size) {
+    size_t i = 0;
+    while (i < n) {
+        size_t in_msg = (size_t)(c->offset % size);
+        size_t take;
+        if (in_msg < sizeof(uint64_t)) {
+            take = sizeof(uint64_t) - in_msg < n - i ? sizeof(uint64_t) - in_msg : n - i;
+            memcpy(c->header + in_msg, p + i, take);
+            if (in_msg + take == sizeof(uint64_t)) {
+                uint64_t seq;
+                memcpy(&seq, c->header, sizeof(seq));
+                c->errors += seq != c->offset / size;
+            }
+        } else {
+            take = size - in_msg < n - i ? size - in_msg : n - i;
+        }
+        i += take;
+        c->offset += take;
+    }
+}
+
+static void fill_batch(char *buf, int n, size_t size, uint64_t first) {
+    for (int i = 0; i < n; i++) {
+        uint64_t seq = first + (uint64_t)i;
+        memcpy(buf + (size_t)i * size, &seq, sizeof(seq));
+    }
+}
+
+// fds[0] é a ponta do filho (leitura), fds[1] a do pai (escrita)
+static int channel_open(ipc_uring_bench_channel_t kind, int fds[2]) {
+    if (kind == IPC_URING_BENCH_PIPE) {
+        if (pipe2(fds, O_CLOEXEC) == -1) {
+            return -1;
+        }
+        ipc_pipe_set_size(fds[1], IPC_URING_BENCH_CHANNEL_SIZE);
+        return 0;
+    }
+    int buffer = IPC_URING_BENCH_CHANNEL_SIZE;
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) == -1) {
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        setsockopt(fds[i], SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+        setsockopt(fds[i], SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    }
+    return 0;
+}
+
+// Anel de um lado: o canal vira o descritor fixo 0; sem memlock suficiente, segue sem buffer registrado
+static int ring_setup(ipc_uring_t *ring, int fd, void *buf, size_t len, unsigned entries, int sqpoll) {
+    if (ipc_uring_init(ring, entries, sqpoll) == -1) {
+        return -1;
+    }
+    if (ipc_uring_register_files(ring, &fd, 1) == -1) {
+        ipc_uring_close(ring);
+        return -1;
+    }
+    ipc_uring_register_buffer(ring, buf, len);
+    return 0;
+}
+
+/**
+ * @brief Filho: lê cfg->messages mensagens pelo caminho dado e preenche o relatório.
+ */
+static int bench_reader(bench_path_t path, int fd, int report_fd, const ipc_uring_bench_config_t *cfg,
+                        uring_report_t *report) {
+    size_t cap = (size_t)cfg->depth * cfg->size;
+    uint64_t total = (uint64_t)cfg->messages * cfg->size;
+    unsigned char *buf = aligned_alloc(4096, (cap + 4095) & ~(size_t)4095);
+    stream_check_t check;
+    ipc_uring_t ring;
+    char ready = 1;
+    int ok = buf != NULL;
+
+    memset(&check, 0, sizeof(check));
+    memset(report, 0, sizeof(*report));
+    if (ok && path != PATH_BLOCKING) {
+        ok = ring_setup(&ring, fd, buf, cap, 2, path == PATH_URING_SQPOLL) == 0;
+        report->fixed_buffer = ok && ring.fixed_buffer;
+    }
+    ready = (char)ok;
+    if (ipc_write_all(report_fd, &ready, 1) == -1 || !ok) {
+        free(buf);
+        return -1;
+    }
+
+    while (ok && check.offset < total) {
+        // Os dois caminhos leem blocos de até um lote inteiro: a comparação mede
+        // o mecanismo de E/S, não a junção de mensagens numa leitura só
+        size_t want = total - check.offset < cap ? (size_t)(total - check.offset) : cap;
+        ssize_t got;
+        if (path == PATH_BLOCKING) {
+            got = read(fd, buf, want);
+            report->syscalls++;
+            if (got == -1 && errno == EINTR) continue;
+        } else {
+            // O mesmo bloco por io_uring_enter()
+            ipc_uring_cqe_t cqe;
+            ok = ipc_uring_prep(&ring, IPC_URING_READ, ring.fixed_files ? 0 : fd, buf, (unsigned)want, 0, 0) == 0 &&
+                 ipc_uring_submit_and_wait(&ring, 1) == 0 && ipc_uring_pop(&ring, &cqe) == 1;
+            got = ok ? cqe.res : -1;
+            if (ok && got < 0) {
+                errno = -cqe.res;
+                got = -1;
+            }
+        }
+        if (got <= 0) {
+            ok = 0;
+            break;
+        }
+        check_chunk(&check, buf, (size_t)got, cfg->size);
+    }
+    if (path != PATH_BLOCKING) {
+        report->syscalls = ring.syscalls;
+        ipc_uring_close(&ring);
+    }
+    report->received = check.offset;
+    report->errors = check.errors;
+    free(buf);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief Pai: envia cfg->messages mensagens pelo caminho dado.
+ *
+ * @return Syscalls usados, ou -1 em erro.
+ */
+static long long bench_writer(bench_path_t path, int fd, const ipc_uring_bench_config_t *cfg, ipc_uring_t *ring,
+                              char *buf) {
+    long long syscalls = 0;
+
+    for (long sent = 0; sent < cfg->messages;) {
+        int n = cfg->messages - sent < cfg->depth ? (int)(cfg->messages - sent) : cfg->depth;
+        fill_batch(buf, n, cfg->size, (uint64_t)sent);
+        if (path == PATH_BLOCKING) {
+            for (int i = 0; i < n; i++) {
+                const char *p = buf + (size_t)i * cfg->size;
+                size_t left = cfg->size;
+                while (left > 0) {
+                    ssize_t w = write(fd, p, left);
+                    syscalls++;
+                    if (w == -1) {
+                        if (errno == EINTR) continue;
+                        return -1;
+                    }
+                    p += w;
+                    left -= (size_t)w;
+                }
+            }
+            sent += n;
+            continue;
+        }
+        // Escritas encadeadas: o kernel só inicia a próxima quando a anterior termina, sem reordenar
+        for (int i = 0; i < n; i++) {
+            if (ipc_uring_prep(ring, IPC_URING_WRITE, ring->fixed_files ? 0 : fd, buf + (size_t)i * cfg->size,
+                               (unsigned)cfg->size, (uint64_t)i, i < n - 1) == -1) {
+                return -1;
+            }
+        }
+        if (ipc_uring_submit_and_wait(ring, (unsigned)n) == -1) {
+            return -1;
+        }
+        for (int i = 0; i < n; i++) {
+            ipc_uring_cqe_t cqe = { 0, 0 };
+            if (ipc_uring_pop(ring, &cqe) != 1 || cqe.res != (int32_t)cfg->size) {
+                // Uma escrita curta ou com erro cancela o resto da cadeia (-ECANCELED)
+                errno = cqe.res < 0 ? -cqe.res : EIO;
+                return -1;
+            }
+        }
+        sent += n;
+    }
+    return path == PATH_BLOCKING ? syscalls : (long long)ring->syscalls;
+}
+
+/**
+ * @brief Mede um caminho e imprime sua linha "metrics".
+ *
+ * @param msgs_per_sec Recebe a vazão (para o speedup dos caminhos seguintes).
+ * @return 0 em sucesso, 1 se o caminho não estiver disponível, -1 em erro (já relatado).
+ */
+static int bench_path(const char *module, bench_path_t path, const ipc_uring_bench_config_t *cfg,
+                      double baseline, double *msgs_per_sec) {
+    pid_t pid = getpid();
+    char status_msg[256], metrics[640];
+    int ch[2], rep[2], status;
+    size_t cap = (size_t)cfg->depth * cfg->size;
+    ipc_uring_t ring;
+    uring_report_t report;
+    char ready = 0;
+
+    memset(&ring, 0, sizeof(ring));
+    if (path != PATH_BLOCKING) {
+        // Sonda antes de criar processos: kernel sem io_uring ou SQPOLL não permitido
+        if (ipc_uring_init(&ring, 2, path == PATH_URING_SQPOLL) == -1) {
+            snprintf(status_msg, sizeof(status_msg), "Caminho %s indisponível: %s", path_names[path], strerror(errno));
+            print_json_status(module, "uring_unavailable", status_msg, pid);
+            return 1;
+        }
+        ipc_uring_close(&ring);
+    }
+    char *buf = aligned_alloc(4096, (cap + 4095) & ~(size_t)4095);
+    if (!buf || channel_open(cfg->channel, ch) == -1) {
+        print_json_error(module, "Falha ao criar o canal do modo uring", pid);
+        free(buf);
+        return -1;
+    }
+    if (pipe2(rep, O_CLOEXEC) == -1) {
+        print_json_error(module, "Falha ao criar o pipe de relatório", pid);
+        close(ch[0]);
+        close(ch[1]);
+        free(buf);
+        return -1;
+    }
+    memset(buf, 'u', cap);
+
+    pid_t child = fork();
+    if (child == 0) {
+        close(ch[1]);
+        close(rep[0]);
+        int rc = bench_reader(path, ch[0], rep[1], cfg, &report);
+        if (ipc_write_all(rep[1], &report, sizeof(report)) == -1 || rc == -1) {
+            _exit(EXIT_FAILURE);
+        }
+        _exit(EXIT_SUCCESS);
+    }
+    close(ch[0]);
+    close(rep[1]);
+    if (child == -1) {
+        print_json_error(module, "Falha no fork() do leitor", pid);
+        close(ch[1]);
+        close(rep[0]);
+        free(buf);
+        return -1;
+    }
+
+    int ok = path == PATH_BLOCKING || ring_setup(&ring, ch[1], buf, cap, (unsigned)cfg->depth,
+                                                  path == PATH_URING_SQPOLL) == 0;
+    ok = ipc_read_all(rep[0], &ready, 1) == 0 && ready && ok;
+    uint64_t start = now_ns();
+    long long writer_syscalls = ok ? bench_writer(path, ch[1], cfg, &ring, buf) : -1;
+    int writer_errno = errno;
+    close(ch[1]);
+    int got_report = ok && writer_syscalls >= 0 && ipc_read_all(rep[0], &report, sizeof(report)) == 0;
+    uint64_t end = now_ns();
+    int fixed_buffer = path != PATH_BLOCKING && ring.fixed_buffer;
+    if (path != PATH_BLOCKING) {
+        ipc_uring_close(&ring);
+    }
+    close(rep[0]);
+    waitpid(child, &status, 0);
+    free(buf);
+
+    if (!got_report || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        snprintf(status_msg, sizeof(status_msg), "Caminho %s falhou: %s", path_names[path],
+                 strerror(writer_syscalls < 0 ? writer_errno : errno));
+        print_json_error(module, status_msg, pid);
+        return -1;
+    }
+
+    uint64_t messages = report.received / cfg->size;
+    uint64_t syscalls = (uint64_t)writer_syscalls + report.syscalls;
+    double secs = (double)(end - start) / 1e9;
+    *msgs_per_sec = secs > 0 ? (double)messages / secs : 0.0;
+    snprintf(metrics, sizeof(metrics),
+             "{\"channel\":\"%s\",\"path\":\"%s\",\"messages\":%llu,\"size\":%zu,\"depth\":%d,\"read_block\":%zu,"
+             "\"registered_buffers\":%s,\"errors\":%llu,\"syscalls\":%llu,\"syscalls_per_msg\":%.4f,"
+             "\"seconds\":%.6f,\"msgs_per_sec\":%.0f,\"gb_per_sec\":%.4f,\"speedup_vs_blocking\":%.2f}",
+             cfg->channel == IPC_URING_BENCH_PIPE ? "pipe" : "socket", path_names[path],
+             (unsigned long long)messages, cfg->size, path == PATH_BLOCKING ? 1 : cfg->depth, cap,
+             fixed_buffer && report.fixed_buffer ? "true" : "false", (unsigned long long)report.errors,
+             (unsigned long long)syscalls, messages ? (double)syscalls / (double)messages : 0.0, secs,
+             *msgs_per_sec, secs > 0 ? (double)report.received / secs / 1e9 : 0.0,
+             baseline > 0 ? *msgs_per_sec / baseline : 1.0);
+    print_json_metrics(module, "uring", metrics, pid);
+
+    if (report.errors || messages != (uint64_t)cfg->messages) {
+        snprintf(status_msg, sizeof(status_msg), "Caminho %s: %llu mensagem(ns) fora de ordem.", path_names[path],
+                 (unsigned long long)report.errors);
+        print_json_error(module, status_msg, pid);
+        return -1;
+    }
+    return 0;
+}
+
+int ipc_uring_bench_run(const char *module, const ipc_uring_bench_config_t *cfg) {
+    pid_t pid = getpid();
+    char status_msg[256];
+    double blocking = 0.0, rate;
+    int failures = 0;
+
+    // O leitor pode sair antes do fim do envio em caso de erro
+    signal(SIGPIPE, SIG_IGN);
+    snprintf(status_msg, sizeof(status_msg), "Comparando E/S bloqueante e io_uring: %ld mensagens de %zu bytes, lote %d%s.",
+             cfg->messages, cfg->size, cfg->depth, cfg->sqpoll ? ", com SQPOLL" : "");
+    print_json_status(module, "uring_start", status_msg, pid);
+
+    failures += bench_path(module, PATH_BLOCKING, cfg, 0.0, &blocking) == -1;
+    failures += bench_path(module, PATH_URING, cfg, blocking, &rate) == -1;
+    if (cfg->sqpoll) {
+        failures += bench_path(module, PATH_URING_SQPOLL, cfg, blocking, &rate) == -1;
+    }
+
+    if (failures) {
+        print_json_error(module, "Um ou mais caminhos falharam.", pid);
+        return 1;
+    }
+    print_json_status(module, "success", "Comparação bloqueante x io_uring concluída.", pid);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file ipc_uring_bench.h
+ * @brief Comparação do caminho bloqueante com io_uring num pipe ou socket, usada por pipe_demo e socket_demo.
+ *
+ * O pai envia N mensagens numeradas a um filho pelo canal (pipe() ou
+ * socketpair() AF_UNIX). Cada caminho é medido em separado:
+ *   - blocking: um write() por mensagem, como os demos;
+ *   - uring: o pai mantém um lote de escritas encadeadas (IOSQE_IO_LINK, para
+ *     não reordenar o fluxo) em voo por io_uring_enter(); descritores fixos e
+ *     buffer registrado nos dois lados;
+ *   - uring_sqpoll (opcional): o mesmo com IORING_SETUP_SQPOLL.
+ * Em todos os caminhos o filho lê em blocos de até um lote (read_block na
+ * métrica), um read() ou uma leitura por io_uring_enter(): a diferença
+ * medida vem do envio em lote e do mecanismo, não de juntar mensagens na
+ * leitura. Cada linha "metrics" traz os syscalls das duas pontas por
+ * mensagem e a vazão, com o speedup sobre o caminho bloqueante.
+ */
+
+#ifndef IPC_URING_BENCH_H
+#define IPC_URING_BENCH_H
+
+#include <stddef.h>
+
+// Padrões e limites do modo uring
+#define IPC_URING_BENCH_DEFAULT_SIZE 64
+#define IPC_URING_BENCH_DEFAULT_DEPTH 32
+#define IPC_URING_BENCH_MIN_SIZE 8                 // Cabe o número de sequência
+#define IPC_URING_BENCH_MAX_SIZE 65536
+#define IPC_URING_BENCH_MAX_DEPTH 256
+
+// Capacidade pedida ao canal (F_SETPIPE_SZ ou SO_SNDBUF/SO_RCVBUF), igual para todos os caminhos
+#define IPC_URING_BENCH_CHANNEL_SIZE (1024 * 1024)
+
+/**
+ * @brief Tipo de canal entre pai e filho.
+ */
+typedef enum {
+    IPC_URING_BENCH_PIPE,
+    IPC_URING_BENCH_SOCKET
+} ipc_uring_bench_channel_t;
+
+/**
+ * @brief Configuração de ipc_uring_bench_run().
+ */
+typedef struct {
+    ipc_uring_bench_channel_t channel;
+    long messages;                  // Mensagens por caminho
+    size_t size;                    // Tamanho de cada mensagem
+    int depth;                      // Mensagens em voo por io_uring_enter()
+    int sqpoll;                     // 1 para medir também com SQPOLL
+} ipc_uring_bench_config_t;
+
+/**
+ * @brief Mede os caminhos e imprime uma linha "metrics" "uring" por caminho.
+ *
+ * Sem suporte a io_uring no kernel (ou na compilação) só o caminho
+ * bloqueante é medido e um status explica o motivo.
+ *
+ * @param module Módulo das mensagens JSON ("pipe" ou "socket").
+ * @param cfg Configuração.
+ * @return 0 em sucesso, 1 em erro (já relatado em JSON).
+ */
+int ipc_uring_bench_run(const char *module, const ipc_uring_bench_config_t *cfg);
+
+#endif // IPC_URING_BENCH_H
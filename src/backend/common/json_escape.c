@@ -0,0 +1,158 @@
+#include "json_escape.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JSON_ESCAPE_X86 1
+#endif
+
+// As leituras alinhadas podem passar do '\0' dentro do mesmo bloco (e da mesma página)
+#if defined(__has_attribute)
+#if __has_attribute(no_sanitize_address)
+#define JSON_NO_ASAN __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef JSON_NO_ASAN
+#define JSON_NO_ASAN
+#endif
+
+static int is_special(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+static const char *scan_scalar(const char *s) {
+    while (!is_special((unsigned char)*s)) {
+        s++;
+    }
+    return s;
+}
+
+#ifdef JSON_ESCAPE_X86
+
+// Máscara dos bytes especiais em 16 bytes: v <= 0x1F sem sinal equivale a min(v, 0x1F) == v
+__attribute__((target("sse2")))
+static inline int special_mask_sse2(__m128i v) {
+    __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+    __m128i backslash = _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'));
+    __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(0x1F)), v);
+    return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(quote, backslash), control));
+}
+
+// O primeiro bloco é lido a partir do endereço alinhado anterior e os bytes
+// antes de s são descartados da máscara; assim nenhuma leitura cruza página
+__attribute__((target("sse2"))) JSON_NO_ASAN
+static const char *scan_sse2(const char *s) {
+    uintptr_t offset = (uintptr_t)s & 15;
+    const char *block = s - offset;
+    unsigned mask = (unsigned)special_mask_sse2(_mm_load_si128((const __m128i *)block)) >> offset;
+    if (mask) {
+        return s + __builtin_ctz(mask);
+    }
+    for (;;) {
+        block += 16;
+        mask = (unsigned)special_mask_sse2(_mm_load_si128((const __m128i *)block));
+        if (mask) {
+            return block + __builtin_ctz(mask);
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static inline unsigned special_mask_avx2(__m256i v) {
+    __m256i quote = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+    __m256i backslash = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'));
+    __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(v, _mm256_set1_epi8(0x1F)), v);
+    return (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(quote, backslash), control));
+}
+
+__attribute__((target("avx2"))) JSON_NO_ASAN
+static const char *scan_avx2(const char *s) {
+    uintptr_t offset = (uintptr_t)s & 31;
+    const char *block = s - offset;
+    unsigned mask = special_mask_avx2(_mm256_load_si256((const __m256i *)block)) >> offset;
+    if (mask) {
+        return s + __builtin_ctz(mask);
+    }
+    for (;;) {
+        block += 32;
+        mask = special_mask_avx2(_mm256_load_si256((const __m256i *)block));
+        if (mask) {
+            return block + __builtin_ctz(mask);
+        }
+    }
+}
+
+#endif // JSON_ESCAPE_X86
+
+static json_escape_impl_t impls[3];
+static size_t impl_count = 0;
+static const json_escape_impl_t *selected = NULL;
+static pthread_once_t select_once = PTHREAD_ONCE_INIT;
+
+// Detecta a CPU uma vez; IPC_JSON_ESCAPE pode forçar uma implementação suportada
+static void select_impl(void) {
+    size_t n = 0;
+    impls[n].name = "scalar";
+    impls[n++].scan = scan_scalar;
+#ifdef JSON_ESCAPE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+        impls[n].name = "sse2";
+        impls[n++].scan = scan_sse2;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        impls[n].name = "avx2";
+        impls[n++].scan = scan_avx2;
+    }
+#endif
+    const json_escape_impl_t *best = &impls[n - 1];
+    const char *forced = getenv(JSON_ESCAPE_IMPL_ENV);
+    for (size_t i = 0; forced && i < n; i++) {
+        if (strcmp(forced, impls[i].name) == 0) {
+            best = &impls[i];
+        }
+    }
+    impl_count = n;
+    selected = best;
+}
+
+static const json_escape_impl_t *current_impl(void) {
+    pthread_once(&select_once, select_impl);
+    return selected;
+}
+
+const char *json_escape_scan(const char *s) {
+    return current_impl()->scan(s);
+}
+
+size_t json_escape_sequence(unsigned char c, char *out) {
+    static const char hex[] = "0123456789abcdef";
+    out[0] = '\\';
+    switch (c) {
+        case '"':  out[1] = '"';  return 2;
+        case '\\': out[1] = '\\'; return 2;
+        case '\n': out[1] = 'n';  return 2;
+        case '\r': out[1] = 'r';  return 2;
+        case '\t': out[1] = 't';  return 2;
+        default:
+            out[1] = 'u';
+            out[2] = '0';
+            out[3] = '0';
+            out[4] = hex[c >> 4];
+            out[5] = hex[c & 15];
+            return 6;
+    }
+}
+
+const json_escape_impl_t *json_escape_impls(size_t *count) {
+    current_impl();
+    *count = impl_count;
+    return impls;
+}
+
+const char *json_escape_impl_name(void) {
+    return current_impl()->name;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file json_escape.h
+ * @brief Varredura vetorizada (SSE2/AVX2) de caracteres que exigem escape em JSON
+ * 
+ * O custo de escapar uma string JSON está em achar os poucos bytes que
+ * precisam de escape (aspas, barra invertida e controles < 0x20) no meio de
+ * longos trechos limpos. Estas funções comparam 16 (SSE2) ou 32 (AVX2) bytes
+ * por instrução e devolvem a posição do próximo byte especial; o chamador
+ * copia o trecho limpo em bloco. A implementação é escolhida em tempo de
+ * execução conforme a CPU, com fallback escalar.
+ */
+
+#ifndef JSON_ESCAPE_H
+#define JSON_ESCAPE_H
+
+#include <stddef.h>
+
+// Maior sequência de escape gerada por json_escape_sequence() ("\u001f")
+#define JSON_ESCAPE_MAX_SEQ 6
+
+// Variável de ambiente que força uma implementação: "scalar", "sse2" ou "avx2"
+#define JSON_ESCAPE_IMPL_ENV "IPC_JSON_ESCAPE"
+
+/**
+ * @brief Função de varredura: retorna o primeiro byte especial de s.
+ * 
+ * Byte especial é '"', '\\' ou qualquer byte < 0x20, inclusive o '\0'
+ * final, então o retorno nunca passa do terminador.
+ */
+typedef const char *(*json_escape_scan_fn)(const char *s);
+
+/**
+ * @brief Implementação de varredura disponível.
+ */
+typedef struct {
+    const char *name;           // "scalar", "sse2" ou "avx2"
+    json_escape_scan_fn scan;
+} json_escape_impl_t;
+
+/**
+ * @brief Varre s com a melhor implementação suportada pela CPU.
+ * 
+ * @param s String terminada em '\0'.
+ * @return Ponteiro para o primeiro byte especial (possivelmente o '\0').
+ * 
+ * @note As versões vetoriais leem blocos alinhados que podem passar do '\0'
+ *       sem nunca cruzar uma fronteira de página (como o strlen da libc).
+ */
+const char *json_escape_scan(const char *s);
+
+/**
+ * @brief Gera a sequência de escape de um byte especial (exceto '\0').
+ * 
+ * Usa \\" \\\\ \\n \\r \\t e \\u00XX para os demais controles.
+ * 
+ * @param c Byte especial.
+ * @param out Destino com pelo menos JSON_ESCAPE_MAX_SEQ bytes (sem terminador).
+ * @return Bytes gravados em out.
+ */
+size_t json_escape_sequence(unsigned char c, char *out);
+
+/**
+ * @brief Lista as implementações suportadas por esta CPU (escalar primeiro).
+ * 
+ * @param count Recebe o número de entradas.
+ * @return Vetor estático de implementações.
+ */
+const json_escape_impl_t *json_escape_impls(size_t *count);
+
+/**
+ * @brief Nome da implementação usada por json_escape_scan().
+ * 
+ * @return "scalar", "sse2" ou "avx2".
+ */
+const char *json_escape_impl_name(void);
+
+#endif // JSON_ESCAPE_H
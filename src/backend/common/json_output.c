@@ -1,137 +1,1267 @@
 #include "json_output.h"
+#include "json_escape.h"
 #include <stdio.h>
-#include <time.h>
-#include <string.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#define JSON_OUTPUT_HAS_TSC 1
+#endif
+
+/**
+ * @brief Carimbo de tempo de um registro, tirado quando ele é emitido.
+ */
+typedef struct {
+    uint64_t ts_ns;         // Relógio configurado (ver json_clock_t)
+    uint64_t seq;           // Ordem do registro no processo
+    uint64_t elapsed_ns;    // Desde o registro anterior da mesma thread (0 no primeiro)
+} json_stamp_t;
+
+/**
+ * @brief Entrada da tabela de strings internadas (formato binário).
+ */
+typedef struct {
+    uint32_t hash;
+    uint16_t id;
+    uint8_t len;
+    uint8_t used;
+    char text[JSON_INTERN_MAX_LEN];
+} json_intern_slot_t;
+
+/**
+ * @brief Buffer de saída de uma thread.
+ *
+ * Os registros são escapados e montados diretamente aqui, sem heap; vários
+ * registros completos podem se acumular até a política de flush mandar
+ * escrevê-los com write(2).
+ */
+typedef struct {
+    char data[JSON_OUTPUT_BUFFER_SIZE];
+    size_t len;                 // Bytes pendentes (registros completos + o registro em montagem)
+    size_t record_start;        // Onde começa o registro em montagem
+    int spilled;                // O registro em montagem não coube e já foi parcialmente escrito
+    uint64_t first_pending_ns;  // Instante do registro pendente mais antigo (política por tempo)
+    uint64_t last_event_ns;     // ts_ns do último registro desta thread (para elapsed_ns)
+    json_stamp_t stamp;         // Carimbo do registro em montagem
+    int registered;             // Já associado à chave de flush no término da thread
+    int hold;                   // Registro binário em montagem: não pode ser escrito pela metade
+    int overflow;               // ... e não coube no buffer (será descartado)
+    size_t frame_carry;         // Bytes de um quadro binário grande ainda por vir no próximo lote
+    uint32_t tid;               // Escopo dos ids internados (0: ainda não lido)
+    unsigned intern_count;
+    json_intern_slot_t intern[JSON_INTERN_SLOTS];
+} json_out_buffer_t;
+
+static __thread json_out_buffer_t tls_out;
+
+// Política global (definida no início do processo, antes de criar threads)
+static json_flush_policy_t flush_policy = JSON_FLUSH_IMMEDIATE;
+static size_t flush_size = JSON_OUTPUT_DEFAULT_FLUSH_SIZE;
+static long flush_interval_ms = JSON_OUTPUT_DEFAULT_FLUSH_MS;
+static json_format_t output_format = JSON_FORMAT_TEXT;
+static int output_fd = STDOUT_FILENO;
 
-// Função auxiliar para escapar strings JSON
-char* escape_json_string(const char* input) {
-    if (!input) return NULL;
-    
-    int len = strlen(input);
-    int escaped_len = len;
-    
-    // Conta caracteres que precisam ser escapados
-    for (int i = 0; i < len; i++) {
-        if (input[i] == '"' || input[i] == '\\' || input[i] == '\n' || input[i] == '\r' || input[i] == '\t') {
-            escaped_len += 1;
-        }
-    }
-    
-    char* escaped = malloc(escaped_len + 1);
-    if (!escaped) return NULL;
-    
-    int j = 0;
-    for (int i = 0; i < len; i++) {
-        switch (input[i]) {
-            case '"':
-                escaped[j++] = '\\';
-                escaped[j++] = '"';
-                break;
-            case '\\':
-                escaped[j++] = '\\';
-                escaped[j++] = '\\';
-                break;
-            case '\n':
-                escaped[j++] = '\\';
-                escaped[j++] = 'n';
-                break;
-            case '\r':
-                escaped[j++] = '\\';
-                escaped[j++] = 'r';
-                break;
-            case '\t':
-                escaped[j++] = '\\';
-                escaped[j++] = 't';
-                break;
-            default:
-                escaped[j++] = input[i];
-                break;
-        }
-    }
-    escaped[j] = '\0';
-    return escaped;
+static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_flush_key;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-void print_json_status(const char* module, const char* status, const char* message, int pid) {
-    time_t now;
-    time(&now);
-    
-    char* escaped_module = escape_json_string(module);
-    char* escaped_status = escape_json_string(status);
-    char* escaped_message = escape_json_string(message);
-    
-    if (pid > 0) {
-        printf("{\"type\":\"status\",\"module\":\"%s\",\"status\":\"%s\",\"message\":\"%s\",\"pid\":%d,\"timestamp\":%ld}\n", 
-               escaped_module ? escaped_module : module, 
-               escaped_status ? escaped_status : status, 
-               escaped_message ? escaped_message : message, 
-               pid, now);
-    } else {
-        printf("{\"type\":\"status\",\"module\":\"%s\",\"status\":\"%s\",\"message\":\"%s\",\"timestamp\":%ld}\n", 
-               escaped_module ? escaped_module : module, 
-               escaped_status ? escaped_status : status, 
-               escaped_message ? escaped_message : message, 
-               now);
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Relógio dos carimbos e campos opcionais (definidos no início do processo)
+static json_clock_t stamp_clock = JSON_CLOCK_REALTIME;
+static unsigned stamp_fields = 0;
+static uint64_t stamp_seq = 0;
+static int64_t monotonic_to_realtime_ns = 0;    // Converte ts_ns monotônico no "timestamp" em segundos
+
+#ifdef JSON_OUTPUT_HAS_TSC
+// TSC -> ns no domínio do CLOCK_MONOTONIC: base + (tsc - tsc_base) * mult / 2^32
+static uint64_t tsc_base = 0;
+static uint64_t tsc_base_ns = 0;
+static uint64_t tsc_mult = 0;
+
+// Só um TSC invariante (frequência fixa, sincronizado entre núcleos) serve de relógio
+static int tsc_invariant(void) {
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    return (edx & (1u << 8)) != 0;
+}
+
+// Mede a frequência contra o CLOCK_MONOTONIC por JSON_OUTPUT_TSC_CALIBRATION_MS
+static int tsc_calibrate(void) {
+    if (!tsc_invariant()) {
+        return -1;
+    }
+    uint64_t ns0 = monotonic_ns();
+    uint64_t tsc0 = __rdtsc();
+    struct timespec pause = { 0, JSON_OUTPUT_TSC_CALIBRATION_MS * 1000000L };
+    nanosleep(&pause, NULL);
+    uint64_t ns1 = monotonic_ns();
+    uint64_t tsc1 = __rdtsc();
+    if (tsc1 <= tsc0 || ns1 <= ns0) {
+        return -1;
+    }
+    tsc_mult = (uint64_t)(((unsigned __int128)(ns1 - ns0) << 32) / (tsc1 - tsc0));
+    tsc_base = tsc1;
+    tsc_base_ns = ns1;
+    return 0;
+}
+
+static uint64_t tsc_ns(void) {
+    return tsc_base_ns + (uint64_t)(((unsigned __int128)(__rdtsc() - tsc_base) * tsc_mult) >> 32);
+}
+#endif
+
+static uint64_t clock_now_ns(void) {
+    switch (stamp_clock) {
+        case JSON_CLOCK_MONOTONIC:
+            return monotonic_ns();
+#ifdef JSON_OUTPUT_HAS_TSC
+        case JSON_CLOCK_TSC:
+            return tsc_ns();
+#endif
+        case JSON_CLOCK_REALTIME:
+        default:
+            return realtime_ns();
+    }
+}
+
+static void take_stamp(json_stamp_t *stamp, uint64_t *last_event_ns) {
+    stamp->ts_ns = clock_now_ns();
+    stamp->seq = (stamp_fields & JSON_FIELD_SEQ) ? __atomic_fetch_add(&stamp_seq, 1, __ATOMIC_RELAXED) : 0;
+    stamp->elapsed_ns = *last_event_ns ? stamp->ts_ns - *last_event_ns : 0;
+    *last_event_ns = stamp->ts_ns;
+}
+
+// "timestamp" continua em segundos de relógio de parede, qualquer que seja o relógio
+static long long stamp_seconds(const json_stamp_t *stamp) {
+    int64_t wall_ns = (int64_t)stamp->ts_ns + (stamp_clock == JSON_CLOCK_REALTIME ? 0 : monotonic_to_realtime_ns);
+    return (long long)(wall_ns / 1000000000LL);
+}
+
+// write(2) completo; erros (ex: EPIPE com o leitor fechado) descartam a saída
+static void write_fully(const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(output_fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+}
+
+// Escreve o conteúdo pendente do buffer. Os lotes são cortados em fronteiras
+// de registro e limitados a PIPE_BUF, para que linhas de pai e filho que
+// compartilham o mesmo pipe nunca se misturem; um registro maior que
+// PIPE_BUF vai sozinho.
+static uint32_t get_u32(const char *p) {
+    const unsigned char *u = (const unsigned char *)p;
+    return (uint32_t)u[0] | (uint32_t)u[1] << 8 | (uint32_t)u[2] << 16 | (uint32_t)u[3] << 24;
+}
+
+// Fim do lote binário que começa em start: quadros inteiros até PIPE_BUF
+static size_t binary_batch_end(json_out_buffer_t *b, size_t start) {
+    size_t end = start;
+    if (b->frame_carry > 0) {
+        // Continuação de um quadro maior que o buffer
+        size_t n = b->frame_carry < b->len - start ? b->frame_carry : b->len - start;
+        b->frame_carry -= n;
+        return start + n;
     }
+    while (end < b->len) {
+        size_t frame_end = end + 4 + get_u32(b->data + end);
+        if (end > start && frame_end - start > PIPE_BUF) {
+            break;
+        }
+        if (frame_end > b->len) {
+            b->frame_carry = frame_end - b->len;
+            return b->len;
+        }
+        end = frame_end;
+    }
+    return end;
+}
+
+static void flush_buffer(json_out_buffer_t *b) {
+    size_t start = 0;
+
+    // Mantém a ordem com quem usa printf() no mesmo stdout
     fflush(stdout);
-    
-    // Libera memória alocada
-    free(escaped_module);
-    free(escaped_status);
-    free(escaped_message);
+    while (start < b->len && output_format == JSON_FORMAT_BINARY) {
+        size_t end = binary_batch_end(b, start);
+        write_fully(b->data + start, end - start);
+        start = end;
+    }
+    while (start < b->len) {
+        size_t window = b->len - start < PIPE_BUF ? b->len - start : PIPE_BUF;
+        size_t end = start + window;
+        if (end < b->len) {
+            const char *nl = NULL;
+            for (size_t i = end; i > start; i--) {
+                if (b->data[i - 1] == '\n') {
+                    nl = b->data + i - 1;
+                    break;
+                }
+            }
+            if (!nl) {
+                nl = memchr(b->data + end, '\n', b->len - end);
+            }
+            end = nl ? (size_t)(nl - b->data) + 1 : b->len;
+        }
+        write_fully(b->data + start, end - start);
+        start = end;
+    }
+    b->len = 0;
 }
 
-void print_json_data(const char* module, const char* data, const char* source, int pid) {
-    time_t now;
-    time(&now);
-    
-    char* escaped_module = escape_json_string(module);
-    char* escaped_data = escape_json_string(data);
-    char* escaped_source = escape_json_string(source);
-    
-    if (pid > 0) {
-        printf("{\"type\":\"data\",\"module\":\"%s\",\"data\":\"%s\",\"source\":\"%s\",\"pid\":%d,\"timestamp\":%ld}\n", 
-               escaped_module ? escaped_module : module, 
-               escaped_data ? escaped_data : data, 
-               escaped_source ? escaped_source : source, 
-               pid, now);
+static void flush_at_exit(void) {
+    flush_buffer(&tls_out);
+}
+
+static void async_prepare_fork(void);
+static void async_parent_fork(void);
+static void async_child_fork(void);
+static int async_start(size_t capacity);
+
+static void flush_before_fork(void) {
+    // Sem isso o filho herdaria uma cópia dos registros pendentes e os repetiria
+    async_prepare_fork();
+    flush_buffer(&tls_out);
+}
+
+static void flush_after_fork_parent(void) {
+    async_parent_fork();
+}
+
+static void flush_after_fork_child(void) {
+    // Outro tid: as strings internadas precisam ser definidas de novo
+    memset(tls_out.intern, 0, sizeof(tls_out.intern));
+    tls_out.intern_count = 0;
+    tls_out.tid = 0;
+    async_child_fork();
+}
+
+static void flush_on_thread_exit(void *buffer) {
+    flush_buffer((json_out_buffer_t *)buffer);
+}
+
+// Lê IPC_JSON_FLUSH: "immediate", "size[:bytes]", "time[:ms]" ou "async[:eventos]"
+static void parse_flush_env(void) {
+    const char *value = getenv(JSON_OUTPUT_FLUSH_ENV);
+    if (!value) {
+        return;
+    }
+    const char *arg = strchr(value, ':');
+    size_t name_len = arg ? (size_t)(arg - value) : strlen(value);
+    long number = arg ? atol(arg + 1) : 0;
+
+    if (name_len == 4 && strncasecmp(value, "size", 4) == 0) {
+        json_output_set_flush_policy(JSON_FLUSH_SIZE, number > 0 ? (size_t)number : 0, 0);
+    } else if (name_len == 4 && strncasecmp(value, "time", 4) == 0) {
+        json_output_set_flush_policy(JSON_FLUSH_TIME, 0, number > 0 ? number : 0);
+    } else if (name_len == 5 && strncasecmp(value, "async", 5) == 0) {
+        async_start(number > 0 ? (size_t)number : 0);
     } else {
-        printf("{\"type\":\"data\",\"module\":\"%s\",\"data\":\"%s\",\"source\":\"%s\",\"timestamp\":%ld}\n", 
-               escaped_module ? escaped_module : module, 
-               escaped_data ? escaped_data : data, 
-               escaped_source ? escaped_source : source, 
-               now);
+        json_output_set_flush_policy(JSON_FLUSH_IMMEDIATE, 0, 0);
     }
-    fflush(stdout);
-    
-    // Libera memória alocada
-    free(escaped_module);
-    free(escaped_data);
-    free(escaped_source);
 }
 
-void print_json_error(const char* module, const char* error, int pid) {
-    time_t now;
-    time(&now);
-    
-    char* escaped_module = escape_json_string(module);
-    char* escaped_error = escape_json_string(error);
-    
+// Lê IPC_JSON_CLOCK ("realtime", "monotonic" ou "tsc"), IPC_JSON_FIELDS ("seq,elapsed")
+// e IPC_JSON_FORMAT ("json" ou "binary")
+static void parse_stream_env(void) {
+    const char *clock_name = getenv(JSON_OUTPUT_CLOCK_ENV);
+    const char *fields = getenv(JSON_OUTPUT_FIELDS_ENV);
+    const char *format = getenv(JSON_OUTPUT_FORMAT_ENV);
+
+    if (format && strcasecmp(format, "binary") == 0) {
+        json_output_set_format(JSON_FORMAT_BINARY);
+    }
+
+    if (clock_name && strcasecmp(clock_name, "monotonic") == 0) {
+        json_output_set_clock(JSON_CLOCK_MONOTONIC);
+    } else if (clock_name && strcasecmp(clock_name, "tsc") == 0) {
+        json_output_set_clock(JSON_CLOCK_TSC);
+    }
+    if (fields) {
+        unsigned flags = 0;
+        if (strstr(fields, "seq")) flags |= JSON_FIELD_SEQ;
+        if (strstr(fields, "elapsed")) flags |= JSON_FIELD_ELAPSED;
+        json_output_set_fields(flags);
+    }
+}
+
+static void init_output(void) {
+    pthread_key_create(&thread_flush_key, flush_on_thread_exit);
+    pthread_atfork(flush_before_fork, flush_after_fork_parent, flush_after_fork_child);
+    atexit(flush_at_exit);
+    monotonic_to_realtime_ns = (int64_t)realtime_ns() - (int64_t)monotonic_ns();
+    parse_stream_env();
+    parse_flush_env();
+}
+
+static json_out_buffer_t *out_buffer(void) {
+    pthread_once(&init_once, init_output);
+    json_out_buffer_t *b = &tls_out;
+    if (!b->registered) {
+        // A thread principal é coberta pelo atexit; as demais pelo destrutor da chave
+        pthread_setspecific(thread_flush_key, b);
+        b->registered = 1;
+    }
+    return b;
+}
+
+// Acrescenta bytes ao buffer; se encher no meio de um registro muito
+// grande, escreve o que já existe e continua
+static void out_write(json_out_buffer_t *b, const char *p, size_t n) {
+    while (n > 0) {
+        if (b->len == sizeof(b->data)) {
+            if (b->hold) {
+                // Registro binário em montagem: escreve só os anteriores e o traz para o início
+                size_t start = b->record_start, partial = b->len - start;
+                if (start == 0) {
+                    b->overflow = 1;
+                    return;
+                }
+                b->len = start;
+                flush_buffer(b);
+                memmove(b->data, b->data + start, partial);
+                b->len = partial;
+                b->record_start = 0;
+                continue;
+            }
+            flush_buffer(b);
+            b->record_start = 0;
+            b->spilled = 1;
+        }
+        size_t space = sizeof(b->data) - b->len;
+        size_t chunk = n < space ? n : space;
+        memcpy(b->data + b->len, p, chunk);
+        b->len += chunk;
+        p += chunk;
+        n -= chunk;
+    }
+}
+
+#define out_literal(b, lit) out_write((b), (lit), sizeof(lit) - 1)
+
+// Escapa em uma única passada: a varredura vetorizada acha o próximo byte
+// especial e o trecho limpo antes dele é copiado em bloco
+static void out_escaped(json_out_buffer_t *b, const char *s) {
+    char seq[JSON_ESCAPE_MAX_SEQ];
+    for (;;) {
+        const char *stop = json_escape_scan(s);
+        out_write(b, s, (size_t)(stop - s));
+        if (*stop == '\0') {
+            return;
+        }
+        out_write(b, seq, json_escape_sequence((unsigned char)*stop, seq));
+        s = stop + 1;
+    }
+}
+
+static void out_int(json_out_buffer_t *b, long long value) {
+    char digits[24];
+    char *p = digits + sizeof(digits);
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        *--p = '-';
+    }
+    out_write(b, p, (size_t)(digits + sizeof(digits) - p));
+}
+
+static void out_key(json_out_buffer_t *b, const char *key) {
+    out_literal(b, ",\"");
+    out_escaped(b, key);
+    out_literal(b, "\":");
+}
+
+size_t json_escape_into(char *dst, size_t dst_size, const char *src) {
+    size_t needed = 0;
+    size_t limit = dst_size > 0 ? dst_size - 1 : 0;  // Reserva o terminador
+    int truncated = 0;
+    char seq[JSON_ESCAPE_MAX_SEQ];
+
+    for (;;) {
+        const char *stop = json_escape_scan(src);
+        size_t run = (size_t)(stop - src);
+        if (!truncated) {
+            size_t copy = needed + run <= limit ? run : limit - needed;
+            if (copy > 0) {
+                memcpy(dst + needed, src, copy);
+            }
+            truncated = copy < run;
+            if (truncated) {
+                limit = needed + copy;
+            }
+        }
+        needed += run;
+        if (*stop == '\0') {
+            break;
+        }
+        size_t width = json_escape_sequence((unsigned char)*stop, seq);
+        // Nunca corta uma sequência de escape ao meio
+        if (!truncated && needed + width <= limit) {
+            memcpy(dst + needed, seq, width);
+        } else if (!truncated) {
+            truncated = 1;
+            limit = needed;
+        }
+        needed += width;
+        src = stop + 1;
+    }
+    if (dst_size > 0) {
+        dst[needed < limit ? needed : limit] = '\0';
+    }
+    return needed;
+}
+
+// Campos comuns aos dois caminhos (chamada direta e thread de escrita assíncrona)
+static void record_open(json_out_buffer_t *b, const char *type, const char *module) {
+    if (b->len == 0) {
+        b->first_pending_ns = monotonic_ns();
+    }
+    b->record_start = b->len;
+    b->spilled = 0;
+    out_literal(b, "{\"type\":\"");
+    out_escaped(b, type);
+    out_literal(b, "\",\"module\":\"");
+    out_escaped(b, module ? module : "");
+    out_literal(b, "\"");
+}
+
+static void record_string(json_out_buffer_t *b, const char *key, const char *value) {
+    out_key(b, key);
+    out_literal(b, "\"");
+    out_escaped(b, value ? value : "");
+    out_literal(b, "\"");
+}
+
+static void record_int(json_out_buffer_t *b, const char *key, long long value) {
+    out_key(b, key);
+    out_int(b, value);
+}
+
+static void record_close(json_out_buffer_t *b, const json_stamp_t *stamp) {
+    record_int(b, "timestamp", stamp_seconds(stamp));
+    record_int(b, "ts_ns", (long long)stamp->ts_ns);
+    if (stamp_fields & JSON_FIELD_SEQ) {
+        record_int(b, "seq", (long long)stamp->seq);
+    }
+    if (stamp_fields & JSON_FIELD_ELAPSED) {
+        record_int(b, "elapsed_ns", (long long)stamp->elapsed_ns);
+    }
+    out_literal(b, "}\n");
+}
+
+// Tipos de registro; os valores batem com json_frame_kind_t
+typedef enum {
+    JSON_EVENT_STATUS = JSON_FRAME_STATUS,
+    JSON_EVENT_DATA = JSON_FRAME_DATA,
+    JSON_EVENT_ERROR = JSON_FRAME_ERROR,
+    JSON_EVENT_METRICS = JSON_FRAME_METRICS,
+    JSON_EVENT_LINE = JSON_FRAME_LINE   // Registro já montado por json_record_*()
+} json_event_kind_t;
+
+/* ------------------------------------------------------------------------
+ * Formato binário
+ *
+ * Cada registro vira um quadro com prefixo de tamanho (layout em
+ * json_frame_kind_t). module, status e source se repetem muito e vão como
+ * u16: a primeira ocorrência de cada string numa thread gera um quadro DEF
+ * antes do registro que a usa. Como os ids são por thread (tid), não há
+ * tabela compartilhada nem trava, e a ordem dos quadros de uma thread
+ * garante que o DEF chega primeiro.
+ * ------------------------------------------------------------------------ */
+
+static void put_le(char *p, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        p[i] = (char)(value >> (8 * i));
+    }
+}
+
+static void out_le(json_out_buffer_t *b, uint64_t value, int bytes) {
+    char p[8];
+    put_le(p, value, bytes);
+    out_write(b, p, (size_t)bytes);
+}
+
+static void out_str(json_out_buffer_t *b, const char *s, size_t len) {
+    out_le(b, len, 4);
+    out_write(b, s, len);
+}
+
+static uint32_t writer_tid(json_out_buffer_t *b) {
+    if (b->tid == 0) {
+        b->tid = (uint32_t)syscall(SYS_gettid);
+    }
+    return b->tid;
+}
+
+// Garante espaço contíguo para um quadro inteiro (até o tamanho do buffer)
+static void out_reserve(json_out_buffer_t *b, size_t n) {
+    if (n > sizeof(b->data)) {
+        n = sizeof(b->data);
+    }
+    if (sizeof(b->data) - b->len < n) {
+        flush_buffer(b);
+    }
+}
+
+static void out_frame_header(json_out_buffer_t *b, size_t frame_size, int kind, int flags, uint16_t id) {
+    char h[JSON_FRAME_HEADER_SIZE];
+    out_reserve(b, frame_size);
+    put_le(h, frame_size - 4, 4);
+    h[4] = (char)kind;
+    h[5] = (char)flags;
+    put_le(h + 6, id, 2);
+    put_le(h + 8, writer_tid(b), 4);
+    out_write(b, h, sizeof(h));
+}
+
+// FNV-1a
+static uint32_t intern_hash(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)s[i]) * 16777619u;
+    }
+    return h;
+}
+
+// Id da string nesta thread, definindo-a no stream na primeira vez;
+// JSON_FRAME_LITERAL se for longa demais ou a tabela estiver cheia
+static uint16_t intern(json_out_buffer_t *b, const char *s, size_t len) {
+    if (len > JSON_INTERN_MAX_LEN) {
+        return JSON_FRAME_LITERAL;
+    }
+    uint32_t h = intern_hash(s, len);
+    for (size_t probe = 0, i = h & (JSON_INTERN_SLOTS - 1); probe < JSON_INTERN_SLOTS;
+         probe++, i = (i + 1) & (JSON_INTERN_SLOTS - 1)) {
+        json_intern_slot_t *slot = &b->intern[i];
+        if (!slot->used) {
+            if (b->intern_count >= JSON_INTERN_LIMIT) {
+                return JSON_FRAME_LITERAL;
+            }
+            slot->used = 1;
+            slot->hash = h;
+            slot->len = (uint8_t)len;
+            slot->id = (uint16_t)b->intern_count++;
+            memcpy(slot->text, s, len);
+            out_frame_header(b, JSON_FRAME_HEADER_SIZE + len, JSON_FRAME_DEF, 0, slot->id);
+            out_write(b, s, len);
+            return slot->id;
+        }
+        if (slot->hash == h && slot->len == len && memcmp(slot->text, s, len) == 0) {
+            return slot->id;
+        }
+    }
+    return JSON_FRAME_LITERAL;
+}
+
+static size_t tag_size(uint16_t id, size_t len) {
+    return 2 + (id == JSON_FRAME_LITERAL ? 4 + len : 0);
+}
+
+static void out_tag(json_out_buffer_t *b, uint16_t id, const char *s, size_t len) {
+    out_le(b, id, 2);
+    if (id == JSON_FRAME_LITERAL) {
+        out_str(b, s, len);
+    }
+}
+
+static void emit_binary(json_out_buffer_t *b, json_event_kind_t kind, int pid, const json_stamp_t *stamp,
+                        const char *module, const char *first, const char *second) {
+    size_t module_len = strlen(module), first_len = strlen(first), second_len = strlen(second);
+    int flags = ((stamp_fields & JSON_FIELD_SEQ) ? JSON_FRAME_F_SEQ : 0) |
+                ((stamp_fields & JSON_FIELD_ELAPSED) ? JSON_FRAME_F_ELAPSED : 0);
+
+    // Os DEFs precisam sair antes do quadro que usa os ids
+    uint16_t module_id = intern(b, module, module_len);
+    uint16_t tag_id = 0;
+    if (kind == JSON_EVENT_STATUS) {
+        tag_id = intern(b, first, first_len);
+    } else if (kind == JSON_EVENT_DATA) {
+        tag_id = intern(b, second, second_len);
+    }
+
+    size_t size = JSON_FRAME_HEADER_SIZE + (module_id == JSON_FRAME_LITERAL ? 4 + module_len : 0) + 16 +
+                  ((flags & JSON_FRAME_F_SEQ) ? 8 : 0) + ((flags & JSON_FRAME_F_ELAPSED) ? 8 : 0);
+    switch (kind) {
+        case JSON_EVENT_STATUS: size += tag_size(tag_id, first_len) + 4 + second_len; break;
+        case JSON_EVENT_DATA:   size += 4 + first_len + tag_size(tag_id, second_len); break;
+        case JSON_EVENT_ERROR:  size += 4 + first_len; break;
+        default:                size += 4 + first_len + 4 + second_len; break;
+    }
+
+    out_frame_header(b, size, kind, flags, module_id);
+    if (module_id == JSON_FRAME_LITERAL) {
+        out_str(b, module, module_len);
+    }
+    char fixed[32];
+    size_t n = 16;
+    put_le(fixed, (uint32_t)pid, 4);
+    put_le(fixed + 4, (uint64_t)stamp_seconds(stamp), 4);
+    put_le(fixed + 8, stamp->ts_ns, 8);
+    if (flags & JSON_FRAME_F_SEQ) {
+        put_le(fixed + n, stamp->seq, 8);
+        n += 8;
+    }
+    if (flags & JSON_FRAME_F_ELAPSED) {
+        put_le(fixed + n, stamp->elapsed_ns, 8);
+        n += 8;
+    }
+    out_write(b, fixed, n);
+
+    switch (kind) {
+        case JSON_EVENT_STATUS:
+            out_tag(b, tag_id, first, first_len);
+            out_str(b, second, second_len);
+            break;
+        case JSON_EVENT_DATA:
+            out_str(b, first, first_len);
+            out_tag(b, tag_id, second, second_len);
+            break;
+        case JSON_EVENT_ERROR:
+            out_str(b, first, first_len);
+            break;
+        default:
+            out_str(b, first, first_len);
+            out_str(b, second, second_len);
+            break;
+    }
+}
+
+// Um registro dos print_json_*(), no formato configurado
+static void emit_event(json_out_buffer_t *b, json_event_kind_t kind, int pid, const json_stamp_t *stamp,
+                       const char *module, const char *first, const char *second) {
+    module = module ? module : "";
+    first = first ? first : "";
+    second = second ? second : "";
+
+    if (output_format == JSON_FORMAT_BINARY) {
+        if (b->len == 0) {
+            b->first_pending_ns = monotonic_ns();
+        }
+        emit_binary(b, kind, pid, stamp, module, first, second);
+        return;
+    }
+    switch (kind) {
+        case JSON_EVENT_STATUS:
+            record_open(b, "status", module);
+            record_string(b, "status", first);
+            record_string(b, "message", second);
+            break;
+        case JSON_EVENT_DATA:
+            record_open(b, "data", module);
+            record_string(b, "data", first);
+            record_string(b, "source", second);
+            break;
+        case JSON_EVENT_ERROR:
+            record_open(b, "error", module);
+            record_string(b, "error", first);
+            break;
+        case JSON_EVENT_METRICS:
+        default:
+            record_open(b, "metrics", module);
+            record_string(b, "name", first);
+            out_key(b, "metrics");
+            out_write(b, second, strlen(second));
+            break;
+    }
     if (pid > 0) {
-        printf("{\"type\":\"error\",\"module\":\"%s\",\"error\":\"%s\",\"pid\":%d,\"timestamp\":%ld}\n", 
-               escaped_module ? escaped_module : module, 
-               escaped_error ? escaped_error : error, 
-               pid, now);
-    } else {
-        printf("{\"type\":\"error\",\"module\":\"%s\",\"error\":\"%s\",\"timestamp\":%ld}\n", 
-               escaped_module ? escaped_module : module, 
-               escaped_error ? escaped_error : error, 
-               now);
+        record_int(b, "pid", pid);
     }
-    fflush(stdout);
-    
-    // Libera memória alocada
-    free(escaped_module);
-    free(escaped_error);
+    record_close(b, stamp);
+}
+
+// Registro de json_record_*() já montado em texto (com '\n' no fim)
+static void emit_line(json_out_buffer_t *b, const char *line, size_t len) {
+    if (output_format == JSON_FORMAT_BINARY && len > 0) {
+        len--;
+        out_frame_header(b, JSON_FRAME_HEADER_SIZE + len, JSON_FRAME_LINE, 0, 0);
+    }
+    out_write(b, line, len);
+}
+
+// Formato binário: o texto do registro em montagem ganha o cabeçalho de quadro no lugar
+static void wrap_line_in_place(json_out_buffer_t *b) {
+    size_t text_len = b->len - b->record_start - 1;  // Sem o '\n'
+    if (b->record_start + JSON_FRAME_HEADER_SIZE + text_len > sizeof(b->data)) {
+        // Abre espaço escrevendo antes os registros anteriores
+        size_t start = b->record_start;
+        b->len = start;
+        flush_buffer(b);
+        memmove(b->data, b->data + start, text_len);
+        b->record_start = 0;
+    }
+    if (JSON_FRAME_HEADER_SIZE + text_len > sizeof(b->data)) {
+        b->len = 0;
+        return;
+    }
+    char *frame = b->data + b->record_start;
+    memmove(frame + JSON_FRAME_HEADER_SIZE, frame, text_len);
+    put_le(frame, JSON_FRAME_HEADER_SIZE - 4 + text_len, 4);
+    frame[4] = (char)JSON_FRAME_LINE;
+    frame[5] = 0;
+    put_le(frame + 6, 0, 2);
+    put_le(frame + 8, writer_tid(b), 4);
+    b->len = b->record_start + JSON_FRAME_HEADER_SIZE + text_len;
+}
+
+static void apply_flush_policy(json_out_buffer_t *b) {
+    switch (flush_policy) {
+        case JSON_FLUSH_SIZE:
+            if (b->len >= flush_size) {
+                flush_buffer(b);
+            }
+            break;
+        case JSON_FLUSH_TIME:
+            if (monotonic_ns() - b->first_pending_ns >= (uint64_t)flush_interval_ms * 1000000ULL) {
+                flush_buffer(b);
+            }
+            break;
+        case JSON_FLUSH_IMMEDIATE:
+        default:
+            flush_buffer(b);
+            break;
+    }
+}
+
+/* ------------------------------------------------------------------------
+ * Modo assíncrono
+ *
+ * Quem registra só copia os textos para um evento binário de tamanho fixo
+ * numa fila MPSC limitada (fila de Vyukov: cada célula tem um número de
+ * sequência, os produtores disputam a posição com CAS e o consumidor único
+ * não precisa de atomics de leitura-modificação-escrita). Uma thread de
+ * escrita formata os eventos no próprio buffer e os escreve em lotes.
+ * Fila cheia descarta o evento e incrementa um contador.
+ * ------------------------------------------------------------------------ */
+
+// Cabeçalho de um evento; o resto da célula é texto
+#define JSON_EVENT_HEADER_SIZE 48
+#define JSON_EVENT_TEXT_SIZE (JSON_OUTPUT_ASYNC_EVENT_SIZE - JSON_EVENT_HEADER_SIZE)
+
+/**
+ * @brief Célula da fila: um evento ainda não formatado.
+ *
+ * text guarda module e até dois campos, cada um terminado em '\0' (ou, em
+ * JSON_EVENT_LINE, os len bytes da linha pronta).
+ */
+typedef struct {
+    size_t seq;             // == posição: livre; == posição + 1: publicada
+    json_stamp_t stamp;     // Tirado por quem registrou, não pela thread de escrita
+    int32_t pid;
+    uint32_t len;
+    uint8_t kind;
+    uint8_t reserved[7];
+    char text[JSON_EVENT_TEXT_SIZE];
+} json_event_t;
+
+typedef char json_event_size_check[sizeof(json_event_t) == JSON_OUTPUT_ASYNC_EVENT_SIZE ? 1 : -1];
+
+static json_event_t *async_cells = NULL;
+static size_t async_mask = 0;
+static int async_active = 0;
+static size_t async_enqueue_pos __attribute__((aligned(64)));   // Disputada pelos produtores
+static size_t async_dequeue_pos __attribute__((aligned(64)));   // Só a thread de escrita
+static size_t async_written_pos;                                 // Eventos já entregues ao write(2)
+static int async_sleeping __attribute__((aligned(64)));          // Futex: escrita esperando eventos
+static int async_stop = 0;
+static int async_worker_running = 0;
+static pthread_t async_worker;
+static pthread_mutex_t async_start_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t async_worker_lock = PTHREAD_MUTEX_INITIALIZER; // Presa enquanto há lote em andamento
+static unsigned long long async_dropped = 0;
+static unsigned long long async_truncated = 0;
+
+static void async_wake_worker(void) {
+    if (__atomic_exchange_n(&async_sleeping, 0, __ATOMIC_SEQ_CST)) {
+        syscall(SYS_futex, &async_sleeping, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+static int async_cell_ready(size_t pos) {
+    return __atomic_load_n(&async_cells[pos & async_mask].seq, __ATOMIC_SEQ_CST) == pos + 1;
+}
+
+static void format_event(json_out_buffer_t *b, const json_event_t *e) {
+    const char *module = e->text;
+    const char *first = module + strlen(module) + 1;
+    const char *second = first + strlen(first) + 1;
+
+    if (e->kind == JSON_EVENT_LINE) {
+        emit_line(b, e->text, e->len);
+        return;
+    }
+    emit_event(b, (json_event_kind_t)e->kind, e->pid, &e->stamp, module, first, second);
+}
+
+static void *async_worker_main(void *arg) {
+    (void)arg;
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, NULL);  // Sinais do processo ficam com as threads da aplicação
+
+    json_out_buffer_t *b = out_buffer();
+    pthread_mutex_lock(&async_worker_lock);
+    for (;;) {
+        size_t pos = async_dequeue_pos;
+        if (async_cell_ready(pos)) {
+            json_event_t *cell = &async_cells[pos & async_mask];
+            format_event(b, cell);
+            __atomic_store_n(&cell->seq, pos + async_mask + 1, __ATOMIC_RELEASE);
+            async_dequeue_pos = pos + 1;
+            if (b->len >= flush_size) {
+                flush_buffer(b);
+                __atomic_store_n(&async_written_pos, async_dequeue_pos, __ATOMIC_RELEASE);
+            }
+            continue;
+        }
+
+        // Fila vazia: fecha o lote e dorme até um produtor acordar (ou o intervalo expirar)
+        if (b->len > 0) {
+            flush_buffer(b);
+        }
+        __atomic_store_n(&async_written_pos, pos, __ATOMIC_RELEASE);
+        if (__atomic_load_n(&async_stop, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        pthread_mutex_unlock(&async_worker_lock);
+        __atomic_store_n(&async_sleeping, 1, __ATOMIC_SEQ_CST);
+        if (!async_cell_ready(pos) && !__atomic_load_n(&async_stop, __ATOMIC_SEQ_CST)) {
+            struct timespec timeout = { 0, JSON_OUTPUT_DEFAULT_FLUSH_MS * 1000000L };
+            syscall(SYS_futex, &async_sleeping, FUTEX_WAIT_PRIVATE, 1, &timeout, NULL, 0);
+        }
+        __atomic_store_n(&async_sleeping, 0, __ATOMIC_RELAXED);
+        pthread_mutex_lock(&async_worker_lock);
+    }
+    pthread_mutex_unlock(&async_worker_lock);
+    return NULL;
+}
+
+// A thread de escrita nasce no primeiro evento (também em cada filho de fork())
+static void async_ensure_worker(void) {
+    if (__atomic_load_n(&async_worker_running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    pthread_mutex_lock(&async_start_lock);
+    if (!async_worker_running) {
+        __atomic_store_n(&async_stop, 0, __ATOMIC_RELAXED);
+        if (pthread_create(&async_worker, NULL, async_worker_main, NULL) == 0) {
+            __atomic_store_n(&async_worker_running, 1, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&async_start_lock);
+}
+
+// Reserva a próxima célula livre; NULL com a fila cheia
+static json_event_t *async_claim(size_t *pos_out) {
+    size_t pos = __atomic_load_n(&async_enqueue_pos, __ATOMIC_RELAXED);
+    for (;;) {
+        json_event_t *cell = &async_cells[pos & async_mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&async_enqueue_pos, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *pos_out = pos;
+                return cell;
+            }
+        } else if (diff < 0) {
+            __atomic_fetch_add(&async_dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&async_enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void async_publish(json_event_t *cell, size_t pos) {
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    // Só paga a syscall quem encontra a escrita dormindo (fila estava vazia)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&async_sleeping, __ATOMIC_RELAXED)) {
+        async_wake_worker();
+    }
+}
+
+// Copia até room bytes sem cortar um caractere UTF-8 ao meio
+static size_t clip_text(const char *s, size_t room, int *clipped) {
+    size_t n = strnlen(s, room + 1);
+    if (n <= room) {
+        return n;
+    }
+    *clipped = 1;
+    n = room;
+    while (n > 0 && ((unsigned char)s[n] & 0xC0) == 0x80) {
+        n--;
+    }
+    return n;
+}
+
+/**
+ * @brief Enfileira um evento dos print_json_*(): só cópias, sem escape.
+ *
+ * O último campo de JSON_EVENT_METRICS é JSON pronto e não pode ser cortado;
+ * se não couber, o evento é descartado.
+ */
+static void async_push(json_event_kind_t kind, int pid, const char *module, const char *first, const char *second) {
+    const char *fields[3] = { module ? module : "", first ? first : "", second ? second : "" };
+    json_stamp_t stamp;
+    size_t pos;
+
+    // Carimbo antes da fila: um evento descartado deixa um buraco visível em "seq"
+    take_stamp(&stamp, &tls_out.last_event_ns);
+    async_ensure_worker();
+    json_event_t *cell = async_claim(&pos);
+    if (!cell) {
+        return;
+    }
+    cell->kind = (uint8_t)kind;
+    cell->pid = pid;
+    cell->stamp = stamp;
+
+    size_t used = 0;
+    int truncated = 0;
+    for (int i = 0; i < 3; i++) {
+        size_t room = JSON_EVENT_TEXT_SIZE - used - (size_t)(3 - i);  // Reserva os terminadores restantes
+        int clipped = 0;
+        size_t n = clip_text(fields[i], room, &clipped);
+        truncated |= clipped;
+        if (clipped && kind == JSON_EVENT_METRICS && i == 2) {
+            // Célula já reservada: publica como linha vazia, que a escrita ignora
+            cell->kind = JSON_EVENT_LINE;
+            cell->len = 0;
+            __atomic_fetch_add(&async_dropped, 1, __ATOMIC_RELAXED);
+            async_publish(cell, pos);
+            return;
+        }
+        memcpy(cell->text + used, fields[i], n);
+        used += n;
+        cell->text[used++] = '\0';
+    }
+    if (truncated) {
+        __atomic_fetch_add(&async_truncated, 1, __ATOMIC_RELAXED);
+    }
+    async_publish(cell, pos);
+}
+
+// Registro montado por json_record_*(): vai pronto para a fila
+static void async_push_line(const char *line, size_t len) {
+    size_t pos;
+
+    async_ensure_worker();
+    json_event_t *cell = async_claim(&pos);
+    if (!cell) {
+        return;
+    }
+    cell->kind = JSON_EVENT_LINE;
+    if (len > JSON_EVENT_TEXT_SIZE) {
+        len = 0;
+        __atomic_fetch_add(&async_dropped, 1, __ATOMIC_RELAXED);
+    }
+    memcpy(cell->text, line, len);
+    cell->len = (uint32_t)len;
+    async_publish(cell, pos);
+}
+
+// Espera a escrita entregar tudo o que foi enfileirado até agora
+static void async_drain(void) {
+    size_t target = __atomic_load_n(&async_enqueue_pos, __ATOMIC_ACQUIRE);
+    while (__atomic_load_n(&async_worker_running, __ATOMIC_ACQUIRE) &&
+           __atomic_load_n(&async_written_pos, __ATOMIC_ACQUIRE) < target) {
+        async_wake_worker();
+        struct timespec pause = { 0, 50000 };
+        nanosleep(&pause, NULL);
+    }
+}
+
+static void async_prepare_fork(void) {
+    if (async_active) {
+        async_drain();
+        pthread_mutex_lock(&async_worker_lock);  // A escrita fica parada fora de um lote
+    }
+}
+
+static void async_parent_fork(void) {
+    if (async_active) {
+        pthread_mutex_unlock(&async_worker_lock);
+    }
+}
+
+// O filho herda a fila vazia, mas não a thread: ela renasce no primeiro evento
+static void async_child_fork(void) {
+    if (async_active) {
+        pthread_mutex_init(&async_worker_lock, NULL);
+        pthread_mutex_init(&async_start_lock, NULL);
+        async_worker_running = 0;
+        async_sleeping = 0;
+        async_dropped = 0;
+        async_truncated = 0;
+    }
+}
+
+static void async_stop_at_exit(void) {
+    json_output_stop_async();
+}
+
+// Sem pthread_once: também é chamada de dentro de init_output()
+static int async_start(size_t capacity) {
+    static int exit_hook = 0;
+    size_t slots = 16;
+
+    if (async_active) {
+        return 0;
+    }
+    if (capacity == 0) {
+        capacity = JSON_OUTPUT_ASYNC_DEFAULT_CAPACITY;
+    }
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+    void *cells = NULL;
+    if (posix_memalign(&cells, 64, slots * sizeof(json_event_t)) != 0) {
+        return -1;
+    }
+    async_cells = cells;
+    for (size_t i = 0; i < slots; i++) {
+        async_cells[i].seq = i;
+    }
+    async_mask = slots - 1;
+    async_enqueue_pos = 0;
+    async_dequeue_pos = 0;
+    async_written_pos = 0;
+    async_dropped = 0;
+    async_truncated = 0;
+    if (!exit_hook) {
+        // Registrado depois de flush_at_exit, logo roda antes dele
+        atexit(async_stop_at_exit);
+        exit_hook = 1;
+    }
+    __atomic_store_n(&async_active, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int async_enabled(void) {
+    pthread_once(&init_once, init_output);
+    return __atomic_load_n(&async_active, __ATOMIC_ACQUIRE);
+}
+
+int json_output_start_async(size_t capacity) {
+    pthread_once(&init_once, init_output);
+    json_output_flush();  // O que já estava no buffer da thread sai antes dos eventos da fila
+    return async_start(capacity);
+}
+
+void json_output_stop_async(void) {
+    char message[160];
+
+    if (!__atomic_load_n(&async_active, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    if (async_worker_running) {
+        __atomic_store_n(&async_stop, 1, __ATOMIC_RELEASE);
+        async_wake_worker();
+        pthread_join(async_worker, NULL);
+        async_worker_running = 0;
+    }
+    __atomic_store_n(&async_active, 0, __ATOMIC_RELEASE);
+    free(async_cells);
+    async_cells = NULL;
+
+    if (async_dropped > 0 || async_truncated > 0) {
+        snprintf(message, sizeof(message),
+                 "Saída assíncrona: %llu eventos descartados (fila cheia), %llu com texto truncado",
+                 async_dropped, async_truncated);
+        print_json_status("json_output", "warning", message, getpid());
+    }
+}
+
+unsigned long long json_output_async_dropped(void) {
+    return __atomic_load_n(&async_dropped, __ATOMIC_RELAXED);
+}
+
+void json_record_begin(const char* type, const char* module) {
+    json_out_buffer_t *b = out_buffer();
+    take_stamp(&b->stamp, &b->last_event_ns);
+    record_open(b, type, module);
+    b->hold = output_format == JSON_FORMAT_BINARY;
+    b->overflow = 0;
+}
+
+void json_record_string(const char* key, const char* value) {
+    record_string(&tls_out, key, value);
+}
+
+void json_record_int(const char* key, long long value) {
+    record_int(&tls_out, key, value);
+}
+
+void json_record_raw(const char* key, const char* raw_json) {
+    json_out_buffer_t *b = &tls_out;
+    out_key(b, key);
+    out_write(b, raw_json, strlen(raw_json));
+}
+
+void json_record_end(void) {
+    json_out_buffer_t *b = &tls_out;
+    record_close(b, &b->stamp);
+    b->hold = 0;
+    if (b->overflow) {
+        // Formato binário: o registro não cabe num quadro
+        b->len = b->record_start;
+        b->overflow = 0;
+        return;
+    }
+
+    if (__atomic_load_n(&async_active, __ATOMIC_ACQUIRE) && !b->spilled) {
+        // O registro pronto vira um evento; o que estava pendente antes dele sai primeiro
+        size_t record_len = b->len - b->record_start;
+        if (b->record_start > 0) {
+            b->len = b->record_start;
+            flush_buffer(b);
+            memmove(b->data, b->data + b->record_start, record_len);
+        }
+        async_push_line(b->data, record_len);
+        b->len = 0;
+        return;
+    }
+    if (output_format == JSON_FORMAT_BINARY) {
+        wrap_line_in_place(b);
+    }
+    apply_flush_policy(b);
+}
+
+void json_output_set_flush_policy(json_flush_policy_t policy, size_t size_threshold, long interval_ms) {
+    flush_policy = policy;
+    flush_size = size_threshold > 0 ? size_threshold : JSON_OUTPUT_DEFAULT_FLUSH_SIZE;
+    if (flush_size > JSON_OUTPUT_BUFFER_SIZE) {
+        flush_size = JSON_OUTPUT_BUFFER_SIZE;
+    }
+    flush_interval_ms = interval_ms > 0 ? interval_ms : JSON_OUTPUT_DEFAULT_FLUSH_MS;
+}
+
+void json_output_set_format(json_format_t format) {
+    output_format = format;
+}
+
+int json_output_set_clock(json_clock_t clock) {
+    if (clock == JSON_CLOCK_TSC) {
+#ifdef JSON_OUTPUT_HAS_TSC
+        if (tsc_mult != 0 || tsc_calibrate() == 0) {
+            stamp_clock = JSON_CLOCK_TSC;
+            return 0;
+        }
+#endif
+        stamp_clock = JSON_CLOCK_MONOTONIC;
+        return -1;
+    }
+    stamp_clock = clock;
+    return 0;
+}
+
+const char *json_output_clock_name(void) {
+    pthread_once(&init_once, init_output);
+    switch (stamp_clock) {
+        case JSON_CLOCK_MONOTONIC: return "monotonic";
+        case JSON_CLOCK_TSC:       return "tsc";
+        case JSON_CLOCK_REALTIME:
+        default:                   return "realtime";
+    }
+}
+
+void json_output_set_fields(unsigned fields) {
+    stamp_fields = fields;
+}
+
+void json_output_flush(void) {
+    if (async_enabled()) {
+        async_drain();
+    }
+    flush_buffer(out_buffer());
+}
+
+int json_output_set_fd(int fd) {
+    if (async_enabled()) {
+        errno = EBUSY;
+        return -1;
+    }
+    json_out_buffer_t *b = out_buffer();
+    flush_buffer(b);
+    if (fd != output_fd) {
+        // Stream novo: quem lê não viu os DEF das strings internadas
+        memset(b->intern, 0, sizeof(b->intern));
+        b->intern_count = 0;
+        output_fd = fd;
+    }
+    return 0;
+}
+
+// Caminho síncrono dos print_json_*()
+static void emit_now(json_event_kind_t kind, int pid, const char *module, const char *first, const char *second) {
+    json_out_buffer_t *b = out_buffer();
+    json_stamp_t stamp;
+    take_stamp(&stamp, &b->last_event_ns);
+    emit_event(b, kind, pid, &stamp, module, first, second);
+    apply_flush_policy(b);
+}
+
+void print_json_status(const char* module, const char* status, const char* message, int pid) {
+    if (async_enabled()) {
+        async_push(JSON_EVENT_STATUS, pid, module, status, message);
+        return;
+    }
+    emit_now(JSON_EVENT_STATUS, pid, module, status, message);
+}
+
+void print_json_data(const char* module, const char* data, const char* source, int pid) {
+    if (async_enabled()) {
+        async_push(JSON_EVENT_DATA, pid, module, data, source);
+        return;
+    }
+    emit_now(JSON_EVENT_DATA, pid, module, data, source);
+}
+
+void print_json_error(const char* module, const char* error, int pid) {
+    if (async_enabled()) {
+        async_push(JSON_EVENT_ERROR, pid, module, error, NULL);
+        return;
+    }
+    emit_now(JSON_EVENT_ERROR, pid, module, error, NULL);
+}
+
+void print_json_metrics(const char* module, const char* name, const char* metrics, int pid) {
+    if (async_enabled()) {
+        async_push(JSON_EVENT_METRICS, pid, module, name, metrics);
+        return;
+    }
+    emit_now(JSON_EVENT_METRICS, pid, module, name, metrics);
 }
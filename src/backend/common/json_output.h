@@ -6,6 +6,18 @@
  * a integração entre o backend C e o frontend Python. Todas as mensagens
  * seguem um formato consistente com campos obrigatórios.
  * 
+ * Os registros são escapados diretamente em um buffer por thread (sem
+ * malloc) e escritos com write(2), um a um ou em lotes conforme a política
+ * de flush (json_output_set_flush_policy() ou IPC_JSON_FLUSH).
+ * 
+ * No modo assíncrono (json_output_start_async() ou IPC_JSON_FLUSH=async)
+ * os print_json_*() apenas copiam os textos para uma fila MPSC limitada;
+ * uma thread de escrita formata e escreve os registros em lotes.
+ * 
+ * Com IPC_JSON_FORMAT=binary os mesmos registros saem como quadros binários
+ * com prefixo de tamanho e strings internadas (ver json_frame_kind_t), sem
+ * escape nem conversão de números para texto.
+ * 
  * @author [Seu Nome]
  * @date [Data de Criação]
  */
@@ -13,6 +25,111 @@
 #ifndef JSON_OUTPUT_H
 #define JSON_OUTPUT_H
 
+#include <stddef.h>
+
+// Buffer de saída por thread: os registros são montados aqui, sem malloc
+#define JSON_OUTPUT_BUFFER_SIZE (64 * 1024)
+
+// Padrões das políticas de flush por tamanho (bytes pendentes) e por tempo
+#define JSON_OUTPUT_DEFAULT_FLUSH_SIZE (16 * 1024)
+#define JSON_OUTPUT_DEFAULT_FLUSH_MS 100
+
+// Variável de ambiente lida no primeiro registro: "immediate", "size[:bytes]", "time[:ms]" ou "async[:eventos]"
+#define JSON_OUTPUT_FLUSH_ENV "IPC_JSON_FLUSH"
+
+// Relógio de "ts_ns" ("realtime", "monotonic" ou "tsc") e campos opcionais ("seq,elapsed")
+#define JSON_OUTPUT_CLOCK_ENV "IPC_JSON_CLOCK"
+#define JSON_OUTPUT_FIELDS_ENV "IPC_JSON_FIELDS"
+
+// Duração da calibração do TSC contra o CLOCK_MONOTONIC
+#define JSON_OUTPUT_TSC_CALIBRATION_MS 10
+
+// Campos opcionais de cada registro (json_output_set_fields)
+#define JSON_FIELD_SEQ      0x1     // "seq": ordem do registro no processo
+#define JSON_FIELD_ELAPSED  0x2     // "elapsed_ns": desde o registro anterior da mesma thread
+
+// Formato do stream: "json" (linhas, padrão) ou "binary" (quadros)
+#define JSON_OUTPUT_FORMAT_ENV "IPC_JSON_FORMAT"
+
+// Quadros binários: cabeçalho fixo, id de string "não internada" e limites da tabela por thread
+#define JSON_FRAME_HEADER_SIZE 12
+#define JSON_FRAME_LITERAL 0xFFFF
+#define JSON_INTERN_SLOTS 256
+#define JSON_INTERN_LIMIT 192
+#define JSON_INTERN_MAX_LEN 47
+
+// Bits de "flags" nos quadros de evento
+#define JSON_FRAME_F_SEQ      0x1
+#define JSON_FRAME_F_ELAPSED  0x2
+
+// Modo assíncrono: eventos de tamanho fixo (cabeçalho + textos) e capacidade padrão da fila
+#define JSON_OUTPUT_ASYNC_EVENT_SIZE 512
+#define JSON_OUTPUT_ASYNC_DEFAULT_CAPACITY 4096
+
+/**
+ * @brief Quando os registros acumulados são escritos no stdout.
+ * 
+ * Os limites de JSON_FLUSH_SIZE e JSON_FLUSH_TIME só são conferidos quando a
+ * thread registra um novo evento: não há timer, pois o buffer é da thread e
+ * só ela pode escrevê-lo. Uma thread que fica ociosa retém os registros
+ * pendentes (mesmo além do intervalo) até o próximo registro, até
+ * json_output_flush() ou até a thread terminar. Quem precisa de um atraso
+ * máximo garantido deve chamar json_output_flush() antes de bloquear ou usar
+ * o modo assíncrono, cuja thread de escrita esvazia a fila sozinha.
+ */
+typedef enum {
+    JSON_FLUSH_IMMEDIATE,   // Um write(2) por registro (padrão; ideal para o frontend ao vivo)
+    JSON_FLUSH_SIZE,        // Escreve quando os bytes pendentes passam do limite
+    JSON_FLUSH_TIME         // Escreve quando o registro pendente mais antigo passa do intervalo
+} json_flush_policy_t;
+
+/**
+ * @brief Relógio do campo "ts_ns" de cada registro.
+ * 
+ * CLOCK_MONOTONIC é comum a todos os processos da máquina, então a diferença
+ * entre os ts_ns de dois registros (ex: "enviado" no pai e "recebido" no
+ * filho) é a latência do salto. O "timestamp" em segundos continua sendo
+ * relógio de parede em todos os modos.
+ */
+typedef enum {
+    JSON_CLOCK_REALTIME,    // CLOCK_REALTIME em ns (padrão)
+    JSON_CLOCK_MONOTONIC,   // CLOCK_MONOTONIC em ns
+    JSON_CLOCK_TSC          // rdtsc convertido para o domínio do CLOCK_MONOTONIC (calibrado no início)
+} json_clock_t;
+
+/**
+ * @brief Formato do stream de saída.
+ */
+typedef enum {
+    JSON_FORMAT_TEXT,       // Uma linha JSON por registro (padrão)
+    JSON_FORMAT_BINARY      // Quadros binários (json_frame_kind_t)
+} json_format_t;
+
+/**
+ * @brief Tipos de quadro do formato binário.
+ * 
+ * Inteiros em little-endian; str = u32 tamanho + bytes (UTF-8, sem '\0').
+ * Todo quadro começa com o mesmo cabeçalho de JSON_FRAME_HEADER_SIZE bytes:
+ * 
+ *     u32 size    bytes depois deste campo
+ *     u8  kind    json_frame_kind_t
+ *     u8  flags   JSON_FRAME_F_* (eventos)
+ *     u16 id      módulo (eventos), id definido (DEF) ou 0 (LINE)
+ *     u32 writer  tid de quem escreveu: escopo dos ids internados
+ * 
+ * Eventos continuam com [str módulo, se id == JSON_FRAME_LITERAL], i32 pid,
+ * u32 timestamp, u64 ts_ns, [u64 seq], [u64 elapsed_ns] e os campos do tipo.
+ * Campos internados são u16 id, seguidos de str quando id == JSON_FRAME_LITERAL.
+ */
+typedef enum {
+    JSON_FRAME_STATUS = 1,  // id status, str message
+    JSON_FRAME_DATA = 2,    // str data, id source
+    JSON_FRAME_ERROR = 3,   // str error
+    JSON_FRAME_METRICS = 4, // str name, str metrics (objeto JSON)
+    JSON_FRAME_LINE = 5,    // Registro de json_record_*(): o texto JSON inteiro
+    JSON_FRAME_DEF = 6      // Define a string do id para este writer (vem antes do primeiro uso)
+} json_frame_kind_t;
+
 /**
  * @brief Imprime uma mensagem de status em formato JSON
  * 
@@ -69,4 +186,197 @@ void print_json_data(const char* module, const char* data, const char* source, i
  */
 void print_json_error(const char* module, const char* error, int pid);
 
+/**
+ * @brief Imprime métricas numéricas em formato JSON
+ * 
+ * Gera uma mensagem JSON cujo campo "metrics" é um objeto JSON montado pelo
+ * chamador (ex: percentis de latência e vazão de um benchmark), para que o
+ * frontend e scripts leiam os números sem interpretar texto livre.
+ * 
+ * @param module Nome do módulo que está gerando a mensagem
+ * @param name Identificador da medição (ex: "shm_pingpong_64")
+ * @param metrics Objeto JSON válido, inserido sem escape (ex: "{\"p50_ns\":120}")
+ * @param pid ID do processo (use 0 se não aplicável)
+ * 
+ * @note Apenas module e name são escapados; metrics é responsabilidade do chamador
+ * @note Timestamp é gerado automaticamente no momento da chamada
+ * 
+ * @example
+ * print_json_metrics("bench", "pipe_stream_4096", "{\"msgs_per_sec\":250000}", getpid());
+ */
+void print_json_metrics(const char* module, const char* name, const char* metrics, int pid);
+
+/**
+ * @brief Escapa uma string JSON em um buffer fornecido pelo chamador
+ * 
+ * Uma única passada, sem alocação. O resultado é sempre terminado em '\0'
+ * (se dst_size > 0) e um par de escape nunca é cortado ao meio.
+ * 
+ * @param dst Buffer de destino
+ * @param dst_size Tamanho de dst em bytes
+ * @param src String de entrada
+ * @return Tamanho do texto escapado completo (sem o '\0'); se for >= dst_size, houve truncamento
+ */
+size_t json_escape_into(char* dst, size_t dst_size, const char* src);
+
+/**
+ * @brief Inicia um registro JSON no buffer da thread atual
+ * 
+ * Escreve os campos "type" e "module". Deve ser seguido de zero ou mais
+ * json_record_string()/json_record_int()/json_record_raw() e de um
+ * json_record_end(), todos na mesma thread.
+ * 
+ * @param type Tipo do registro (ex: "status", "data")
+ * @param module Nome do módulo
+ * 
+ * @example
+ * json_record_begin("status", "pipes");
+ * json_record_string("status", "ok");
+ * json_record_int("pid", getpid());
+ * json_record_end();
+ */
+void json_record_begin(const char* type, const char* module);
+
+/**
+ * @brief Acrescenta um campo string (escapado) ao registro em montagem
+ * 
+ * @param key Nome do campo
+ * @param value Valor (NULL vira "")
+ */
+void json_record_string(const char* key, const char* value);
+
+/**
+ * @brief Acrescenta um campo inteiro ao registro em montagem
+ * 
+ * @param key Nome do campo
+ * @param value Valor
+ */
+void json_record_int(const char* key, long long value);
+
+/**
+ * @brief Acrescenta um campo com JSON já pronto (inserido sem escape)
+ * 
+ * @param key Nome do campo
+ * @param raw_json Valor JSON válido (objeto, número, etc.)
+ */
+void json_record_raw(const char* key, const char* raw_json);
+
+/**
+ * @brief Fecha o registro (acrescenta "timestamp", "ts_ns" e os campos
+ *        opcionais) e aplica a política de flush
+ * 
+ * O carimbo de tempo é o do json_record_begin().
+ */
+void json_record_end(void);
+
+/**
+ * @brief Define a política de flush de todas as threads
+ * 
+ * Deve ser chamada no início do processo, antes de criar threads. Também
+ * configurável pela variável de ambiente IPC_JSON_FLUSH.
+ * 
+ * @param policy JSON_FLUSH_IMMEDIATE, JSON_FLUSH_SIZE ou JSON_FLUSH_TIME
+ * @param size_threshold Bytes pendentes que disparam a escrita (0: padrão)
+ * @param interval_ms Idade máxima do registro pendente mais antigo (0: padrão)
+ * 
+ * @note A idade é verificada a cada novo registro; o que restar pendente é
+ *       escrito no exit(), no término da thread e antes de cada fork()
+ * @note Registros pendentes se perdem se o processo morrer por sinal ou _exit()
+ */
+void json_output_set_flush_policy(json_flush_policy_t policy, size_t size_threshold, long interval_ms);
+
+/**
+ * @brief Escolhe o formato do stream de saída
+ * 
+ * Deve ser chamada no início do processo, antes do primeiro registro.
+ * Também configurável pela variável de ambiente IPC_JSON_FORMAT.
+ * 
+ * @param format JSON_FORMAT_TEXT ou JSON_FORMAT_BINARY
+ * 
+ * @note No formato binário, um registro de json_record_*() maior que
+ *       JSON_OUTPUT_BUFFER_SIZE é descartado
+ */
+void json_output_set_format(json_format_t format);
+
+/**
+ * @brief Escolhe o relógio do campo "ts_ns"
+ * 
+ * Deve ser chamada no início do processo. JSON_CLOCK_TSC calibra o TSC por
+ * JSON_OUTPUT_TSC_CALIBRATION_MS; sem TSC invariante usa CLOCK_MONOTONIC.
+ * Também configurável pela variável de ambiente IPC_JSON_CLOCK.
+ * 
+ * @param clock Relógio desejado
+ * @return 0 em sucesso, -1 se o TSC não pôde ser usado (ficou o monotônico)
+ */
+int json_output_set_clock(json_clock_t clock);
+
+/**
+ * @brief Nome do relógio em uso ("realtime", "monotonic" ou "tsc")
+ * 
+ * @return String estática
+ */
+const char *json_output_clock_name(void);
+
+/**
+ * @brief Liga os campos opcionais "seq" e "elapsed_ns"
+ * 
+ * Também configurável por IPC_JSON_FIELDS (ex: "seq,elapsed").
+ * 
+ * @param fields Combinação de JSON_FIELD_SEQ e JSON_FIELD_ELAPSED (0: nenhum)
+ */
+void json_output_set_fields(unsigned fields);
+
+/**
+ * @brief Escreve imediatamente os registros pendentes da thread atual
+ * 
+ * No modo assíncrono, espera também a thread de escrita esvaziar a fila.
+ */
+void json_output_flush(void);
+
+/**
+ * @brief Troca o descritor de saída (padrão: STDOUT_FILENO)
+ * 
+ * Escreve antes os registros pendentes da thread atual no descritor
+ * anterior. Com um descritor diferente, as strings internadas do formato
+ * binário são definidas de novo, já que o novo leitor nunca viu os DEF.
+ * Feito para um único emissor (ex: o daemon trocando de cliente); não
+ * fecha nenhum dos descritores.
+ * 
+ * @param fd Descritor que passa a receber os registros
+ * @return 0 em sucesso, -1 com errno = EBUSY no modo assíncrono
+ */
+int json_output_set_fd(int fd);
+
+/**
+ * @brief Liga o modo assíncrono
+ * 
+ * A memória é fixa: capacity eventos de JSON_OUTPUT_ASYNC_EVENT_SIZE bytes,
+ * reservados aqui. Com a fila cheia o evento é descartado e contado; textos
+ * que não cabem no evento são truncados (um "metrics" que não cabe é
+ * descartado, já que JSON cortado seria inválido).
+ * 
+ * @param capacity Número de eventos na fila, arredondado para potência de 2 (0: padrão)
+ * @return 0 em sucesso, -1 se a fila não pôde ser alocada
+ * 
+ * @note A fila é esvaziada antes de cada fork(); o filho cria a própria
+ *       thread de escrita no primeiro evento
+ * @note Registros da fila ainda não escritos se perdem com _exit() ou sinal
+ */
+int json_output_start_async(size_t capacity);
+
+/**
+ * @brief Esvazia a fila, encerra a thread de escrita e volta ao modo síncrono
+ * 
+ * Chamada automaticamente no exit(). Se houve descartes ou truncamentos,
+ * emite um status "warning" com os contadores.
+ */
+void json_output_stop_async(void);
+
+/**
+ * @brief Eventos descartados pelo modo assíncrono neste processo (fila cheia)
+ * 
+ * @return Total de descartes desde json_output_start_async()
+ */
+unsigned long long json_output_async_dropped(void);
+
 #endif // JSON_OUTPUT_H
\ No newline at end of file
@@ -0,0 +1,697 @@
+/**
+ * @file ipc_daemon.c
+ * @brief Daemon de backend: canais da libipc aquecidos atrás de um socket de controle.
+ *
+ * No início o daemon abre um canal de cada transporte (pipe, unix e shm) e
+ * cria com fork() um worker de eco para cada um; daí em diante nada mais é
+ * criado por requisição. Um laço poll() atende o socket de controle e as
+ * conexões dos clientes: cada linha "<canal> <mensagem>" é enviada pelo
+ * canal pedido, o eco do worker é lido de volta e os eventos da requisição
+ * (json_output.h) voltam pela própria conexão do cliente, terminando com um
+ * status "done". As conexões não bloqueiam: os eventos são gerados num
+ * memfd, vão para uma fila por cliente e saem quando o socket aceita, de
+ * modo que um cliente que para de ler não trava os outros. Um worker que
+ * morre (antes ou no meio de uma requisição) vira um evento de erro, e o
+ * canal é recriado com um worker novo. Protocolo completo em ipc_daemon.h.
+ *
+ * Uso: ./ipc_daemon [--socket <nome>] [--capacity <bytes>]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "ipc_daemon.h"
+#include "../common/json_output.h"
+#include "../common/ipc_channel.h"
+#include "../sockets/socket_ready.h"
+
+// Mensagens por recv_batch/send_batch no worker
+#define DAEMON_WORKER_BATCH 8
+
+// Menor capacidade aceita em --capacity
+#define DAEMON_MIN_CAPACITY 4096
+
+/**
+ * @brief Canal aquecido: criado no início, com o worker já conectado ao lado 1.
+ */
+typedef struct {
+    const char *module;         // Nome do canal no frontend (BackendManager)
+    const char *transport;      // Transporte da libipc
+    ipc_channel_t ch;
+    pid_t worker;               // -1 depois que o worker terminou
+    unsigned long requests;
+} daemon_channel_t;
+
+/**
+ * @brief Conexão de controle (não bloqueante): linha em montagem e eventos ainda não enviados.
+ */
+typedef struct {
+    int fd;
+    json_format_t format;
+    char *buf;
+    size_t len;
+    char *out;                  // Eventos pendentes, escritos quando o socket aceita (POLLOUT)
+    size_t out_len;
+    size_t out_cap;
+} daemon_client_t;
+
+static daemon_channel_t channels[] = {
+    { "pipes", "pipe", { 0 }, -1, 0 },
+    { "sockets", "unix", { 0 }, -1, 0 },
+    { "shm", "shm", { 0 }, -1, 0 },
+};
+#define DAEMON_CHANNELS (int)(sizeof(channels) / sizeof(channels[0]))
+
+static volatile sig_atomic_t stop_requested;
+static json_format_t default_format = JSON_FORMAT_TEXT;
+static unsigned char *echo_buf;
+static ipc_channel_config_t channel_cfg;
+static int listen_fd = -1;
+static int events_fd = -1;      // memfd onde json_output escreve os eventos de uma requisição
+static daemon_client_t clients[IPC_DAEMON_MAX_CLIENTS];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void on_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+// Worker: ecoa em lotes até o daemon fechar o canal
+static int echo_worker(int index, pid_t daemon_pid) {
+    ipc_channel_msg_t msgs[DAEMON_WORKER_BATCH];
+    int rc;
+
+    // Morre junto com o daemon, mesmo por SIGKILL: o ring de SHM não veria o fim do canal
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    if (getppid() != daemon_pid) {
+        return 1;
+    }
+    // Os canais dos outros workers são cópias: fecha tudo deles sem marcar
+    // fim. Num worker recriado o daemon já está no lado 0; nos descritores
+    // fechar a cópia desse lado não afeta ninguém, mas no ring marcaria o fim
+    // (e trocaria o dono) no segmento compartilhado, então ele volta a "sem lado"
+    for (int i = 0; i < DAEMON_CHANNELS; i++) {
+        if (i != index && channels[i].ch.ops) {
+            if (strcmp(channels[i].transport, "shm") == 0) {
+                channels[i].ch.side = -1;
+            }
+            ipc_channel_close(&channels[i].ch);
+        }
+    }
+    // Um worker recriado herda também o socket de controle e as conexões
+    if (listen_fd != -1) {
+        close(listen_fd);
+    }
+    if (events_fd != -1) {
+        close(events_fd);
+    }
+    for (int i = 0; i < IPC_DAEMON_MAX_CLIENTS; i++) {
+        if (clients[i].fd != -1) {
+            close(clients[i].fd);
+        }
+    }
+    ipc_channel_t *ch = &channels[index].ch;
+    ipc_channel_attach(ch, 1);
+    for (int i = 0; i < DAEMON_WORKER_BATCH; i++) {
+        msgs[i].buf = malloc(IPC_DAEMON_MAX_REQUEST);
+        msgs[i].cap = IPC_DAEMON_MAX_REQUEST;
+        if (!msgs[i].buf) {
+            return 1;
+        }
+    }
+    while ((rc = ipc_channel_recv_batch(ch, msgs, DAEMON_WORKER_BATCH)) > 0) {
+        if (ipc_channel_send_batch(ch, msgs, rc) == -1) {
+            return 1;
+        }
+    }
+    ipc_channel_close(ch);
+    return rc == 0 ? 0 : 1;
+}
+
+static pid_t spawn_worker(int index) {
+    pid_t daemon_pid = getpid();
+    pid_t worker = fork();
+    if (worker == 0) {
+        // Os eventos do worker vão para o stdout do daemon, não para o cliente da vez
+        json_output_set_fd(STDOUT_FILENO);
+        int rc = echo_worker(index, daemon_pid);
+        json_output_flush();
+        _exit(rc);
+    }
+    return worker;
+}
+
+/**
+ * @brief Abre todos os canais e cria os workers; só depois o daemon escolhe o lado 0.
+ *
+ * @return 0 em sucesso, -1 em erro (mensagem já emitida).
+ */
+static int start_channels(void) {
+    pid_t pid = getpid();
+    char status_msg[256];
+
+    for (int i = 0; i < DAEMON_CHANNELS; i++) {
+        if (ipc_channel_open(&channels[i].ch, channels[i].transport, &channel_cfg) == -1) {
+            snprintf(status_msg, sizeof(status_msg), "Falha ao abrir o canal %s: %s",
+                     channels[i].transport, strerror(errno));
+            print_json_error(IPC_DAEMON_MODULE, status_msg, pid);
+            return -1;
+        }
+    }
+    for (int i = 0; i < DAEMON_CHANNELS; i++) {
+        pid_t worker = spawn_worker(i);
+        if (worker == -1) {
+            print_json_error(IPC_DAEMON_MODULE, "Falha no fork() do worker", pid);
+            return -1;
+        }
+        channels[i].worker = worker;
+    }
+    for (int i = 0; i < DAEMON_CHANNELS; i++) {
+        ipc_channel_attach(&channels[i].ch, 0);
+    }
+    return 0;
+}
+
+static void stop_channels(void) {
+    // Fim do canal: cada worker vê EOF, sai do laço e termina
+    for (int i = 0; i < DAEMON_CHANNELS; i++) {
+        if (channels[i].ch.ops) {
+            ipc_channel_close(&channels[i].ch);
+        }
+    }
+    for (int i = 0; i < DAEMON_CHANNELS; i++) {
+        if (channels[i].worker > 0) {
+            waitpid(channels[i].worker, NULL, 0);
+        }
+    }
+}
+
+/**
+ * @brief Troca o worker de um canal (morto ou preso) por um novo, num canal recém-aberto.
+ *
+ * O canal antigo pode ter ficado no meio de uma mensagem: é fechado e
+ * recriado em vez de reaproveitado.
+ *
+ * @return 0 em sucesso, -1 em erro (mensagem já emitida; a próxima requisição tenta de novo).
+ */
+static int restart_worker(daemon_channel_t *chn) {
+    pid_t pid = getpid();
+    char status_msg[256];
+
+    if (chn->worker > 0) {
+        kill(chn->worker, SIGKILL);
+        waitpid(chn->worker, NULL, 0);
+        chn->worker = -1;
+    }
+    if (chn->ch.ops) {
+        ipc_channel_close(&chn->ch);
+    }
+    if (ipc_channel_open(&chn->ch, chn->transport, &channel_cfg) == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Falha ao reabrir o canal %s: %s", chn->transport, strerror(errno));
+        print_json_error(IPC_DAEMON_MODULE, status_msg, pid);
+        return -1;
+    }
+    chn->worker = spawn_worker((int)(chn - channels));
+    if (chn->worker == -1) {
+        print_json_error(IPC_DAEMON_MODULE, "Falha no fork() do worker", pid);
+        ipc_channel_close(&chn->ch);
+        return -1;
+    }
+    ipc_channel_attach(&chn->ch, 0);
+    snprintf(status_msg, sizeof(status_msg), "Canal %s recriado com o worker %d.", chn->transport, (int)chn->worker);
+    print_json_status(IPC_DAEMON_MODULE, "worker_restart", status_msg, pid);
+    return 0;
+}
+
+static daemon_channel_t *find_channel(const char *name, size_t len) {
+    for (int i = 0; i < DAEMON_CHANNELS; i++) {
+        if ((strlen(channels[i].module) == len && strncmp(channels[i].module, name, len) == 0) ||
+            (strlen(channels[i].transport) == len && strncmp(channels[i].transport, name, len) == 0)) {
+            return &channels[i];
+        }
+    }
+    return NULL;
+}
+
+// Uma requisição de eco pelo canal já aberto: nenhum fork, exec ou criação de IPC aqui
+static void forward(daemon_channel_t *chn, const char *message, size_t len) {
+    pid_t pid = getpid();
+    char status_msg[256];
+    size_t got = 0;
+
+    // Um worker que terminou entre requisições é trocado antes do envio
+    if (chn->worker > 0 && waitpid(chn->worker, NULL, WNOHANG) != 0) {
+        chn->worker = -1;
+    }
+    if (chn->worker <= 0) {
+        snprintf(status_msg, sizeof(status_msg), "O worker do canal %s terminou.", chn->transport);
+        print_json_error(IPC_DAEMON_MODULE, status_msg, pid);
+        if (restart_worker(chn) == -1) {
+            return;
+        }
+    }
+    chn->requests++;
+    snprintf(status_msg, sizeof(status_msg), "Encaminhando %zu bytes pelo canal %s (requisição %lu).",
+             len, chn->transport, chn->requests);
+    print_json_status(IPC_DAEMON_MODULE, "forward", status_msg, pid);
+    print_json_data(IPC_DAEMON_MODULE, message, "cliente -> daemon", pid);
+
+    // Worker morto no meio da requisição: EOF nos descritores; no shm o recv
+    // confere a vida do dono do ring e também termina em vez de esperar o eco
+    uint64_t start = now_ns();
+    int rc = ipc_channel_send(&chn->ch, message, len) == 0 ?
+             ipc_channel_recv(&chn->ch, echo_buf, IPC_DAEMON_MAX_REQUEST, &got) : -1;
+    if (rc != 1) {
+        if (rc == 0) {
+            errno = EPIPE;
+        }
+        snprintf(status_msg, sizeof(status_msg), "Falha no canal %s: %s", chn->transport, strerror(errno));
+        print_json_error(IPC_DAEMON_MODULE, status_msg, pid);
+        restart_worker(chn);
+        return;
+    }
+    uint64_t rtt = now_ns() - start;
+    echo_buf[got] = '\0';
+    print_json_data(IPC_DAEMON_MODULE, (const char *)echo_buf, "worker -> daemon (eco)", chn->worker);
+
+    char name[64], metrics[256];
+    snprintf(name, sizeof(name), "%s_request", chn->transport);
+    snprintf(metrics, sizeof(metrics), "{\"transport\":\"%s\",\"bytes\":%zu,\"rtt_ns\":%llu,\"requests\":%lu}",
+             chn->transport, got, (unsigned long long)rtt, chn->requests);
+    print_json_metrics(IPC_DAEMON_MODULE, name, metrics, pid);
+}
+
+// Eventos seguintes vão para o memfd, no formato da conexão
+static void events_begin(const daemon_client_t *c) {
+    json_output_set_fd(events_fd);
+    json_output_set_format(c->format);
+}
+
+/**
+ * @brief Volta ao stdout e move os eventos acumulados no memfd para a fila da conexão.
+ *
+ * Nenhuma escrita no socket aqui: um cliente que parou de ler não segura o
+ * laço. De volta ao stdout, a próxima requisição (talvez de outra conexão)
+ * recebe os DEF das strings internadas de novo.
+ *
+ * @return 0 em sucesso, -1 sem memória para a fila (a conexão é fechada).
+ */
+static int events_end(daemon_client_t *c) {
+    json_output_set_fd(STDOUT_FILENO);
+    json_output_set_format(default_format);
+
+    off_t size = lseek(events_fd, 0, SEEK_CUR);
+    int rc = 0;
+    if (size > 0 && c->out_len + (size_t)size > c->out_cap) {
+        size_t cap = c->out_cap ? c->out_cap : IPC_DAEMON_MAX_REQUEST;
+        while (cap < c->out_len + (size_t)size) {
+            cap *= 2;
+        }
+        char *out = realloc(c->out, cap);
+        if (!out) {
+            rc = -1;
+        } else {
+            c->out = out;
+            c->out_cap = cap;
+        }
+    }
+    if (rc == 0 && size > 0) {
+        ssize_t n = pread(events_fd, c->out + c->out_len, (size_t)size, 0);
+        rc = n == (ssize_t)size ? 0 : -1;
+        if (rc == 0) {
+            c->out_len += (size_t)size;
+        }
+    }
+    if (ftruncate(events_fd, 0) == -1 || lseek(events_fd, 0, SEEK_SET) == -1) {
+        rc = -1;
+    }
+    return rc;
+}
+
+/**
+ * @brief Escreve o que o socket aceitar da fila de eventos, sem bloquear.
+ *
+ * @return 0 para manter a conexão, -1 se ela caiu.
+ */
+static int client_flush(daemon_client_t *c) {
+    size_t sent = 0;
+    while (sent < c->out_len) {
+        ssize_t n = write(c->fd, c->out + sent, c->out_len - sent);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN) {
+            break;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        sent += (size_t)n;
+    }
+    if (sent > 0) {
+        c->out_len -= sent;
+        memmove(c->out, c->out + sent, c->out_len);
+    }
+    return 0;
+}
+
+// Executa uma linha; os eventos vão para a fila da conexão, no formato dela
+static int handle_request(daemon_client_t *c, char *line, size_t len) {
+    pid_t pid = getpid();
+    char status_msg[256];
+
+    const char *space = memchr(line, ' ', len);
+    size_t word = space ? (size_t)(space - line) : len;
+    const char *arg = space ? space + 1 : line + len;
+    daemon_channel_t *chn = find_channel(line, word);
+
+    // Configuração da conexão, não requisição: nenhum evento
+    if (word == 6 && strncmp(line, "format", 6) == 0 &&
+        (strcmp(arg, "json") == 0 || strcmp(arg, "binary") == 0)) {
+        c->format = strcmp(arg, "binary") == 0 ? JSON_FORMAT_BINARY : JSON_FORMAT_TEXT;
+        return 0;
+    }
+    events_begin(c);
+
+    if (chn) {
+        forward(chn, arg, len - (size_t)(arg - line));
+    } else if (word == 4 && strncmp(line, "ping", 4) == 0) {
+        print_json_status(IPC_DAEMON_MODULE, "pong", "Daemon ativo.", pid);
+    } else if (word == 4 && strncmp(line, "stop", 4) == 0) {
+        print_json_status(IPC_DAEMON_MODULE, "stopping", "Daemon encerrando a pedido do cliente.", pid);
+        stop_requested = 1;
+    } else {
+        snprintf(status_msg, sizeof(status_msg), "Comando desconhecido: %.*s", (int)word, line);
+        print_json_error(IPC_DAEMON_MODULE, status_msg, pid);
+    }
+    print_json_status(IPC_DAEMON_MODULE, "done", "Requisição concluída.", pid);
+    return events_end(c);
+}
+
+/**
+ * @brief Executa as linhas completas do buffer enquanto a fila de eventos não passar do limite.
+ *
+ * Com mais de IPC_DAEMON_OUTPUT_HIGH bytes pendentes as linhas restantes
+ * esperam no buffer: o cliente que não lê as respostas para de ser atendido
+ * em vez de fazer a fila crescer sem limite.
+ *
+ * @return 0 para manter a conexão, -1 para fechá-la (linha longa demais ou sem memória).
+ */
+static int client_process(daemon_client_t *c) {
+    char *start = c->buf, *nl;
+    int rc = 0;
+    while (rc == 0 && !stop_requested && c->out_len < IPC_DAEMON_OUTPUT_HIGH &&
+           (nl = memchr(start, '\n', (size_t)(c->buf + c->len - start))) != NULL) {
+        size_t len = (size_t)(nl - start);
+        if (len > 0 && start[len - 1] == '\r') {
+            len--;
+        }
+        start[len] = '\0';
+        rc = handle_request(c, start, len);
+        start = nl + 1;
+    }
+    c->len -= (size_t)(start - c->buf);
+    memmove(c->buf, start, c->len);
+    if (rc == 0 && c->len == IPC_DAEMON_MAX_REQUEST && !memchr(c->buf, '\n', c->len)) {
+        events_begin(c);
+        print_json_error(IPC_DAEMON_MODULE, "Requisição maior que IPC_DAEMON_MAX_REQUEST; conexão encerrada.", getpid());
+        events_end(c);
+        client_flush(c);
+        return -1;
+    }
+    return rc;
+}
+
+/**
+ * @brief Lê o que chegou na conexão e executa as linhas completas.
+ *
+ * @return 0 para manter a conexão, -1 para fechá-la (EOF, erro ou linha longa demais).
+ */
+static int client_read(daemon_client_t *c) {
+    ssize_t n = read(c->fd, c->buf + c->len, IPC_DAEMON_MAX_REQUEST - c->len);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return 0;
+    }
+    if (n <= 0) {
+        return -1;
+    }
+    c->len += (size_t)n;
+    return client_process(c);
+}
+
+/**
+ * @brief Cria o socket de controle em escuta.
+ *
+ * Num caminho do sistema de arquivos, um daemon vivo no mesmo caminho não
+ * tem o socket removido (EADDRINUSE); no abstrato o bind() já recusa.
+ *
+ * @return Descritor em escuta, ou -1 em erro.
+ */
+static int open_control_socket(const char *name) {
+    struct sockaddr_un addr;
+    socklen_t addr_len;
+
+    if (socket_addr_init(&addr, &addr_len, name) == -1) {
+        return -1;
+    }
+    if (!socket_addr_is_abstract(name)) {
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (probe == -1) {
+            return -1;
+        }
+        if (connect(probe, (struct sockaddr *)&addr, addr_len) == 0) {
+            close(probe);
+            errno = EADDRINUSE;
+            return -1;
+        }
+        close(probe);
+        unlink(name);
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *)&addr, addr_len) == -1 || listen(fd, SOMAXCONN) == -1) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Confere o dono da conexão: só processos do mesmo usuário falam com o daemon.
+ *
+ * O nome abstrato padrão não tem permissões de arquivo, então qualquer
+ * usuário conseguiria conectar; SO_PEERCRED traz o UID de quem conectou.
+ *
+ * @return 1 se o UID é o do daemon, 0 caso contrário (mensagem já emitida).
+ */
+static int client_allowed(int fd) {
+    struct ucred cred = { -1, (uid_t)-1, (gid_t)-1 };
+    socklen_t cred_len = sizeof(cred);
+    char status_msg[128];
+
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) == 0 && cred.uid == getuid()) {
+        return 1;
+    }
+    snprintf(status_msg, sizeof(status_msg), "Conexão recusada: UID %d (PID %d) não é o do daemon.",
+             (int)cred.uid, (int)cred.pid);
+    print_json_status(IPC_DAEMON_MODULE, "rejected", status_msg, getpid());
+    return 0;
+}
+
+static void close_client(daemon_client_t *c) {
+    close(c->fd);
+    free(c->buf);
+    free(c->out);
+    c->fd = -1;
+    c->buf = c->out = NULL;
+    c->len = c->out_len = c->out_cap = 0;
+}
+
+static void serve(void) {
+    struct pollfd pfds[IPC_DAEMON_MAX_CLIENTS + 1];
+    int map[IPC_DAEMON_MAX_CLIENTS + 1];
+
+    while (!stop_requested) {
+        int n = 0, timeout = -1;
+        pfds[n].fd = listen_fd;
+        pfds[n].events = POLLIN;
+        map[n++] = -1;
+        for (int i = 0; i < IPC_DAEMON_MAX_CLIENTS; i++) {
+            daemon_client_t *c = &clients[i];
+            if (c->fd != -1) {
+                // Fila acima do limite: só escrita até o cliente ler as respostas
+                pfds[n].fd = c->fd;
+                pfds[n].events = (short)((c->out_len < IPC_DAEMON_OUTPUT_HIGH ? POLLIN : 0) |
+                                         (c->out_len > 0 ? POLLOUT : 0));
+                map[n++] = i;
+                // Linhas que esperaram a fila baixar não dependem de evento novo no socket
+                if (c->out_len < IPC_DAEMON_OUTPUT_HIGH && memchr(c->buf, '\n', c->len)) {
+                    timeout = 0;
+                }
+            }
+        }
+        if (poll(pfds, (nfds_t)n, timeout) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            print_json_error(IPC_DAEMON_MODULE, "Falha no poll()", getpid());
+            break;
+        }
+        for (int k = 1; k < n && !stop_requested; k++) {
+            daemon_client_t *c = &clients[map[k]];
+            short revents = pfds[k].revents;
+            int rc = 0;
+            if (c->out_len > 0 && (revents & (POLLOUT | POLLERR | POLLHUP))) {
+                rc = client_flush(c);
+            }
+            // Primeiro as linhas que já estavam no buffer; só então lê mais
+            if (rc == 0) {
+                rc = client_process(c);
+            }
+            if (rc == 0 && (revents & (POLLIN | POLLHUP)) && c->out_len < IPC_DAEMON_OUTPUT_HIGH) {
+                rc = client_read(c);
+            }
+            // Tentativa imediata: quase sempre o socket aceita tudo e não há POLLOUT a esperar
+            if (rc == 0 && c->out_len > 0) {
+                rc = client_flush(c);
+            }
+            if (rc == -1) {
+                close_client(c);
+            }
+        }
+        if (!stop_requested && (pfds[0].revents & POLLIN)) {
+            int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK);
+            if (fd != -1 && !client_allowed(fd)) {
+                close(fd);
+                fd = -1;
+            }
+            int slot = -1;
+            for (int i = 0; fd != -1 && i < IPC_DAEMON_MAX_CLIENTS && slot == -1; i++) {
+                if (clients[i].fd == -1) {
+                    slot = i;
+                }
+            }
+            if (fd != -1 && (slot == -1 || (clients[slot].buf = malloc(IPC_DAEMON_MAX_REQUEST)) == NULL)) {
+                // Sem vaga: o cliente vê EOF e pode tentar de novo
+                close(fd);
+            } else if (fd != -1) {
+                clients[slot].fd = fd;
+                clients[slot].format = default_format;
+                clients[slot].len = 0;
+            }
+        }
+    }
+    // Última tentativa de entregar o que ficou na fila (ex: o "done" do stop)
+    for (int i = 0; i < IPC_DAEMON_MAX_CLIENTS; i++) {
+        if (clients[i].fd != -1) {
+            client_flush(&clients[i]);
+            close_client(&clients[i]);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    char name[sizeof(((struct sockaddr_un *)0)->sun_path)];
+    pid_t pid = getpid();
+    char status_msg[512];
+
+    const char *env_name = getenv(IPC_DAEMON_SOCKET_ENV);
+    if (env_name && env_name[0]) {
+        snprintf(name, sizeof(name), "%s", env_name);
+    } else {
+        snprintf(name, sizeof(name), IPC_DAEMON_SOCKET_FORMAT, (unsigned)getuid());
+    }
+    for (int i = 1; i < argc; i += 2) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--socket") == 0 && value && value[0]) {
+            snprintf(name, sizeof(name), "%s", value);
+        } else if (strcmp(argv[i], "--capacity") == 0 && value && strtoul(value, NULL, 10) >= DAEMON_MIN_CAPACITY) {
+            channel_cfg.capacity = strtoul(value, NULL, 10);
+        } else {
+            print_json_error(IPC_DAEMON_MODULE, "Uso: ./ipc_daemon [--socket <nome>] [--capacity <bytes>]", pid);
+            return 1;
+        }
+    }
+
+    // Os eventos mudam de descritor a cada requisição: só no modo síncrono
+    json_output_stop_async();
+    const char *format = getenv(JSON_OUTPUT_FORMAT_ENV);
+    if (format && strcasecmp(format, "binary") == 0) {
+        default_format = JSON_FORMAT_BINARY;
+    }
+    echo_buf = malloc(IPC_DAEMON_MAX_REQUEST + 1);
+    if (!echo_buf) {
+        print_json_error(IPC_DAEMON_MODULE, "Falha ao alocar o buffer de eco", pid);
+        return 1;
+    }
+    events_fd = memfd_create("ipc_daemon_events", MFD_CLOEXEC);
+    if (events_fd == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Falha no memfd_create dos eventos: %s", strerror(errno));
+        print_json_error(IPC_DAEMON_MODULE, status_msg, pid);
+        free(echo_buf);
+        return 1;
+    }
+    for (int i = 0; i < IPC_DAEMON_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+    }
+    if (start_channels() == -1) {
+        stop_channels();
+        return 1;
+    }
+
+    // Um cliente que some no meio da resposta não pode derrubar o daemon
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_IGN;
+    sigaction(SIGPIPE, &sa, NULL);
+    sa.sa_handler = on_stop_signal;     // Sem SA_RESTART: o poll() volta com EINTR
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+
+    listen_fd = open_control_socket(name);
+    if (listen_fd == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Falha ao escutar em %s: %s", name, strerror(errno));
+        print_json_error(IPC_DAEMON_MODULE, status_msg, pid);
+        stop_channels();
+        return 1;
+    }
+    snprintf(status_msg, sizeof(status_msg),
+             "Daemon escutando em %s; canais aquecidos: pipe (worker %d), unix (worker %d), shm (worker %d).",
+             name, (int)channels[0].worker, (int)channels[1].worker, (int)channels[2].worker);
+    print_json_status(IPC_DAEMON_MODULE, "listening", status_msg, pid);
+    json_output_flush();
+
+    serve();
+
+    close(listen_fd);
+    if (!socket_addr_is_abstract(name)) {
+        unlink(name);
+    }
+    stop_channels();
+    print_json_status(IPC_DAEMON_MODULE, "stopped", "Daemon encerrado; canais fechados.", pid);
+    close(events_fd);
+    free(echo_buf);
+    return 0;
+}
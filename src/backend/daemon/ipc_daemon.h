@@ -0,0 +1,47 @@
+/**
+ * @file ipc_daemon.h
+ * @brief Daemon de backend persistente com socket de controle local
+ *
+ * O ipc_daemon cria uma vez os canais pipe, unix e shm da libipc, cada um
+ * com um worker de eco já conectado, e atende comandos de texto num socket
+ * AF_UNIX. Cada requisição atravessa um canal já aquecido e os eventos
+ * (status, data, metrics) voltam pela própria conexão de controle, no
+ * formato de json_output.h: o frontend deixa de pagar fork/exec, ligação
+ * dinâmica e criação do IPC a cada clique.
+ *
+ * Protocolo (uma linha por requisição, terminada em '\n'):
+ *
+ *   <canal> <mensagem>   canal: pipes|pipe, sockets|unix ou shm
+ *   format json|binary   formato dos eventos desta conexão (sem resposta)
+ *   ping                 responde "pong"
+ *   stop                 encerra o daemon
+ *
+ * Toda requisição, exceto format, termina com um status "done" do módulo
+ * IPC_DAEMON_MODULE.
+ *
+ * Só processos do mesmo UID do daemon são atendidos (SO_PEERCRED); os
+ * demais têm a conexão fechada logo após o accept().
+ */
+
+#ifndef IPC_DAEMON_H
+#define IPC_DAEMON_H
+
+// Variável de ambiente com o nome do socket de controle ('@' inicial: namespace abstrato)
+#define IPC_DAEMON_SOCKET_ENV "IPC_DAEMON_SOCKET"
+
+// Nome padrão (%u: UID), um daemon por usuário sem arquivo em /tmp
+#define IPC_DAEMON_SOCKET_FORMAT "@ipc_daemon.%u"
+
+// Maior linha de requisição, com o '\n'
+#define IPC_DAEMON_MAX_REQUEST (64 * 1024)
+
+// Eventos pendentes numa conexão acima dos quais as próximas linhas dela esperam
+#define IPC_DAEMON_OUTPUT_HIGH (256 * 1024)
+
+// Conexões de controle simultâneas
+#define IPC_DAEMON_MAX_CLIENTS 16
+
+// Módulo dos eventos emitidos pelo daemon
+#define IPC_DAEMON_MODULE "ipc_daemon"
+
+#endif // IPC_DAEMON_H
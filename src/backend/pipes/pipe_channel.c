@@ -0,0 +1,53 @@
+#define _GNU_SOURCE
+#include "../common/ipc_channel.h"
+#include "../common/ipc_io.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+// Transporte "pipe" de ipc_channel.h: um pipe por sentido, fds[0..1] do lado 0 ao 1 e fds[2..3] do 1 ao 0
+
+static int pipe_channel_open(ipc_channel_t *ch, const ipc_channel_config_t *cfg) {
+    if (pipe2(ch->fds, O_CLOEXEC) == -1) {
+        return -1;
+    }
+    if (pipe2(ch->fds + 2, O_CLOEXEC) == -1 || ipc_channel_fd_init(ch) == -1) {
+        for (int i = 0; i < 4; i++) {
+            if (ch->fds[i] != -1) {
+                close(ch->fds[i]);
+            }
+        }
+        return -1;
+    }
+    // Sem privilégio o kernel limita a pipe-max-size; a capacidade padrão do pipe serve de piso
+    ipc_pipe_set_size(ch->fds[1], cfg->capacity);
+    ipc_pipe_set_size(ch->fds[3], cfg->capacity);
+    return 0;
+}
+
+static void pipe_channel_attach(ipc_channel_t *ch, int side) {
+    ch->send_fd = ch->fds[side == 0 ? 1 : 3];
+    ch->recv_fd = ch->fds[side == 0 ? 2 : 0];
+    close(ch->fds[side == 0 ? 0 : 1]);
+    close(ch->fds[side == 0 ? 3 : 2]);
+}
+
+static void pipe_channel_close(ipc_channel_t *ch) {
+    if (ch->side == -1) {
+        // Nunca anexado (erro antes do fork): fecha as quatro pontas
+        for (int i = 0; i < 4; i++) {
+            close(ch->fds[i]);
+        }
+    }
+    ipc_channel_fd_close(ch);
+}
+
+const ipc_channel_ops_t ipc_channel_pipe_ops = {
+    "pipe",
+    pipe_channel_open,
+    pipe_channel_attach,
+    ipc_channel_fd_send,
+    ipc_channel_fd_recv,
+    ipc_channel_fd_send_batch,
+    ipc_channel_fd_recv_batch,
+    pipe_channel_close,
+};
@@ -6,6 +6,11 @@
  * usando dois pipes anônimos: um para o pai enviar dados ao filho e outro
  * para o filho enviar dados de volta ao pai (eco).
  *
+ * O eco usa o canal "pipe" da libipc (ipc_channel.h): toda mensagem trafega
+ * em quadros com prefixo de tamanho (ipc_io.h), então chega inteira. Com --stream o demo vira
+ * um transporte de volume: o pai empurra N bytes em blocos, o filho ecoa
+ * cada bloco e o pai relata a vazão sustentada em GB/s.
+ *
  * A saída do programa é em formato JSON para permitir a integração com
  * uma interface gráfica (frontend), com logs detalhados de cada etapa.
  */
@@ -13,29 +18,538 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <pthread.h>
 #include <sys/wait.h>
 #include "../common/json_output.h"
+#include "../common/affinity.h"
+#include "../common/ipc_io.h"
+#include "../common/ipc_channel.h"
+#include "../common/ipc_uring_bench.h"
+#include "pipe_pool.h"
+
+// Maior mensagem do eco: um único argumento do execve() não passa de MAX_ARG_STRLEN (128 KB)
+#define PIPE_DEMO_MAX_MESSAGE (128 * 1024)
+
+// Padrões do modo --stream: bloco por quadro e capacidade pedida a cada pipe
+#define STREAM_DEFAULT_CHUNK (256UL * 1024)
+#define STREAM_DEFAULT_PIPE_SIZE (1024UL * 1024)
+#define STREAM_MIN_CHUNK sizeof(uint64_t)
+
+// Destino do eco no modo zero-copy: o pai confere o número do bloco e descarta o resto com splice()
+#define STREAM_SINK_PATH "/dev/null"
+
+/**
+ * @brief Caminho dos dados no modo --stream.
+ */
+typedef enum {
+    STREAM_COPY,                // write()/read(): duas cópias por sentido
+    STREAM_ZEROCOPY             // vmsplice() no envio, splice() no eco e no descarte
+} stream_path_t;
+
+/**
+ * @brief Parâmetros e contadores do modo --stream.
+ *
+ * No zero-copy o pipe referencia as páginas dos blocos enviados até elas
+ * serem consumidas do outro lado, e o eco só as passa adiante. Por isso os
+ * blocos formam um anel e o bloco do quadro N só é reescrito depois que o
+ * pai confirmou (acked) o eco do quadro N - nslots.
+ */
+typedef struct {
+    int write_fd;               // Pai -> filho
+    uint64_t total;             // Bytes de carga a enviar
+    size_t chunk;               // Carga máxima por quadro
+    stream_path_t path;
+    char *slots;                // Zero-copy: anel de blocos alinhados à página
+    size_t slot_size;
+    size_t nslots;
+    uint64_t acked;             // Quadros cujo eco o pai já consumiu por inteiro
+    int stop;                   // O pai desistiu: não esperar mais confirmações
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int error;                  // errno da thread de envio (0 se ok)
+} stream_sender_t;
+
+// Lê uma mensagem inteira do canal como string terminada em '\0' (NULL em erro ou EOF)
+static char *read_message(ipc_channel_t *ch) {
+    size_t len;
+    char *buffer = malloc(PIPE_DEMO_MAX_MESSAGE + 1);
+    if (!buffer) {
+        return NULL;
+    }
+    if (ipc_channel_recv(ch, buffer, PIPE_DEMO_MAX_MESSAGE, &len) != 1) {
+        free(buffer);
+        return NULL;
+    }
+    buffer[len] = '\0';
+    return buffer;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Tamanho com sufixo opcional K/M/G (potências de 1024); 0 se inválido ou se não cabe em 64 bits
+static uint64_t parse_size(const char *text) {
+    char *end;
+    uint64_t unit = 1;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (errno == ERANGE) {
+        return 0;
+    }
+    switch (*end) {
+        case 'G': case 'g': unit = 1024ULL * 1024 * 1024; end++; break;
+        case 'M': case 'm': unit = 1024ULL * 1024; end++; break;
+        case 'K': case 'k': unit = 1024ULL; end++; break;
+        default: break;
+    }
+    if (*end != '\0' || value > UINT64_MAX / unit) {
+        return 0;
+    }
+    return (uint64_t)value * unit;
+}
+
+// Zero-copy: espera o pai liberar o bloco usado pelo quadro seq - nslots
+static int stream_slot_wait(stream_sender_t *s, uint64_t seq) {
+    int ok;
+    pthread_mutex_lock(&s->lock);
+    while (!s->stop && s->acked + s->nslots <= seq) {
+        pthread_cond_wait(&s->cond, &s->lock);
+    }
+    ok = !s->stop;
+    pthread_mutex_unlock(&s->lock);
+    return ok ? 0 : -1;
+}
+
+static void stream_ack(stream_sender_t *s, uint64_t frames, int stop) {
+    pthread_mutex_lock(&s->lock);
+    s->acked = frames;
+    s->stop |= stop;
+    pthread_cond_signal(&s->cond);
+    pthread_mutex_unlock(&s->lock);
+}
+
+/**
+ * @brief Thread de envio do pai: blocos numerados seguidos de um quadro vazio (fim).
+ *
+ * Roda em paralelo com a leitura do eco; com os dois sentidos no mesmo
+ * laço, pai e filho travariam com os dois pipes cheios.
+ */
+static void *stream_send(void *arg) {
+    stream_sender_t *s = arg;
+    char *block = s->path == STREAM_COPY ? malloc(s->chunk) : s->slots;
+    uint64_t sent = 0;
+
+    if (!block) {
+        s->error = ENOMEM;
+        return NULL;
+    }
+    if (s->path == STREAM_COPY) {
+        memset(block, 'p', s->chunk);
+    }
+    for (uint64_t seq = 0; sent < s->total; seq++) {
+        size_t len = s->total - sent < s->chunk ? (size_t)(s->total - sent) : s->chunk;
+        int rc;
+        if (s->path == STREAM_COPY) {
+            memcpy(block, &seq, len < sizeof(seq) ? len : sizeof(seq));
+            rc = ipc_write_frame(s->write_fd, block, len);
+        } else {
+            if (stream_slot_wait(s, seq) == -1) {
+                s->error = ECANCELED;
+                break;
+            }
+            block = s->slots + (seq % s->nslots) * s->slot_size;
+            memcpy(block, &seq, len < sizeof(seq) ? len : sizeof(seq));
+            rc = ipc_write_frame_header(s->write_fd, len);
+            if (rc == 0) {
+                rc = ipc_vmsplice_all(s->write_fd, block, len);
+            }
+        }
+        if (rc == -1) {
+            s->error = errno;
+            break;
+        }
+        sent += len;
+    }
+    if (!s->error && ipc_write_frame(s->write_fd, NULL, 0) == -1) {
+        s->error = errno;
+    }
+    if (s->path == STREAM_COPY) {
+        free(block);
+    }
+    return NULL;
+}
+
+// Filho no modo --stream: ecoa cada quadro até o quadro vazio
+static int stream_child(int in_fd, int out_fd, stream_path_t path, size_t chunk, uint64_t *echoed) {
+    char *block = NULL;
+    uint32_t frame_len;
+    size_t len;
+    int rc;
+
+    if (path == STREAM_COPY && !(block = malloc(chunk))) {
+        return -1;
+    }
+    *echoed = 0;
+    for (;;) {
+        if (path == STREAM_COPY) {
+            rc = ipc_read_frame(in_fd, block, chunk, &len);
+        } else {
+            rc = ipc_read_frame_header(in_fd, &frame_len);
+            len = frame_len;
+        }
+        if (rc != 1) {
+            break;
+        }
+        if (path == STREAM_COPY) {
+            rc = ipc_write_frame(out_fd, block, len) == -1 ? -1 : 1;
+        } else {
+            // O prefixo é reescrito; a carga passa de um pipe ao outro sem sair do kernel
+            rc = ipc_write_frame_header(out_fd, len) == -1 ||
+                 (len > 0 && ipc_splice_all(in_fd, out_fd, len) == -1) ? -1 : 1;
+        }
+        if (rc == -1 || len == 0) {
+            break;
+        }
+        *echoed += len;
+    }
+    free(block);
+    return rc == 1 ? 0 : -1;
+}
+
+// Pai no modo --stream: lê o eco, confere tamanho e numeração de cada bloco
+static int stream_parent(int in_fd, stream_sender_t *s, int sink_fd, uint64_t *received) {
+    char *block = s->path == STREAM_COPY ? malloc(s->chunk) : NULL;
+    uint32_t frame_len;
+    size_t len;
+    uint64_t seq = 0;
+    int rc;
+
+    if (s->path == STREAM_COPY && !block) {
+        return -1;
+    }
+    *received = 0;
+    for (;;) {
+        if (s->path == STREAM_COPY) {
+            rc = ipc_read_frame(in_fd, block, s->chunk, &len);
+        } else {
+            rc = ipc_read_frame_header(in_fd, &frame_len);
+            len = frame_len;
+        }
+        if (rc != 1 || len == 0) {
+            break;
+        }
+
+        uint64_t got = 0;
+        size_t head = len < sizeof(got) ? len : sizeof(got);
+        size_t expect = s->total - *received < s->chunk ? (size_t)(s->total - *received) : s->chunk;
+        if (len != expect) {
+            errno = EBADMSG;
+            rc = -1;
+            break;
+        }
+        if (s->path == STREAM_COPY) {
+            memcpy(&got, block, head);
+        } else if (ipc_read_all(in_fd, &got, head) == -1 ||
+                   (len > head && ipc_splice_all(in_fd, sink_fd, len - head) == -1)) {
+            rc = -1;
+            break;
+        }
+        if (head == sizeof(got) && got != seq) {
+            errno = EBADMSG;
+            rc = -1;
+            break;
+        }
+        *received += len;
+        seq++;
+        if (s->path == STREAM_ZEROCOPY) {
+            // Eco consumido: as páginas do bloco não estão mais em nenhum pipe
+            stream_ack(s, seq, 0);
+        }
+    }
+    free(block);
+    return rc == 1 && *received == s->total ? 0 : -1;
+}
+
+/**
+ * @brief Uma passada do modo --stream por um dos caminhos: cria os pipes, faz o fork e mede.
+ *
+ * @param pipe_cap Recebe a capacidade efetiva do pipe Pai->Filho.
+ * @param elapsed Recebe o tempo do primeiro envio até o fim do eco.
+ * @return 0 em sucesso, -1 em erro (já relatado em JSON).
+ */
+static int stream_pass(stream_path_t path, uint64_t total, size_t chunk, size_t pipe_size,
+                       long *pipe_cap, uint64_t *elapsed) {
+    const char *path_name = path == STREAM_COPY ? "copy" : "zerocopy";
+    int to_child[2], to_parent[2];
+    char status_msg[512];
+    pid_t parent_pid = getpid();
+
+    if (pipe(to_child) == -1) {
+        print_json_error("pipes", "Falha ao criar os pipes.", parent_pid);
+        return -1;
+    }
+    if (pipe(to_parent) == -1) {
+        print_json_error("pipes", "Falha ao criar os pipes.", parent_pid);
+        close(to_child[0]); close(to_child[1]);
+        return -1;
+    }
+    long size_p2c = ipc_pipe_set_size(to_child[1], pipe_size);
+    long size_c2p = ipc_pipe_set_size(to_parent[1], pipe_size);
+    if (size_p2c == -1 || size_c2p == -1) {
+        snprintf(status_msg, sizeof(status_msg), "F_SETPIPE_SZ falhou (%s); usando a capacidade padrão.", strerror(errno));
+        print_json_status("pipes", "pipe_size", status_msg, parent_pid);
+        size_p2c = size_c2p = -1;
+    } else {
+        snprintf(status_msg, sizeof(status_msg), "Capacidade dos pipes (%s): %ld bytes (Pai->Filho), %ld bytes (Filho->Pai).",
+                 path_name, size_p2c, size_c2p);
+        print_json_status("pipes", "pipe_size", status_msg, parent_pid);
+    }
+    *pipe_cap = size_p2c;
 
-#define BUFFER_SIZE 256
+    stream_sender_t sender;
+    memset(&sender, 0, sizeof(sender));
+    sender.write_fd = to_child[1];
+    sender.total = total;
+    sender.chunk = chunk;
+    sender.path = path;
+    pthread_mutex_init(&sender.lock, NULL);
+    pthread_cond_init(&sender.cond, NULL);
+
+    int sink_fd = -1;
+    if (path == STREAM_ZEROCOPY) {
+        // Anel com folga para os dois pipes cheios: em regime o envio não espera confirmações
+        long page = sysconf(_SC_PAGESIZE);
+        size_t capacity = size_p2c > 0 && size_c2p > 0 ? (size_t)size_p2c + (size_t)size_c2p : 2 * pipe_size;
+        void *slots = NULL;
+        sender.slot_size = (chunk + (size_t)page - 1) / (size_t)page * (size_t)page;
+        sender.nslots = capacity / sender.slot_size + 2;
+        sink_fd = open(STREAM_SINK_PATH, O_WRONLY);
+        if (sink_fd == -1 || posix_memalign(&slots, (size_t)page, sender.nslots * sender.slot_size) != 0) {
+            print_json_error("pipes", "Falha ao preparar os blocos do modo zero-copy.", parent_pid);
+            if (sink_fd != -1) {
+                close(sink_fd);
+            }
+            close(to_child[0]); close(to_child[1]);
+            close(to_parent[0]); close(to_parent[1]);
+            free(slots);
+            pthread_cond_destroy(&sender.cond);
+            pthread_mutex_destroy(&sender.lock);
+            return -1;
+        }
+        sender.slots = slots;
+        memset(sender.slots, 'p', sender.nslots * sender.slot_size);
+    }
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        print_json_error("pipes", "Falha no fork().", parent_pid);
+        if (sink_fd != -1) {
+            close(sink_fd);
+        }
+        close(to_child[0]); close(to_child[1]);
+        close(to_parent[0]); close(to_parent[1]);
+        free(sender.slots);
+        pthread_cond_destroy(&sender.cond);
+        pthread_mutex_destroy(&sender.lock);
+        return -1;
+    }
+    if (pid == 0) {
+        pid_t child_pid = getpid();
+        uint64_t echoed = 0;
+        ipc_affinity_apply("pipes", IPC_ROLE_CONSUMER);
+        close(to_child[1]);
+        close(to_parent[0]);
+        snprintf(status_msg, sizeof(status_msg), "Filho pronto para ecoar o stream (%s).", path_name);
+        print_json_status("pipes", "child_start", status_msg, child_pid);
+        int rc = stream_child(to_child[0], to_parent[1], path, chunk, &echoed);
+        close(to_child[0]);
+        close(to_parent[1]);
+        if (rc == -1) {
+            snprintf(status_msg, sizeof(status_msg), "Filho interrompeu o eco após %llu bytes: %s",
+                     (unsigned long long)echoed, strerror(errno));
+            print_json_error("pipes", status_msg, child_pid);
+            exit(EXIT_FAILURE);
+        }
+        snprintf(status_msg, sizeof(status_msg), "Filho ecoou %llu bytes.", (unsigned long long)echoed);
+        print_json_status("pipes", "child_exit", status_msg, child_pid);
+        exit(EXIT_SUCCESS);
+    }
+
+    ipc_affinity_apply("pipes", IPC_ROLE_PRODUCER);
+    close(to_child[0]);
+    close(to_parent[1]);
+    snprintf(status_msg, sizeof(status_msg), "Pai enviando %llu bytes em blocos de %zu bytes (%s)...",
+             (unsigned long long)total, chunk, path_name);
+    print_json_status("pipes", "stream_start", status_msg, parent_pid);
+
+    pthread_t thread;
+    uint64_t received = 0;
+    uint64_t start = now_ns();
+    int rc = -1;
+    if (pthread_create(&thread, NULL, stream_send, &sender) == 0) {
+        rc = stream_parent(to_parent[0], &sender, sink_fd, &received);
+        // Sem leitor o envio falharia com EPIPE; fechar antes do join evita bloquear
+        if (rc == -1) {
+            stream_ack(&sender, sender.acked, 1);
+            close(to_parent[0]);
+            to_parent[0] = -1;
+        }
+        pthread_join(thread, NULL);
+    }
+    *elapsed = now_ns() - start;
+    close(to_child[1]);
+    if (to_parent[0] != -1) {
+        close(to_parent[0]);
+    }
+    if (sink_fd != -1) {
+        close(sink_fd);
+    }
+    free(sender.slots);
+    pthread_cond_destroy(&sender.cond);
+    pthread_mutex_destroy(&sender.lock);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (rc == -1 || sender.error || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        snprintf(status_msg, sizeof(status_msg), "Stream (%s) falhou após %llu bytes ecoados (envio: %s).",
+                 path_name, (unsigned long long)received, sender.error ? strerror(sender.error) : "ok");
+        print_json_error("pipes", status_msg, parent_pid);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Modo --stream: eco de total bytes em blocos de chunk, com pipes de pipe_size.
+ *
+ * Com zerocopy, a mesma carga passa em seguida pelo caminho vmsplice/splice
+ * e as duas linhas "metrics" saem lado a lado.
+ */
+static int run_stream(uint64_t total, size_t chunk, size_t pipe_size, int zerocopy) {
+    char metrics[512];
+    pid_t parent_pid = getpid();
+    double copy_secs = 0;
+
+    print_json_status("pipes", "setup", "Iniciando a configuração dos pipes (modo stream)...", parent_pid);
+    // Se um lado morrer o outro recebe EPIPE e relata o erro, em vez de ser morto por SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    for (int path = STREAM_COPY; path <= (zerocopy ? STREAM_ZEROCOPY : STREAM_COPY); path++) {
+        long pipe_cap = 0;
+        uint64_t elapsed = 0;
+        if (stream_pass((stream_path_t)path, total, chunk, pipe_size, &pipe_cap, &elapsed) == -1) {
+            return 1;
+        }
+
+        double secs = (double)elapsed / 1e9;
+        if (path == STREAM_COPY) {
+            copy_secs = secs;
+        }
+        snprintf(metrics, sizeof(metrics),
+                 "{\"path\":\"%s\",\"bytes\":%llu,\"chunk\":%zu,\"frames\":%llu,\"pipe_size\":%ld,"
+                 "\"seconds\":%.6f,\"gb_per_sec\":%.4f,\"wire_gb_per_sec\":%.4f,\"speedup_vs_copy\":%.2f}",
+                 path == STREAM_COPY ? "copy" : "zerocopy",
+                 (unsigned long long)total, chunk, (unsigned long long)((total + chunk - 1) / chunk),
+                 pipe_cap, secs, secs > 0 ? (double)total / secs / 1e9 : 0.0,
+                 secs > 0 ? 2.0 * (double)total / secs / 1e9 : 0.0,
+                 secs > 0 ? copy_secs / secs : 0.0);
+        print_json_metrics("pipes", path == STREAM_COPY ? "stream" : "stream_zerocopy", metrics, parent_pid);
+    }
+    print_json_status("pipes", "success", "Stream via pipes concluído com sucesso.", parent_pid);
+    return 0;
+}
 
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        print_json_error("pipes", "Uso: ./pipe_demo <mensagem>", getpid());
+    uint64_t stream_bytes = 0;
+    size_t chunk = STREAM_DEFAULT_CHUNK;
+    size_t pipe_size = STREAM_DEFAULT_PIPE_SIZE;
+    int zerocopy = 0;
+    pipe_pool_config_t pool = { 0, PIPE_POOL_DEFAULT_DEPTH, PIPE_POOL_ROUND_ROBIN, 0, PIPE_POOL_DEFAULT_REQUEST_SIZE };
+    ipc_uring_bench_config_t uring = { IPC_URING_BENCH_PIPE, 0, IPC_URING_BENCH_DEFAULT_SIZE,
+                                       IPC_URING_BENCH_DEFAULT_DEPTH, 0 };
+    long depth = 0;
+    int argi = 1;
+
+    // Opções: [--stream <bytes> [--chunk <bytes>] [--pipe-size <bytes>] [--zerocopy]] (sufixos K/M/G)
+    //         [--pool <workers> [--depth N] [--dispatch rr|least] [--requests N] [--request-size <bytes>]]
+    //         [--uring <mensagens> [--size <bytes>] [--depth N] [--sqpoll]]
+    while (argi < argc && strncmp(argv[argi], "--", 2) == 0) {
+        const char *opt = argv[argi];
+        uint64_t value = argi + 1 < argc ? parse_size(argv[argi + 1]) : 0;
+        if (strcmp(opt, "--zerocopy") == 0 || strcmp(opt, "--sqpoll") == 0) {
+            zerocopy |= opt[2] == 'z';
+            uring.sqpoll |= opt[2] == 's';
+            argi++;
+            continue;
+        } else if (strcmp(opt, "--dispatch") == 0 && argi + 1 < argc &&
+                   (strcmp(argv[argi + 1], "rr") == 0 || strcmp(argv[argi + 1], "least") == 0)) {
+            pool.dispatch = strcmp(argv[argi + 1], "rr") == 0 ? PIPE_POOL_ROUND_ROBIN : PIPE_POOL_LEAST_LOADED;
+        } else if (strcmp(opt, "--pool") == 0 && value > 0 && value <= PIPE_POOL_MAX_WORKERS) {
+            pool.workers = (int)value;
+        } else if (strcmp(opt, "--depth") == 0 && value > 0 && value <= PIPE_POOL_MAX_DEPTH) {
+            depth = (long)value;
+        } else if (strcmp(opt, "--uring") == 0 && value > 0 && value <= LONG_MAX) {
+            uring.messages = (long)value;
+        } else if (strcmp(opt, "--size") == 0 && value >= IPC_URING_BENCH_MIN_SIZE && value <= IPC_URING_BENCH_MAX_SIZE) {
+            uring.size = (size_t)value;
+        } else if (strcmp(opt, "--requests") == 0 && value > 0 && value <= LONG_MAX) {
+            pool.requests = (long)value;
+        } else if (strcmp(opt, "--request-size") == 0 && value >= sizeof(uint64_t) &&
+                   value <= IPC_FRAME_MAX_PAYLOAD - sizeof(uint64_t)) {
+            pool.request_size = (size_t)value;
+        } else if (strcmp(opt, "--stream") == 0 && value > 0) {
+            stream_bytes = value;
+        } else if (strcmp(opt, "--chunk") == 0 && value >= STREAM_MIN_CHUNK && value <= IPC_FRAME_MAX_PAYLOAD) {
+            chunk = (size_t)value;
+        } else if (strcmp(opt, "--pipe-size") == 0 && value > 0 && value <= INT32_MAX) {
+            pipe_size = (size_t)value;
+        } else {
+            break;
+        }
+        argi += 2;
+    }
+    int modes = (pool.workers > 0) + (stream_bytes > 0) + (uring.messages > 0);
+    if (depth > 0) {
+        pool.depth = (int)depth;
+        uring.depth = (int)depth;
+    }
+    if (pool.workers > 0 && modes == 1 && !zerocopy && !uring.sqpoll && argi == argc) {
+        return pipe_pool_run(&pool);
+    }
+    if (stream_bytes > 0 && modes == 1 && !uring.sqpoll && argi == argc) {
+        return run_stream(stream_bytes, chunk, pipe_size, zerocopy);
+    }
+    if (uring.messages > 0 && modes == 1 && !zerocopy && uring.depth <= IPC_URING_BENCH_MAX_DEPTH && argi == argc) {
+        return ipc_uring_bench_run("pipes", &uring);
+    }
+    if (argc - argi != 1 || modes > 0 || zerocopy || uring.sqpoll) {
+        print_json_error("pipes", "Uso: ./pipe_demo <mensagem> | ./pipe_demo --stream <bytes> "
+                         "[--chunk <bytes>] [--pipe-size <bytes>] [--zerocopy] | ./pipe_demo --pool <workers> "
+                         "[--depth <N>] [--dispatch rr|least] [--requests <N>] [--request-size <bytes>] | "
+                         "./pipe_demo --uring <mensagens> [--size <bytes>] [--depth <N>] [--sqpoll]", getpid());
         return 1;
     }
-    const char *message_to_send = argv[1];
+    const char *message_to_send = argv[argi];
     char status_msg[512];
 
     // --- 1. SETUP ---
     print_json_status("pipes", "setup", "Iniciando a configuração dos pipes...", getpid());
 
-    int parent_to_child_pipe[2];
-    int child_to_parent_pipe[2];
+    // Canal "pipe" da libipc: um pipe Pai->Filho e outro Filho->Pai, mensagens em quadros
+    ipc_channel_t channel;
     pid_t pid;
-    char buffer[BUFFER_SIZE];
 
-    if (pipe(parent_to_child_pipe) == -1 || pipe(child_to_parent_pipe) == -1) {
+    if (ipc_channel_open(&channel, "pipe", NULL) == -1) {
         print_json_error("pipes", "Falha ao criar os pipes.", getpid());
         exit(EXIT_FAILURE);
     }
@@ -54,35 +568,35 @@ int main(int argc, char *argv[]) {
     if (pid == 0) {
         pid_t child_pid = getpid();
         print_json_status("pipes", "child_start", "Processo filho iniciado.", child_pid);
+        ipc_affinity_apply("pipes", IPC_ROLE_CONSUMER);
 
-        // Fechar pontas não utilizadas
-        close(parent_to_child_pipe[1]); // Não escreve no pipe Pai->Filho
-        close(child_to_parent_pipe[0]);  // Não lê no pipe Filho->Pai
+        // Fechar pontas não utilizadas: não escreve no pipe Pai->Filho nem lê no Filho->Pai
+        ipc_channel_attach(&channel, 1);
         print_json_status("pipes", "child_setup", "Filho fechou pontas de pipe não utilizadas.", child_pid);
 
-        // Ler do pai
+        // Ler do pai: o prefixo informa o tamanho, então a mensagem chega inteira
         snprintf(status_msg, sizeof(status_msg), "Filho aguardando mensagem do pai no pipe...");
         print_json_status("pipes", "child_read_wait", status_msg, child_pid);
-        ssize_t bytes_read = read(parent_to_child_pipe[0], buffer, sizeof(buffer) - 1);
+        char *buffer = read_message(&channel);
 
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            snprintf(status_msg, sizeof(status_msg), "Filho recebeu %zd bytes.", bytes_read);
+        if (buffer) {
+            snprintf(status_msg, sizeof(status_msg), "Filho recebeu %zu bytes.", strlen(buffer));
             print_json_status("pipes", "child_read_ok", status_msg, child_pid);
             print_json_data("pipes", buffer, "pai -> filho", getppid());
 
             // Escrever eco para o pai
             snprintf(status_msg, sizeof(status_msg), "Filho enviando eco: \"%s\"", buffer);
             print_json_status("pipes", "child_write", status_msg, child_pid);
-            write(child_to_parent_pipe[1], buffer, strlen(buffer) + 1);
-
+            if (ipc_channel_send(&channel, buffer, strlen(buffer)) == -1) {
+                print_json_error("pipes", "Filho falhou ao escrever o eco no pipe.", child_pid);
+            }
+            free(buffer);
         } else {
             print_json_error("pipes", "Filho falhou ao ler do pipe do pai.", child_pid);
         }
 
         // Limpeza final do filho
-        close(parent_to_child_pipe[0]);
-        close(child_to_parent_pipe[1]);
+        ipc_channel_close(&channel);
         print_json_status("pipes", "child_exit", "Processo filho finalizado.", child_pid);
         exit(EXIT_SUCCESS);
     }
@@ -90,34 +604,35 @@ int main(int argc, char *argv[]) {
     else {
         pid_t parent_pid = getpid();
         print_json_status("pipes", "parent_start", "Pai continua execução após fork.", parent_pid);
+        ipc_affinity_apply("pipes", IPC_ROLE_PRODUCER);
 
-        // Fechar pontas não utilizadas
-        close(parent_to_child_pipe[0]); // Não lê no pipe Pai->Filho
-        close(child_to_parent_pipe[1]);  // Não escreve no pipe Filho->Pai
+        // Fechar pontas não utilizadas: não lê no pipe Pai->Filho nem escreve no Filho->Pai
+        ipc_channel_attach(&channel, 0);
         print_json_status("pipes", "parent_setup", "Pai fechou pontas de pipe não utilizadas.", parent_pid);
 
         // Escrever para o filho
         snprintf(status_msg, sizeof(status_msg), "Pai enviando mensagem: \"%s\"", message_to_send);
         print_json_status("pipes", "parent_write", status_msg, parent_pid);
-        write(parent_to_child_pipe[1], message_to_send, strlen(message_to_send) + 1);
+        if (ipc_channel_send(&channel, message_to_send, strlen(message_to_send)) == -1) {
+            print_json_error("pipes", "Pai falhou ao escrever no pipe.", parent_pid);
+        }
         print_json_data("pipes", message_to_send, "pai -> filho", parent_pid);
 
         // Ler eco do filho
         print_json_status("pipes", "parent_read_wait", "Pai aguardando eco do filho...", parent_pid);
-        ssize_t bytes_read = read(child_to_parent_pipe[0], buffer, sizeof(buffer) - 1);
+        char *buffer = read_message(&channel);
 
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            snprintf(status_msg, sizeof(status_msg), "Pai recebeu eco de %zd bytes.", bytes_read);
+        if (buffer) {
+            snprintf(status_msg, sizeof(status_msg), "Pai recebeu eco de %zu bytes.", strlen(buffer));
             print_json_status("pipes", "parent_read_ok", status_msg, parent_pid);
             print_json_data("pipes", buffer, "filho -> pai (eco)", pid);
+            free(buffer);
         } else {
             print_json_error("pipes", "Pai falhou ao ler o eco do filho.", parent_pid);
         }
 
         // Limpeza final do pai
-        close(parent_to_child_pipe[1]);
-        close(child_to_parent_pipe[0]);
+        ipc_channel_close(&channel);
 
         print_json_status("pipes", "parent_wait", "Pai aguardando término do processo filho...", parent_pid);
         wait(NULL);
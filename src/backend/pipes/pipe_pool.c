@@ -0,0 +1,542 @@
+#define _GNU_SOURCE
+#include "pipe_pool.h"
+#include "../common/json_output.h"
+#include "../common/affinity.h"
+#include "../common/ipc_io.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Bytes lidos do stdin por chamada
+#define POOL_INPUT_CHUNK 65536
+
+/**
+ * @brief Requisição em voo: os workers respondem na ordem de chegada.
+ */
+typedef struct {
+    uint64_t id;
+    uint64_t sent_ns;
+    size_t bytes;               // Tamanho do quadro no pipe (prefixo + carga)
+} pool_request_t;
+
+/**
+ * @brief Worker do pool visto pelo despachante.
+ */
+typedef struct {
+    pid_t pid;
+    int to_worker;              // Ponta de escrita do pipe despachante -> worker
+    int from_worker;            // Ponta de leitura do pipe worker -> despachante
+    size_t pipe_cap;            // Capacidade efetiva do pipe de requisições
+    pool_request_t *fifo;       // depth posições, circular
+    int head;
+    int inflight;
+    size_t inflight_bytes;
+    long served;
+} pool_worker_t;
+
+/**
+ * @brief Estado do despachante.
+ */
+typedef struct {
+    const pipe_pool_config_t *cfg;
+    pool_worker_t workers[PIPE_POOL_MAX_WORKERS];
+    int spawned;
+    int rr_next;
+
+    // Entrada: linhas do stdin (modo interativo) ou carga sintética (benchmark)
+    char *in;
+    size_t in_start, in_len, in_cap;
+    int in_open;
+    long generated;
+    char *synthetic;
+
+    // Buffers de quadro (carga = id u64 + mensagem, com '\0' extra para os eventos)
+    char *frame;
+    size_t frame_cap;
+
+    uint64_t next_id;
+    long completed;
+    uint64_t bytes;
+    uint64_t latency_sum_ns;
+    uint64_t latency_max_ns;
+} pool_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int grow(char **buf, size_t *cap, size_t need) {
+    if (need <= *cap) {
+        return 0;
+    }
+    size_t next = *cap ? *cap : 4096;
+    while (next < need) {
+        next *= 2;
+    }
+    char *p = realloc(*buf, next);
+    if (!p) {
+        return -1;
+    }
+    *buf = p;
+    *cap = next;
+    return 0;
+}
+
+const char *pipe_pool_dispatch_name(pipe_pool_dispatch_t dispatch) {
+    return dispatch == PIPE_POOL_LEAST_LOADED ? "least" : "rr";
+}
+
+/**
+ * @brief Laço do worker: ecoa cada quadro até o EOF do pipe de requisições.
+ */
+static void pool_worker(int index, int in_fd, int out_fd) {
+    pid_t pid = getpid();
+    char status_msg[256];
+    char *buf = NULL;
+    size_t cap = 0;
+    uint32_t len;
+    long served = 0;
+    int rc;
+
+    ipc_affinity_apply("pipes", IPC_ROLE_CONSUMER);
+    snprintf(status_msg, sizeof(status_msg), "Worker %d pronto no pipe persistente.", index);
+    print_json_status("pipes", "worker_start", status_msg, pid);
+
+    while ((rc = ipc_read_frame_header(in_fd, &len)) == 1) {
+        if (grow(&buf, &cap, len) == -1 || ipc_read_all(in_fd, buf, len) == -1 ||
+            ipc_write_frame(out_fd, buf, len) == -1) {
+            rc = -1;
+            break;
+        }
+        served++;
+    }
+    free(buf);
+    if (rc == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Worker %d falhou após %ld requisições: %s", index, served, strerror(errno));
+        print_json_error("pipes", status_msg, pid);
+        exit(EXIT_FAILURE);
+    }
+    snprintf(status_msg, sizeof(status_msg), "Worker %d encerrado após %ld requisições.", index, served);
+    print_json_status("pipes", "worker_exit", status_msg, pid);
+    exit(EXIT_SUCCESS);
+}
+
+static int pool_spawn(pool_t *p, int index) {
+    pool_worker_t *w = &p->workers[index];
+    int to_worker[2], from_worker[2];
+
+    if (pipe(to_worker) == -1) {
+        return -1;
+    }
+    if (pipe(from_worker) == -1) {
+        close(to_worker[0]);
+        close(to_worker[1]);
+        return -1;
+    }
+    long cap = ipc_pipe_set_size(to_worker[1], PIPE_POOL_PIPE_SIZE);
+    ipc_pipe_set_size(from_worker[1], PIPE_POOL_PIPE_SIZE);
+    if (cap == -1) {
+        cap = fcntl(to_worker[1], F_GETPIPE_SZ);
+    }
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(to_worker[0]); close(to_worker[1]);
+        close(from_worker[0]); close(from_worker[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        // Pontas herdadas dos workers anteriores impediriam o EOF deles no encerramento
+        for (int j = 0; j < index; j++) {
+            close(p->workers[j].to_worker);
+            close(p->workers[j].from_worker);
+        }
+        close(to_worker[1]);
+        close(from_worker[0]);
+        pool_worker(index, to_worker[0], from_worker[1]);
+    }
+
+    close(to_worker[0]);
+    close(from_worker[1]);
+    w->pid = pid;
+    w->to_worker = to_worker[1];
+    w->from_worker = from_worker[0];
+    w->pipe_cap = cap > 0 ? (size_t)cap : 0;
+    return 0;
+}
+
+// Próxima requisição disponível: 1 se há uma pronta (msg/len preenchidos), 0 se não
+static int pool_peek(pool_t *p, const char **msg, size_t *len) {
+    if (p->cfg->requests > 0) {
+        if (p->generated >= p->cfg->requests) {
+            return 0;
+        }
+        *msg = p->synthetic;
+        *len = p->cfg->request_size;
+        return 1;
+    }
+    if (p->in_start == p->in_len) {
+        return 0;
+    }
+    const char *start = p->in + p->in_start;
+    const char *nl = memchr(start, '\n', p->in_len - p->in_start);
+    if (nl) {
+        *len = (size_t)(nl - start);
+    } else if (!p->in_open && p->in_len > p->in_start) {
+        *len = p->in_len - p->in_start;     // Última linha sem '\n'
+    } else {
+        return 0;
+    }
+    *msg = start;
+    return 1;
+}
+
+static void pool_consume(pool_t *p, size_t len) {
+    if (p->cfg->requests > 0) {
+        p->generated++;
+        return;
+    }
+    p->in_start += len;
+    if (p->in_start < p->in_len) {
+        p->in_start++;                      // '\n'
+    }
+}
+
+// Quadro não pode bloquear o despachante: cabe no que sobra do pipe ou o worker está ocioso
+static int pool_can_accept(const pool_t *p, const pool_worker_t *w, size_t frame) {
+    return w->inflight == 0 ||
+           (w->inflight < p->cfg->depth && w->inflight_bytes + frame <= w->pipe_cap);
+}
+
+static pool_worker_t *pool_pick(pool_t *p, size_t frame) {
+    int n = p->cfg->workers;
+    pool_worker_t *best = NULL;
+
+    if (p->cfg->dispatch == PIPE_POOL_ROUND_ROBIN) {
+        for (int k = 0; k < n; k++) {
+            int i = (p->rr_next + k) % n;
+            if (pool_can_accept(p, &p->workers[i], frame)) {
+                p->rr_next = (i + 1) % n;
+                return &p->workers[i];
+            }
+        }
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        pool_worker_t *w = &p->workers[i];
+        if (pool_can_accept(p, w, frame) && (!best || w->inflight < best->inflight)) {
+            best = w;
+        }
+    }
+    return best;
+}
+
+static int pool_send(pool_t *p, pool_worker_t *w, const char *msg, size_t len) {
+    size_t payload = sizeof(uint64_t) + len;
+    uint64_t id = p->next_id++;
+
+    if (grow(&p->frame, &p->frame_cap, payload + 1) == -1) {
+        return -1;
+    }
+    memcpy(p->frame, &id, sizeof(id));
+    memcpy(p->frame + sizeof(id), msg, len);
+    p->frame[payload] = '\0';
+
+    pool_request_t *slot = &w->fifo[(w->head + w->inflight) % p->cfg->depth];
+    slot->id = id;
+    slot->bytes = IPC_FRAME_HEADER_SIZE + payload;
+    slot->sent_ns = now_ns();
+    if (ipc_write_frame(w->to_worker, p->frame, payload) == -1) {
+        return -1;
+    }
+    w->inflight++;
+    w->inflight_bytes += slot->bytes;
+
+    if (p->cfg->requests == 0) {
+        char status_msg[256];
+        print_json_data("pipes", p->frame + sizeof(id), "pai -> filho", getpid());
+        snprintf(status_msg, sizeof(status_msg), "Requisição %llu despachada ao worker %d (%d em voo).",
+                 (unsigned long long)id, (int)(w - p->workers), w->inflight);
+        print_json_status("pipes", "pool_dispatch", status_msg, getpid());
+    }
+    return 0;
+}
+
+// Lê uma resposta do worker e a casa com a requisição mais antiga em voo
+static int pool_receive(pool_t *p, pool_worker_t *w) {
+    uint32_t len;
+    uint64_t id;
+
+    int rc = ipc_read_frame_header(w->from_worker, &len);
+    if (rc != 1) {
+        if (rc == 0) {
+            errno = EPIPE;              // Worker terminou com requisições em voo
+        }
+        return -1;
+    }
+    if (grow(&p->frame, &p->frame_cap, (size_t)len + 1) == -1 ||
+        ipc_read_all(w->from_worker, p->frame, len) == -1) {
+        return -1;
+    }
+    pool_request_t *slot = &w->fifo[w->head];
+    memcpy(&id, p->frame, sizeof(id));
+    if (w->inflight == 0 || len < sizeof(id) || id != slot->id) {
+        errno = EBADMSG;
+        return -1;
+    }
+    uint64_t latency = now_ns() - slot->sent_ns;
+    p->latency_sum_ns += latency;
+    if (latency > p->latency_max_ns) {
+        p->latency_max_ns = latency;
+    }
+    p->bytes += len - sizeof(id);
+    p->completed++;
+    w->head = (w->head + 1) % p->cfg->depth;
+    w->inflight--;
+    w->inflight_bytes -= slot->bytes;
+    w->served++;
+
+    if (p->cfg->requests == 0) {
+        p->frame[len] = '\0';
+        print_json_data("pipes", p->frame + sizeof(id), "filho -> pai (eco)", w->pid);
+    }
+    return 0;
+}
+
+static int pool_read_input(pool_t *p) {
+    // Descarta as linhas já despachadas antes de crescer o buffer
+    if (p->in_start > 0) {
+        memmove(p->in, p->in + p->in_start, p->in_len - p->in_start);
+        p->in_len -= p->in_start;
+        p->in_start = 0;
+    }
+    if (grow(&p->in, &p->in_cap, p->in_len + POOL_INPUT_CHUNK) == -1) {
+        return -1;
+    }
+    ssize_t n = read(STDIN_FILENO, p->in + p->in_len, POOL_INPUT_CHUNK);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    if (n == 0) {
+        p->in_open = 0;
+    }
+    p->in_len += (size_t)n;
+    return 0;
+}
+
+/**
+ * @brief Laço do despachante: despacha o que couber, espera respostas ou entrada.
+ */
+static int pool_loop(pool_t *p) {
+    struct pollfd fds[PIPE_POOL_MAX_WORKERS + 1];
+    pool_worker_t *owners[PIPE_POOL_MAX_WORKERS + 1];
+
+    for (;;) {
+        const char *msg;
+        size_t len;
+        int ready;
+        while ((ready = pool_peek(p, &msg, &len)) == 1) {
+            if (len > IPC_FRAME_MAX_PAYLOAD - sizeof(uint64_t)) {
+                errno = EMSGSIZE;
+                return -1;
+            }
+            pool_worker_t *w = pool_pick(p, IPC_FRAME_HEADER_SIZE + sizeof(uint64_t) + len);
+            if (!w) {
+                break;
+            }
+            if (pool_send(p, w, msg, len) == -1) {
+                return -1;
+            }
+            pool_consume(p, len);
+        }
+
+        int nfds = 0;
+        if (!ready && p->cfg->requests == 0 && p->in_open) {
+            fds[nfds].fd = STDIN_FILENO;
+            fds[nfds].events = POLLIN;
+            owners[nfds++] = NULL;
+        }
+        for (int i = 0; i < p->cfg->workers; i++) {
+            if (p->workers[i].inflight > 0) {
+                fds[nfds].fd = p->workers[i].from_worker;
+                fds[nfds].events = POLLIN;
+                owners[nfds++] = &p->workers[i];
+            }
+        }
+        if (nfds == 0) {
+            return 0;                       // Entrada esgotada e nada em voo
+        }
+
+        json_output_flush();
+        if (poll(fds, (nfds_t)nfds, -1) == -1) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        for (int k = 0; k < nfds; k++) {
+            if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            if (owners[k] == NULL ? pool_read_input(p) == -1 : pool_receive(p, owners[k]) == -1) {
+                return -1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Linha de base: um fork() e um par de pipes novo por mensagem (sem exec).
+ *
+ * @return Microssegundos por requisição, ou -1 em erro.
+ */
+static double pool_fork_baseline(const pipe_pool_config_t *cfg, const char *payload) {
+    long count = cfg->requests < PIPE_POOL_FORK_BASELINE_MAX ? cfg->requests : PIPE_POOL_FORK_BASELINE_MAX;
+    char *reply = malloc(cfg->request_size + 1);
+    uint64_t start = now_ns();
+
+    if (!reply) {
+        return -1;
+    }
+    for (long i = 0; i < count; i++) {
+        int to_child[2], to_parent[2];
+        size_t len;
+        if (pipe(to_child) == -1) {
+            free(reply);
+            return -1;
+        }
+        if (pipe(to_parent) == -1) {
+            close(to_child[0]);
+            close(to_child[1]);
+            free(reply);
+            return -1;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(to_child[1]);
+            close(to_parent[0]);
+            int ok = ipc_read_frame(to_child[0], reply, cfg->request_size, &len) == 1 &&
+                     ipc_write_frame(to_parent[1], reply, len) == 0;
+            _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        close(to_child[0]);
+        close(to_parent[1]);
+        int ok = pid > 0 && ipc_write_frame(to_child[1], payload, cfg->request_size) == 0 &&
+                 ipc_read_frame(to_parent[0], reply, cfg->request_size, &len) == 1;
+        close(to_child[1]);
+        close(to_parent[0]);
+        if (pid > 0) {
+            waitpid(pid, NULL, 0);
+        }
+        if (!ok) {
+            free(reply);
+            return -1;
+        }
+    }
+    free(reply);
+    return (double)(now_ns() - start) / 1e3 / (double)count;
+}
+
+static void pool_shutdown(pool_t *p) {
+    for (int i = 0; i < p->spawned; i++) {
+        close(p->workers[i].to_worker);
+    }
+    for (int i = 0; i < p->spawned; i++) {
+        close(p->workers[i].from_worker);
+        waitpid(p->workers[i].pid, NULL, 0);
+        free(p->workers[i].fifo);
+    }
+}
+
+int pipe_pool_run(const pipe_pool_config_t *cfg) {
+    pid_t parent_pid = getpid();
+    char status_msg[512], metrics[1024], served[512];
+    double fork_us = 0;
+    pool_t p;
+
+    memset(&p, 0, sizeof(p));
+    p.cfg = cfg;
+    p.in_open = 1;
+    // Worker morto vira EPIPE no despachante em vez de derrubá-lo com SIGPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    if (cfg->requests > 0) {
+        p.synthetic = malloc(cfg->request_size ? cfg->request_size : 1);
+        if (!p.synthetic) {
+            print_json_error("pipes", "Falha ao alocar a carga sintética.", parent_pid);
+            return 1;
+        }
+        memset(p.synthetic, 'r', cfg->request_size);
+        fork_us = pool_fork_baseline(cfg, p.synthetic);
+        if (fork_us < 0) {
+            print_json_error("pipes", "Falha na linha de base fork-por-mensagem.", parent_pid);
+            free(p.synthetic);
+            return 1;
+        }
+    }
+
+    snprintf(status_msg, sizeof(status_msg), "Criando pool de %d workers (até %d requisições em voo cada, despacho %s)...",
+             cfg->workers, cfg->depth, pipe_pool_dispatch_name(cfg->dispatch));
+    print_json_status("pipes", "pool_setup", status_msg, parent_pid);
+    for (int i = 0; i < cfg->workers; i++) {
+        p.workers[i].fifo = calloc((size_t)cfg->depth, sizeof(pool_request_t));
+        if (!p.workers[i].fifo || pool_spawn(&p, i) == -1) {
+            free(p.workers[i].fifo);
+            print_json_error("pipes", "Falha ao criar um worker do pool.", parent_pid);
+            pool_shutdown(&p);
+            free(p.synthetic);
+            return 1;
+        }
+        p.spawned++;
+    }
+    ipc_affinity_apply("pipes", IPC_ROLE_PRODUCER);
+    print_json_status("pipes", "pool_ready",
+                      cfg->requests > 0 ? "Pool pronto; enviando requisições sintéticas."
+                                        : "Pool pronto; cada linha do stdin é uma requisição.", parent_pid);
+
+    uint64_t start = now_ns();
+    int rc = pool_loop(&p);
+    uint64_t elapsed = now_ns() - start;
+    int err = errno;
+    pool_shutdown(&p);
+    free(p.in);
+    free(p.frame);
+    free(p.synthetic);
+    if (rc == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Pool interrompido após %ld requisições: %s", p.completed, strerror(err));
+        print_json_error("pipes", status_msg, parent_pid);
+        return 1;
+    }
+
+    size_t off = 0;
+    for (int i = 0; i < cfg->workers && off < sizeof(served); i++) {
+        off += (size_t)snprintf(served + off, sizeof(served) - off, "%s%ld", i ? "," : "", p.workers[i].served);
+    }
+    double secs = (double)elapsed / 1e9;
+    double us_per_req = p.completed ? (double)elapsed / 1e3 / (double)p.completed : 0.0;
+    int n = snprintf(metrics, sizeof(metrics),
+                     "{\"workers\":%d,\"depth\":%d,\"dispatch\":\"%s\",\"requests\":%ld,\"bytes\":%llu,"
+                     "\"seconds\":%.6f,\"req_per_sec\":%.0f,\"us_per_request\":%.3f,"
+                     "\"mean_latency_us\":%.3f,\"max_latency_us\":%.3f,\"served\":[%s]",
+                     cfg->workers, cfg->depth, pipe_pool_dispatch_name(cfg->dispatch), p.completed,
+                     (unsigned long long)p.bytes, secs, secs > 0 ? (double)p.completed / secs : 0.0, us_per_req,
+                     p.completed ? (double)p.latency_sum_ns / 1e3 / (double)p.completed : 0.0,
+                     (double)p.latency_max_ns / 1e3, served);
+    if (cfg->requests > 0) {
+        n += snprintf(metrics + n, sizeof(metrics) - (size_t)n,
+                      ",\"fork_us_per_request\":%.3f,\"speedup_vs_fork\":%.2f",
+                      fork_us, us_per_req > 0 ? fork_us / us_per_req : 0.0);
+    }
+    snprintf(metrics + n, sizeof(metrics) - (size_t)n, "}");
+    print_json_metrics("pipes", "pool", metrics, parent_pid);
+    print_json_status("pipes", "success", "Pool de pipes encerrado com sucesso.", parent_pid);
+    return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file pipe_pool.h
+ * @brief Pool persistente de workers pré-criados, ligados ao despachante por pipes.
+ *
+ * Em vez de um fork() por mensagem, o pool cria N filhos uma única vez,
+ * cada um com um par de pipes permanente. O despachante lê requisições
+ * (linhas do stdin ou carga sintética), escolhe um worker por rodízio ou
+ * pelo menor número de requisições em voo e mantém várias requisições
+ * em voo por worker. Cada requisição e cada resposta é um quadro de
+ * ipc_io.h cuja carga começa com o id da requisição (u64).
+ */
+
+#ifndef PIPE_POOL_H
+#define PIPE_POOL_H
+
+#include <stddef.h>
+
+// Limites e padrões do pool
+#define PIPE_POOL_MAX_WORKERS 64
+#define PIPE_POOL_DEFAULT_DEPTH 8
+#define PIPE_POOL_MAX_DEPTH 1024
+#define PIPE_POOL_DEFAULT_REQUEST_SIZE 64
+
+// Capacidade pedida aos pipes de cada worker (F_SETPIPE_SZ)
+#define PIPE_POOL_PIPE_SIZE (1024UL * 1024)
+
+// Requisições da linha de base fork-por-mensagem no modo benchmark
+#define PIPE_POOL_FORK_BASELINE_MAX 500
+
+/**
+ * @brief Política de escolha do worker para a próxima requisição.
+ */
+typedef enum {
+    PIPE_POOL_ROUND_ROBIN,      // Próximo worker com espaço, em rodízio
+    PIPE_POOL_LEAST_LOADED      // Worker com menos requisições em voo
+} pipe_pool_dispatch_t;
+
+/**
+ * @brief Configuração de pipe_pool_run().
+ */
+typedef struct {
+    int workers;                    // Número de filhos (1..PIPE_POOL_MAX_WORKERS)
+    int depth;                      // Máximo de requisições em voo por worker
+    pipe_pool_dispatch_t dispatch;
+    long requests;                  // > 0: benchmark com requisições sintéticas; 0: linhas do stdin
+    size_t request_size;            // Carga de cada requisição sintética
+} pipe_pool_config_t;
+
+/**
+ * @brief Cria o pool, atende requisições até o fim da entrada e encerra os workers.
+ *
+ * Com requests == 0 cada linha do stdin é uma requisição e cada eco vira
+ * um evento "data"; o pool termina no EOF do stdin. Com requests > 0 são
+ * enviadas requisições sintéticas sem eventos por requisição, e a linha
+ * "metrics" final inclui a comparação com um fork() por mensagem.
+ *
+ * @param cfg Configuração do pool.
+ * @return 0 em sucesso, 1 em erro (já relatado em JSON).
+ */
+int pipe_pool_run(const pipe_pool_config_t *cfg);
+
+/**
+ * @brief Nome da política ("rr" ou "least").
+ */
+const char *pipe_pool_dispatch_name(pipe_pool_dispatch_t dispatch);
+
+#endif // PIPE_POOL_H
@@ -0,0 +1,285 @@
+#include "shm_broadcast.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+// Marca de slot sendo sobrescrito (só no modo SHM_BCAST_DROP_LAGGING)
+#define SHM_BCAST_WRITING UINT64_MAX
+
+/**
+ * @brief Cabeçalho de cada slot; o payload vem logo em seguida.
+ * 
+ * stamp = sequência + 1 da mensagem contida (0: nunca usado). O escritor grava
+ * o stamp por último, com release, e o leitor o confere antes e depois de ler.
+ */
+typedef struct {
+    uint64_t stamp;
+    uint32_t len;
+    uint32_t reserved;
+} shm_bcast_slot_t;
+
+static shm_bcast_slot_t *slot_at(shm_manager_t *shm_mgr, uint64_t seq) {
+    shm_bcast_header_t *hdr = shm_mgr->bcast;
+    return (shm_bcast_slot_t *)(shm_mgr->bcast_slots + (seq & (hdr->slot_count - 1)) * hdr->slot_stride);
+}
+
+static shm_bcast_reader_t *my_reader(shm_manager_t *shm_mgr) {
+    if (shm_mgr->bcast_reader < 0) {
+        return NULL;
+    }
+    return &shm_mgr->bcast->readers[shm_mgr->bcast_reader];
+}
+
+int shm_bcast_init(shm_manager_t *shm_mgr, size_t slot_size, int flags) {
+    shm_bcast_header_t *hdr = (shm_bcast_header_t *)shm_mgr->data;
+    size_t header_size = (sizeof(shm_bcast_header_t) + SHM_CACHE_LINE - 1) & ~(size_t)(SHM_CACHE_LINE - 1);
+
+    if (shm_mgr->is_creator) {
+        uint64_t stride = (sizeof(shm_bcast_slot_t) + slot_size + SHM_CACHE_LINE - 1) & ~(uint64_t)(SHM_CACHE_LINE - 1);
+        uint64_t slots = 1;
+        if (shm_mgr->data_size <= header_size) {
+            errno = ENOSPC;
+            return -1;
+        }
+        while ((slots * 2) * stride <= shm_mgr->data_size - header_size) {
+            slots *= 2;
+        }
+        if (slots < 2 || slot_size == 0) {
+            errno = ENOSPC;
+            return -1;
+        }
+
+        memset(hdr, 0, sizeof(*hdr));
+        hdr->flags = (uint32_t)flags;
+        hdr->slot_count = slots;
+        hdr->slot_size = slot_size;
+        hdr->slot_stride = stride;
+        memset((char *)shm_mgr->data + header_size, 0, slots * stride);
+        __atomic_store_n(&hdr->magic, SHM_BCAST_MAGIC, __ATOMIC_RELEASE);
+    } else if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHM_BCAST_MAGIC) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    shm_mgr->bcast = hdr;
+    shm_mgr->bcast_slots = (unsigned char *)shm_mgr->data + header_size;
+    shm_mgr->bcast_reader = -1;
+    shm_mgr->bcast_cached_min = 0;
+    shm_mgr->bcast_cached_write = 0;
+    return 0;
+}
+
+int shm_bcast_join(shm_manager_t *shm_mgr) {
+    shm_bcast_header_t *hdr = shm_mgr->bcast;
+
+    for (int i = 0; i < SHM_BCAST_MAX_READERS; i++) {
+        shm_bcast_reader_t *reader = &hdr->readers[i];
+        uint32_t expected = SHM_BCAST_READER_FREE;
+        uint32_t state = __atomic_load_n(&reader->state, __ATOMIC_RELAXED);
+        if (state == SHM_BCAST_READER_DROPPED) {
+            expected = SHM_BCAST_READER_DROPPED;  // Cursor de leitor desligado pode ser reaproveitado
+        } else if (state != SHM_BCAST_READER_FREE) {
+            continue;
+        }
+        if (__atomic_compare_exchange_n(&reader->state, &expected, SHM_BCAST_READER_ACTIVE, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            // Entra no fim atual do stream. Se o escritor andar uma volta antes
+            // de enxergar este cursor, a leitura detecta pelo stamp e ressincroniza.
+            uint64_t start = __atomic_load_n(&hdr->write_seq, __ATOMIC_SEQ_CST);
+            __atomic_store_n(&reader->pid, (uint32_t)getpid(), __ATOMIC_RELAXED);
+            __atomic_store_n(&reader->cursor, start, __ATOMIC_SEQ_CST);
+            shm_mgr->bcast_reader = i;
+            shm_mgr->bcast_cached_write = start;
+            return 0;
+        }
+    }
+    errno = EBUSY;
+    return -1;
+}
+
+void shm_bcast_leave(shm_manager_t *shm_mgr) {
+    shm_bcast_reader_t *reader = my_reader(shm_mgr);
+    if (reader) {
+        __atomic_store_n(&reader->state, SHM_BCAST_READER_FREE, __ATOMIC_RELEASE);
+        shm_mgr->bcast_reader = -1;
+    }
+}
+
+// Percorre os cursores; no modo drop desliga quem ficaria uma volta para trás
+static uint64_t scan_readers(shm_manager_t *shm_mgr, uint64_t seq, int drop) {
+    shm_bcast_header_t *hdr = shm_mgr->bcast;
+    uint64_t min = seq;
+
+    for (int i = 0; i < SHM_BCAST_MAX_READERS; i++) {
+        shm_bcast_reader_t *reader = &hdr->readers[i];
+        if (__atomic_load_n(&reader->state, __ATOMIC_ACQUIRE) != SHM_BCAST_READER_ACTIVE) {
+            continue;
+        }
+        uint64_t cursor = __atomic_load_n(&reader->cursor, __ATOMIC_ACQUIRE);
+        if (drop && seq - cursor >= hdr->slot_count) {
+            uint32_t expected = SHM_BCAST_READER_ACTIVE;
+            if (__atomic_compare_exchange_n(&reader->state, &expected, SHM_BCAST_READER_DROPPED, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+                __atomic_add_fetch(&hdr->dropped_readers, 1, __ATOMIC_RELAXED);
+            }
+            continue;
+        }
+        if (cursor < min) {
+            min = cursor;
+        }
+    }
+    return min;
+}
+
+uint64_t shm_bcast_slowest(shm_manager_t *shm_mgr) {
+    return scan_readers(shm_mgr, __atomic_load_n(&shm_mgr->bcast->write_seq, __ATOMIC_ACQUIRE), 0);
+}
+
+int shm_bcast_write(shm_manager_t *shm_mgr, const void *data, size_t len) {
+    shm_bcast_header_t *hdr = shm_mgr->bcast;
+    int drop = (hdr->flags & SHM_BCAST_DROP_LAGGING) != 0;
+
+    if (len > hdr->slot_size) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    uint64_t seq = __atomic_load_n(&hdr->write_seq, __ATOMIC_RELAXED);
+
+    // Só percorre os cursores quando o mínimo em cache indica ring cheio
+    if (seq - shm_mgr->bcast_cached_min >= hdr->slot_count) {
+        shm_mgr->bcast_cached_min = scan_readers(shm_mgr, seq, drop);
+        if (seq - shm_mgr->bcast_cached_min >= hdr->slot_count) {
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+
+    shm_bcast_slot_t *slot = slot_at(shm_mgr, seq);
+    if (drop) {
+        // Leitores atrasados podem estar lendo este slot: marca a sobrescrita
+        __atomic_store_n(&slot->stamp, SHM_BCAST_WRITING, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+    slot->len = (uint32_t)len;
+    memcpy(slot + 1, data, len);
+    __atomic_store_n(&slot->stamp, seq + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&hdr->write_seq, seq + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void mark_dropped(shm_bcast_reader_t *reader) {
+    uint32_t expected = SHM_BCAST_READER_ACTIVE;
+    __atomic_compare_exchange_n(&reader->state, &expected, SHM_BCAST_READER_DROPPED, 0,
+                                __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+// Localiza o próximo slot íntegro deste leitor; NULL com errno em caso de erro
+static shm_bcast_slot_t *next_slot(shm_manager_t *shm_mgr, shm_bcast_reader_t *reader, uint64_t *cursor_out) {
+    shm_bcast_header_t *hdr = shm_mgr->bcast;
+
+    for (;;) {
+        if (__atomic_load_n(&reader->state, __ATOMIC_ACQUIRE) != SHM_BCAST_READER_ACTIVE) {
+            errno = EPIPE;
+            return NULL;
+        }
+
+        uint64_t cursor = __atomic_load_n(&reader->cursor, __ATOMIC_RELAXED);
+        if (cursor == shm_mgr->bcast_cached_write) {
+            shm_mgr->bcast_cached_write = __atomic_load_n(&hdr->write_seq, __ATOMIC_ACQUIRE);
+            if (cursor == shm_mgr->bcast_cached_write) {
+                errno = EAGAIN;
+                return NULL;
+            }
+        }
+
+        shm_bcast_slot_t *slot = slot_at(shm_mgr, cursor);
+        if (__atomic_load_n(&slot->stamp, __ATOMIC_ACQUIRE) == cursor + 1) {
+            *cursor_out = cursor;
+            return slot;
+        }
+
+        // O slot já foi sobrescrito: este leitor ficou uma volta para trás
+        if (hdr->flags & SHM_BCAST_DROP_LAGGING) {
+            mark_dropped(reader);
+            errno = EPIPE;
+            return NULL;
+        }
+        // Sem o modo drop isso só acontece na corrida do join: ressincroniza
+        __atomic_store_n(&reader->cursor, __atomic_load_n(&hdr->write_seq, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    }
+}
+
+// Confere, depois de ler o payload, se o escritor não reaproveitou o slot
+static int slot_still_valid(shm_bcast_slot_t *slot, uint64_t cursor) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&slot->stamp, __ATOMIC_RELAXED) == cursor + 1;
+}
+
+ssize_t shm_bcast_read(shm_manager_t *shm_mgr, void *buffer, size_t size) {
+    shm_bcast_reader_t *reader = my_reader(shm_mgr);
+    uint64_t cursor;
+
+    if (!reader) {
+        errno = EINVAL;
+        return -1;
+    }
+    shm_bcast_slot_t *slot = next_slot(shm_mgr, reader, &cursor);
+    if (!slot) {
+        return -1;
+    }
+
+    uint32_t len = slot->len;
+    if (len > size || len > shm_mgr->bcast->slot_size) {
+        // No modo drop um comprimento absurdo pode vir de uma sobrescrita em curso
+        if (!slot_still_valid(slot, cursor)) {
+            mark_dropped(reader);
+            errno = EPIPE;
+            return -1;
+        }
+        errno = EMSGSIZE;
+        return -1;
+    }
+    memcpy(buffer, slot + 1, len);
+    if (!slot_still_valid(slot, cursor)) {
+        mark_dropped(reader);
+        errno = EPIPE;
+        return -1;
+    }
+
+    __atomic_store_n(&reader->cursor, cursor + 1, __ATOMIC_RELEASE);
+    return (ssize_t)len;
+}
+
+const void *shm_bcast_peek(shm_manager_t *shm_mgr, size_t *len) {
+    shm_bcast_reader_t *reader = my_reader(shm_mgr);
+    uint64_t cursor;
+
+    if (!reader) {
+        errno = EINVAL;
+        return NULL;
+    }
+    shm_bcast_slot_t *slot = next_slot(shm_mgr, reader, &cursor);
+    if (!slot) {
+        return NULL;
+    }
+    *len = slot->len <= shm_mgr->bcast->slot_size ? slot->len : shm_mgr->bcast->slot_size;
+    return slot + 1;
+}
+
+int shm_bcast_consume(shm_manager_t *shm_mgr) {
+    shm_bcast_reader_t *reader = my_reader(shm_mgr);
+    if (!reader) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    uint64_t cursor = __atomic_load_n(&reader->cursor, __ATOMIC_RELAXED);
+    if (!slot_still_valid(slot_at(shm_mgr, cursor), cursor)) {
+        mark_dropped(reader);
+        errno = EPIPE;
+        return -1;
+    }
+    __atomic_store_n(&reader->cursor, cursor + 1, __ATOMIC_RELEASE);
+    return 0;
+}
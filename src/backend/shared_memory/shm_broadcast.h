@@ -0,0 +1,132 @@
+/**
+ * @file shm_broadcast.h
+ * @brief Canal broadcast (um escritor, vários leitores) sobre memória compartilhada
+ * 
+ * O escritor grava cada mensagem uma única vez em um ring de slots de tamanho
+ * fixo; cada leitor mantém seu próprio cursor, em uma linha de cache
+ * exclusiva, e lê os mesmos slots. O custo do escritor não cresce com o
+ * número de leitores: ele só percorre os cursores quando o ring parece cheio,
+ * para descobrir o leitor mais lento (backpressure).
+ * 
+ * Com SHM_BCAST_DROP_LAGGING o escritor nunca espera: leitores que ficaram
+ * uma volta inteira para trás são desligados do canal e recebem EPIPE.
+ */
+
+#ifndef SHM_BROADCAST_H
+#define SHM_BROADCAST_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "shm_handler.h"
+
+// Identifica um segmento já formatado como broadcast
+#define SHM_BCAST_MAGIC 0x42434153u
+
+// Número máximo de leitores simultâneos por canal
+#define SHM_BCAST_MAX_READERS 64
+
+// Flags de shm_bcast_init()
+#define SHM_BCAST_DROP_LAGGING 0x01  // Desliga leitores atrasados em vez de bloquear o escritor
+
+// Estados do cursor de um leitor
+#define SHM_BCAST_READER_FREE    0
+#define SHM_BCAST_READER_ACTIVE  1
+#define SHM_BCAST_READER_DROPPED 2
+
+/**
+ * @brief Cursor de um leitor, sozinho em uma linha de cache.
+ */
+typedef struct {
+    uint64_t cursor;        // Próxima sequência a ser lida
+    uint32_t state;         // SHM_BCAST_READER_*
+    uint32_t pid;           // Processo dono do cursor
+    char pad[SHM_CACHE_LINE - 16];
+} shm_bcast_reader_t;
+
+/**
+ * @brief Cabeçalho do canal, gravado no início da área de dados.
+ */
+typedef struct shm_bcast_header {
+    uint32_t magic;             // SHM_BCAST_MAGIC após a formatação
+    uint32_t flags;             // SHM_BCAST_*
+    uint64_t slot_count;        // Número de slots (potência de 2)
+    uint64_t slot_size;         // Payload máximo de cada slot
+    uint64_t slot_stride;       // Distância entre slots (alinhada à linha de cache)
+    uint64_t dropped_readers;   // Total de leitores desligados por atraso
+    char pad0[SHM_CACHE_LINE - 40];
+    uint64_t write_seq;         // Próxima sequência a publicar (só o escritor grava)
+    char pad1[SHM_CACHE_LINE - 8];
+    shm_bcast_reader_t readers[SHM_BCAST_MAX_READERS];
+} shm_bcast_header_t;
+
+/**
+ * @brief Formata (criador) ou valida (demais) o canal broadcast no segmento.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador (já inicializada).
+ * @param slot_size Payload máximo por mensagem (ignorado se não for o criador).
+ * @param flags SHM_BCAST_DROP_LAGGING ou 0 (ignorado se não for o criador).
+ * @return 0 em sucesso, -1 em erro (ENOSPC: menos de 2 slots cabem no
+ *         segmento, EAGAIN: canal ainda não formatado).
+ */
+int shm_bcast_init(shm_manager_t *shm_mgr, size_t slot_size, int flags);
+
+/**
+ * @brief Registra este processo como leitor.
+ * 
+ * O leitor começa no fim atual do stream: recebe apenas mensagens publicadas
+ * depois do join.
+ * 
+ * @return 0 em sucesso, -1 com errno = EBUSY se todos os cursores estão em uso.
+ */
+int shm_bcast_join(shm_manager_t *shm_mgr);
+
+/**
+ * @brief Libera o cursor deste leitor.
+ */
+void shm_bcast_leave(shm_manager_t *shm_mgr);
+
+/**
+ * @brief Publica uma mensagem para todos os leitores (somente o escritor).
+ * 
+ * @return 0 em sucesso, -1 em erro (EAGAIN: o leitor mais lento ainda não
+ *         liberou o slot, EMSGSIZE: mensagem maior que o slot).
+ */
+int shm_bcast_write(shm_manager_t *shm_mgr, const void *data, size_t len);
+
+/**
+ * @brief Copia a próxima mensagem deste leitor.
+ * 
+ * @return Tamanho da mensagem, ou -1 em erro (EAGAIN: nada novo, EMSGSIZE:
+ *         buffer pequeno, EPIPE: leitor desligado por atraso).
+ */
+ssize_t shm_bcast_read(shm_manager_t *shm_mgr, void *buffer, size_t size);
+
+/**
+ * @brief Acessa a próxima mensagem no lugar, sem copiar.
+ * 
+ * O ponteiro vale até shm_bcast_consume(). Sem SHM_BCAST_DROP_LAGGING o slot
+ * não pode ser sobrescrito enquanto isso; com a flag, shm_bcast_consume()
+ * informa se o conteúdo foi sobrescrito durante a leitura.
+ * 
+ * @param len Recebe o tamanho da mensagem.
+ * @return Ponteiro para o payload, ou NULL em erro (EAGAIN ou EPIPE).
+ */
+const void *shm_bcast_peek(shm_manager_t *shm_mgr, size_t *len);
+
+/**
+ * @brief Avança o cursor após shm_bcast_peek().
+ * 
+ * @return 0 se a mensagem lida no lugar era íntegra, -1 com errno = EPIPE
+ *         se o leitor foi ultrapassado pelo escritor durante a leitura.
+ */
+int shm_bcast_consume(shm_manager_t *shm_mgr);
+
+/**
+ * @brief Menor cursor entre os leitores ativos (o leitor mais lento).
+ * 
+ * @return Sequência do leitor mais lento, ou a sequência de escrita se não
+ *         houver leitores ativos.
+ */
+uint64_t shm_bcast_slowest(shm_manager_t *shm_mgr);
+
+#endif // SHM_BROADCAST_H
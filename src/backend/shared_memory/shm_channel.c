@@ -0,0 +1,279 @@
+#define _GNU_SOURCE
+#include "../common/ipc_channel.h"
+#include "../common/affinity.h"
+#include "shm_handler.h"
+#include "shm_ring.h"
+#include "shm_futex.h"
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// Transporte "shm" de ipc_channel.h: shm[0] é o ring do lado 0 ao 1, shm[1] o do lado 1 ao 0.
+//
+// Cada registro do ring é uma mensagem. Uma mensagem de tamanho >= max
+// (shm_ring_max_payload()) vai em fatias de exatamente max bytes seguidas de
+// uma fatia final menor (possivelmente vazia): registro de tamanho max quer
+// dizer "continua", sem cabeçalho extra nas mensagens pequenas.
+//
+// O leitor com o ring vazio cede a CPU algumas vezes e depois dorme no futex
+// do segmento, para um canal ocioso (ex: no ipc_daemon) não consumir CPU.
+//
+// No attach cada lado vira o dono (shm_acquire_owner()) do ring em que
+// escreve. A cada fatia de espera sem dados o leitor confere se o dono do
+// ring ainda vive: um escritor que morreu sem fechar o canal conta como fim
+// do canal, em vez de deixar o outro lado esperando para sempre.
+
+// sched_yield() antes de dormir na campainha
+#define SHM_CHANNEL_YIELDS 64
+
+// Distingue os canais de um mesmo processo nos nomes dos segmentos
+static unsigned channel_serial;
+
+// O semáforo do segmento não é usado pelo canal: futex_sem.count vira um
+// contador de eventos (a campainha) e futex_sem.waiters diz se o leitor
+// está dormindo ou prestes a dormir.
+static shm_futex_sem_t *doorbell(shm_manager_t *ring) {
+    return &((shm_segment_header_t *)ring->ptr)->futex_sem;
+}
+
+// Depois de publicar: o FUTEX_WAKE só acontece com o leitor estacionado
+static void doorbell_ring(shm_manager_t *ring) {
+    shm_futex_sem_t *bell = doorbell(ring);
+    // Pareia com o incremento de waiters em doorbell_wait(): ou o escritor vê
+    // o leitor, ou o leitor vê o registro antes de dormir
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&bell->waiters, __ATOMIC_SEQ_CST) > 0) {
+        __atomic_add_fetch(&bell->count, 1, __ATOMIC_SEQ_CST);
+        shm_futex_wake(&bell->count, INT_MAX);
+    }
+}
+
+// Dono registrado e morto (owner_pid 0: o outro lado ainda não fez o attach)
+static int writer_gone(shm_manager_t *ring) {
+    shm_segment_header_t *hdr = (shm_segment_header_t *)ring->ptr;
+    return __atomic_load_n(&hdr->owner_pid, __ATOMIC_ACQUIRE) != 0 && !shm_owner_alive(ring);
+}
+
+/**
+ * @brief Espera o ring ficar legível: cede a CPU e depois dorme em fatias de SHM_LIVENESS_POLL_MS.
+ *
+ * @return 0 para tentar ler de novo, -1 se o ring continua vazio e o escritor morreu.
+ */
+static int ring_wait(shm_manager_t *ring, int *idle) {
+    if ((*idle)++ < SHM_CHANNEL_YIELDS) {
+        sched_yield();
+        return 0;
+    }
+    shm_futex_sem_t *bell = doorbell(ring);
+    __atomic_add_fetch(&bell->waiters, 1, __ATOMIC_SEQ_CST);
+    uint32_t seen = __atomic_load_n(&bell->count, __ATOMIC_SEQ_CST);
+    if (!shm_ring_readable(ring)) {
+        struct timespec slice = { 0, SHM_LIVENESS_POLL_MS * 1000000L };
+        shm_futex_wait_timeout(&bell->count, seen, &slice);
+    }
+    __atomic_sub_fetch(&bell->waiters, 1, __ATOMIC_SEQ_CST);
+    // Um último registro pode ter sido publicado antes da morte: só desiste com o ring vazio
+    return !shm_ring_readable(ring) && writer_gone(ring) ? -1 : 0;
+}
+
+static int ring_open(shm_manager_t **out, size_t capacity, char dir) {
+    char name[SHM_NAME_MAX];
+    shm_manager_t *mgr = calloc(1, sizeof(*mgr));
+
+    if (!mgr) {
+        return -1;
+    }
+    snprintf(name, sizeof(name), "/ipc_channel_%d_%u_%c", (int)getpid(),
+             __atomic_fetch_add(&channel_serial, 1, __ATOMIC_RELAXED), dir);
+    if (init_shm_ex(mgr, name, capacity + sizeof(shm_ring_header_t), SHM_F_CREATE | SHM_F_REPLACE | SHM_F_POPULATE) == -1) {
+        free(mgr);
+        return -1;
+    }
+    if (shm_ring_init(mgr) == -1 || ipc_numa_bind_from_env("channel", mgr->ptr, mgr->size) == -1) {
+        cleanup_shm(mgr);
+        free(mgr);
+        return -1;
+    }
+    // Os dois lados herdam o mapeamento pelo fork(): os nomes saem já, e nada sobra se um processo morrer
+    shm_unlink(mgr->name);
+    sem_unlink(mgr->sem_name);
+    mgr->is_creator = 0;
+    *out = mgr;
+    return 0;
+}
+
+static void ring_free(void *ring) {
+    if (ring) {
+        cleanup_shm(ring);
+        free(ring);
+    }
+}
+
+static int shm_channel_open(ipc_channel_t *ch, const ipc_channel_config_t *cfg) {
+    shm_manager_t *a, *b;
+
+    if (ring_open(&a, cfg->capacity, 'a') == -1) {
+        return -1;
+    }
+    if (ring_open(&b, cfg->capacity, 'b') == -1) {
+        ring_free(a);
+        return -1;
+    }
+    ch->shm[0] = a;
+    ch->shm[1] = b;
+    return 0;
+}
+
+static void shm_channel_attach(ipc_channel_t *ch, int side) {
+    // Os dois rings continuam mapeados: o do outro sentido é lido por este
+    // lado, que confere a vida do dono do ring enquanto espera por ele
+    shm_acquire_owner(ch->shm[side]);
+}
+
+static int shm_channel_send(ipc_channel_t *ch, const void *buf, size_t len) {
+    shm_manager_t *out = ch->shm[ch->side], *in = ch->shm[1 - ch->side];
+    size_t max = shm_ring_max_payload(out);
+    const char *p = buf;
+    unsigned full = 0;
+
+    for (;;) {
+        size_t chunk = len < max ? len : max;
+        while (shm_ring_write(out, p, chunk) == -1) {
+            if (errno != EAGAIN) {
+                return -1;
+            }
+            // Ring cheio e o outro lado já fechou o canal (ou morreu): ninguém vai consumir
+            if (__atomic_load_n(&in->ring->closed, __ATOMIC_ACQUIRE) ||
+                (++full % SHM_CHANNEL_YIELDS == 0 && writer_gone(in))) {
+                errno = EPIPE;
+                return -1;
+            }
+            sched_yield();
+        }
+        doorbell_ring(out);
+        p += chunk;
+        len -= chunk;
+        if (chunk < max) {
+            return 0;
+        }
+    }
+}
+
+/**
+ * @brief Lê fatias até a mensagem terminar; got bytes já estão em buf.
+ *
+ * @param wait 0 para desistir se a primeira fatia ainda não chegou (EAGAIN) ou não cabe (EMSGSIZE);
+ *             nesse modo só aceita mensagens de fatia única, pois o tamanho total das outras
+ *             só se conhece depois de consumi-las.
+ * @return 1 com a mensagem, 0 no fim do canal (antes da primeira fatia), -1 em erro.
+ */
+static int ring_recv(shm_manager_t *in, char *buf, size_t cap, size_t *len, int wait) {
+    size_t max = shm_ring_max_payload(in), got = 0;
+    int first = 1, idle = 0;
+
+    for (;;) {
+        // Sem espera, uma fatia cheia (mensagem de várias fatias) dá EMSGSIZE e fica no ring
+        size_t room = (!wait && cap >= max) ? max - 1 : cap - got;
+        ssize_t n = shm_ring_read(in, buf + got, room);
+        if (n < 0 && errno == EAGAIN) {
+            if (first && !wait) {
+                return -1;
+            }
+            // Fim do canal: fechado e vazio, ou o escritor morreu sem fechá-lo
+            if (shm_ring_drained(in) || ring_wait(in, &idle) == -1) {
+                if (first) {
+                    return 0;
+                }
+                errno = EPIPE;
+                return -1;
+            }
+            continue;
+        }
+        if (n < 0 && first && !wait) {
+            // EMSGSIZE sem nada lido: o registro continua no ring para o próximo recv
+            return -1;
+        }
+        if (n < 0) {
+            // EMSGSIZE: descarta o resto da mensagem para o próximo recv começar nela
+            char *scratch = malloc(max);
+            while (scratch) {
+                ssize_t skipped = shm_ring_read(in, scratch, max);
+                if (skipped >= 0 && (size_t)skipped < max) {
+                    break;
+                }
+                if (skipped < 0 && (errno != EAGAIN || shm_ring_drained(in))) {
+                    break;
+                }
+                if (skipped < 0 && ring_wait(in, &idle) == -1) {
+                    break;
+                }
+            }
+            free(scratch);
+            errno = EMSGSIZE;
+            return -1;
+        }
+        first = 0;
+        idle = 0;
+        got += (size_t)n;
+        if ((size_t)n < max) {
+            *len = got;
+            return 1;
+        }
+    }
+}
+
+static int shm_channel_recv(ipc_channel_t *ch, void *buf, size_t cap, size_t *len) {
+    return ring_recv(ch->shm[1 - ch->side], buf, cap, len, 1);
+}
+
+static int shm_channel_recv_batch(ipc_channel_t *ch, ipc_channel_msg_t *msgs, int count) {
+    shm_manager_t *in = ch->shm[1 - ch->side];
+    int rc = ring_recv(in, msgs[0].buf, msgs[0].cap, &msgs[0].len, 1);
+    if (rc <= 0) {
+        return rc;
+    }
+    // As seguintes só se já tiverem chegado inteiras numa fatia; as demais ficam no ring
+    int got = 1;
+    while (got < count) {
+        rc = ring_recv(in, msgs[got].buf, msgs[got].cap, &msgs[got].len, 0);
+        if (rc == 1) {
+            got++;
+            continue;
+        }
+        // EAGAIN: nada mais chegou; EMSGSIZE: a próxima não foi consumida e o próximo recv a trata
+        if (rc == -1 && errno != EAGAIN && errno != EMSGSIZE) {
+            return -1;
+        }
+        break;
+    }
+    return got;
+}
+
+static void shm_channel_close(ipc_channel_t *ch) {
+    if (ch->side != -1 && ch->shm[ch->side]) {
+        shm_ring_close(ch->shm[ch->side]);
+        doorbell_ring(ch->shm[ch->side]);
+        // O mutex robusto do dono não pode ficar travado num mapeamento desfeito
+        shm_release_owner(ch->shm[ch->side]);
+    }
+    ring_free(ch->shm[0]);
+    ring_free(ch->shm[1]);
+    ch->shm[0] = ch->shm[1] = NULL;
+}
+
+const ipc_channel_ops_t ipc_channel_shm_ops = {
+    "shm",
+    shm_channel_open,
+    shm_channel_attach,
+    shm_channel_send,
+    shm_channel_recv,
+    NULL,                       // Sem syscall por mensagem: send um a um já é o lote
+    shm_channel_recv_batch,
+    shm_channel_close,
+};
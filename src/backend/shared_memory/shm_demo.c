@@ -3,9 +3,856 @@
 #include <string.h>
 #include <unistd.h>
 #include <sys/wait.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
 #include <sys/mman.h>
 #include "../common/json_output.h"
+#include "../common/affinity.h"
 #include "shm_handler.h"
+#include "shm_ring.h"
+#include "shm_slab.h"
+#include "shm_broadcast.h"
+#include "shm_snapshot.h"
+
+// Palavras do valor publicado no modo --snapshot (todas iguais = leitura íntegra)
+#define SNAP_WORDS 8
+
+/**
+ * @brief Resultado de um leitor do benchmark --snapshot (memória anônima compartilhada).
+ */
+typedef struct {
+    uint64_t reads;         // Leituras completas
+    uint64_t inconsistent;  // Valores com palavras diferentes (não deveria acontecer)
+    char pad[SHM_CACHE_LINE - 16];
+} snap_result_t;
+
+// Espera máxima do consumidor do modo --recover por um sinal do produtor
+#define RECOVER_WAIT_MS 5000
+
+/**
+ * @brief Registro publicado no ring do modo --recover.
+ */
+typedef struct {
+    uint64_t epoch;         // Época do produtor que escreveu o registro
+    uint64_t seq;           // Sequência global (continua após o reinício)
+} recover_record_t;
+
+// Blocos do slab em circulação no modo --zerocopy (frames "em voo")
+#define ZC_BLOCKS 8
+
+/**
+ * @brief Registro publicado no ring do modo --zerocopy: só o handle do frame.
+ */
+typedef struct {
+    shm_handle_t handle;    // Bloco no segmento do slab
+    uint64_t length;        // Bytes válidos no bloco
+    uint64_t seq;           // Número do frame
+} zc_record_t;
+
+/**
+ * @brief Opções de linha de comando que escolhem o canal de SHM usado.
+ */
+typedef struct {
+    const char *name;   // NULL: canal padrão de init_shm()
+    size_t size;        // Bytes de dados do segmento (com --name)
+    int flags;          // SHM_F_POPULATE / SHM_F_HUGETLB / SHM_F_MLOCK
+    int sync_mode;      // SHM_SYNC_SEM ou SHM_SYNC_FUTEX
+} shm_demo_opts_t;
+
+// Vincula um segmento recém-criado ao nó de IPC_NUMA_NODE (se definido)
+static int bind_channel(shm_manager_t *shm_mgr) {
+    if (ipc_numa_bind_from_env("shm", shm_mgr->ptr, shm_mgr->size) == -1) {
+        cleanup_shm(shm_mgr);
+        return -1;
+    }
+    return 0;
+}
+
+// Cria (pai) ou anexa (filho) o canal descrito pelas opções
+static int open_channel(shm_manager_t *shm_mgr, const shm_demo_opts_t *opts, int create) {
+    int rc;
+    if (!opts->name) {
+        rc = init_shm(shm_mgr, create);
+    } else {
+        rc = init_shm_ex(shm_mgr, opts->name, create ? opts->size : 0,
+                         opts->flags | (create ? SHM_F_CREATE : 0));
+    }
+    if (rc == 0 && create) {
+        rc = bind_channel(shm_mgr);
+    }
+    return rc;
+}
+
+// Descreve o canal criado (nome, tamanho e recursos de memória efetivos)
+static void describe_channel(const shm_manager_t *shm_mgr, char *out, size_t size) {
+    snprintf(out, size, "SHM ('%s') com %zu bytes%s%s%s%s, sincronização via %s.",
+             shm_mgr->name, shm_mgr->size,
+             (shm_mgr->flags & SHM_F_POPULATE) ? ", MAP_POPULATE" : "",
+             (shm_mgr->flags & SHM_F_HUGETLB) ? ", hugetlbfs" : "",
+             (shm_mgr->flags & SHM_F_THP) ? ", THP (madvise)" : "",
+             (shm_mgr->flags & SHM_F_MLOCK) ? ", mlock" : "",
+             ((shm_segment_header_t *)shm_mgr->ptr)->sync_mode == SHM_SYNC_FUTEX ?
+                 "semáforo futex interno" : shm_mgr->sem_name);
+}
+
+static double elapsed_seconds(const struct timespec *start, const struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) + (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * @brief Modo --stream: envia N mensagens pelo ring SPSC e mede mensagens/s.
+ *
+ * O pai (produtor) publica as mensagens; o filho (consumidor) as consome na
+ * mesma ordem. Com SHM_SYNC_SEM o lado que não pode avançar apenas cede a CPU
+ * (sched_yield) e tenta de novo; com SHM_SYNC_FUTEX cada mensagem é
+ * sinalizada pelo semáforo futex do segmento, que só entra no kernel quando
+ * o consumidor realmente dormiu.
+ */
+static int run_stream(long count, const char *message, const shm_demo_opts_t *opts) {
+    shm_manager_t shm_mgr;
+    char status_msg[512];
+    size_t msg_len = strlen(message);
+
+    print_json_status("shm", "stream_setup", "Pai criando SHM em modo ring...", getpid());
+    int sync_mode = opts->sync_mode;
+    if (open_channel(&shm_mgr, opts, 1) == -1) {
+        print_json_error("shm", "Pai falhou ao inicializar o ring na SHM", getpid());
+        return EXIT_FAILURE;
+    }
+    if (shm_set_sync_mode(&shm_mgr, sync_mode) == -1 || shm_ring_init(&shm_mgr) == -1) {
+        print_json_error("shm", "Pai falhou ao inicializar o ring na SHM", getpid());
+        cleanup_shm(&shm_mgr);
+        return EXIT_FAILURE;
+    }
+    describe_channel(&shm_mgr, status_msg, sizeof(status_msg));
+    print_json_status("shm", "setup_complete", status_msg, getpid());
+    if (msg_len > shm_ring_max_payload(&shm_mgr)) {
+        snprintf(status_msg, sizeof(status_msg), "Mensagem maior que o registro máximo do ring (%zu bytes)",
+                 shm_ring_max_payload(&shm_mgr));
+        print_json_error("shm", status_msg, getpid());
+        cleanup_shm(&shm_mgr);
+        return EXIT_FAILURE;
+    }
+    snprintf(status_msg, sizeof(status_msg), "Ring pronto: %llu bytes de dados, %ld mensagens de %zu bytes.",
+             (unsigned long long)shm_mgr.ring->capacity, count, msg_len);
+    print_json_status("shm", "stream_ready", status_msg, getpid());
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        print_json_error("shm", "Falha no fork()", getpid());
+        cleanup_shm(&shm_mgr);
+        return EXIT_FAILURE;
+    }
+
+    if (pid == 0) {
+        // --- Consumidor ---
+        pid_t child_pid = getpid();
+        shm_manager_t child_shm_mgr;
+        char *buffer = malloc(msg_len + 1);
+        ipc_affinity_apply("shm", IPC_ROLE_CONSUMER);
+        struct timespec start, end;
+        long received = 0, corrupted = 0;
+
+        if (!buffer || open_channel(&child_shm_mgr, opts, 0) == -1) {
+            print_json_error("shm", "Filho falhou ao se conectar ao ring", child_pid);
+            exit(EXIT_FAILURE);
+        }
+        if (shm_ring_init(&child_shm_mgr) == -1) {
+            print_json_error("shm", "Filho falhou ao se conectar ao ring", child_pid);
+            cleanup_shm(&child_shm_mgr);
+            exit(EXIT_FAILURE);
+        }
+        print_json_status("shm", "stream_consumer_start", "Filho consumindo mensagens do ring...", child_pid);
+
+        long idle = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (received < count) {
+            if (sync_mode == SHM_SYNC_FUTEX && shm_sem_wait_robust(&child_shm_mgr, -1) == -1) {
+                print_json_error("shm", errno == EOWNERDEAD ? "Produtor terminou antes de enviar todas as mensagens"
+                                                            : "Filho falhou na espera do semáforo futex", child_pid);
+                break;
+            }
+            ssize_t n = shm_ring_read(&child_shm_mgr, buffer, msg_len + 1);
+            if (n < 0) {
+                if (errno == EAGAIN) {
+                    // Ring vazio: de tempos em tempos confere se o produtor ainda existe
+                    if (++idle % 4096 == 0 && !shm_owner_alive(&child_shm_mgr) &&
+                        shm_ring_read(&child_shm_mgr, buffer, msg_len + 1) == -1) {
+                        print_json_error("shm", "Produtor terminou antes de enviar todas as mensagens", child_pid);
+                        break;
+                    }
+                    sched_yield();
+                    continue;
+                }
+                print_json_error("shm", "Filho falhou ao ler do ring", child_pid);
+                break;
+            }
+            if ((size_t)n != msg_len || memcmp(buffer, message, msg_len) != 0) {
+                corrupted++;
+            }
+            received++;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double secs = elapsed_seconds(&start, &end);
+        snprintf(status_msg, sizeof(status_msg),
+                 "Filho recebeu %ld mensagens (%ld corrompidas) em %.6f s: %.0f msg/s, %.2f MB/s",
+                 received, corrupted, secs, secs > 0 ? received / secs : 0.0,
+                 secs > 0 ? (double)received * msg_len / secs / 1e6 : 0.0);
+        print_json_status("shm", "stream_result", status_msg, child_pid);
+
+        cleanup_shm(&child_shm_mgr);
+        free(buffer);
+        exit(received == count && corrupted == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    // --- Produtor ---
+    pid_t parent_pid = getpid();
+    struct timespec start, end;
+    long sent = 0;
+
+    print_json_status("shm", "stream_producer_start", "Pai publicando mensagens no ring...", parent_pid);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (sent < count) {
+        if (shm_ring_write(&shm_mgr, message, msg_len) == 0) {
+            sent++;
+            if (sync_mode == SHM_SYNC_FUTEX && shm_sem_post(&shm_mgr) == -1) {
+                print_json_error("shm", "Pai falhou ao sinalizar semáforo futex", parent_pid);
+                break;
+            }
+        } else if (errno == EAGAIN) {
+            sched_yield();
+        } else {
+            print_json_error("shm", "Pai falhou ao escrever no ring", parent_pid);
+            break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double secs = elapsed_seconds(&start, &end);
+    snprintf(status_msg, sizeof(status_msg), "Pai publicou %ld mensagens em %.6f s: %.0f msg/s",
+             sent, secs, secs > 0 ? sent / secs : 0.0);
+    print_json_status("shm", "stream_producer_done", status_msg, parent_pid);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    cleanup_shm(&shm_mgr);
+
+    if (sent != count || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        print_json_error("shm", "Streaming via ring finalizado com falha.", parent_pid);
+        return EXIT_FAILURE;
+    }
+    print_json_status("shm", "success", "Streaming via ring finalizado com sucesso.", parent_pid);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Modo --zerocopy: transmite N frames de SIZE bytes sem memcpy.
+ *
+ * Usa dois canais: um segmento com o alocador slab (os frames) e um ring
+ * pequeno por onde passam apenas handles. O pai preenche cada frame direto
+ * no bloco reservado e publica o handle; o filho lê o frame no lugar e
+ * devolve o bloco à free list.
+ */
+static int run_zerocopy(long count, size_t frame_size, const shm_demo_opts_t *opts) {
+    shm_manager_t slab_mgr, queue_mgr;
+    char status_msg[512];
+    char slab_name[SHM_NAME_MAX], queue_name[SHM_NAME_MAX];
+    const char *base_name = opts->name ? opts->name : "/ipc_zc";
+    shm_slab_class_config_t frames = { frame_size, ZC_BLOCKS };
+    int flags = opts->flags | SHM_F_CREATE | SHM_F_REPLACE;
+
+    snprintf(slab_name, sizeof(slab_name), "%s", base_name);
+    snprintf(queue_name, sizeof(queue_name), "%s_q", base_name);
+
+    // Espaço para os blocos alinhados em página mais os metadados do slab
+    size_t slab_size = ZC_BLOCKS * ((frame_size + 4095) / 4096 * 4096) + sizeof(shm_slab_header_t) + 2 * 4096;
+
+    print_json_status("shm", "zc_setup", "Pai criando slab e fila de handles...", getpid());
+    if (init_shm_ex(&slab_mgr, slab_name, slab_size, flags) == -1 || bind_channel(&slab_mgr) == -1) {
+        print_json_error("shm", "Pai falhou ao criar o segmento do slab", getpid());
+        return EXIT_FAILURE;
+    }
+    if (init_shm_ex(&queue_mgr, queue_name, 64 * 1024, SHM_F_CREATE | SHM_F_REPLACE) == -1 ||
+        bind_channel(&queue_mgr) == -1) {
+        print_json_error("shm", "Pai falhou ao criar a fila de handles", getpid());
+        cleanup_shm(&slab_mgr);
+        return EXIT_FAILURE;
+    }
+    if (shm_slab_init(&slab_mgr, &frames, 1) == -1 || shm_ring_init(&queue_mgr) == -1) {
+        print_json_error("shm", "Pai falhou ao formatar slab/ring", getpid());
+        cleanup_shm(&queue_mgr);
+        cleanup_shm(&slab_mgr);
+        return EXIT_FAILURE;
+    }
+    describe_channel(&slab_mgr, status_msg, sizeof(status_msg));
+    print_json_status("shm", "setup_complete", status_msg, getpid());
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        print_json_error("shm", "Falha no fork()", getpid());
+        cleanup_shm(&queue_mgr);
+        cleanup_shm(&slab_mgr);
+        return EXIT_FAILURE;
+    }
+
+    if (pid == 0) {
+        // --- Consumidor: lê os frames no lugar e os libera ---
+        pid_t child_pid = getpid();
+        shm_manager_t child_slab, child_queue;
+        struct timespec start, end;
+        long received = 0, corrupted = 0, idle = 0;
+        uint64_t bytes = 0;
+        ipc_affinity_apply("shm", IPC_ROLE_CONSUMER);
+
+        if (init_shm_ex(&child_slab, slab_name, 0, opts->flags & ~SHM_F_MLOCK) == -1) {
+            print_json_error("shm", "Filho falhou ao se conectar ao slab", child_pid);
+            exit(EXIT_FAILURE);
+        }
+        if (init_shm_ex(&child_queue, queue_name, 0, 0) == -1) {
+            print_json_error("shm", "Filho falhou ao se conectar à fila", child_pid);
+            cleanup_shm(&child_slab);
+            exit(EXIT_FAILURE);
+        }
+        if (shm_slab_init(&child_slab, NULL, 0) == -1 || shm_ring_init(&child_queue) == -1) {
+            print_json_error("shm", "Filho encontrou slab/ring não formatados", child_pid);
+            cleanup_shm(&child_queue);
+            cleanup_shm(&child_slab);
+            exit(EXIT_FAILURE);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (received < count) {
+            zc_record_t rec;
+            ssize_t n = shm_ring_read(&child_queue, &rec, sizeof(rec));
+            if (n < 0 && errno == EAGAIN && ++idle % 4096 == 0 && !shm_owner_alive(&child_queue)) {
+                // Produtor morto: só o que já estava na fila ainda pode chegar
+                n = shm_ring_read(&child_queue, &rec, sizeof(rec));
+                if (n < 0 && errno == EAGAIN) {
+                    print_json_error("shm", "Produtor terminou antes de enviar todos os frames", child_pid);
+                    break;
+                }
+            }
+            if (n < 0 && errno == EAGAIN) {
+                sched_yield();
+                continue;
+            }
+            if (n < 0) {
+                print_json_error("shm", "Filho falhou ao ler a fila de handles", child_pid);
+                break;
+            }
+            unsigned char *frame = shm_slab_ptr(&child_slab, rec.handle);
+            uint64_t seq;
+            if (!frame) {
+                corrupted++;
+            } else {
+                memcpy(&seq, frame, sizeof(seq));
+                if (seq != rec.seq || frame[rec.length - 1] != (unsigned char)rec.seq) {
+                    corrupted++;
+                }
+                shm_slab_free(&child_slab, rec.handle);
+            }
+            bytes += rec.length;
+            received++;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        double secs = elapsed_seconds(&start, &end);
+        snprintf(status_msg, sizeof(status_msg),
+                 "Filho recebeu %ld frames de %zu bytes (%ld corrompidos) em %.6f s: %.0f frames/s, %.3f GB/s",
+                 received, frame_size, corrupted, secs, secs > 0 ? received / secs : 0.0,
+                 secs > 0 ? (double)bytes / secs / 1e9 : 0.0);
+        print_json_status("shm", "zc_result", status_msg, child_pid);
+
+        cleanup_shm(&child_queue);
+        cleanup_shm(&child_slab);
+        exit(corrupted == 0 && received == count ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    // --- Produtor: preenche os frames no lugar e publica só o handle ---
+    pid_t parent_pid = getpid();
+    long sent = 0, idle = 0;
+    int status = 0, reaped = 0;
+    while (sent < count && !reaped) {
+        zc_record_t rec;
+        unsigned char *frame = shm_slab_alloc(&slab_mgr, frame_size, &rec.handle);
+        if (!frame) {
+            // Todos os blocos estão com o consumidor; de tempos em tempos confere se ele ainda existe
+            if (++idle % 4096 == 0 && waitpid(pid, &status, WNOHANG) == pid) {
+                reaped = 1;
+                break;
+            }
+            sched_yield();
+            continue;
+        }
+        rec.length = frame_size;
+        rec.seq = (uint64_t)sent;
+        memset(frame, (unsigned char)rec.seq, frame_size);
+        memcpy(frame, &rec.seq, frame_size < sizeof(rec.seq) ? frame_size : sizeof(rec.seq));
+        frame[frame_size - 1] = (unsigned char)rec.seq;
+
+        while (shm_ring_write(&queue_mgr, &rec, sizeof(rec)) == -1) {
+            if (++idle % 4096 == 0 && waitpid(pid, &status, WNOHANG) == pid) {
+                reaped = 1;
+                break;
+            }
+            sched_yield();
+        }
+        if (!reaped) {
+            sent++;
+        }
+    }
+
+    if (reaped) {
+        print_json_error("shm", "Consumidor terminou antes de receber todos os frames", parent_pid);
+    } else {
+        waitpid(pid, &status, 0);
+    }
+    cleanup_shm(&queue_mgr);
+    cleanup_shm(&slab_mgr);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        print_json_error("shm", "Transferência zero-copy finalizada com falha.", parent_pid);
+        return EXIT_FAILURE;
+    }
+    print_json_status("shm", "success", "Transferência zero-copy finalizada com sucesso.", parent_pid);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Modo --broadcast: um escritor publica N mensagens para R leitores.
+ *
+ * Cada mensagem é escrita uma única vez; os filhos a leem no lugar
+ * (shm_bcast_peek/consume), cada um com seu cursor. Com --drop o escritor
+ * nunca espera pelo leitor mais lento: quem ficar uma volta para trás é
+ * desligado do canal.
+ */
+static int run_broadcast(int readers, long count, const char *message, const shm_demo_opts_t *opts, int drop) {
+    shm_manager_t shm_mgr;
+    char status_msg[512];
+    const char *name = opts->name ? opts->name : "/ipc_bcast";
+    size_t msg_len = strlen(message);
+    size_t slot_stride = (msg_len + 16 + SHM_CACHE_LINE - 1) / SHM_CACHE_LINE * SHM_CACHE_LINE;
+    pid_t pids[SHM_BCAST_MAX_READERS];
+
+    print_json_status("shm", "bcast_setup", "Pai criando canal broadcast...", getpid());
+    if (init_shm_ex(&shm_mgr, name, sizeof(shm_bcast_header_t) + 4096 * slot_stride + SHM_CACHE_LINE,
+                    opts->flags | SHM_F_CREATE | SHM_F_REPLACE) == -1 || bind_channel(&shm_mgr) == -1) {
+        print_json_error("shm", "Pai falhou ao criar o segmento broadcast", getpid());
+        return EXIT_FAILURE;
+    }
+    if (shm_bcast_init(&shm_mgr, msg_len, drop ? SHM_BCAST_DROP_LAGGING : 0) == -1) {
+        print_json_error("shm", "Pai falhou ao formatar o canal broadcast", getpid());
+        cleanup_shm(&shm_mgr);
+        return EXIT_FAILURE;
+    }
+    snprintf(status_msg, sizeof(status_msg), "Canal '%s': %llu slots de %zu bytes, %d leitores, modo %s.",
+             name, (unsigned long long)shm_mgr.bcast->slot_count, msg_len, readers,
+             drop ? "drop (leitores lentos são desligados)" : "backpressure");
+    print_json_status("shm", "setup_complete", status_msg, getpid());
+
+    for (int r = 0; r < readers; r++) {
+        pids[r] = fork();
+        if (pids[r] < 0) {
+            print_json_error("shm", "Falha no fork()", getpid());
+            readers = r;
+            break;
+        }
+        if (pids[r] == 0) {
+            // --- Leitor ---
+            pid_t child_pid = getpid();
+            shm_manager_t child_mgr;
+            struct timespec start, end;
+            long received = 0, corrupted = 0;
+            int dropped = 0;
+            ipc_affinity_apply("shm", IPC_ROLE_CONSUMER);
+
+            if (init_shm_ex(&child_mgr, name, 0, opts->flags & ~SHM_F_MLOCK) == -1 ||
+                shm_bcast_init(&child_mgr, 0, 0) == -1 || shm_bcast_join(&child_mgr) == -1) {
+                print_json_error("shm", "Leitor falhou ao entrar no canal broadcast", child_pid);
+                exit(EXIT_FAILURE);
+            }
+
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            while (received < count) {
+                size_t len;
+                const void *payload = shm_bcast_peek(&child_mgr, &len);
+                if (!payload) {
+                    if (errno == EAGAIN) {
+                        sched_yield();
+                        continue;
+                    }
+                    dropped = 1;
+                    break;
+                }
+                int intact = len == msg_len && memcmp(payload, message, msg_len) == 0;
+                if (shm_bcast_consume(&child_mgr) == -1) {
+                    dropped = 1;
+                    break;
+                }
+                if (!intact) {
+                    corrupted++;
+                }
+                received++;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &end);
+
+            double secs = elapsed_seconds(&start, &end);
+            snprintf(status_msg, sizeof(status_msg),
+                     "Leitor recebeu %ld de %ld mensagens (%ld corrompidas)%s em %.6f s: %.0f msg/s",
+                     received, count, corrupted, dropped ? ", desligado por atraso" : "",
+                     secs, secs > 0 ? received / secs : 0.0);
+            print_json_status("shm", dropped ? "bcast_reader_dropped" : "bcast_reader_result", status_msg, child_pid);
+
+            shm_bcast_leave(&child_mgr);
+            cleanup_shm(&child_mgr);
+            exit(corrupted == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+
+    // --- Escritor: espera todos os leitores entrarem antes de publicar ---
+    pid_t parent_pid = getpid();
+    struct timespec start, end;
+    for (;;) {
+        int active = 0;
+        for (int i = 0; i < SHM_BCAST_MAX_READERS; i++) {
+            if (__atomic_load_n(&shm_mgr.bcast->readers[i].state, __ATOMIC_ACQUIRE) != SHM_BCAST_READER_FREE) {
+                active++;
+            }
+        }
+        int status;
+        if (active >= readers || waitpid(-1, &status, WNOHANG) > 0) {
+            break;
+        }
+        sched_yield();
+    }
+
+    long sent = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (sent < count) {
+        if (shm_bcast_write(&shm_mgr, message, msg_len) == 0) {
+            sent++;
+        } else if (errno == EAGAIN) {
+            sched_yield();
+        } else {
+            print_json_error("shm", "Escritor falhou ao publicar no canal broadcast", parent_pid);
+            break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double write_secs = elapsed_seconds(&start, &end);
+
+    int failed = sent != count;
+    for (int r = 0; r < readers; r++) {
+        int status;
+        waitpid(pids[r], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed = 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double total_secs = elapsed_seconds(&start, &end);
+
+    snprintf(status_msg, sizeof(status_msg),
+             "Escritor publicou %ld mensagens em %.6f s (%.0f msg/s); %.0f entregas/s para %d leitores; %llu leitores desligados.",
+             sent, write_secs, write_secs > 0 ? sent / write_secs : 0.0,
+             total_secs > 0 ? (double)sent * readers / total_secs : 0.0, readers,
+             (unsigned long long)shm_mgr.bcast->dropped_readers);
+    print_json_status("shm", "bcast_result", status_msg, parent_pid);
+    cleanup_shm(&shm_mgr);
+
+    if (failed) {
+        print_json_error("shm", "Broadcast finalizado com falha.", parent_pid);
+        return EXIT_FAILURE;
+    }
+    print_json_status("shm", "success", "Broadcast finalizado com sucesso.", parent_pid);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Uma rodada do benchmark --snapshot com um número fixo de leitores.
+ *
+ * O escritor publica valores novos sem parar durante duration_ms; cada
+ * leitor lê o último valor o mais rápido possível e confere sua integridade.
+ */
+static int snapshot_round(const char *name, int readers, long duration_ms, snap_result_t *results, int *stop) {
+    char status_msg[512];
+    pid_t pids[SHM_BCAST_MAX_READERS];
+    shm_manager_t writer;
+
+    if (init_shm_ex(&writer, name, 0, 0) == -1 || shm_snapshot_init(&writer) == -1) {
+        return -1;
+    }
+    __atomic_store_n(stop, 0, __ATOMIC_RELEASE);
+    memset(results, 0, sizeof(snap_result_t) * readers);
+
+    for (int r = 0; r < readers; r++) {
+        pids[r] = fork();
+        if (pids[r] < 0) {
+            // Encerra os leitores já criados antes de desistir da rodada
+            print_json_error("shm", "Falha no fork()", getpid());
+            __atomic_store_n(stop, 1, __ATOMIC_RELEASE);
+            for (int k = 0; k < r; k++) {
+                waitpid(pids[k], NULL, 0);
+            }
+            cleanup_shm(&writer);
+            return -1;
+        }
+        if (pids[r] == 0) {
+            shm_manager_t reader;
+            uint64_t value[SNAP_WORDS];
+            ipc_affinity_apply("shm", IPC_ROLE_CONSUMER);
+            if (init_shm_ex(&reader, name, 0, 0) == -1 || shm_snapshot_init(&reader) == -1) {
+                exit(EXIT_FAILURE);
+            }
+            while (!__atomic_load_n(stop, __ATOMIC_ACQUIRE)) {
+                if (shm_snapshot_read(&reader, value, sizeof(value), NULL) != sizeof(value)) {
+                    continue;
+                }
+                for (int w = 1; w < SNAP_WORDS; w++) {
+                    if (value[w] != value[0]) {
+                        results[r].inconsistent++;
+                        break;
+                    }
+                }
+                results[r].reads++;
+            }
+            cleanup_shm(&reader);
+            exit(EXIT_SUCCESS);
+        }
+    }
+
+    struct timespec start, now;
+    uint64_t value[SNAP_WORDS];
+    uint64_t writes = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    do {
+        for (int w = 0; w < SNAP_WORDS; w++) {
+            value[w] = writes;
+        }
+        shm_snapshot_write(&writer, value, sizeof(value));
+        writes++;
+        if ((writes & 1023) == 0) {
+            sched_yield();  // Em máquinas com poucos núcleos, deixa os leitores rodarem
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (elapsed_seconds(&start, &now) * 1000.0 < duration_ms);
+    __atomic_store_n(stop, 1, __ATOMIC_RELEASE);
+
+    for (int r = 0; r < readers; r++) {
+        waitpid(pids[r], NULL, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double secs = elapsed_seconds(&start, &now);
+
+    uint64_t reads = 0, inconsistent = 0;
+    for (int r = 0; r < readers; r++) {
+        reads += results[r].reads;
+        inconsistent += results[r].inconsistent;
+    }
+    snprintf(status_msg, sizeof(status_msg),
+             "%d leitor(es): %.0f leituras/s no total (%.0f por leitor), escritor %.0f escritas/s, %llu leituras inconsistentes",
+             readers, reads / secs, reads / secs / readers, writes / secs, (unsigned long long)inconsistent);
+    print_json_status("shm", "snapshot_result", status_msg, getpid());
+    cleanup_shm(&writer);
+    return inconsistent == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Modo --snapshot: mede a escala dos leitores do seqlock (1, 2, 4, ... R).
+ */
+static int run_snapshot_bench(int max_readers, long duration_ms, const shm_demo_opts_t *opts) {
+    shm_manager_t shm_mgr;
+    const char *name = opts->name ? opts->name : "/ipc_snapshot";
+    int failed = 0;
+
+    print_json_status("shm", "snapshot_setup", "Pai criando segmento snapshot (seqlock)...", getpid());
+    if (init_shm_ex(&shm_mgr, name, 4096, opts->flags | SHM_F_CREATE | SHM_F_REPLACE) == -1 ||
+        bind_channel(&shm_mgr) == -1 || shm_snapshot_init(&shm_mgr) == -1) {
+        print_json_error("shm", "Pai falhou ao criar o segmento snapshot", getpid());
+        return EXIT_FAILURE;
+    }
+
+    // Resultados e flag de parada em memória anônima herdada pelos filhos
+    size_t shared_size = sizeof(snap_result_t) * SHM_BCAST_MAX_READERS + sizeof(int);
+    snap_result_t *results = mmap(NULL, shared_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (results == MAP_FAILED) {
+        print_json_error("shm", "Falha ao mapear área de resultados", getpid());
+        cleanup_shm(&shm_mgr);
+        return EXIT_FAILURE;
+    }
+    int *stop = (int *)(results + SHM_BCAST_MAX_READERS);
+
+    int readers = 1;
+    for (;;) {
+        if (snapshot_round(name, readers, duration_ms, results, stop) == -1) {
+            failed = 1;
+        }
+        if (readers == max_readers) {
+            break;
+        }
+        readers = readers * 2 > max_readers ? max_readers : readers * 2;
+    }
+
+    munmap(results, shared_size);
+    cleanup_shm(&shm_mgr);
+    if (failed) {
+        print_json_error("shm", "Benchmark snapshot encontrou leituras inconsistentes.", getpid());
+        return EXIT_FAILURE;
+    }
+    print_json_status("shm", "success", "Benchmark snapshot finalizado com sucesso.", getpid());
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Produtor do modo --recover: reanexa ao canal, assume a posse e publica registros.
+ *
+ * Com crash != 0 o produtor publica os registros mas não sinaliza o último
+ * (fica "em trânsito") e morre com SIGKILL segurando o mutex do dono, como
+ * se tivesse caído entre a escrita e o post.
+ */
+static void recover_producer(const char *name, uint64_t first_seq, long count, int crash) {
+    pid_t pid = getpid();
+    shm_manager_t shm_mgr;
+    char status_msg[256];
+
+    ipc_affinity_apply("shm", IPC_ROLE_PRODUCER);
+    if (init_shm_ex(&shm_mgr, name, 0, SHM_F_REATTACH) == -1 || shm_ring_init(&shm_mgr) == -1) {
+        print_json_error("shm", "Produtor falhou ao reanexar ao canal", pid);
+        exit(EXIT_FAILURE);
+    }
+    int recovered = shm_acquire_owner(&shm_mgr);
+    if (recovered == -1) {
+        print_json_error("shm", "Produtor falhou ao assumir a posse do canal", pid);
+        exit(EXIT_FAILURE);
+    }
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr.ptr;
+    recover_record_t rec = { hdr->epoch, first_seq };
+    snprintf(status_msg, sizeof(status_msg),
+             "Produtor assumiu o canal na época %llu%s; ring preservado (head=%llu, tail=%llu).",
+             (unsigned long long)rec.epoch, recovered ? " recuperando de um dono morto" : "",
+             (unsigned long long)shm_mgr.ring->head, (unsigned long long)shm_mgr.ring->tail);
+    print_json_status("shm", "recover_producer_start", status_msg, pid);
+
+    for (long i = 0; i < count; i++, rec.seq++) {
+        while (shm_ring_write(&shm_mgr, &rec, sizeof(rec)) == -1) {
+            if (errno != EAGAIN) {
+                print_json_error("shm", "Produtor falhou ao escrever no ring", pid);
+                exit(EXIT_FAILURE);
+            }
+            sched_yield();
+        }
+        if (crash && i == count - 1) {
+            print_json_status("shm", "recover_crash", "Produtor morrendo entre a escrita e o post (SIGKILL)...", pid);
+            json_output_flush();  // Com IPC_JSON_FLUSH=async/size/time, o que está pendente morreria junto
+            kill(pid, SIGKILL);
+        }
+        shm_sem_post(&shm_mgr);
+    }
+
+    // Saída limpa: devolve a posse e desanexa sem remover o segmento
+    shm_release_owner(&shm_mgr);
+    cleanup_shm(&shm_mgr);
+    exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Modo --recover: o produtor cai no meio do envio e é reiniciado.
+ *
+ * O pai (consumidor) cria o canal e lê registros com shm_sem_wait_robust().
+ * O primeiro produtor morre após publicar N registros sem sinalizar o
+ * último; o consumidor detecta a morte do dono, recupera o registro em
+ * trânsito direto do ring e inicia um segundo produtor, que reanexa ao
+ * segmento vivo (SHM_F_REATTACH) e continua a sequência sem reset do ring
+ * nem perda da posição do consumidor.
+ */
+static int run_recover(long count, const shm_demo_opts_t *opts) {
+    const char *name = opts->name ? opts->name : "/ipc_shm_recover";
+    pid_t pid = getpid();
+    shm_manager_t shm_mgr;
+    char status_msg[512];
+
+    if (init_shm_ex(&shm_mgr, name, 64 * 1024, opts->flags | SHM_F_CREATE | SHM_F_REPLACE) == -1 ||
+        bind_channel(&shm_mgr) == -1 || shm_set_sync_mode(&shm_mgr, SHM_SYNC_FUTEX) == -1 || shm_ring_init(&shm_mgr) == -1) {
+        print_json_error("shm", "Consumidor falhou ao criar o canal", pid);
+        return EXIT_FAILURE;
+    }
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr.ptr;
+
+    pid_t producer = fork();
+    if (producer == 0) {
+        recover_producer(name, 0, count, 1);
+    }
+
+    long received = 0, out_of_order = 0, in_flight = 0;
+    int restarts = 0;
+    uint64_t next_seq = 0;
+    recover_record_t rec;
+
+    while (producer > 0 && received < 2 * count) {
+        int rc = shm_sem_wait_robust(&shm_mgr, RECOVER_WAIT_MS);
+        if (rc == -1 && errno != EOWNERDEAD) {
+            print_json_error("shm", "Consumidor desistiu de esperar pelo produtor", pid);
+            break;
+        }
+        if (rc == 0) {
+            if (shm_ring_read(&shm_mgr, &rec, sizeof(rec)) != (ssize_t)sizeof(rec)) {
+                print_json_error("shm", "Consumidor falhou ao ler do ring", pid);
+                break;
+            }
+            out_of_order += rec.seq != next_seq;
+            next_seq = rec.seq + 1;
+            received++;
+            continue;
+        }
+
+        // Dono morto: registros publicados mas não sinalizados ainda estão no ring
+        while (shm_ring_read(&shm_mgr, &rec, sizeof(rec)) == (ssize_t)sizeof(rec)) {
+            out_of_order += rec.seq != next_seq;
+            next_seq = rec.seq + 1;
+            received++;
+            in_flight++;
+        }
+        waitpid(producer, NULL, 0);
+        if (restarts > 0) {
+            break;
+        }
+        restarts++;
+        uint64_t old_epoch = __atomic_load_n(&hdr->epoch, __ATOMIC_ACQUIRE);
+        snprintf(status_msg, sizeof(status_msg),
+                 "Dono do canal morreu na época %llu; %ld registro(s) em trânsito recuperado(s). Reiniciando produtor...",
+                 (unsigned long long)old_epoch, in_flight);
+        print_json_status("shm", "recover_detected", status_msg, pid);
+
+        producer = fork();
+        if (producer == 0) {
+            recover_producer(name, next_seq, count, 0);
+        }
+        // Espera o novo produtor assumir antes de voltar a checar a vida do dono
+        while (producer > 0 && __atomic_load_n(&hdr->epoch, __ATOMIC_ACQUIRE) == old_epoch &&
+               waitpid(producer, NULL, WNOHANG) == 0) {
+            sched_yield();
+        }
+    }
+    if (producer > 0) {
+        waitpid(producer, NULL, 0);
+    }
+
+    snprintf(status_msg, sizeof(status_msg),
+             "Consumidor recebeu %ld de %ld registros (%ld em trânsito recuperados, %ld fora de ordem) em %d reinício(s).",
+             received, 2 * count, in_flight, out_of_order, restarts);
+    print_json_status("shm", "recover_result", status_msg, pid);
+    cleanup_shm(&shm_mgr);
+
+    if (received != 2 * count || out_of_order != 0 || in_flight == 0) {
+        print_json_error("shm", "Recuperação do canal finalizada com falha.", pid);
+        return EXIT_FAILURE;
+    }
+    print_json_status("shm", "success", "Recuperação do canal finalizada com sucesso.", pid);
+    return EXIT_SUCCESS;
+}
 
 int main(int argc, char *argv[]) {
     pid_t pid;
@@ -13,17 +860,112 @@ int main(int argc, char *argv[]) {
     char status_msg[512];
 
     char *message = "Mensagem padrão via SHM";
-    if (argc > 1) {
-        message = argv[1];
+    shm_demo_opts_t opts = { NULL, SHM_DATA_SIZE, 0, SHM_SYNC_SEM };
+    long stream_count = 0;
+    long zc_count = 0;
+    size_t zc_frame = 0;
+    long bcast_count = 0;
+    int bcast_readers = 0;
+    int bcast_drop = 0;
+    int snap_readers = 0;
+    long snap_ms = 0;
+    long recover_count = 0;
+    int argi = 1;
+
+    // Opções: [--futex] [--stream N] [--zerocopy N bytes] [--broadcast R N] [--drop] [--snapshot R ms] [--recover N]
+    //         [--name /nome] [--size bytes]
+    //         [--populate] [--hugetlb] [--mlock] [mensagem]
+    while (argi < argc && strncmp(argv[argi], "--", 2) == 0) {
+        const char *opt = argv[argi];
+        const char *value = argi + 1 < argc ? argv[argi + 1] : NULL;
+        if (strcmp(opt, "--futex") == 0) {
+            opts.sync_mode = SHM_SYNC_FUTEX;
+        } else if (strcmp(opt, "--populate") == 0) {
+            opts.flags |= SHM_F_POPULATE;
+        } else if (strcmp(opt, "--hugetlb") == 0) {
+            opts.flags |= SHM_F_HUGETLB;
+        } else if (strcmp(opt, "--mlock") == 0) {
+            opts.flags |= SHM_F_MLOCK;
+        } else if (strcmp(opt, "--stream") == 0 && value && atol(value) > 0) {
+            stream_count = atol(value);
+            argi++;
+        } else if (strcmp(opt, "--zerocopy") == 0 && value && argi + 2 < argc &&
+                   atol(value) > 0 && strtoull(argv[argi + 2], NULL, 0) >= sizeof(uint64_t)) {
+            zc_count = atol(value);
+            zc_frame = (size_t)strtoull(argv[argi + 2], NULL, 0);
+            argi += 2;
+        } else if (strcmp(opt, "--broadcast") == 0 && value && argi + 2 < argc &&
+                   atoi(value) > 0 && atoi(value) <= SHM_BCAST_MAX_READERS && atol(argv[argi + 2]) > 0) {
+            bcast_readers = atoi(value);
+            bcast_count = atol(argv[argi + 2]);
+            argi += 2;
+        } else if (strcmp(opt, "--snapshot") == 0 && value && argi + 2 < argc &&
+                   atoi(value) > 0 && atoi(value) <= SHM_BCAST_MAX_READERS && atol(argv[argi + 2]) > 0) {
+            snap_readers = atoi(value);
+            snap_ms = atol(argv[argi + 2]);
+            argi += 2;
+        } else if (strcmp(opt, "--recover") == 0 && value && atol(value) > 0) {
+            recover_count = atol(value);
+            argi++;
+        } else if (strcmp(opt, "--drop") == 0) {
+            bcast_drop = 1;
+        } else if (strcmp(opt, "--name") == 0 && value) {
+            opts.name = value;
+            argi++;
+        } else if (strcmp(opt, "--size") == 0 && value && strtoull(value, NULL, 0) > 0) {
+            opts.size = (size_t)strtoull(value, NULL, 0);
+            argi++;
+        } else {
+            print_json_error("shm", "Uso: ./shm_demo [--futex] [--stream <N>] [--zerocopy <N> <bytes>] "
+                             "[--broadcast <leitores> <N>] [--drop] [--snapshot <leitores> <ms>] [--recover <N>] [--name </nome>] [--size <bytes>] "
+                             "[--populate] [--hugetlb] [--mlock] [mensagem]", getpid());
+            return 1;
+        }
+        argi++;
+    }
+    if (argi < argc) {
+        message = argv[argi];
+    }
+    if (!opts.name && opts.flags) {
+        // Recursos de memória só se aplicam a canais nomeados de init_shm_ex()
+        opts.name = SHM_NAME;
+    }
+
+    // O pai é o produtor em todos os modos, exceto em --recover (lá os filhos produzem)
+    ipc_affinity_apply("shm", recover_count > 0 ? IPC_ROLE_CONSUMER : IPC_ROLE_PRODUCER);
+
+    if (stream_count > 0) {
+        return run_stream(stream_count, message, &opts);
+    }
+    if (zc_count > 0) {
+        return run_zerocopy(zc_count, zc_frame, &opts);
+    }
+    if (bcast_readers > 0) {
+        return run_broadcast(bcast_readers, bcast_count, message, &opts, bcast_drop);
+    }
+    if (snap_readers > 0) {
+        return run_snapshot_bench(snap_readers, snap_ms, &opts);
+    }
+    if (recover_count > 0) {
+        return run_recover(recover_count, &opts);
     }
     
     // --- 1. PAI: SETUP ---
     print_json_status("shm", "setup", "Pai (Criador) iniciando configuração...", getpid());
-    if (init_shm(&shm_mgr, 1) == -1) {
+    if (open_channel(&shm_mgr, &opts, 1) == -1) {
         print_json_error("shm", "Pai falhou ao inicializar SHM e semáforo", getpid());
         exit(EXIT_FAILURE);
     }
-    snprintf(status_msg, sizeof(status_msg), "SHM ('%s') e semáforo ('%s') criados.", SHM_NAME, SEM_NAME);
+    if (shm_set_sync_mode(&shm_mgr, opts.sync_mode) == -1) {
+        print_json_error("shm", "Pai falhou ao inicializar SHM e semáforo", getpid());
+        cleanup_shm(&shm_mgr);
+        exit(EXIT_FAILURE);
+    }
+    if (!opts.name && opts.sync_mode == SHM_SYNC_SEM) {
+        snprintf(status_msg, sizeof(status_msg), "SHM ('%s') e semáforo ('%s') criados.", SHM_NAME, SEM_NAME);
+    } else {
+        describe_channel(&shm_mgr, status_msg, sizeof(status_msg));
+    }
     print_json_status("shm", "setup_complete", status_msg, getpid());
     
     // --- 2. PAI: FORKING ---
@@ -41,9 +983,10 @@ int main(int argc, char *argv[]) {
         pid_t child_pid = getpid();
         shm_manager_t child_shm_mgr;
         print_json_status("shm", "child_start", "Filho (Leitor) iniciado.", child_pid);
+        ipc_affinity_apply("shm", IPC_ROLE_CONSUMER);
 
         // Anexa à SHM e ao semáforo existentes
-        if (init_shm(&child_shm_mgr, 0) == -1) {
+        if (open_channel(&child_shm_mgr, &opts, 0) == -1) {
             print_json_error("shm", "Filho falhou ao se conectar à SHM", child_pid);
             exit(EXIT_FAILURE);
         }
@@ -51,20 +994,23 @@ int main(int argc, char *argv[]) {
 
         // Aguarda o sinal (post) do pai (bloqueante)
         print_json_status("shm", "child_sem_wait", "Filho bloqueado, aguardando sinal do pai...", child_pid);
-        if (shm_sem_wait(&child_shm_mgr) == -1) {
-            print_json_error("shm", "Filho falhou na espera do semáforo", child_pid);
+        // A espera desiste se o pai morrer antes do post, em vez de bloquear para sempre
+        if (shm_sem_wait_robust(&child_shm_mgr, -1) == -1) {
+            print_json_error("shm", errno == EOWNERDEAD ? "Pai terminou sem sinalizar; filho desistiu da espera"
+                                                        : "Filho falhou na espera do semáforo", child_pid);
             cleanup_shm(&child_shm_mgr);
             exit(EXIT_FAILURE);
         }
 
         // Lê a mensagem da memória
         print_json_status("shm", "child_read_shm", "Sinal recebido! Filho lendo da memória...", child_pid);
-        char buffer[SHM_SIZE];
-        if (read_from_shm(&child_shm_mgr, buffer, sizeof(buffer)) == 0) {
+        char *buffer = malloc(child_shm_mgr.data_size);
+        if (buffer && read_from_shm(&child_shm_mgr, buffer, child_shm_mgr.data_size) == 0) {
             print_json_data("shm", buffer, "leitura_filho", child_pid);
         } else {
             print_json_error("shm", "Filho falhou ao ler da SHM", child_pid);
         }
+        free(buffer);
         
         // Limpa seus recursos e termina
         cleanup_shm(&child_shm_mgr);
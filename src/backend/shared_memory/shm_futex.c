@@ -0,0 +1,156 @@
+#include "shm_futex.h"
+#include <errno.h>
+#include <unistd.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+// Limites da espera ativa adaptativa
+#define SHM_SPIN_MIN 16
+#define SHM_SPIN_MAX 4000
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Girar só faz sentido se o outro processo puder rodar em paralelo
+static uint32_t spin_ceiling(void) {
+    static int online_cpus = 0;
+    if (online_cpus == 0) {
+        online_cpus = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    return online_cpus > 1 ? SHM_SPIN_MAX : 0;
+}
+
+int shm_futex_wait_timeout(uint32_t *addr, uint32_t expected, const struct timespec *timeout) {
+    // Sem FUTEX_PRIVATE_FLAG: o futex é compartilhado entre processos.
+    // O timeout de FUTEX_WAIT é relativo (NULL: sem limite).
+    if (syscall(SYS_futex, addr, FUTEX_WAIT, expected, timeout, NULL, 0) == -1) {
+        return -1;
+    }
+    return 0;
+}
+
+int shm_futex_wait(uint32_t *addr, uint32_t expected) {
+    return shm_futex_wait_timeout(addr, expected, NULL);
+}
+
+// Tempo restante até deadline (CLOCK_MONOTONIC); 0 se já passou
+static int remaining_time(const struct timespec *deadline, struct timespec *left) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    left->tv_sec = deadline->tv_sec - now.tv_sec;
+    left->tv_nsec = deadline->tv_nsec - now.tv_nsec;
+    if (left->tv_nsec < 0) {
+        left->tv_sec--;
+        left->tv_nsec += 1000000000L;
+    }
+    return left->tv_sec >= 0;
+}
+
+int shm_futex_wake(uint32_t *addr, int count) {
+    return (int)syscall(SYS_futex, addr, FUTEX_WAKE, count, NULL, NULL, 0);
+}
+
+void shm_futex_sem_init(shm_futex_sem_t *sem, uint32_t value) {
+    sem->waiters = 0;
+    sem->spin = SHM_SPIN_MIN;
+    sem->reserved = 0;
+    __atomic_store_n(&sem->count, value, __ATOMIC_RELEASE);
+}
+
+int shm_futex_sem_trywait(shm_futex_sem_t *sem) {
+    uint32_t value = __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+    while (value > 0) {
+        if (__atomic_compare_exchange_n(&sem->count, &value, value - 1, 1,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return 0;
+        }
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+int shm_futex_sem_wait(shm_futex_sem_t *sem) {
+    return shm_futex_sem_timedwait(sem, -1);
+}
+
+int shm_futex_sem_timedwait(shm_futex_sem_t *sem, long timeout_ms) {
+    struct timespec deadline;
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    uint32_t ceiling = spin_ceiling();
+    uint32_t limit = __atomic_load_n(&sem->spin, __ATOMIC_RELAXED);
+    if (limit > ceiling) {
+        limit = ceiling;
+    }
+
+    // 1. Espera ativa: resolve a entrega sem syscall quando o par está rodando
+    for (uint32_t i = 0; i < limit; i++) {
+        if (shm_futex_sem_trywait(sem) == 0) {
+            // Deu certo girando: permite girar um pouco mais da próxima vez
+            uint32_t next = limit + limit / 4 + 1;
+            __atomic_store_n(&sem->spin, next < SHM_SPIN_MAX ? next : SHM_SPIN_MAX, __ATOMIC_RELAXED);
+            return 0;
+        }
+        cpu_relax();
+    }
+    if (limit > 0) {
+        // Girar não adiantou: reduz o orçamento para não desperdiçar CPU
+        uint32_t next = limit / 2;
+        __atomic_store_n(&sem->spin, next > SHM_SPIN_MIN ? next : SHM_SPIN_MIN, __ATOMIC_RELAXED);
+    }
+
+    // 2. Estaciona no futex. O incremento de waiters (seq_cst) antes de checar
+    //    count pareia com o incremento de count antes de ler waiters no post:
+    //    ou o post enxerga o waiter e chama FUTEX_WAKE, ou o FUTEX_WAIT
+    //    enxerga o novo count e retorna EAGAIN.
+    for (;;) {
+        if (shm_futex_sem_trywait(sem) == 0) {
+            return 0;
+        }
+        struct timespec left;
+        if (timeout_ms >= 0 && !remaining_time(&deadline, &left)) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        __atomic_add_fetch(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+        int rc = shm_futex_wait_timeout(&sem->count, 0, timeout_ms >= 0 ? &left : NULL);
+        int saved_errno = errno;
+        __atomic_sub_fetch(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+        if (rc == -1 && saved_errno != EAGAIN && saved_errno != EINTR && saved_errno != ETIMEDOUT) {
+            errno = saved_errno;
+            return -1;
+        }
+    }
+}
+
+int shm_futex_sem_post(shm_futex_sem_t *sem) {
+    uint32_t value = __atomic_add_fetch(&sem->count, 1, __ATOMIC_SEQ_CST);
+    if (value == 0) {
+        // Overflow do contador
+        __atomic_sub_fetch(&sem->count, 1, __ATOMIC_SEQ_CST);
+        errno = EOVERFLOW;
+        return -1;
+    }
+    // Caminho rápido: ninguém dormindo, nenhuma syscall
+    if (__atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST) > 0) {
+        if (shm_futex_wake(&sem->count, 1) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file shm_futex.h
+ * @brief Semáforo híbrido spin-then-futex armazenado na própria SHM
+ * 
+ * Alternativa aos semáforos POSIX nomeados (sem_open) para o caminho quente.
+ * O contador vive dentro do segmento mapeado, então sem_post/sem_wait viram
+ * operações atômicas em memória compartilhada: a syscall FUTEX_WAKE só é
+ * feita quando há um processo realmente estacionado no kernel, e quem espera
+ * primeiro gira por um número adaptativo de iterações antes de dormir.
+ */
+
+#ifndef SHM_FUTEX_H
+#define SHM_FUTEX_H
+
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Semáforo contador compartilhado entre processos.
+ * 
+ * Deve ficar em memória mapeada com MAP_SHARED e ser zerado pelo criador.
+ * O futex é feito sobre o próprio campo count.
+ */
+typedef struct {
+    uint32_t count;     // Valor do semáforo
+    uint32_t waiters;   // Processos estacionados (ou prestes a estacionar) no futex
+    uint32_t spin;      // Dica adaptativa de quantas iterações girar antes de dormir
+    uint32_t reserved;
+} shm_futex_sem_t;
+
+/**
+ * @brief Inicializa o semáforo com um valor.
+ * 
+ * @param sem Ponteiro para o semáforo dentro da SHM.
+ * @param value Valor inicial.
+ */
+void shm_futex_sem_init(shm_futex_sem_t *sem, uint32_t value);
+
+/**
+ * @brief Decrementa o semáforo sem bloquear.
+ * 
+ * @param sem Ponteiro para o semáforo.
+ * @return 0 em sucesso, -1 com errno = EAGAIN se o valor era 0.
+ */
+int shm_futex_sem_trywait(shm_futex_sem_t *sem);
+
+/**
+ * @brief Decrementa o semáforo, girando e depois dormindo no futex.
+ * 
+ * @param sem Ponteiro para o semáforo.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int shm_futex_sem_wait(shm_futex_sem_t *sem);
+
+/**
+ * @brief Como shm_futex_sem_wait(), mas desiste após timeout_ms.
+ * 
+ * @param sem Ponteiro para o semáforo.
+ * @param timeout_ms Tempo máximo de espera em milissegundos (negativo: sem limite).
+ * @return 0 em sucesso, -1 com errno = ETIMEDOUT se o prazo esgotou.
+ */
+int shm_futex_sem_timedwait(shm_futex_sem_t *sem, long timeout_ms);
+
+/**
+ * @brief Incrementa o semáforo e acorda um processo se houver alguém dormindo.
+ * 
+ * @param sem Ponteiro para o semáforo.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int shm_futex_sem_post(shm_futex_sem_t *sem);
+
+/**
+ * @brief Dorme enquanto *addr == expected (FUTEX_WAIT compartilhado).
+ * 
+ * @return 0 ao ser acordado, -1 com errno = EAGAIN se o valor já mudou.
+ */
+int shm_futex_wait(uint32_t *addr, uint32_t expected);
+
+/**
+ * @brief shm_futex_wait() com timeout relativo (NULL: sem limite).
+ * 
+ * @return 0 ao ser acordado, -1 com errno = EAGAIN (valor mudou) ou ETIMEDOUT.
+ */
+int shm_futex_wait_timeout(uint32_t *addr, uint32_t expected, const struct timespec *timeout);
+
+/**
+ * @brief Acorda até count processos dormindo em addr (FUTEX_WAKE compartilhado).
+ * 
+ * @return Número de processos acordados, ou -1 em erro.
+ */
+int shm_futex_wake(uint32_t *addr, int count);
+
+#endif // SHM_FUTEX_H
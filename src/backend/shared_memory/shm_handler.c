@@ -7,71 +7,285 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <signal.h>
+#include <time.h>
+
+// Tamanho padrão de huge page quando /proc/meminfo não informa
+#define SHM_DEFAULT_HUGEPAGE_SIZE (2UL * 1024 * 1024)
+
+// Lê o tamanho de huge page do sistema (linha "Hugepagesize:" em kB)
+static size_t hugepage_size(void) {
+    FILE *meminfo = fopen("/proc/meminfo", "r");
+    char line[128];
+    size_t size_kb = 0;
+
+    if (meminfo) {
+        while (fgets(line, sizeof(line), meminfo)) {
+            if (sscanf(line, "Hugepagesize: %zu kB", &size_kb) == 1) {
+                break;
+            }
+        }
+        fclose(meminfo);
+    }
+    return size_kb > 0 ? size_kb * 1024 : SHM_DEFAULT_HUGEPAGE_SIZE;
+}
+
+// perror() preservando errno, para que o chamador ainda veja a causa da falha
+static void report_error(const char *what) {
+    int saved_errno = errno;
+    perror(what);
+    errno = saved_errno;
+}
+
+static size_t round_up(size_t value, size_t align) {
+    return (value + align - 1) / align * align;
+}
+
+// Caminho do arquivo no hugetlbfs correspondente ao nome POSIX ("/x" -> "/dev/hugepages/x")
+static void hugetlbfs_path(const char *name, char *path, size_t size) {
+    snprintf(path, size, "%s%s", SHM_HUGETLBFS_DIR, name);
+}
+
+// Remove o objeto de memória do sistema (tmpfs ou hugetlbfs)
+static int unlink_segment(const char *name, int hugetlbfs) {
+    if (hugetlbfs) {
+        char path[sizeof(SHM_HUGETLBFS_DIR) + SHM_NAME_MAX];
+        hugetlbfs_path(name, path, sizeof(path));
+        return unlink(path);
+    }
+    return shm_unlink(name);
+}
 
 // Função para limpar todos os recursos em caso de falha na inicialização
 static void init_cleanup_on_failure(shm_manager_t *shm_mgr) {
+    int saved_errno = errno;
     if (shm_mgr->shm_fd != -1) {
         close(shm_mgr->shm_fd);
     }
-    shm_unlink(SHM_NAME);
     if (shm_mgr->sem != SEM_FAILED) {
         sem_close(shm_mgr->sem);
     }
-    sem_unlink(SEM_NAME);
+    if (shm_mgr->is_creator) {
+        unlink_segment(shm_mgr->name, shm_mgr->flags & SHM_F_HUGETLB);
+        sem_unlink(shm_mgr->sem_name);
+    }
+    errno = saved_errno;
 }
 
-int init_shm(shm_manager_t *shm_mgr, int create) {
+// Abre (ou cria) o objeto de memória: hugetlbfs quando pedido e disponível,
+// caso contrário shm_open() em /dev/shm.
+static int open_segment(shm_manager_t *shm_mgr, int oflag) {
+    if (shm_mgr->flags & SHM_F_HUGETLB) {
+        char path[sizeof(SHM_HUGETLBFS_DIR) + SHM_NAME_MAX];
+        hugetlbfs_path(shm_mgr->name, path, sizeof(path));
+        int fd = open(path, oflag, 0666);
+        if (fd != -1 || (errno != ENOENT && errno != ENODEV)) {
+            return fd;
+        }
+        // hugetlbfs não montado: cai para tmpfs + madvise(MADV_HUGEPAGE)
+        shm_mgr->flags &= ~SHM_F_HUGETLB;
+        shm_mgr->flags |= SHM_F_THP;
+    }
+    return shm_open(shm_mgr->name, oflag, 0666);
+}
+
+// kill(pid, 0) só testa a existência (EPERM: existe, mas é de outro usuário).
+// Um processo zumbi, que já terminou mas ainda não foi coletado pelo pai,
+// também responde, então o estado em /proc/<pid>/stat é conferido.
+static int pid_alive(pid_t pid) {
+    char path[32], line[256];
+    char state = 'R';
+
+    if (pid <= 0 || (kill(pid, 0) == -1 && errno != EPERM)) {
+        return 0;
+    }
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE *stat_file = fopen(path, "r");
+    if (stat_file) {
+        // Formato: "pid (comm) S ..."; comm pode conter ')' e espaços
+        if (fgets(line, sizeof(line), stat_file)) {
+            char *end = strrchr(line, ')');
+            if (end && end[1] == ' ') {
+                state = end[2];
+            }
+        }
+        fclose(stat_file);
+    }
+    return state != 'Z' && state != 'X';
+}
+
+// Verifica se um segmento existente pertence a outro processo ainda vivo,
+// para que SHM_F_REPLACE não destrua um canal em uso
+static int segment_in_use(shm_manager_t *shm_mgr) {
+    int saved_errno = errno;
+    int in_use = 0;
+    int fd = open_segment(shm_mgr, O_RDONLY);
+    struct stat st;
+
+    if (fd != -1 && fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(shm_segment_header_t)) {
+        shm_segment_header_t *hdr = mmap(0, sizeof(*hdr), PROT_READ, MAP_SHARED, fd, 0);
+        if (hdr != MAP_FAILED) {
+            pid_t owner = (pid_t)__atomic_load_n(&hdr->owner_pid, __ATOMIC_ACQUIRE);
+            in_use = __atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) == SHM_SEGMENT_MAGIC &&
+                     owner != getpid() && pid_alive(owner);
+            munmap(hdr, sizeof(*hdr));
+        }
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+    errno = saved_errno;
+    return in_use;
+}
+
+// Inicializa o mutex do dono: compartilhado entre processos e robusto, para
+// que a morte do dono seja reportada (EOWNERDEAD) em vez de travar o canal
+static int init_owner_lock(shm_segment_header_t *hdr) {
+    pthread_mutexattr_t attr;
+    int rc = pthread_mutexattr_init(&attr);
+    if (rc == 0) {
+        rc = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    }
+    if (rc == 0) {
+        rc = pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    }
+    if (rc == 0) {
+        rc = pthread_mutex_init(&hdr->owner_lock, &attr);
+    }
+    pthread_mutexattr_destroy(&attr);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return 0;
+}
+
+static int init_shm_common(shm_manager_t *shm_mgr, const char *name, const char *sem_name,
+                           size_t size, int flags) {
+    int create = (flags & (SHM_F_CREATE | SHM_F_REATTACH)) != 0;
+
+    memset(shm_mgr, 0, sizeof(*shm_mgr));
     shm_mgr->shm_fd = -1;
     shm_mgr->sem = SEM_FAILED;
+    shm_mgr->ptr = MAP_FAILED;
     shm_mgr->is_creator = create;
+    shm_mgr->flags = flags;
 
-    if (create) {
-        // Garante que não haja lixo de execuções anteriores
-        shm_unlink(SHM_NAME);
-        sem_unlink(SEM_NAME);
+    if (!name || name[0] != '/' || strchr(name + 1, '/') != NULL ||
+        strlen(name) + sizeof(SHM_SEM_SUFFIX) > SHM_NAME_MAX) {
+        fprintf(stderr, "Error: Invalid shared memory name.\n");
+        errno = EINVAL;
+        return -1;
+    }
+    snprintf(shm_mgr->name, sizeof(shm_mgr->name), "%s", name);
+    if (sem_name) {
+        snprintf(shm_mgr->sem_name, sizeof(shm_mgr->sem_name), "%s", sem_name);
+    } else {
+        snprintf(shm_mgr->sem_name, sizeof(shm_mgr->sem_name), "%s%s", name, SHM_SEM_SUFFIX);
+    }
 
-        // Criar o objeto de memória compartilhada
-        shm_mgr->shm_fd = shm_open(SHM_NAME, O_CREAT | O_RDWR, 0666);
-        if (shm_mgr->shm_fd == -1) {
-            perror("shm_open");
+    if (create && (flags & SHM_F_REPLACE) && !(flags & SHM_F_REATTACH)) {
+        // Garante que não haja lixo de execuções anteriores, mas nunca remove
+        // um canal cujo dono ainda está vivo
+        if (segment_in_use(shm_mgr)) {
+            fprintf(stderr, "Error: Shared memory segment is in use by a live process.\n");
+            errno = EBUSY;
             return -1;
         }
+        unlink_segment(shm_mgr->name, shm_mgr->flags & SHM_F_HUGETLB);
+        sem_unlink(shm_mgr->sem_name);
+    }
+
+    if (create) {
+        // Criar o objeto de memória compartilhada; sem SHM_F_REPLACE um canal
+        // existente com o mesmo nome não é destruído (EEXIST)
+        shm_mgr->shm_fd = open_segment(shm_mgr, O_CREAT | O_EXCL | O_RDWR);
+        if (shm_mgr->shm_fd == -1 && errno == EEXIST && (flags & SHM_F_REATTACH)) {
+            // Segmento vivo: anexa sem reformatar (ver o ramo abaixo)
+            create = 0;
+            shm_mgr->is_creator = 0;
+        } else if (shm_mgr->shm_fd == -1) {
+            report_error("shm_open");
+            return -1;
+        }
+    }
+
+    if (create) {
 
-        // Definir o tamanho da memória compartilhada
-        if (ftruncate(shm_mgr->shm_fd, SHM_SIZE) == -1) {
-            perror("ftruncate");
+        // Definir o tamanho: cabeçalho + dados, arredondado para a página usada
+        size_t page = (shm_mgr->flags & SHM_F_HUGETLB) ? hugepage_size() : (size_t)sysconf(_SC_PAGESIZE);
+        shm_mgr->size = round_up(sizeof(shm_segment_header_t) + size, page);
+        if (ftruncate(shm_mgr->shm_fd, (off_t)shm_mgr->size) == -1) {
+            report_error("ftruncate");
             init_cleanup_on_failure(shm_mgr);
             return -1;
         }
 
         // Criar o semáforo, inicializado em 0 (bloqueado)
-        shm_mgr->sem = sem_open(SEM_NAME, O_CREAT | O_EXCL, 0666, 0);
+        shm_mgr->sem = sem_open(shm_mgr->sem_name, O_CREAT | O_EXCL, 0666, 0);
         if (shm_mgr->sem == SEM_FAILED) {
-            perror("sem_open");
+            report_error("sem_open");
             init_cleanup_on_failure(shm_mgr);
             return -1;
         }
     } else {
         // Abrir um objeto de memória compartilhada existente
-        shm_mgr->shm_fd = shm_open(SHM_NAME, O_RDWR, 0666);
         if (shm_mgr->shm_fd == -1) {
-            perror("shm_open (non-creator)");
+            shm_mgr->shm_fd = open_segment(shm_mgr, O_RDWR);
+        }
+        if (shm_mgr->shm_fd == -1) {
+            report_error("shm_open (non-creator)");
+            return -1;
+        }
+
+        // O tamanho real vem do próprio objeto
+        struct stat st;
+        if (fstat(shm_mgr->shm_fd, &st) == -1 || (size_t)st.st_size < sizeof(shm_segment_header_t) ||
+            (size > 0 && (size_t)st.st_size < sizeof(shm_segment_header_t) + size)) {
+            fprintf(stderr, "Error: Shared memory segment is missing or too small.\n");
+            close(shm_mgr->shm_fd);
+            errno = EINVAL;
             return -1;
         }
+        shm_mgr->size = (size_t)st.st_size;
 
-        // Abrir um semáforo existente
-        shm_mgr->sem = sem_open(SEM_NAME, 0);
+        // Abrir um semáforo existente (ao reanexar, recria-o se tiver sumido)
+        shm_mgr->sem = sem_open(shm_mgr->sem_name, (flags & SHM_F_REATTACH) ? O_CREAT : 0, 0666, 0);
         if (shm_mgr->sem == SEM_FAILED) {
-            perror("sem_open (non-creator)");
+            report_error("sem_open (non-creator)");
             close(shm_mgr->shm_fd);
             return -1;
         }
     }
 
-    // Mapear a memória compartilhada no espaço de endereçamento do processo
-    shm_mgr->ptr = mmap(0, SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, shm_mgr->shm_fd, 0);
+    // Mapear a memória compartilhada no espaço de endereçamento do processo.
+    // MAP_POPULATE pré-faz todas as faltas de página aqui, e não no caminho quente.
+    int map_flags = MAP_SHARED;
+    if (flags & SHM_F_POPULATE) {
+        map_flags |= MAP_POPULATE;
+    }
+    shm_mgr->ptr = mmap(0, shm_mgr->size, PROT_READ | PROT_WRITE, map_flags, shm_mgr->shm_fd, 0);
     if (shm_mgr->ptr == MAP_FAILED) {
-        perror("mmap");
+        report_error("mmap");
+        if (create) {
+            init_cleanup_on_failure(shm_mgr);
+        } else {
+            close(shm_mgr->shm_fd);
+            sem_close(shm_mgr->sem);
+        }
+        return -1;
+    }
+
+    if (shm_mgr->flags & SHM_F_THP) {
+        // Huge pages transparentes para shmem (depende de shmem_enabled=advise)
+        if (madvise(shm_mgr->ptr, shm_mgr->size, MADV_HUGEPAGE) == -1) {
+            shm_mgr->flags &= ~SHM_F_THP;
+        }
+    }
+
+    if ((flags & SHM_F_MLOCK) && mlock(shm_mgr->ptr, shm_mgr->size) == -1) {
+        report_error("mlock");
+        munmap(shm_mgr->ptr, shm_mgr->size);
         if (create) {
             init_cleanup_on_failure(shm_mgr);
         } else {
@@ -81,59 +295,207 @@ int init_shm(shm_manager_t *shm_mgr, int create) {
         return -1;
     }
 
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr->ptr;
+    shm_mgr->data = (char *)shm_mgr->ptr + sizeof(shm_segment_header_t);
+    shm_mgr->data_size = shm_mgr->size - sizeof(shm_segment_header_t);
+
+    if (create) {
+        // Formata o cabeçalho de controle; semáforo POSIX é o padrão e o
+        // criador é o dono inicial do canal
+        hdr->sync_mode = SHM_SYNC_SEM;
+        hdr->owner_pid = (uint32_t)getpid();
+        hdr->epoch = 1;
+        shm_futex_sem_init(&hdr->futex_sem, 0);
+        if (init_owner_lock(hdr) == -1) {
+            report_error("pthread_mutex_init");
+            munmap(shm_mgr->ptr, shm_mgr->size);
+            init_cleanup_on_failure(shm_mgr);
+            return -1;
+        }
+        __atomic_store_n(&hdr->magic, SHM_SEGMENT_MAGIC, __ATOMIC_RELEASE);
+    } else if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHM_SEGMENT_MAGIC) {
+        fprintf(stderr, "Error: Shared memory segment is not initialized.\n");
+        munmap(shm_mgr->ptr, shm_mgr->size);
+        close(shm_mgr->shm_fd);
+        sem_close(shm_mgr->sem);
+        errno = EINVAL;
+        return -1;
+    }
+
+    return 0;
+}
+
+int init_shm(shm_manager_t *shm_mgr, int create) {
+    int flags = create ? (SHM_F_CREATE | SHM_F_REPLACE) : 0;
+    return init_shm_common(shm_mgr, SHM_NAME, SEM_NAME, create ? SHM_DATA_SIZE : 0, flags);
+}
+
+int init_shm_ex(shm_manager_t *shm_mgr, const char *name, size_t size, int flags) {
+    return init_shm_common(shm_mgr, name, NULL, size, flags);
+}
+
+int shm_set_sync_mode(shm_manager_t *shm_mgr, int mode) {
+    if (!shm_mgr->is_creator || (mode != SHM_SYNC_SEM && mode != SHM_SYNC_FUTEX)) {
+        errno = EINVAL;
+        return -1;
+    }
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr->ptr;
+    __atomic_store_n(&hdr->sync_mode, (uint32_t)mode, __ATOMIC_RELEASE);
     return 0;
 }
 
 int write_to_shm(shm_manager_t *shm_mgr, const char *data) {
-    if (strlen(data) + 1 > SHM_SIZE) {
+    if (strlen(data) + 1 > shm_mgr->data_size) {
         fprintf(stderr, "Error: Data is too large for the shared memory segment.\n");
         return -1;
     }
     // Usar strcpy para copiar a string, incluindo o terminador nulo
-    strcpy((char *)shm_mgr->ptr, data);
+    strcpy((char *)shm_mgr->data, data);
     return 0;
 }
 
 int read_from_shm(shm_manager_t *shm_mgr, char *buffer, size_t size) {
     if (size == 0) return -1;
+    if (size > shm_mgr->data_size) {
+        size = shm_mgr->data_size;
+    }
     // Usar strncpy para evitar overflow do buffer
-    strncpy(buffer, (char *)shm_mgr->ptr, size - 1);
+    strncpy(buffer, (char *)shm_mgr->data, size - 1);
     buffer[size - 1] = '\0'; // Garantir terminação nula
     return 0;
 }
 
 int cleanup_shm(shm_manager_t *shm_mgr) {
     // Desmapear a memória
-    if (munmap(shm_mgr->ptr, SHM_SIZE) == -1) {
-        perror("munmap");
+    if (munmap(shm_mgr->ptr, shm_mgr->size) == -1) {
+        report_error("munmap");
     }
 
     // Fechar o descritor de arquivo
     if (close(shm_mgr->shm_fd) == -1) {
-        perror("close");
+        report_error("close");
     }
 
     // Fechar o semáforo
     if (sem_close(shm_mgr->sem) == -1) {
-        perror("sem_close");
+        report_error("sem_close");
     }
 
     // Se for o criador, remover os objetos do sistema
     if (shm_mgr->is_creator) {
-        if (shm_unlink(SHM_NAME) == -1) {
-            perror("shm_unlink");
+        if (unlink_segment(shm_mgr->name, shm_mgr->flags & SHM_F_HUGETLB) == -1) {
+            report_error("shm_unlink");
         }
-        if (sem_unlink(SEM_NAME) == -1) {
-            perror("sem_unlink");
+        if (sem_unlink(shm_mgr->sem_name) == -1) {
+            report_error("sem_unlink");
         }
     }
     return 0;
 }
 
 int shm_sem_wait(shm_manager_t *shm_mgr) {
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr->ptr;
+    if (__atomic_load_n(&hdr->sync_mode, __ATOMIC_ACQUIRE) == SHM_SYNC_FUTEX) {
+        return shm_futex_sem_wait(&hdr->futex_sem);
+    }
     return sem_wait(shm_mgr->sem);
 }
 
+int shm_sem_timedwait(shm_manager_t *shm_mgr, long timeout_ms) {
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr->ptr;
+    if (timeout_ms < 0) {
+        return shm_sem_wait(shm_mgr);
+    }
+    if (__atomic_load_n(&hdr->sync_mode, __ATOMIC_ACQUIRE) == SHM_SYNC_FUTEX) {
+        return shm_futex_sem_timedwait(&hdr->futex_sem, timeout_ms);
+    }
+
+    // sem_timedwait() usa prazo absoluto em CLOCK_REALTIME
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    int rc;
+    do {
+        rc = sem_timedwait(shm_mgr->sem, &deadline);
+    } while (rc == -1 && errno == EINTR);
+    return rc;
+}
+
+int shm_sem_wait_robust(shm_manager_t *shm_mgr, long timeout_ms) {
+    long waited = 0;
+    for (;;) {
+        long slice = SHM_LIVENESS_POLL_MS;
+        if (timeout_ms >= 0 && timeout_ms - waited < slice) {
+            slice = timeout_ms - waited;
+        }
+        if (shm_sem_timedwait(shm_mgr, slice) == 0) {
+            return 0;
+        }
+        if (errno != ETIMEDOUT) {
+            return -1;
+        }
+        if (!shm_owner_alive(shm_mgr)) {
+            // Um último post pode ter chegado antes da morte do dono
+            if (shm_sem_timedwait(shm_mgr, 0) == 0) {
+                return 0;
+            }
+            errno = EOWNERDEAD;
+            return -1;
+        }
+        waited += slice;
+        if (timeout_ms >= 0 && waited >= timeout_ms) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+    }
+}
+
+int shm_acquire_owner(shm_manager_t *shm_mgr) {
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr->ptr;
+    int recovered = 0;
+    int rc = pthread_mutex_lock(&hdr->owner_lock);
+
+    if (rc == EOWNERDEAD) {
+        // O dono anterior morreu segurando o mutex. Os registros que ele não
+        // chegou a publicar nunca ficaram visíveis, então basta marcar o
+        // estado como consistente e continuar de onde o canal está.
+        rc = pthread_mutex_consistent(&hdr->owner_lock);
+        recovered = 1;
+    }
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    __atomic_add_fetch(&hdr->epoch, 1, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&hdr->owner_pid, (uint32_t)getpid(), __ATOMIC_RELEASE);
+    return recovered;
+}
+
+int shm_release_owner(shm_manager_t *shm_mgr) {
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr->ptr;
+    __atomic_store_n(&hdr->owner_pid, 0, __ATOMIC_RELEASE);
+    int rc = pthread_mutex_unlock(&hdr->owner_lock);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return 0;
+}
+
+int shm_owner_alive(shm_manager_t *shm_mgr) {
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr->ptr;
+    return pid_alive((pid_t)__atomic_load_n(&hdr->owner_pid, __ATOMIC_ACQUIRE));
+}
+
 int shm_sem_post(shm_manager_t *shm_mgr) {
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr->ptr;
+    if (__atomic_load_n(&hdr->sync_mode, __ATOMIC_ACQUIRE) == SHM_SYNC_FUTEX) {
+        return shm_futex_sem_post(&hdr->futex_sem);
+    }
     return sem_post(shm_mgr->sem);
-}
\ No newline at end of file
+}
@@ -10,8 +10,11 @@
 #ifndef SHM_HANDLER_H
 #define SHM_HANDLER_H
 
+#include <stdint.h>
 #include <sys/types.h>
 #include <semaphore.h>
+#include <pthread.h>
+#include "shm_futex.h"
 
 // Constantes para a memória compartilhada
 #define SHM_NAME "/ipc_shm"
@@ -20,6 +23,63 @@
 // Constantes para o semáforo
 #define SEM_NAME "/ipc_sem"
 
+// Diretório de montagem do hugetlbfs usado com SHM_F_HUGETLB
+#define SHM_HUGETLBFS_DIR "/dev/hugepages"
+
+// Tamanho máximo do nome de um segmento (inclui o '/' inicial)
+#define SHM_NAME_MAX 64
+
+// Sufixo do semáforo nomeado de cada canal criado com init_shm_ex()
+#define SHM_SEM_SUFFIX ".sem"
+
+// Flags de init_shm_ex()
+#define SHM_F_CREATE   0x01  // Cria o segmento (falha com EEXIST se já existir)
+#define SHM_F_REPLACE  0x02  // Com SHM_F_CREATE: remove antes um segmento de mesmo nome
+#define SHM_F_POPULATE 0x04  // MAP_POPULATE: pré-faz as faltas de página no mmap
+#define SHM_F_HUGETLB  0x08  // Segmento em hugetlbfs (fallback: THP via madvise)
+#define SHM_F_MLOCK    0x10  // mlock() do segmento inteiro após o mapeamento
+#define SHM_F_THP      0x20  // Efetivo (saída): huge pages transparentes via MADV_HUGEPAGE
+#define SHM_F_REATTACH 0x40  // Cria se não existir; senão anexa ao segmento vivo sem reformatá-lo
+
+// Tamanho de uma linha de cache (x86-64 e a maioria dos ARM64)
+#define SHM_CACHE_LINE 64
+
+// Identifica um segmento já formatado pelo criador
+#define SHM_SEGMENT_MAGIC 0x49504353u
+
+// Intervalo entre verificações de vida do dono em shm_sem_wait_robust()
+#define SHM_LIVENESS_POLL_MS 100
+
+// Mecanismos de sincronização usados por shm_sem_wait()/shm_sem_post()
+#define SHM_SYNC_SEM   0   // Semáforo POSIX nomeado (padrão)
+#define SHM_SYNC_FUTEX 1   // Semáforo spin-then-futex dentro do segmento
+
+/**
+ * @brief Cabeçalho de controle gravado no início de todo segmento.
+ * 
+ * Guarda o mecanismo de sincronização escolhido pelo criador e o semáforo
+ * futex, para que todos os processos anexados usem o mesmo caminho. Também
+ * identifica o processo dono (produtor) e sua época, protegidos por um mutex
+ * robusto: se o dono morrer, o próximo a adquirir o mutex é avisado e o
+ * canal pode ser retomado sem ser recriado. Os dados do usuário começam logo
+ * após o cabeçalho (shm_manager_t.data).
+ */
+typedef struct shm_segment_header {
+    uint32_t magic;                 // SHM_SEGMENT_MAGIC após a formatação
+    uint32_t sync_mode;             // SHM_SYNC_SEM ou SHM_SYNC_FUTEX
+    uint32_t owner_pid;             // PID do dono atual (0: nenhum)
+    uint32_t reserved;
+    uint64_t epoch;                 // Incrementada a cada troca de dono
+    char pad0[SHM_CACHE_LINE - 24];
+    shm_futex_sem_t futex_sem;      // Usado quando sync_mode == SHM_SYNC_FUTEX
+    char pad1[SHM_CACHE_LINE - sizeof(shm_futex_sem_t)];
+    pthread_mutex_t owner_lock;     // Mutex robusto mantido pelo dono enquanto vivo
+    char pad2[SHM_CACHE_LINE - sizeof(pthread_mutex_t) % SHM_CACHE_LINE];
+} shm_segment_header_t;
+
+// Bytes disponíveis para dados após o cabeçalho no segmento padrão de init_shm()
+#define SHM_DATA_SIZE (SHM_SIZE - sizeof(shm_segment_header_t))
+
 /**
  * @brief Estrutura para gerenciar a memória compartilhada e a sincronização.
  * 
@@ -30,19 +90,83 @@
 typedef struct {
     int shm_fd;        // Descritor de arquivo da memória compartilhada
     void *ptr;         // Ponteiro para a memória mapeada
+    void *data;        // Início da área de dados (após o cabeçalho de controle)
+    size_t size;       // Tamanho total mapeado (cabeçalho + dados)
+    size_t data_size;  // Bytes disponíveis em data
     sem_t *sem;        // Ponteiro para o semáforo de sincronização
     int is_creator;    // Flag que indica se este processo é o criador
+    int flags;         // Flags SHM_F_* efetivamente aplicadas
+    char name[SHM_NAME_MAX];      // Nome POSIX do segmento
+    char sem_name[SHM_NAME_MAX];  // Nome POSIX do semáforo associado
+
+    // Estado local do modo ring (ver shm_ring.h)
+    struct shm_ring_header *ring;   // Cabeçalho do ring (NULL fora do modo ring)
+    unsigned char *ring_data;       // Início da área circular de dados
+    uint64_t ring_cached_head;      // Última leitura de head feita pelo consumidor
+    uint64_t ring_cached_tail;      // Última leitura de tail feita pelo produtor
+
+    // Estado local do modo slab (ver shm_slab.h)
+    struct shm_slab_header *slab;   // Cabeçalho do alocador (NULL fora do modo slab)
+
+    // Estado local do modo broadcast (ver shm_broadcast.h)
+    struct shm_bcast_header *bcast; // Cabeçalho do canal (NULL fora do modo broadcast)
+    unsigned char *bcast_slots;     // Início dos slots
+    int bcast_reader;               // Índice do cursor deste leitor (-1: escritor)
+    uint64_t bcast_cached_min;      // Último cursor mínimo visto pelo escritor
+    uint64_t bcast_cached_write;    // Última sequência de escrita vista pelo leitor
+
+    // Estado local do modo snapshot (ver shm_snapshot.h)
+    struct shm_snapshot_header *snapshot; // Cabeçalho do seqlock (NULL fora do modo snapshot)
 } shm_manager_t;
 
 /**
  * @brief Inicializa a memória compartilhada e o semáforo.
  * 
+ * Usa o canal padrão (SHM_NAME/SEM_NAME, SHM_SIZE bytes). Ao criar, um
+ * segmento anterior com o mesmo nome só é substituído se estiver abandonado
+ * (dono morto, sem dono ou o próprio processo); se o dono gravado nele ainda
+ * estiver vivo, o segmento é preservado e a criação falha com EBUSY.
+ * 
  * @param shm_mgr Ponteiro para a estrutura do gerenciador.
  * @param create Flag: 1 para criar, 0 para apenas abrir.
- * @return 0 em sucesso, -1 em erro.
+ * @return 0 em sucesso, -1 em erro (EBUSY: o canal padrão pertence a outro processo vivo).
  */
 int init_shm(shm_manager_t *shm_mgr, int create);
 
+/**
+ * @brief Inicializa um canal de memória compartilhada configurável.
+ * 
+ * Permite vários canais independentes no mesmo host (cada um com seu nome e
+ * seu semáforo "<name>.sem") e segmentos de vários GB. As flags SHM_F_*
+ * controlam criação, pré-população das páginas, huge pages e mlock.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @param name Nome POSIX do segmento (ex: "/canal_1").
+ * @param size Bytes de dados desejados após o cabeçalho (ao abrir: mínimo exigido, ou 0).
+ * @param flags Combinação de SHM_F_CREATE, SHM_F_REPLACE, SHM_F_REATTACH, SHM_F_POPULATE, SHM_F_HUGETLB, SHM_F_MLOCK.
+ * @return 0 em sucesso, -1 em erro (EBUSY: SHM_F_REPLACE sobre um canal cujo dono está vivo).
+ * 
+ * @note Com SHM_F_REATTACH um segmento existente é apenas anexado: cabeçalho,
+ *       ring e posição do consumidor são preservados e is_creator fica 0,
+ *       então o segmento sobrevive ao cleanup_shm() deste processo.
+ * @note Com SHM_F_HUGETLB o segmento é criado em SHM_HUGETLBFS_DIR; se o
+ *       hugetlbfs não estiver montado, usa /dev/shm com MADV_HUGEPAGE e
+ *       marca SHM_F_THP em shm_mgr->flags.
+ */
+int init_shm_ex(shm_manager_t *shm_mgr, const char *name, size_t size, int flags);
+
+/**
+ * @brief Escolhe o mecanismo usado por shm_sem_wait()/shm_sem_post().
+ * 
+ * Deve ser chamada pelo criador antes de qualquer espera ou sinalização; a
+ * escolha fica gravada no segmento e vale para todos os processos anexados.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @param mode SHM_SYNC_SEM ou SHM_SYNC_FUTEX.
+ * @return 0 em sucesso, -1 em erro (não criador ou modo inválido).
+ */
+int shm_set_sync_mode(shm_manager_t *shm_mgr, int mode);
+
 /**
  * @brief Escreve dados na memória compartilhada.
  * 
@@ -73,14 +197,73 @@ int cleanup_shm(shm_manager_t *shm_mgr);
 /**
  * @brief Bloqueia (espera) no semáforo.
  * 
+ * No modo SHM_SYNC_FUTEX gira brevemente e só entra no kernel se o
+ * sinal ainda não tiver chegado.
+ * 
  * @param shm_mgr Ponteiro para a estrutura do gerenciador.
  * @return 0 em sucesso, -1 em erro.
  */
 int shm_sem_wait(shm_manager_t *shm_mgr);
 
+/**
+ * @brief Espera no semáforo por no máximo timeout_ms.
+ * 
+ * Usa sem_timedwait() no modo SHM_SYNC_SEM e o timeout do futex no modo
+ * SHM_SYNC_FUTEX.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @param timeout_ms Tempo máximo de espera em milissegundos (negativo: sem limite).
+ * @return 0 em sucesso, -1 com errno = ETIMEDOUT se o prazo esgotou.
+ */
+int shm_sem_timedwait(shm_manager_t *shm_mgr, long timeout_ms);
+
+/**
+ * @brief Espera no semáforo enquanto o dono do segmento estiver vivo.
+ * 
+ * Espera em fatias de SHM_LIVENESS_POLL_MS e, a cada fatia esgotada, verifica
+ * se o processo dono ainda existe. Assim o leitor não fica bloqueado para
+ * sempre se o escritor morrer entre a escrita e o shm_sem_post().
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @param timeout_ms Tempo máximo total (negativo: sem limite enquanto o dono viver).
+ * @return 0 em sucesso, -1 com errno = EOWNERDEAD (dono morreu) ou ETIMEDOUT.
+ */
+int shm_sem_wait_robust(shm_manager_t *shm_mgr, long timeout_ms);
+
+/**
+ * @brief Torna este processo o dono (produtor) do segmento.
+ * 
+ * Trava o mutex robusto do cabeçalho e o mantém até shm_release_owner() ou
+ * até o processo terminar. Se o dono anterior morreu segurando o mutex, o
+ * estado é marcado consistente e a função retorna 1: o chamador está
+ * retomando um canal vivo. Em ambos os casos a época é incrementada.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @return 0 se assumiu normalmente, 1 se recuperou de um dono morto, -1 em erro.
+ */
+int shm_acquire_owner(shm_manager_t *shm_mgr);
+
+/**
+ * @brief Devolve a posse do segmento adquirida com shm_acquire_owner().
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int shm_release_owner(shm_manager_t *shm_mgr);
+
+/**
+ * @brief Verifica se o processo dono do segmento ainda existe.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @return 1 se vivo, 0 se não há dono ou ele terminou.
+ */
+int shm_owner_alive(shm_manager_t *shm_mgr);
+
 /**
  * @brief Libera (posta) o semáforo.
  * 
+ * No modo SHM_SYNC_FUTEX só faz syscall se houver alguém dormindo.
+ * 
  * @param shm_mgr Ponteiro para a estrutura do gerenciador.
  * @return 0 em sucesso, -1 em erro.
  */
@@ -0,0 +1,147 @@
+#include "shm_ring.h"
+#include <string.h>
+#include <errno.h>
+
+// Marcador gravado no lugar do comprimento quando o registro não cabe no
+// final da área de dados: o consumidor pula direto para o início do ring.
+#define SHM_RING_PAD 0xFFFFFFFFu
+
+// Cada registro = comprimento (uint32_t) + payload, arredondado para 8 bytes
+#define SHM_RING_ALIGN 8
+#define SHM_RING_RECORD_SIZE(len) \
+    (((uint64_t)sizeof(uint32_t) + (len) + SHM_RING_ALIGN - 1) & ~(uint64_t)(SHM_RING_ALIGN - 1))
+
+// Maior potência de 2 menor ou igual a n
+static uint64_t floor_pow2(uint64_t n) {
+    uint64_t p = 1;
+    while (p <= n / 2) {
+        p <<= 1;
+    }
+    return p;
+}
+
+int shm_ring_init(shm_manager_t *shm_mgr) {
+    shm_ring_header_t *hdr = (shm_ring_header_t *)shm_mgr->data;
+
+    if (shm_mgr->is_creator) {
+        uint64_t capacity = floor_pow2(shm_mgr->data_size - sizeof(shm_ring_header_t));
+
+        memset(hdr, 0, sizeof(*hdr));
+        hdr->capacity = capacity;
+        __atomic_store_n(&hdr->head, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&hdr->tail, 0, __ATOMIC_RELAXED);
+        // Publica o magic por último: quem o enxergar vê o cabeçalho completo
+        __atomic_store_n(&hdr->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+    } else if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    shm_mgr->ring = hdr;
+    shm_mgr->ring_data = (unsigned char *)shm_mgr->data + sizeof(shm_ring_header_t);
+    shm_mgr->ring_cached_head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+    shm_mgr->ring_cached_tail = __atomic_load_n(&hdr->tail, __ATOMIC_ACQUIRE);
+    return 0;
+}
+
+size_t shm_ring_max_payload(const shm_manager_t *shm_mgr) {
+    // Limitar o registro a metade do ring garante que registro + padding de
+    // wrap-around sempre caibam em um ring vazio.
+    return shm_mgr->ring->capacity / 2 - sizeof(uint32_t);
+}
+
+int shm_ring_write(shm_manager_t *shm_mgr, const void *data, size_t len) {
+    shm_ring_header_t *hdr = shm_mgr->ring;
+
+    if (len > shm_ring_max_payload(shm_mgr)) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    uint64_t capacity = hdr->capacity;
+    uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_RELAXED);
+    uint64_t pos = head & (capacity - 1);
+    uint64_t contiguous = capacity - pos;
+    uint64_t record = SHM_RING_RECORD_SIZE(len);
+    uint64_t needed = record > contiguous ? contiguous + record : record;
+
+    // Só relê o tail compartilhado quando a cópia local indica ring cheio
+    if (head + needed - shm_mgr->ring_cached_tail > capacity) {
+        shm_mgr->ring_cached_tail = __atomic_load_n(&hdr->tail, __ATOMIC_ACQUIRE);
+        if (head + needed - shm_mgr->ring_cached_tail > capacity) {
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+
+    if (record > contiguous) {
+        uint32_t pad = SHM_RING_PAD;
+        memcpy(shm_mgr->ring_data + pos, &pad, sizeof(pad));
+        head += contiguous;
+        pos = 0;
+    }
+
+    uint32_t len32 = (uint32_t)len;
+    memcpy(shm_mgr->ring_data + pos, &len32, sizeof(len32));
+    memcpy(shm_mgr->ring_data + pos + sizeof(len32), data, len);
+
+    // Release: o registro fica visível antes do novo head
+    __atomic_store_n(&hdr->head, head + record, __ATOMIC_RELEASE);
+    return 0;
+}
+
+ssize_t shm_ring_read(shm_manager_t *shm_mgr, void *buffer, size_t size) {
+    shm_ring_header_t *hdr = shm_mgr->ring;
+    uint64_t capacity = hdr->capacity;
+    uint64_t tail = __atomic_load_n(&hdr->tail, __ATOMIC_RELAXED);
+
+    for (;;) {
+        if (tail == shm_mgr->ring_cached_head) {
+            shm_mgr->ring_cached_head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+            if (tail == shm_mgr->ring_cached_head) {
+                errno = EAGAIN;
+                return -1;
+            }
+        }
+
+        uint64_t pos = tail & (capacity - 1);
+        uint32_t len;
+        memcpy(&len, shm_mgr->ring_data + pos, sizeof(len));
+
+        if (len == SHM_RING_PAD) {
+            tail += capacity - pos;
+            __atomic_store_n(&hdr->tail, tail, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        if (len > size) {
+            errno = EMSGSIZE;
+            return -1;
+        }
+
+        memcpy(buffer, shm_mgr->ring_data + pos + sizeof(len), len);
+        // Release: a cópia termina antes de o produtor poder reaproveitar o espaço
+        __atomic_store_n(&hdr->tail, tail + SHM_RING_RECORD_SIZE(len), __ATOMIC_RELEASE);
+        return (ssize_t)len;
+    }
+}
+
+void shm_ring_close(shm_manager_t *shm_mgr) {
+    // Release: registros publicados antes ficam visíveis para quem vir o flag
+    __atomic_store_n(&shm_mgr->ring->closed, 1, __ATOMIC_RELEASE);
+}
+
+int shm_ring_drained(shm_manager_t *shm_mgr) {
+    shm_ring_header_t *hdr = shm_mgr->ring;
+    if (!__atomic_load_n(&hdr->closed, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+    // Lido depois do flag: um head que ainda diverge do tail tem registros a consumir
+    return __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE) == __atomic_load_n(&hdr->tail, __ATOMIC_RELAXED);
+}
+
+int shm_ring_readable(shm_manager_t *shm_mgr) {
+    shm_ring_header_t *hdr = shm_mgr->ring;
+    return __atomic_load_n(&hdr->closed, __ATOMIC_ACQUIRE) ||
+           __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE) != __atomic_load_n(&hdr->tail, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file shm_ring.h
+ * @brief Ring buffer SPSC (um produtor, um consumidor) sem locks sobre a SHM
+ * 
+ * Este arquivo define o modo "ring" do gerenciador de memória compartilhada.
+ * Em vez de sobrescrever uma única string no início do segmento, o segmento
+ * passa a conter um cabeçalho alinhado em linha de cache com os índices
+ * atômicos de escrita (head) e leitura (tail), seguido de uma área circular
+ * de registros de tamanho variável prefixados pelo comprimento.
+ * 
+ * Produtor e consumidor só se comunicam pelos índices, sem semáforo por
+ * mensagem, o que permite transmitir milhões de mensagens por segundo.
+ */
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "shm_handler.h"
+
+// Identifica um segmento já formatado como ring
+#define SHM_RING_MAGIC 0x52494e47u
+
+/**
+ * @brief Cabeçalho do ring, gravado no início da área de dados do segmento.
+ * 
+ * head e tail são contadores de bytes que só crescem; a posição na área de
+ * dados é obtida com (índice & (capacity - 1)). Cada índice ocupa sua própria
+ * linha de cache para evitar false sharing entre produtor e consumidor.
+ */
+typedef struct shm_ring_header {
+    uint32_t magic;                         // SHM_RING_MAGIC após a formatação
+    uint32_t closed;                        // 1 depois de shm_ring_close() pelo produtor
+    uint64_t capacity;                      // Bytes da área de dados (potência de 2)
+    char pad0[SHM_CACHE_LINE - 16];
+    uint64_t head;                          // Escrito apenas pelo produtor
+    char pad1[SHM_CACHE_LINE - 8];
+    uint64_t tail;                          // Escrito apenas pelo consumidor
+    char pad2[SHM_CACHE_LINE - 8];
+} shm_ring_header_t;
+
+/**
+ * @brief Coloca o gerenciador em modo ring.
+ * 
+ * O processo criador formata o cabeçalho (zera head/tail); os demais apenas
+ * validam o cabeçalho existente.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador (já inicializada).
+ * @return 0 em sucesso, -1 em erro (errno = EAGAIN se o ring ainda não foi formatado).
+ */
+int shm_ring_init(shm_manager_t *shm_mgr);
+
+/**
+ * @brief Maior payload aceito por shm_ring_write().
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador em modo ring.
+ * @return Tamanho máximo de um registro, em bytes.
+ */
+size_t shm_ring_max_payload(const shm_manager_t *shm_mgr);
+
+/**
+ * @brief Publica um registro no ring (somente o produtor).
+ * 
+ * Não bloqueia: se não houver espaço, retorna -1 com errno = EAGAIN e o
+ * chamador decide se espera ou descarta.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @param data Dados a serem copiados para o ring.
+ * @param len Tamanho dos dados.
+ * @return 0 em sucesso, -1 em erro (EAGAIN: ring cheio, EMSGSIZE: registro grande demais).
+ */
+int shm_ring_write(shm_manager_t *shm_mgr, const void *data, size_t len);
+
+/**
+ * @brief Consome o próximo registro do ring (somente o consumidor).
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @param buffer Buffer de destino.
+ * @param size Tamanho do buffer.
+ * @return Tamanho do registro lido, ou -1 em erro (EAGAIN: ring vazio,
+ *         EMSGSIZE: buffer menor que o registro, que permanece no ring).
+ */
+ssize_t shm_ring_read(shm_manager_t *shm_mgr, void *buffer, size_t size);
+
+/**
+ * @brief Marca o fim do fluxo (somente o produtor); registros já publicados continuam legíveis.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ */
+void shm_ring_close(shm_manager_t *shm_mgr);
+
+/**
+ * @brief 1 se o produtor fechou o ring e não resta registro a consumir.
+ * 
+ * O consumidor chama depois de um shm_ring_read() com EAGAIN para
+ * distinguir ring momentaneamente vazio de fim do fluxo.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @return 1 no fim do fluxo, 0 caso contrário.
+ */
+int shm_ring_drained(shm_manager_t *shm_mgr);
+
+/**
+ * @brief 1 se o consumidor tem algo a ver: um registro publicado ou o fim do fluxo.
+ * 
+ * Condição para o consumidor deixar de esperar (ex: antes de dormir num futex).
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @return 1 se há registro ou o ring foi fechado, 0 se está vazio e aberto.
+ */
+int shm_ring_readable(shm_manager_t *shm_mgr);
+
+#endif // SHM_RING_H
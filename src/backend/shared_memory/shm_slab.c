@@ -0,0 +1,177 @@
+#include "shm_slab.h"
+#include <string.h>
+#include <errno.h>
+
+// Blocos grandes começam em fronteira de página; os pequenos, de linha de cache
+#define SHM_SLAB_PAGE 4096
+#define SHM_SLAB_INDEX_MASK 0xFFFFFFFFull
+
+static uint64_t align_up(uint64_t value, uint64_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static uint32_t *next_array(shm_manager_t *shm_mgr, const shm_slab_class_t *cls) {
+    return (uint32_t *)((char *)shm_mgr->ptr + cls->next);
+}
+
+// Encontra a classe e o índice do bloco de um handle; -1 se inválido
+static int locate(shm_manager_t *shm_mgr, shm_handle_t handle, shm_slab_class_t **cls_out, uint32_t *index_out) {
+    shm_slab_header_t *hdr = shm_mgr->slab;
+    if (!hdr) {
+        return -1;
+    }
+    for (uint32_t c = 0; c < hdr->class_count; c++) {
+        shm_slab_class_t *cls = &hdr->classes[c];
+        uint64_t end = cls->base + cls->block_count * cls->block_stride;
+        if (handle >= cls->base && handle < end) {
+            if ((handle - cls->base) % cls->block_stride != 0) {
+                return -1;
+            }
+            *cls_out = cls;
+            *index_out = (uint32_t)((handle - cls->base) / cls->block_stride);
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static void push_free(shm_manager_t *shm_mgr, shm_slab_class_t *cls, uint32_t index) {
+    uint32_t *next = next_array(shm_mgr, cls);
+    uint64_t head = __atomic_load_n(&cls->free_head, __ATOMIC_RELAXED);
+    uint64_t desired;
+    do {
+        __atomic_store_n(&next[index], (uint32_t)(head & SHM_SLAB_INDEX_MASK), __ATOMIC_RELAXED);
+        // A tag é incrementada a cada troca do topo, o que invalida um CAS
+        // concorrente que tenha lido o mesmo índice antes de um pop/push (ABA)
+        desired = (((head >> 32) + 1) << 32) | (uint64_t)(index + 1);
+    } while (!__atomic_compare_exchange_n(&cls->free_head, &head, desired, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static int pop_free(shm_manager_t *shm_mgr, shm_slab_class_t *cls, uint32_t *index) {
+    uint32_t *next = next_array(shm_mgr, cls);
+    uint64_t head = __atomic_load_n(&cls->free_head, __ATOMIC_ACQUIRE);
+    uint64_t desired;
+    do {
+        uint32_t top = (uint32_t)(head & SHM_SLAB_INDEX_MASK);
+        if (top == 0) {
+            return -1;
+        }
+        *index = top - 1;
+        uint32_t after = __atomic_load_n(&next[top - 1], __ATOMIC_RELAXED);
+        desired = (((head >> 32) + 1) << 32) | after;
+    } while (!__atomic_compare_exchange_n(&cls->free_head, &head, desired, 1,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+    return 0;
+}
+
+int shm_slab_init(shm_manager_t *shm_mgr, const shm_slab_class_config_t *classes, int class_count) {
+    shm_slab_header_t *hdr = (shm_slab_header_t *)shm_mgr->data;
+
+    if (!shm_mgr->is_creator) {
+        if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHM_SLAB_MAGIC) {
+            errno = EAGAIN;
+            return -1;
+        }
+        shm_mgr->slab = hdr;
+        return 0;
+    }
+
+    if (class_count < 1 || class_count > SHM_SLAB_MAX_CLASSES) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Layout (offsets a partir do início do segmento):
+    // [cabeçalho do segmento][cabeçalho slab][vetores next][blocos classe 0][blocos classe 1]...
+    uint64_t data_start = (uint64_t)((char *)shm_mgr->data - (char *)shm_mgr->ptr);
+    uint64_t cursor = data_start + sizeof(shm_slab_header_t);
+
+    memset(hdr, 0, sizeof(*hdr));
+    for (int c = 0; c < class_count; c++) {
+        if (classes[c].block_size == 0 || classes[c].block_count == 0 ||
+            (c > 0 && classes[c].block_size <= classes[c - 1].block_size)) {
+            errno = EINVAL;
+            return -1;
+        }
+        shm_slab_class_t *cls = &hdr->classes[c];
+        cls->block_size = classes[c].block_size;
+        cls->block_count = classes[c].block_count;
+        cls->next = cursor;
+        cursor += (uint64_t)classes[c].block_count * sizeof(uint32_t);
+    }
+    for (int c = 0; c < class_count; c++) {
+        shm_slab_class_t *cls = &hdr->classes[c];
+        uint64_t align = cls->block_size >= SHM_SLAB_PAGE ? SHM_SLAB_PAGE : SHM_CACHE_LINE;
+        cls->block_stride = align_up(cls->block_size, align);
+        cls->base = align_up(cursor, align);
+        cursor = cls->base + cls->block_count * cls->block_stride;
+    }
+    if (cursor > shm_mgr->size) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    shm_mgr->slab = hdr;
+    hdr->class_count = (uint32_t)class_count;
+    for (int c = 0; c < class_count; c++) {
+        shm_slab_class_t *cls = &hdr->classes[c];
+        // Empilha do último para o primeiro: os blocos de menor endereço saem antes
+        for (uint64_t i = cls->block_count; i > 0; i--) {
+            push_free(shm_mgr, cls, (uint32_t)(i - 1));
+        }
+    }
+    __atomic_store_n(&hdr->magic, SHM_SLAB_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void *shm_slab_alloc(shm_manager_t *shm_mgr, size_t size, shm_handle_t *handle) {
+    shm_slab_header_t *hdr = shm_mgr->slab;
+    int fits = 0;
+
+    for (uint32_t c = 0; c < hdr->class_count; c++) {
+        shm_slab_class_t *cls = &hdr->classes[c];
+        uint32_t index;
+        if (cls->block_size < size) {
+            continue;
+        }
+        fits = 1;
+        if (pop_free(shm_mgr, cls, &index) == 0) {
+            *handle = cls->base + (uint64_t)index * cls->block_stride;
+            return (char *)shm_mgr->ptr + *handle;
+        }
+    }
+
+    *handle = SHM_HANDLE_NULL;
+    errno = fits ? ENOMEM : EMSGSIZE;
+    return NULL;
+}
+
+void *shm_slab_ptr(shm_manager_t *shm_mgr, shm_handle_t handle) {
+    shm_slab_class_t *cls;
+    uint32_t index;
+    if (locate(shm_mgr, handle, &cls, &index) == -1) {
+        return NULL;
+    }
+    return (char *)shm_mgr->ptr + handle;
+}
+
+size_t shm_slab_block_size(shm_manager_t *shm_mgr, shm_handle_t handle) {
+    shm_slab_class_t *cls;
+    uint32_t index;
+    if (locate(shm_mgr, handle, &cls, &index) == -1) {
+        return 0;
+    }
+    return cls->block_size;
+}
+
+int shm_slab_free(shm_manager_t *shm_mgr, shm_handle_t handle) {
+    shm_slab_class_t *cls;
+    uint32_t index;
+    if (locate(shm_mgr, handle, &cls, &index) == -1) {
+        errno = EINVAL;
+        return -1;
+    }
+    push_free(shm_mgr, cls, index);
+    return 0;
+}
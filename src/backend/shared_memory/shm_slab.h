@@ -0,0 +1,119 @@
+/**
+ * @file shm_slab.h
+ * @brief Alocador slab zero-copy dentro de um segmento de memória compartilhada
+ * 
+ * O segmento é dividido em classes de blocos de tamanho fixo, cada uma com
+ * uma free list sem locks (pilha de Treiber com tag contra ABA) guardada no
+ * próprio segmento. O produtor obtém um ponteiro para preencher o bloco no
+ * lugar e publica apenas um handle (offset a partir do início do segmento);
+ * o consumidor converte o handle de volta em ponteiro, lê no lugar e libera
+ * o bloco. Nenhum byte do payload é copiado entre os processos.
+ */
+
+#ifndef SHM_SLAB_H
+#define SHM_SLAB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "shm_handler.h"
+
+// Identifica um segmento já formatado como slab
+#define SHM_SLAB_MAGIC 0x534c4142u
+
+// Número máximo de classes de tamanho por segmento
+#define SHM_SLAB_MAX_CLASSES 16
+
+/**
+ * @brief Handle de um bloco: offset em bytes a partir de shm_manager_t.ptr.
+ * 
+ * Vale em qualquer processo que tenha mapeado o mesmo segmento, mesmo que
+ * o endereço virtual do mapeamento seja diferente. 0 nunca é um bloco válido.
+ */
+typedef uint64_t shm_handle_t;
+
+#define SHM_HANDLE_NULL ((shm_handle_t)0)
+
+/**
+ * @brief Configuração de uma classe de tamanho (usada só pelo criador).
+ */
+typedef struct {
+    size_t block_size;      // Capacidade de cada bloco, em bytes
+    uint32_t block_count;   // Quantidade de blocos da classe
+} shm_slab_class_config_t;
+
+/**
+ * @brief Estado compartilhado de uma classe, em sua própria linha de cache.
+ */
+typedef struct {
+    uint64_t block_size;    // Capacidade de cada bloco
+    uint64_t block_stride;  // Distância entre blocos consecutivos (alinhada)
+    uint64_t block_count;   // Quantidade de blocos
+    uint64_t base;          // Offset do primeiro bloco a partir do início do segmento
+    uint64_t next;          // Offset do vetor de próximos (uint32_t por bloco)
+    uint64_t free_head;     // Topo da free list: (tag << 32) | (índice + 1); 0 = vazia
+    char pad[SHM_CACHE_LINE - 48];
+} shm_slab_class_t;
+
+/**
+ * @brief Cabeçalho do alocador, gravado no início da área de dados.
+ */
+typedef struct shm_slab_header {
+    uint32_t magic;             // SHM_SLAB_MAGIC após a formatação
+    uint32_t class_count;       // Classes configuradas
+    char pad[SHM_CACHE_LINE - 8];
+    shm_slab_class_t classes[SHM_SLAB_MAX_CLASSES];
+} shm_slab_header_t;
+
+/**
+ * @brief Coloca o gerenciador em modo slab.
+ * 
+ * O criador formata as classes (ordenadas por tamanho crescente) e preenche
+ * as free lists; os demais processos apenas validam o cabeçalho.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador (já inicializada).
+ * @param classes Configuração das classes (ignorada se não for o criador).
+ * @param class_count Número de classes (1 a SHM_SLAB_MAX_CLASSES).
+ * @return 0 em sucesso, -1 em erro (ENOSPC: classes não cabem no segmento,
+ *         EAGAIN: segmento ainda não formatado).
+ */
+int shm_slab_init(shm_manager_t *shm_mgr, const shm_slab_class_config_t *classes, int class_count);
+
+/**
+ * @brief Reserva um bloco com pelo menos size bytes.
+ * 
+ * Usa a menor classe que comporte o pedido; se ela estiver esgotada, tenta
+ * as classes maiores. O bloco é de uso exclusivo de quem o recebeu até ser
+ * passado adiante (pelo handle) e liberado.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @param size Bytes necessários.
+ * @param handle Recebe o handle do bloco.
+ * @return Ponteiro para o bloco, ou NULL com errno = ENOMEM (sem blocos livres)
+ *         ou EMSGSIZE (maior que a maior classe).
+ */
+void *shm_slab_alloc(shm_manager_t *shm_mgr, size_t size, shm_handle_t *handle);
+
+/**
+ * @brief Converte um handle em ponteiro no espaço de endereçamento local.
+ * 
+ * @return Ponteiro para o bloco, ou NULL se o handle não for válido.
+ */
+void *shm_slab_ptr(shm_manager_t *shm_mgr, shm_handle_t handle);
+
+/**
+ * @brief Capacidade do bloco identificado pelo handle.
+ * 
+ * @return Bytes utilizáveis no bloco, ou 0 se o handle não for válido.
+ */
+size_t shm_slab_block_size(shm_manager_t *shm_mgr, shm_handle_t handle);
+
+/**
+ * @brief Devolve o bloco à free list da sua classe.
+ * 
+ * Pode ser chamada por qualquer processo anexado (normalmente o consumidor).
+ * 
+ * @return 0 em sucesso, -1 com errno = EINVAL se o handle não for válido.
+ */
+int shm_slab_free(shm_manager_t *shm_mgr, shm_handle_t handle);
+
+#endif // SHM_SLAB_H
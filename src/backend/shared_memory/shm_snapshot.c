@@ -0,0 +1,79 @@
+#include "shm_snapshot.h"
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+
+// Tentativas rasgadas seguidas antes de ceder a CPU ao escritor
+#define SHM_SNAPSHOT_SPIN 64
+
+int shm_snapshot_init(shm_manager_t *shm_mgr) {
+    shm_snapshot_header_t *hdr = (shm_snapshot_header_t *)shm_mgr->data;
+
+    if (shm_mgr->is_creator) {
+        memset(hdr, 0, sizeof(*hdr));
+        hdr->capacity = shm_mgr->data_size - sizeof(shm_snapshot_header_t);
+        __atomic_store_n(&hdr->magic, SHM_SNAPSHOT_MAGIC, __ATOMIC_RELEASE);
+    } else if (__atomic_load_n(&hdr->magic, __ATOMIC_ACQUIRE) != SHM_SNAPSHOT_MAGIC) {
+        errno = EAGAIN;
+        return -1;
+    }
+    shm_mgr->snapshot = hdr;
+    return 0;
+}
+
+int shm_snapshot_write(shm_manager_t *shm_mgr, const void *data, size_t len) {
+    shm_snapshot_header_t *hdr = shm_mgr->snapshot;
+    unsigned char *value = (unsigned char *)(hdr + 1);
+
+    if (len > hdr->capacity) {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    uint64_t seq = __atomic_load_n(&hdr->seq, __ATOMIC_RELAXED);
+    // Sequência ímpar: leitores que começarem agora vão repetir
+    __atomic_store_n(&hdr->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    __atomic_store_n(&hdr->len, (uint64_t)len, __ATOMIC_RELAXED);
+    memcpy(value, data, len);
+
+    // Sequência par: o novo valor está completo
+    __atomic_store_n(&hdr->seq, seq + 2, __ATOMIC_RELEASE);
+    return 0;
+}
+
+ssize_t shm_snapshot_read(shm_manager_t *shm_mgr, void *buffer, size_t size, uint64_t *version) {
+    shm_snapshot_header_t *hdr = shm_mgr->snapshot;
+    const unsigned char *value = (const unsigned char *)(hdr + 1);
+    unsigned attempts = 0;
+
+    for (;;) {
+        uint64_t begin = __atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE);
+        if (begin == 0) {
+            errno = ENODATA;
+            return -1;
+        }
+        if ((begin & 1) == 0) {
+            uint64_t len = __atomic_load_n(&hdr->len, __ATOMIC_RELAXED);
+            size_t copy = len <= size ? (size_t)len : 0;
+            memcpy(buffer, value, copy);
+
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&hdr->seq, __ATOMIC_RELAXED) == begin) {
+                if (len > size) {
+                    errno = EMSGSIZE;
+                    return -1;
+                }
+                if (version) {
+                    *version = begin;
+                }
+                return (ssize_t)len;
+            }
+        }
+        // Escrita em andamento ou leitura rasgada: tenta de novo
+        if (++attempts % SHM_SNAPSHOT_SPIN == 0) {
+            sched_yield();
+        }
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file shm_snapshot.h
+ * @brief Modo "snapshot": último valor publicado, protegido por seqlock
+ * 
+ * Para consumidores que só precisam do valor mais recente (configuração,
+ * estado de mercado, métricas). O escritor incrementa a sequência para um
+ * valor ímpar antes de atualizar e para par depois; o leitor copia o valor e
+ * repete a leitura se a sequência mudou ou era ímpar (leitura rasgada).
+ * Leitores nunca bloqueiam o escritor e nunca usam semáforo.
+ */
+
+#ifndef SHM_SNAPSHOT_H
+#define SHM_SNAPSHOT_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "shm_handler.h"
+
+// Identifica um segmento já formatado como snapshot
+#define SHM_SNAPSHOT_MAGIC 0x534e4150u
+
+/**
+ * @brief Cabeçalho do snapshot, gravado no início da área de dados.
+ */
+typedef struct shm_snapshot_header {
+    uint32_t magic;             // SHM_SNAPSHOT_MAGIC após a formatação
+    uint32_t reserved;
+    uint64_t capacity;          // Bytes disponíveis para o valor
+    char pad0[SHM_CACHE_LINE - 16];
+    uint64_t seq;               // Ímpar durante uma escrita; 0 = nenhum valor ainda
+    uint64_t len;               // Tamanho do valor atual
+    char pad1[SHM_CACHE_LINE - 16];
+} shm_snapshot_header_t;
+
+/**
+ * @brief Formata (criador) ou valida (demais) o snapshot no segmento.
+ * 
+ * @return 0 em sucesso, -1 em erro (EAGAIN: ainda não formatado).
+ */
+int shm_snapshot_init(shm_manager_t *shm_mgr);
+
+/**
+ * @brief Publica um novo valor (um único escritor por segmento).
+ * 
+ * @return 0 em sucesso, -1 com errno = EMSGSIZE se o valor não couber.
+ */
+int shm_snapshot_write(shm_manager_t *shm_mgr, const void *data, size_t len);
+
+/**
+ * @brief Copia o valor mais recente, repetindo se a leitura for rasgada.
+ * 
+ * @param shm_mgr Ponteiro para a estrutura do gerenciador.
+ * @param buffer Buffer de destino.
+ * @param size Tamanho do buffer.
+ * @param version Recebe a sequência do valor lido (pode ser NULL).
+ * @return Tamanho do valor, ou -1 em erro (ENODATA: nada publicado ainda,
+ *         EMSGSIZE: buffer menor que o valor).
+ */
+ssize_t shm_snapshot_read(shm_manager_t *shm_mgr, void *buffer, size_t size, uint64_t *version);
+
+#endif // SHM_SNAPSHOT_H
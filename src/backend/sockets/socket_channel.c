@@ -0,0 +1,49 @@
+#define _GNU_SOURCE
+#include "../common/ipc_channel.h"
+#include <unistd.h>
+#include <sys/socket.h>
+
+// Transporte "unix" de ipc_channel.h: socketpair() AF_UNIX SOCK_STREAM, fds[0] no lado 0 e fds[1] no lado 1
+
+static int socket_channel_open(ipc_channel_t *ch, const ipc_channel_config_t *cfg) {
+    int size = cfg->capacity > (size_t)(1 << 30) ? 1 << 30 : (int)cfg->capacity;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, ch->fds) == -1) {
+        return -1;
+    }
+    if (ipc_channel_fd_init(ch) == -1) {
+        close(ch->fds[0]);
+        close(ch->fds[1]);
+        return -1;
+    }
+    // O kernel limita a net.core.wmem_max/rmem_max; falha aqui só deixa o padrão
+    for (int i = 0; i < 2; i++) {
+        setsockopt(ch->fds[i], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+        setsockopt(ch->fds[i], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    return 0;
+}
+
+static void socket_channel_attach(ipc_channel_t *ch, int side) {
+    ch->send_fd = ch->recv_fd = ch->fds[side];
+    close(ch->fds[1 - side]);
+}
+
+static void socket_channel_close(ipc_channel_t *ch) {
+    if (ch->side == -1) {
+        close(ch->fds[0]);
+        close(ch->fds[1]);
+    }
+    ipc_channel_fd_close(ch);
+}
+
+const ipc_channel_ops_t ipc_channel_unix_ops = {
+    "unix",
+    socket_channel_open,
+    socket_channel_attach,
+    ipc_channel_fd_send,
+    ipc_channel_fd_recv,
+    ipc_channel_fd_send_batch,
+    ipc_channel_fd_recv_batch,
+    socket_channel_close,
+};
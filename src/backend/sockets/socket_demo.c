@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,24 +7,131 @@
 #include <sys/un.h>
 #include <sys/wait.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <time.h>
 
 #include "socket_demo.h"
+#include "socket_epoll.h"
+#include "socket_mmsg.h"
+#include "socket_fdpass.h"
+#include "socket_ready.h"
 #include "../common/json_output.h"
+#include "../common/affinity.h"
+#include "../common/ipc_uring_bench.h"
+#include "../common/ipc_channel.h"
 
-#define BUFFER_SIZE 256
+// Maior mensagem do eco: um único argumento do execve() não passa de MAX_ARG_STRLEN (128 KB)
+#define SOCKET_DEMO_MAX_MESSAGE (128 * 1024)
+#define SOCKET_DEMO_ECHO_PREFIX "Eco do servidor: "
 
-void run_server();
-void run_client(const char* message);
+void run_server(const char* name, size_t fdpass_size, int ready_fd);
+void run_client(const char* name, const char* message, size_t fdpass_size, int ready_fd);
 
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        print_json_error("socket", "Uso: ./socket_demo <mensagem>", getpid());
+    // --abstract antes dos demais argumentos: socket no namespace abstrato em vez de SOCKET_PATH
+    char name[sizeof(((struct sockaddr_un *)0)->sun_path)] = SOCKET_PATH;
+    if (argc >= 2 && strcmp(argv[1], "--abstract") == 0) {
+        snprintf(name, sizeof(name), SOCKET_ABSTRACT_FORMAT, (int)getpid());
+        argv++;
+        argc--;
+    }
+    // Modo servidor epoll: --epoll <clientes> [--messages <N>] [--size <bytes>] [--threads <T>]
+    if (argc >= 3 && strcmp(argv[1], "--epoll") == 0) {
+        socket_epoll_config_t cfg = { atoi(argv[2]), SOCKET_EPOLL_DEFAULT_MESSAGES, SOCKET_EPOLL_DEFAULT_SIZE, 1 };
+        int ok = cfg.clients > 0 && cfg.clients <= SOCKET_EPOLL_MAX_CLIENTS;
+        for (int i = 3; ok && i < argc; i += 2) {
+            const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+            if (strcmp(argv[i], "--messages") == 0 && value && atol(value) > 0) {
+                cfg.messages = atol(value);
+            } else if (strcmp(argv[i], "--size") == 0 && value && strtoul(value, NULL, 10) > 0 &&
+                       strtoul(value, NULL, 10) <= SOCKET_EPOLL_MAX_FRAME) {
+                cfg.size = strtoul(value, NULL, 10);
+            } else if (strcmp(argv[i], "--threads") == 0 && value && atoi(value) > 0 &&
+                       atoi(value) <= SOCKET_EPOLL_MAX_THREADS) {
+                cfg.threads = atoi(value);
+            } else {
+                ok = 0;
+            }
+        }
+        if (ok) {
+            return socket_epoll_run(&cfg);
+        }
+    }
+    // Modo lote: --mmsg <mensagens> [--type stream|dgram|seqpacket|all] [--size <bytes>] [--batch <N>]
+    if (argc >= 3 && strcmp(argv[1], "--mmsg") == 0) {
+        socket_mmsg_config_t cfg = { atol(argv[2]), SOCKET_MMSG_DEFAULT_SIZE, SOCKET_MMSG_DEFAULT_BATCH, SOCKET_MMSG_ALL };
+        int ok = cfg.messages > 0;
+        for (int i = 3; ok && i < argc; i += 2) {
+            const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+            if (strcmp(argv[i], "--type") == 0 && value && socket_mmsg_parse_type(value)) {
+                cfg.types = socket_mmsg_parse_type(value);
+            } else if (strcmp(argv[i], "--size") == 0 && value && strtoul(value, NULL, 10) >= SOCKET_MMSG_MIN_SIZE &&
+                       strtoul(value, NULL, 10) <= SOCKET_MMSG_MAX_SIZE) {
+                cfg.size = strtoul(value, NULL, 10);
+            } else if (strcmp(argv[i], "--batch") == 0 && value && atoi(value) > 0 &&
+                       atoi(value) <= SOCKET_MMSG_MAX_BATCH) {
+                cfg.batch = atoi(value);
+            } else {
+                ok = 0;
+            }
+        }
+        if (ok) {
+            return socket_mmsg_run(&cfg);
+        }
+    }
+    // Modo io_uring: --uring <mensagens> [--size <bytes>] [--depth <N>] [--sqpoll]
+    if (argc >= 3 && strcmp(argv[1], "--uring") == 0) {
+        ipc_uring_bench_config_t cfg = { IPC_URING_BENCH_SOCKET, atol(argv[2]), IPC_URING_BENCH_DEFAULT_SIZE,
+                                         IPC_URING_BENCH_DEFAULT_DEPTH, 0 };
+        int ok = cfg.messages > 0;
+        for (int i = 3; ok && i < argc; i += 2) {
+            const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+            if (strcmp(argv[i], "--sqpoll") == 0) {
+                cfg.sqpoll = 1;
+                i--;
+            } else if (strcmp(argv[i], "--size") == 0 && value && strtoul(value, NULL, 10) >= IPC_URING_BENCH_MIN_SIZE &&
+                       strtoul(value, NULL, 10) <= IPC_URING_BENCH_MAX_SIZE) {
+                cfg.size = strtoul(value, NULL, 10);
+            } else if (strcmp(argv[i], "--depth") == 0 && value && atoi(value) > 0 &&
+                       atoi(value) <= IPC_URING_BENCH_MAX_DEPTH) {
+                cfg.depth = atoi(value);
+            } else {
+                ok = 0;
+            }
+        }
+        if (ok) {
+            return ipc_uring_bench_run("socket", &cfg);
+        }
+    }
+    // Modo fdpass: --fdpass <bytes> <mensagem>; após o eco, a mensagem repetida vai num memfd selado
+    size_t fdpass_size = 0;
+    const char *message = argc == 2 ? argv[1] : NULL;
+    if (argc == 4 && strcmp(argv[1], "--fdpass") == 0 && strtoul(argv[2], NULL, 10) > 0 &&
+        strtoul(argv[2], NULL, 10) <= SOCKET_FDPASS_MAX_SIZE && argv[3][0] != '\0') {
+        fdpass_size = strtoul(argv[2], NULL, 10);
+        message = argv[3];
+    }
+    if (!message || (!fdpass_size && strncmp(message, "--", 2) == 0)) {
+        print_json_error("socket", "Uso: ./socket_demo [--abstract] <mensagem> | ./socket_demo --epoll <clientes> "
+                         "[--messages <N>] [--size <bytes>] [--threads <T>] | ./socket_demo --mmsg <mensagens> "
+                         "[--type stream|dgram|seqpacket|all] [--size <bytes>] [--batch <N>] | "
+                         "./socket_demo [--abstract] --fdpass <bytes> <mensagem> | ./socket_demo --uring <mensagens> "
+                         "[--size <bytes>] [--depth <N>] [--sqpoll]", getpid());
         return 1;
     }
 
-    // Garante que o arquivo de socket de uma execução anterior seja removido
-    unlink(SOCKET_PATH);
-    
+    // Garante que o arquivo de socket de uma execução anterior seja removido (o abstrato não deixa arquivo)
+    if (!socket_addr_is_abstract(name)) {
+        unlink(name);
+    }
+
+    // Pipe de prontidão: o servidor escreve um byte depois do listen(), o cliente espera nele
+    int ready[2];
+    if (pipe2(ready, O_CLOEXEC) == -1) {
+        print_json_error("socket", "Falha ao criar o pipe de prontidão", getpid());
+        exit(EXIT_FAILURE);
+    }
+
     print_json_status("socket", "fork", "Criando processo filho (cliente)...", getpid());
     pid_t pid = fork();
 
@@ -34,11 +142,13 @@ int main(int argc, char *argv[]) {
 
     if (pid == 0) {
         // Processo Filho (Cliente)
-        run_client(argv[1]);
+        close(ready[1]);
+        run_client(name, message, fdpass_size, ready[0]);
         exit(EXIT_SUCCESS);
     } else {
         // Processo Pai (Servidor)
-        run_server();
+        close(ready[0]);
+        run_server(name, fdpass_size, ready[1]);
         print_json_status("socket", "parent_wait", "Servidor aguardando término do cliente...", getpid());
         wait(NULL);
         print_json_status("socket", "shutdown", "Comunicação via socket finalizada.", getpid());
@@ -47,42 +157,51 @@ int main(int argc, char *argv[]) {
     return 0;
 }
 
-void run_server() {
+void run_server(const char* name, size_t fdpass_size, int ready_fd) {
     pid_t pid = getpid();
     char status_msg[512];
     
     print_json_status("socket_server", "init", "Servidor (Pai) iniciado.", pid);
+    // O servidor recebe a mensagem: papel de consumidor
+    ipc_affinity_apply("socket_server", IPC_ROLE_CONSUMER);
 
     // 1. Criar o socket
     int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
     if (server_fd == -1) {
         print_json_error("socket_server", "Falha ao criar socket", pid);
+        close(ready_fd);
         return;
     }
     print_json_status("socket_server", "socket_ok", "Socket do servidor criado.", pid);
 
     // 2. Configurar o endereço e fazer o bind
     struct sockaddr_un server_addr;
-    memset(&server_addr, 0, sizeof(struct sockaddr_un));
-    server_addr.sun_family = AF_UNIX;
-    strncpy(server_addr.sun_path, SOCKET_PATH, sizeof(server_addr.sun_path) - 1);
+    socklen_t addr_len;
 
-    if (bind(server_fd, (struct sockaddr*)&server_addr, sizeof(struct sockaddr_un)) == -1) {
+    if (socket_addr_init(&server_addr, &addr_len, name) == -1 ||
+        bind(server_fd, (struct sockaddr*)&server_addr, addr_len) == -1) {
         print_json_error("socket_server", "Falha no bind", pid);
         close(server_fd);
+        close(ready_fd);
         return;
     }
-    snprintf(status_msg, sizeof(status_msg), "Socket associado ao caminho: %s", SOCKET_PATH);
+    snprintf(status_msg, sizeof(status_msg), "Socket associado ao %s: %s",
+             socket_addr_is_abstract(name) ? "nome abstrato" : "caminho", name);
     print_json_status("socket_server", "bind_ok", status_msg, pid);
 
     // 3. Escutar por conexões
     if (listen(server_fd, 5) == -1) {
         print_json_error("socket_server", "Falha no listen", pid);
         close(server_fd);
+        close(ready_fd);
         return;
     }
     print_json_status("socket_server", "listening", "Servidor escutando por conexões...", pid);
 
+    // 3b. Avisar o cliente: a partir daqui o connect() dele é aceito na fila do listen()
+    socket_ready_notify(ready_fd);
+    close(ready_fd);
+
     // 4. Aceitar a conexão do cliente (bloqueante)
     int client_fd = accept(server_fd, NULL, NULL);
     if (client_fd == -1) {
@@ -92,72 +211,116 @@ void run_server() {
     }
     print_json_status("socket_server", "accepted", "Conexão do cliente aceita.", pid);
 
+    // A conexão aceita vira um canal "unix" da libipc: mensagens em quadros, nada truncado
+    ipc_channel_t conn;
+    if (ipc_channel_adopt_fd(&conn, client_fd) == -1) {
+        print_json_error("socket_server", "Falha ao preparar o canal da conexão", pid);
+        close(client_fd);
+        close(server_fd);
+        return;
+    }
+
     // 5. Receber dados do cliente (bloqueante)
-    char buffer[BUFFER_SIZE];
+    char *buffer = malloc(SOCKET_DEMO_MAX_MESSAGE + 1);
+    size_t num_bytes = 0;
     print_json_status("socket_server", "recv_wait", "Servidor aguardando mensagem do cliente...", pid);
-    ssize_t num_bytes = recv(client_fd, buffer, BUFFER_SIZE - 1, 0);
-    
-    if (num_bytes > 0) {
+
+    if (buffer && ipc_channel_recv(&conn, buffer, SOCKET_DEMO_MAX_MESSAGE, &num_bytes) == 1) {
         buffer[num_bytes] = '\0';
-        snprintf(status_msg, sizeof(status_msg), "Servidor recebeu %zd bytes.", num_bytes);
+        snprintf(status_msg, sizeof(status_msg), "Servidor recebeu %zu bytes.", num_bytes);
         print_json_status("socket_server", "recv_ok", status_msg, pid);
         print_json_data("socket_server", buffer, "cliente -> servidor", pid);
 
         // 6. Enviar uma resposta (eco)
-        char response[BUFFER_SIZE];
-        snprintf(response, sizeof(response), "Eco do servidor: %s", buffer);
+        size_t response_size = num_bytes + sizeof(SOCKET_DEMO_ECHO_PREFIX);
+        char *response = malloc(response_size);
         print_json_status("socket_server", "send_echo", "Servidor enviando eco para o cliente...", pid);
-        send(client_fd, response, strlen(response), 0);
+        if (response) {
+            snprintf(response, response_size, SOCKET_DEMO_ECHO_PREFIX "%s", buffer);
+            ipc_channel_send(&conn, response, strlen(response));
+            free(response);
+        }
 
+        // 6b. A mesma conexão passa a transportar o descritor do buffer compartilhado
+        if (fdpass_size > 0) {
+            socket_fdpass_serve(ipc_channel_fd(&conn));
+        }
     } else {
         print_json_error("socket_server", "Falha ao receber dados do cliente", pid);
     }
+    free(buffer);
 
     // 7. Fechar os descritores e limpar
-    close(client_fd);
+    ipc_channel_close(&conn);
     close(server_fd);
-    unlink(SOCKET_PATH);
+    if (!socket_addr_is_abstract(name)) {
+        unlink(name);
+    }
     print_json_status("socket_server", "closed", "Recursos do servidor liberados.", pid);
 }
 
-void run_client(const char* message) {
+void run_client(const char* name, const char* message, size_t fdpass_size, int ready_fd) {
     pid_t pid = getpid();
     char status_msg[512];
 
     print_json_status("socket_client", "init", "Cliente (Filho) iniciado.", pid);
+    ipc_affinity_apply("socket_client", IPC_ROLE_PRODUCER);
 
     // 1. Criar o socket
     int client_fd = socket(AF_UNIX, SOCK_STREAM, 0);
     if (client_fd == -1) {
         print_json_error("socket_client", "Falha ao criar socket", pid);
+        close(ready_fd);
         return;
     }
     print_json_status("socket_client", "socket_ok", "Socket do cliente criado.", pid);
 
     // 2. Configurar o endereço do servidor
     struct sockaddr_un server_addr;
-    memset(&server_addr, 0, sizeof(struct sockaddr_un));
-    server_addr.sun_family = AF_UNIX;
-    strncpy(server_addr.sun_path, SOCKET_PATH, sizeof(server_addr.sun_path) - 1);
-
-    // Adiciona um pequeno atraso para dar tempo ao servidor de iniciar.
-    // Em um cenário real, usaríamos um loop de retentativa.
-    usleep(100000); // 100ms
+    socklen_t addr_len;
+    if (socket_addr_init(&server_addr, &addr_len, name) == -1) {
+        print_json_error("socket_client", "Endereço do socket inválido", pid);
+        close(client_fd);
+        close(ready_fd);
+        return;
+    }
 
-    // 3. Conectar ao servidor (bloqueante)
-    snprintf(status_msg, sizeof(status_msg), "Cliente tentando conectar a %s...", SOCKET_PATH);
+    // 3. Esperar o aviso do servidor (em vez de um atraso fixo) e conectar
+    snprintf(status_msg, sizeof(status_msg), "Cliente tentando conectar a %s...", name);
     print_json_status("socket_client", "connecting", status_msg, pid);
-    if (connect(client_fd, (struct sockaddr*)&server_addr, sizeof(struct sockaddr_un)) == -1) {
-        print_json_error("socket_client", "Falha ao conectar ao servidor", pid);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int ready = socket_ready_wait(ready_fd, SOCKET_READY_TIMEOUT_MS);
+    close(ready_fd);
+    if (ready == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Servidor não ficou pronto: %s", strerror(errno));
+        print_json_error("socket_client", status_msg, pid);
+        close(client_fd);
+        return;
+    }
+    // Com o aviso recebido o primeiro connect() já é aceito; a retentativa só cobre servidores sem o pipe
+    int attempts = 0;
+    if (socket_connect_retry(client_fd, &server_addr, addr_len, SOCKET_READY_TIMEOUT_MS, &attempts) == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Falha ao conectar ao servidor: %s", strerror(errno));
+        print_json_error("socket_client", status_msg, pid);
+        close(client_fd);
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    snprintf(status_msg, sizeof(status_msg), "Conectado ao servidor em %.1f us (%d tentativa%s de connect).",
+             (t1.tv_sec - t0.tv_sec) * 1e6 + (t1.tv_nsec - t0.tv_nsec) / 1e3, attempts, attempts == 1 ? "" : "s");
+    print_json_status("socket_client", "connected", status_msg, pid);
+
+    ipc_channel_t conn;
+    if (ipc_channel_adopt_fd(&conn, client_fd) == -1) {
+        print_json_error("socket_client", "Falha ao preparar o canal da conexão", pid);
         close(client_fd);
         return;
     }
-    print_json_status("socket_client", "connected", "Conectado ao servidor.", pid);
 
     // 4. Enviar a mensagem inicial
     print_json_status("socket_client", "sending", "Cliente enviando mensagem...", pid);
-    ssize_t bytes_sent = send(client_fd, message, strlen(message), 0);
-    if (bytes_sent > 0) {
+    if (ipc_channel_send(&conn, message, strlen(message)) == 0) {
         print_json_data("socket_client", message, "cliente -> servidor", pid);
     } else {
         print_json_error("socket_client", "Falha ao enviar mensagem", pid);
@@ -165,20 +328,27 @@ void run_client(const char* message) {
 
 
     // 5. Receber a resposta do servidor (bloqueante)
-    char buffer[BUFFER_SIZE];
+    size_t echo_cap = SOCKET_DEMO_MAX_MESSAGE + sizeof(SOCKET_DEMO_ECHO_PREFIX);
+    char *buffer = malloc(echo_cap + 1);
+    size_t num_bytes = 0;
     print_json_status("socket_client", "recv_wait", "Cliente aguardando eco do servidor...", pid);
-    ssize_t num_bytes = recv(client_fd, buffer, BUFFER_SIZE - 1, 0);
 
-    if (num_bytes > 0) {
+    if (buffer && ipc_channel_recv(&conn, buffer, echo_cap, &num_bytes) == 1) {
         buffer[num_bytes] = '\0';
-        snprintf(status_msg, sizeof(status_msg), "Cliente recebeu %zd bytes.", num_bytes);
+        snprintf(status_msg, sizeof(status_msg), "Cliente recebeu %zu bytes.", num_bytes);
         print_json_status("socket_client", "recv_ok", status_msg, pid);
         print_json_data("socket_client", buffer, "servidor -> cliente (eco)", pid);
+
+        // 5b. Transferência em massa: memfd selado via SCM_RIGHTS, comparado com a cópia pelo socket
+        if (fdpass_size > 0) {
+            socket_fdpass_client(ipc_channel_fd(&conn), fdpass_size, message);
+        }
     } else {
         print_json_error("socket_client", "Falha ao receber resposta do servidor", pid);
     }
+    free(buffer);
 
     // 6. Fechar o socket
-    close(client_fd);
+    ipc_channel_close(&conn);
     print_json_status("socket_client", "closed", "Cliente finalizado.", pid);
 }
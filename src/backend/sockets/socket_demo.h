@@ -29,4 +29,14 @@
  */
 #define SOCKET_PATH "/tmp/ipc_socket_demo.sock"
 
+/**
+ * @brief Nome no namespace abstrato do Linux usado com --abstract (%d: PID do servidor)
+ *
+ * O '@' inicial vira o byte nulo de sun_path (socket_addr_init()): o socket
+ * não aparece no sistema de arquivos, dispensa unlink() antes do bind() e
+ * no fim, e desaparece sozinho com o último descritor, mesmo se o processo
+ * morrer. O PID evita colisão entre execuções simultâneas.
+ */
+#define SOCKET_ABSTRACT_FORMAT "@ipc_socket_demo.%d"
+
 #endif // SOCKET_DEMO_H
@@ -0,0 +1,707 @@
+#define _GNU_SOURCE
+#include "socket_epoll.h"
+#include "../common/json_output.h"
+#include "../common/ipc_io.h"
+#include "../common/affinity.h"
+#include "socket_ready.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+// Espaço livre garantido no buffer de entrada antes de cada recv()
+#define CONN_READ_CHUNK 65536
+
+// Intervalo do epoll_wait() para verificar se o lançador terminou, quando não há pidfd
+#define EPOLL_REAP_INTERVAL_MS 100
+
+// Nova tentativa de accept4() depois de EMFILE/ENFILE (as conexões fecham em outras threads)
+#define EPOLL_ACCEPT_RETRY_MS 10
+
+// Fila SPSC de descritores aceitos por shard (potência de 2)
+#define SHARD_QUEUE_SIZE 1024
+
+/**
+ * @brief Buffer de uma conexão: bytes válidos em [start, len).
+ */
+typedef struct {
+    char *data;
+    size_t start;
+    size_t len;
+    size_t cap;
+} conn_buffer_t;
+
+/**
+ * @brief Estado de uma conexão aceita.
+ */
+typedef struct {
+    int fd;
+    conn_buffer_t in;           // Bytes recebidos ainda sem quadro completo
+    conn_buffer_t out;          // Ecos aguardando o socket aceitar escrita
+    int peer_closed;
+} conn_t;
+
+/**
+ * @brief Um laço de eventos: epoll próprio, conexões próprias e contadores próprios.
+ *
+ * Com várias threads, o acceptor entrega cada conexão aceita ao shard pela
+ * fila SPSC (tail só é escrito pelo acceptor, head só pelo shard) e acorda
+ * o shard pelo eventfd; nenhuma trava é compartilhada entre os laços.
+ */
+typedef struct {
+    int index;
+    int cpu;                    // CPU em que a thread foi fixada (-1: sem fixação)
+    int epoll_fd;
+    int event_fd;               // -1 no modo de uma thread (o próprio acceptor atende)
+    pthread_t thread;
+    struct epoll_shard_server *server;
+    int queue[SHARD_QUEUE_SIZE];
+    uint32_t tail __attribute__((aligned(64)));    // Escrito pelo acceptor
+    uint32_t head __attribute__((aligned(64)));    // Escrito pelo shard
+    int stop;                   // Acceptor terminou: sair quando não houver conexões
+    // Contadores escritos só pela thread do shard
+    long connections;
+    long open;
+    long protocol_errors;
+    uint64_t messages;
+    uint64_t bytes;
+} __attribute__((aligned(64))) epoll_shard_t;
+
+/**
+ * @brief Estado do acceptor e totais do servidor.
+ */
+typedef struct epoll_shard_server {
+    const socket_epoll_config_t *cfg;
+    int listen_fd;
+    int epoll_fd;               // epoll do acceptor (no modo de uma thread, o mesmo do shard 0)
+    int accept_blocked;         // accept4() parou em EMFILE/ENFILE: tentar de novo em breve
+    long accepted;
+    long open;                  // Conexões abertas em todos os shards (atômico)
+    long peak;
+    uint64_t first_accept_ns;
+    uint64_t last_accept_ns;
+    epoll_shard_t *shards;
+    int next_shard;
+} epoll_server_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Garante extra bytes livres no fim; compacta antes de crescer
+static int buffer_reserve(conn_buffer_t *b, size_t extra) {
+    if (b->start > 0 && b->cap - b->len < extra) {
+        memmove(b->data, b->data + b->start, b->len - b->start);
+        b->len -= b->start;
+        b->start = 0;
+    }
+    if (b->cap - b->len >= extra) {
+        return 0;
+    }
+    size_t next = b->cap ? b->cap : 4096;
+    while (next - b->len < extra) {
+        next *= 2;
+    }
+    char *p = realloc(b->data, next);
+    if (!p) {
+        return -1;
+    }
+    b->data = p;
+    b->cap = next;
+    return 0;
+}
+
+static int buffer_append(conn_buffer_t *b, const char *data, size_t n) {
+    if (buffer_reserve(b, n) == -1) {
+        return -1;
+    }
+    memcpy(b->data + b->len, data, n);
+    b->len += n;
+    return 0;
+}
+
+static void conn_close(epoll_shard_t *sh, conn_t *c) {
+    // close() também remove o fd do epoll
+    close(c->fd);
+    free(c->in.data);
+    free(c->out.data);
+    free(c);
+    sh->open--;
+    __atomic_sub_fetch(&sh->server->open, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Drena o socket até EAGAIN (edge-triggered) e enfileira o eco de cada quadro completo.
+ *
+ * @return 0 em sucesso, -1 em erro de E/S ou quadro inválido.
+ */
+static int conn_read(epoll_shard_t *sh, conn_t *c) {
+    for (;;) {
+        if (buffer_reserve(&c->in, CONN_READ_CHUNK) == -1) {
+            return -1;
+        }
+        ssize_t n = recv(c->fd, c->in.data + c->in.len, c->in.cap - c->in.len, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
+        }
+        if (n == 0) {
+            c->peer_closed = 1;
+            break;
+        }
+        c->in.len += (size_t)n;
+    }
+
+    // O eco é o próprio quadro: prefixo e carga copiados para a saída
+    while (c->in.len - c->in.start >= IPC_FRAME_HEADER_SIZE) {
+        const unsigned char *h = (const unsigned char *)c->in.data + c->in.start;
+        uint32_t len = (uint32_t)h[0] | (uint32_t)h[1] << 8 | (uint32_t)h[2] << 16 | (uint32_t)h[3] << 24;
+        if (len > SOCKET_EPOLL_MAX_FRAME) {
+            sh->protocol_errors++;
+            errno = EMSGSIZE;
+            return -1;
+        }
+        size_t frame = IPC_FRAME_HEADER_SIZE + (size_t)len;
+        if (c->in.len - c->in.start < frame) {
+            break;
+        }
+        if (buffer_append(&c->out, c->in.data + c->in.start, frame) == -1) {
+            return -1;
+        }
+        c->in.start += frame;
+        sh->messages++;
+        sh->bytes += len;
+    }
+    if (c->in.start == c->in.len) {
+        c->in.start = c->in.len = 0;
+    }
+    return 0;
+}
+
+// Envia o que couber; o resto espera o próximo EPOLLOUT
+static int conn_flush(conn_t *c) {
+    while (c->out.start < c->out.len) {
+        ssize_t n = send(c->fd, c->out.data + c->out.start, c->out.len - c->out.start, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        c->out.start += (size_t)n;
+    }
+    c->out.start = c->out.len = 0;
+    return 0;
+}
+
+// Registra uma conexão no epoll do shard (sempre na thread do shard)
+static void shard_register(epoll_shard_t *sh, int fd) {
+    conn_t *c = calloc(1, sizeof(conn_t));
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = c;
+    if (!c || (c->fd = fd, epoll_ctl(sh->epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)) {
+        free(c);
+        close(fd);
+        __atomic_sub_fetch(&sh->server->open, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    sh->connections++;
+    sh->open++;
+}
+
+// Shard: adota as conexões entregues pelo acceptor
+static void shard_adopt(epoll_shard_t *sh) {
+    uint64_t wakeups;
+    uint32_t tail = __atomic_load_n(&sh->tail, __ATOMIC_ACQUIRE);
+    if (read(sh->event_fd, &wakeups, sizeof(wakeups)) == -1) {
+        // EAGAIN: acordado por uma entrega já adotada
+    }
+    while (sh->head != tail) {
+        shard_register(sh, sh->queue[sh->head & (SHARD_QUEUE_SIZE - 1)]);
+        __atomic_store_n(&sh->head, sh->head + 1, __ATOMIC_RELEASE);
+    }
+}
+
+// Acceptor: entrega fd ao shard; fila cheia acorda o shard e espera uma vaga
+static void shard_push(epoll_shard_t *sh, int fd) {
+    uint64_t one = 1;
+    while (sh->tail - __atomic_load_n(&sh->head, __ATOMIC_ACQUIRE) == SHARD_QUEUE_SIZE) {
+        if (write(sh->event_fd, &one, sizeof(one)) == -1) {
+            // Contador do eventfd já pendente
+        }
+        sched_yield();
+    }
+    sh->queue[sh->tail & (SHARD_QUEUE_SIZE - 1)] = fd;
+    __atomic_store_n(&sh->tail, sh->tail + 1, __ATOMIC_RELEASE);
+}
+
+// Aceita até EAGAIN: com edge-triggered, conexões deixadas na fila não gerariam novo evento
+static void server_accept(epoll_server_t *s) {
+    int threads = s->cfg->threads;
+    uint64_t one = 1;
+    char woken[SOCKET_EPOLL_MAX_THREADS] = { 0 };
+
+    for (;;) {
+        int fd = accept4(s->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            s->accept_blocked = errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM;
+            break;
+        }
+        uint64_t t = now_ns();
+        if (s->accepted++ == 0) {
+            s->first_accept_ns = t;
+        }
+        s->last_accept_ns = t;
+        long open = __atomic_add_fetch(&s->open, 1, __ATOMIC_RELAXED);
+        if (open > s->peak) {
+            s->peak = open;
+        }
+        if (threads == 1) {
+            shard_register(&s->shards[0], fd);
+            continue;
+        }
+        int target = s->next_shard;
+        s->next_shard = (target + 1) % threads;
+        shard_push(&s->shards[target], fd);
+        woken[target] = 1;
+    }
+
+    // Um write() por shard por rodada de accept, não por conexão
+    for (int i = 0; i < threads && threads > 1; i++) {
+        if (woken[i] && write(s->shards[i].event_fd, &one, sizeof(one)) == -1) {
+            // Contador do eventfd já pendente
+        }
+    }
+}
+
+static void server_handle(epoll_shard_t *sh, conn_t *c, uint32_t events) {
+    int rc = 0;
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+        rc = conn_read(sh, c);
+    }
+    if (rc == 0) {
+        rc = conn_flush(c);
+    }
+    if (rc == -1 || (c->peer_closed && c->out.start == c->out.len)) {
+        conn_close(sh, c);
+    }
+}
+
+/**
+ * @brief Laço de um shard no modo com várias threads.
+ */
+static void *shard_loop(void *arg) {
+    epoll_shard_t *sh = arg;
+    struct epoll_event events[SOCKET_EPOLL_MAX_EVENTS];
+
+    if (sh->cpu >= 0 && ipc_pin_cpu(sh->cpu) == -1) {
+        sh->cpu = -1;
+    }
+    for (;;) {
+        int n = epoll_wait(sh->epoll_fd, events, SOCKET_EPOLL_MAX_EVENTS, -1);
+        if (n == -1 && errno != EINTR) {
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == sh) {
+                shard_adopt(sh);
+            } else {
+                server_handle(sh, events[i].data.ptr, events[i].events);
+            }
+        }
+        if (__atomic_load_n(&sh->stop, __ATOMIC_ACQUIRE) && sh->open == 0 &&
+            sh->head == __atomic_load_n(&sh->tail, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Cliente: conecta, troca cfg->messages mensagens conferindo cada eco e fecha.
+ */
+static int epoll_client(const char *path, const socket_epoll_config_t *cfg, int index) {
+    struct sockaddr_un addr;
+    socklen_t addr_len;
+    char *payload = malloc(cfg->size ? cfg->size : 1);
+    char *reply = malloc(cfg->size ? cfg->size : 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    // Caminho longo demais falha com ENAMETOOLONG em vez de conectar a um nome truncado
+    int ok = payload && reply && fd != -1 && socket_addr_init(&addr, &addr_len, path) == 0;
+
+    while (ok && connect(fd, (struct sockaddr *)&addr, addr_len) == -1) {
+        ok = errno == EINTR;
+    }
+    if (ok) {
+        memset(payload, 'a' + index % 26, cfg->size);
+    }
+    for (long m = 0; ok && m < cfg->messages; m++) {
+        size_t len;
+        memcpy(payload, &m, cfg->size < sizeof(m) ? cfg->size : sizeof(m));
+        ok = ipc_write_frame(fd, payload, cfg->size) == 0 &&
+             ipc_read_frame(fd, reply, cfg->size, &len) == 1 &&
+             len == cfg->size && memcmp(payload, reply, len) == 0;
+    }
+    if (!ok) {
+        char status_msg[256];
+        snprintf(status_msg, sizeof(status_msg), "Cliente %d falhou: %s", index, strerror(errno));
+        print_json_error("socket_client", status_msg, getpid());
+    }
+    if (fd != -1) {
+        close(fd);
+    }
+    free(payload);
+    free(reply);
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief Processo que cria os clientes enquanto o servidor já atende; sai com o número de falhas.
+ */
+static void epoll_launcher(const char *path, const socket_epoll_config_t *cfg) {
+    int failures = 0, status;
+
+    for (int i = 0; i < cfg->clients; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            int rc = epoll_client(path, cfg, i);
+            json_output_flush();
+            _exit(rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+        if (pid < 0) {
+            failures += cfg->clients - i;
+            break;
+        }
+    }
+    while (wait(&status) > 0) {
+        failures += !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    _exit(failures > 255 ? 255 : failures);
+}
+
+// Cada conexão ocupa um descritor no servidor: sobe o limite flexível até o rígido
+static void raise_fd_limit(long needed) {
+    struct rlimit rl;
+    char status_msg[256];
+    if (getrlimit(RLIMIT_NOFILE, &rl) == -1) {
+        return;
+    }
+    if (rl.rlim_cur != RLIM_INFINITY && rl.rlim_cur < (rlim_t)needed) {
+        rl.rlim_cur = rl.rlim_max != RLIM_INFINITY && rl.rlim_max < (rlim_t)needed ? rl.rlim_max : (rlim_t)needed;
+        setrlimit(RLIMIT_NOFILE, &rl);
+        if (rl.rlim_cur < (rlim_t)needed) {
+            snprintf(status_msg, sizeof(status_msg),
+                     "Limite de descritores (%llu) menor que o de clientes; conexões excedentes esperam na fila.",
+                     (unsigned long long)rl.rlim_cur);
+            print_json_status("socket_server", "fd_limit", status_msg, getpid());
+        }
+    }
+}
+
+static int listen_socket(const char *path) {
+    struct sockaddr_un addr;
+    socklen_t addr_len;
+    if (socket_addr_init(&addr, &addr_len, path) == -1) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (!socket_addr_is_abstract(path)) {
+        unlink(path);
+    }
+    if (bind(fd, (struct sockaddr *)&addr, addr_len) == -1 || listen(fd, SOMAXCONN) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Cria o epoll (e, com várias threads, o eventfd) de cada shard; CPUs em rodízio sobre a máscara permitida
+static int shards_init(epoll_server_t *s) {
+    int threads = s->cfg->threads;
+    int cpus[CPU_SETSIZE], ncpus = 0;
+    cpu_set_t mask;
+
+    if (threads > 1 && sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &mask)) {
+                cpus[ncpus++] = c;
+            }
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        epoll_shard_t *sh = &s->shards[i];
+        sh->index = i;
+        sh->server = s;
+        sh->cpu = ncpus > 1 ? cpus[i % ncpus] : -1;
+        sh->event_fd = -1;
+        sh->epoll_fd = threads == 1 ? s->epoll_fd : epoll_create1(EPOLL_CLOEXEC);
+        if (sh->epoll_fd == -1) {
+            return -1;
+        }
+        if (threads == 1) {
+            continue;
+        }
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = sh;
+        sh->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (sh->event_fd == -1 || epoll_ctl(sh->epoll_fd, EPOLL_CTL_ADD, sh->event_fd, &ev) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int shards_start(epoll_server_t *s) {
+    for (int i = 0; i < s->cfg->threads && s->cfg->threads > 1; i++) {
+        if (pthread_create(&s->shards[i].thread, NULL, shard_loop, &s->shards[i]) != 0) {
+            return i;
+        }
+    }
+    return s->cfg->threads;
+}
+
+// Avisa os shards que não virão mais conexões e espera cada um esvaziar
+static void shards_stop(epoll_server_t *s, int started) {
+    uint64_t one = 1;
+    for (int i = 0; i < started && s->cfg->threads > 1; i++) {
+        __atomic_store_n(&s->shards[i].stop, 1, __ATOMIC_RELEASE);
+        if (write(s->shards[i].event_fd, &one, sizeof(one)) == -1) {
+            // Contador do eventfd já pendente
+        }
+    }
+    for (int i = 0; i < started && s->cfg->threads > 1; i++) {
+        pthread_join(s->shards[i].thread, NULL);
+    }
+}
+
+static void shards_close(epoll_server_t *s) {
+    for (int i = 0; i < s->cfg->threads && s->cfg->threads > 1; i++) {
+        if (s->shards[i].event_fd != -1) {
+            close(s->shards[i].event_fd);
+        }
+        if (s->shards[i].epoll_fd != -1) {
+            close(s->shards[i].epoll_fd);
+        }
+    }
+    free(s->shards);
+}
+
+// Lista JSON com um campo de cada shard: 'c' conexões, 'm' mensagens, 'p' CPU fixada
+static void shards_format(const epoll_server_t *s, char *out, size_t cap, char field) {
+    size_t off = (size_t)snprintf(out, cap, "[");
+    for (int i = 0; i < s->cfg->threads && off < cap; i++) {
+        const epoll_shard_t *sh = &s->shards[i];
+        long long v = field == 'c' ? (long long)sh->connections :
+                      field == 'm' ? (long long)sh->messages : (long long)sh->cpu;
+        off += (size_t)snprintf(out + off, cap - off, "%s%lld", i ? "," : "", v);
+    }
+    if (off < cap) {
+        snprintf(out + off, cap - off, "]");
+    }
+}
+
+int socket_epoll_run(const socket_epoll_config_t *cfg) {
+    pid_t pid = getpid();
+    char path[108], status_msg[512];
+    char *metrics, *thread_conns, *thread_msgs, *thread_cpus;
+    size_t list_cap = (size_t)cfg->threads * 24 + 8;
+    struct epoll_event events[SOCKET_EPOLL_MAX_EVENTS];
+    epoll_server_t s;
+    int launcher_status = 0, launcher_done = 0;
+
+    memset(&s, 0, sizeof(s));
+    s.cfg = cfg;
+    s.shards = aligned_alloc(64, sizeof(epoll_shard_t) * (size_t)cfg->threads);
+    if (!s.shards) {
+        print_json_error("socket_server", "Falha ao alocar os shards", pid);
+        return 1;
+    }
+    memset(s.shards, 0, sizeof(epoll_shard_t) * (size_t)cfg->threads);
+    for (int i = 0; i < cfg->threads; i++) {
+        s.shards[i].epoll_fd = s.shards[i].event_fd = -1;
+    }
+    snprintf(path, sizeof(path), SOCKET_EPOLL_PATH_FORMAT, (int)pid);
+    raise_fd_limit((long)cfg->clients + 2L * cfg->threads + 64);
+
+    s.listen_fd = listen_socket(path);
+    if (s.listen_fd == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Falha ao escutar em %s: %s", path, strerror(errno));
+        print_json_error("socket_server", status_msg, pid);
+        free(s.shards);
+        return 1;
+    }
+    snprintf(status_msg, sizeof(status_msg),
+             "Servidor epoll escutando em %s (%d clientes, %ld mensagens de %zu bytes cada, %d thread(s)).",
+             path, cfg->clients, cfg->messages, cfg->size, cfg->threads);
+    print_json_status("socket_server", "listening", status_msg, pid);
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = NULL;
+    s.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    int ep_ok = s.epoll_fd != -1 && epoll_ctl(s.epoll_fd, EPOLL_CTL_ADD, s.listen_fd, &ev) == 0 &&
+                shards_init(&s) == 0;
+    int started = ep_ok ? shards_start(&s) : 0;
+    if (!ep_ok || started != cfg->threads) {
+        print_json_error("socket_server", ep_ok ? "Falha ao criar as threads dos shards" : "Falha ao criar o epoll", pid);
+        shards_stop(&s, started);
+        shards_close(&s);
+        if (s.epoll_fd != -1) {
+            close(s.epoll_fd);
+        }
+        close(s.listen_fd);
+        unlink(path);
+        return 1;
+    }
+    uint64_t start = now_ns();
+    pid_t launcher = fork();
+    if (launcher == -1) {
+        print_json_error("socket_server", "Falha no fork() do lançador de clientes", pid);
+        shards_stop(&s, started);
+        shards_close(&s);
+        close(s.epoll_fd);
+        close(s.listen_fd);
+        unlink(path);
+        return 1;
+    }
+    if (launcher == 0) {
+        close(s.listen_fd);
+        epoll_launcher(path, cfg);
+    }
+
+    // pidfd do lançador fica legível quando ele sai; sem suporte (kernel < 5.3) o laço usa timeout
+    int launcher_fd = -1;
+#ifdef SYS_pidfd_open
+    launcher_fd = (int)syscall(SYS_pidfd_open, launcher, 0);
+#endif
+    if (launcher_fd != -1) {
+        ev.events = EPOLLIN;
+        ev.data.ptr = &launcher_fd;
+        if (epoll_ctl(s.epoll_fd, EPOLL_CTL_ADD, launcher_fd, &ev) == -1) {
+            close(launcher_fd);
+            launcher_fd = -1;
+        }
+    }
+
+    // Com uma thread, este laço também atende as conexões (shard 0); com várias, só aceita.
+    // Termina quando o lançador (e portanto todos os clientes) saiu e não há conexões abertas.
+    while (!launcher_done || s.accept_blocked || (cfg->threads == 1 && s.open > 0)) {
+        int timeout = launcher_fd == -1 || launcher_done ? EPOLL_REAP_INTERVAL_MS : -1;
+        if (s.accept_blocked) {
+            timeout = EPOLL_ACCEPT_RETRY_MS;
+        }
+        int n = epoll_wait(s.epoll_fd, events, SOCKET_EPOLL_MAX_EVENTS, timeout);
+        if (n == -1 && errno != EINTR) {
+            print_json_error("socket_server", "Falha no epoll_wait", pid);
+            break;
+        }
+        if (n == 0 && s.accept_blocked) {
+            s.accept_blocked = 0;
+            server_accept(&s);
+        }
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == NULL) {
+                server_accept(&s);
+            } else if (events[i].data.ptr == &launcher_fd) {
+                continue;               // Tratado abaixo pelo waitpid()
+            } else {
+                server_handle(&s.shards[0], events[i].data.ptr, events[i].events);
+            }
+        }
+        if (!launcher_done && waitpid(launcher, &launcher_status, WNOHANG) == launcher) {
+            launcher_done = 1;
+            server_accept(&s);          // Conexões de clientes que já saíram, ainda na fila
+            if (launcher_fd != -1) {
+                // O pidfd de um processo colhido segue legível: fora do epoll, ou o laço gira sem esperar
+                epoll_ctl(s.epoll_fd, EPOLL_CTL_DEL, launcher_fd, NULL);
+                close(launcher_fd);
+                launcher_fd = -1;
+            }
+        }
+    }
+    // Só agora não virão mais conexões: os shards saem quando esvaziarem
+    shards_stop(&s, started);
+    uint64_t end = now_ns();
+    if (launcher_fd != -1) {
+        close(launcher_fd);
+    }
+    close(s.epoll_fd);
+    close(s.listen_fd);
+    unlink(path);
+
+    // Totais: soma dos contadores de cada shard (lidos depois do pthread_join)
+    long protocol_errors = 0;
+    uint64_t messages = 0, bytes = 0;
+    for (int i = 0; i < cfg->threads; i++) {
+        protocol_errors += s.shards[i].protocol_errors;
+        messages += s.shards[i].messages;
+        bytes += s.shards[i].bytes;
+    }
+    thread_conns = malloc(list_cap);
+    thread_msgs = malloc(list_cap);
+    thread_cpus = malloc(list_cap);
+    metrics = malloc(list_cap * 3 + 1024);
+    if (!thread_conns || !thread_msgs || !thread_cpus || !metrics) {
+        print_json_error("socket_server", "Falha ao alocar as métricas", pid);
+        free(thread_conns);
+        free(thread_msgs);
+        free(thread_cpus);
+        free(metrics);
+        shards_close(&s);
+        return 1;
+    }
+    shards_format(&s, thread_conns, list_cap, 'c');
+    shards_format(&s, thread_msgs, list_cap, 'm');
+    shards_format(&s, thread_cpus, list_cap, 'p');
+
+    long failed = WIFEXITED(launcher_status) ? WEXITSTATUS(launcher_status) : cfg->clients;
+    double secs = (double)(end - start) / 1e9;
+    double accept_secs = (double)(s.last_accept_ns - s.first_accept_ns) / 1e9;
+    snprintf(metrics, list_cap * 3 + 1024,
+             "{\"clients\":%d,\"messages_per_client\":%ld,\"size\":%zu,\"connections\":%ld,\"peak_connections\":%ld,"
+             "\"failed_clients\":%ld,\"protocol_errors\":%ld,\"messages\":%llu,\"bytes\":%llu,\"seconds\":%.6f,"
+             "\"connections_per_sec\":%.0f,\"msgs_per_sec\":%.0f,\"gb_per_sec\":%.4f,"
+             "\"threads\":%d,\"thread_connections\":%s,\"thread_messages\":%s,\"thread_cpus\":%s}",
+             cfg->clients, cfg->messages, cfg->size, s.accepted, s.peak, failed, protocol_errors,
+             (unsigned long long)messages, (unsigned long long)bytes, secs,
+             accept_secs > 0 ? (double)s.accepted / accept_secs : (secs > 0 ? (double)s.accepted / secs : 0.0),
+             secs > 0 ? (double)messages / secs : 0.0,
+             secs > 0 ? (double)bytes / secs / 1e9 : 0.0,
+             cfg->threads, thread_conns, thread_msgs, thread_cpus);
+    print_json_metrics("socket_server", "epoll", metrics, pid);
+    free(thread_conns);
+    free(thread_msgs);
+    free(thread_cpus);
+    free(metrics);
+    shards_close(&s);
+
+    if (failed || protocol_errors || s.accepted != cfg->clients) {
+        snprintf(status_msg, sizeof(status_msg), "Servidor epoll: %ld cliente(s) falharam, %ld conexões aceitas de %d.",
+                 failed, s.accepted, cfg->clients);
+        print_json_error("socket_server", status_msg, pid);
+        return 1;
+    }
+    print_json_status("socket_server", "success", "Servidor epoll atendeu todos os clientes.", pid);
+    return 0;
+}
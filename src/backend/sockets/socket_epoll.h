@@ -0,0 +1,57 @@
+/**
+ * @file socket_epoll.h
+ * @brief Servidor AF_UNIX orientado a eventos (epoll, edge-triggered) com N clientes filhos.
+ *
+ * Com uma thread, o servidor aceita e atende todas as conexões no mesmo
+ * laço: o socket de escuta e os de cada cliente são não bloqueantes e
+ * registrados no epoll em modo edge-triggered, então cada evento é drenado
+ * até EAGAIN. Cada conexão tem buffers próprios de entrada e saída; as
+ * mensagens usam o quadro com prefixo de tamanho de ipc_io.h e são ecoadas
+ * inteiras.
+ *
+ * Com T threads, o servidor vira T shards, cada um com seu epoll, suas
+ * conexões e seus contadores, fixado a uma CPU permitida. A thread
+ * principal só aceita e distribui as conexões em rodízio por filas SPSC
+ * sem trava, acordando o shard por um eventfd. (SO_REUSEPORT, que daria a
+ * cada shard um socket de escuta próprio, não existe para AF_UNIX.)
+ *
+ * Os clientes são N processos filhos: cada um conecta, envia M mensagens
+ * (esperando o eco de cada uma) e fecha. Ao final o servidor imprime uma
+ * linha "metrics" com conexões/s e a vazão agregada.
+ */
+
+#ifndef SOCKET_EPOLL_H
+#define SOCKET_EPOLL_H
+
+#include <stddef.h>
+
+// Caminho do socket do modo epoll (um por execução: recebe o pid do servidor)
+#define SOCKET_EPOLL_PATH_FORMAT "/tmp/ipc_socket_epoll_%d.sock"
+
+// Padrões e limites do modo epoll
+#define SOCKET_EPOLL_DEFAULT_MESSAGES 100
+#define SOCKET_EPOLL_DEFAULT_SIZE 1024
+#define SOCKET_EPOLL_MAX_CLIENTS 20000
+#define SOCKET_EPOLL_MAX_FRAME (1024U * 1024)
+#define SOCKET_EPOLL_MAX_EVENTS 256
+#define SOCKET_EPOLL_MAX_THREADS 256
+
+/**
+ * @brief Configuração de socket_epoll_run().
+ */
+typedef struct {
+    int clients;                // Processos clientes (conexões simultâneas possíveis)
+    long messages;              // Mensagens por cliente
+    size_t size;                // Carga de cada mensagem
+    int threads;                // Laços de eventos (1..SOCKET_EPOLL_MAX_THREADS)
+} socket_epoll_config_t;
+
+/**
+ * @brief Sobe o servidor epoll, cria os clientes e atende até todos encerrarem.
+ *
+ * @param cfg Configuração da execução.
+ * @return 0 em sucesso, 1 em erro (já relatado em JSON).
+ */
+int socket_epoll_run(const socket_epoll_config_t *cfg);
+
+#endif // SOCKET_EPOLL_H
@@ -0,0 +1,281 @@
+#define _GNU_SOURCE
+#include "socket_fdpass.h"
+#include "../common/json_output.h"
+#include "../common/ipc_io.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+// Trecho inicial do buffer mostrado no evento "data"
+#define FDPASS_PREVIEW 64
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Preenche dobrando a região já escrita: log2(size) memcpy() em vez de um por padrão
+static void fill_pattern(char *buf, size_t size, const char *pattern) {
+    size_t plen = strlen(pattern);
+    size_t filled = plen < size ? plen : size;
+    memcpy(buf, pattern, filled);
+    while (filled < size) {
+        size_t n = filled < size - filled ? filled : size - filled;
+        memcpy(buf + filled, buf, n);
+        filled += n;
+    }
+}
+
+uint64_t socket_fdpass_checksum(const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    uint64_t sum = 0;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t w;
+        memcpy(&w, p + i, sizeof(w));
+        sum = ((sum << 7) | (sum >> 57)) + w;
+    }
+    for (; i < len; i++) {
+        sum = ((sum << 7) | (sum >> 57)) + p[i];
+    }
+    return sum;
+}
+
+int socket_fdpass_create(size_t size, const char *pattern, uint64_t *checksum) {
+    size_t plen = strlen(pattern);
+    int fd = memfd_create("ipc_socket_fdpass", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1) {
+        return -1;
+    }
+    if (plen == 0 || size == 0 || ftruncate(fd, (off_t)size) == -1) {
+        if (plen == 0 || size == 0) errno = EINVAL;
+        close(fd);
+        return -1;
+    }
+    // MAP_POPULATE aloca as páginas do tmpfs de uma vez, sem uma falta de página por página
+    char *buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (buf == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    fill_pattern(buf, size, pattern);
+    *checksum = socket_fdpass_checksum(buf, size);
+
+    // F_SEAL_WRITE falha com EBUSY enquanto houver mapeamento compartilhado gravável
+    munmap(buf, size);
+    if (fcntl(fd, F_ADD_SEALS, SOCKET_FDPASS_SEALS) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int socket_fdpass_send(int sock, int fd, uint64_t size) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { &size, sizeof(size) };
+    struct msghdr msg;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    for (;;) {
+        ssize_t n = sendmsg(sock, &msg, MSG_NOSIGNAL);
+        if (n == (ssize_t)sizeof(size)) {
+            return 0;
+        }
+        if (n == -1 && errno == EINTR) continue;
+        if (n >= 0) errno = EIO;
+        return -1;
+    }
+}
+
+int socket_fdpass_recv(int sock, uint64_t *size) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { size, sizeof(*size) };
+    struct msghdr msg;
+    ssize_t n;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    do {
+        // MSG_CMSG_CLOEXEC: o descritor recebido não vaza para filhos do receptor
+        n = recvmsg(sock, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+    } while (n == -1 && errno == EINTR);
+    if (n == -1) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS && c->cmsg_len == CMSG_LEN(sizeof(int))) {
+            memcpy(&fd, CMSG_DATA(c), sizeof(int));
+        }
+    }
+    if (fd == -1 || n != (ssize_t)sizeof(*size) || (msg.msg_flags & MSG_CTRUNC)) {
+        if (fd != -1) close(fd);
+        errno = n == 0 ? EPIPE : EPROTO;
+        return -1;
+    }
+    return fd;
+}
+
+const void *socket_fdpass_map(int fd, size_t size) {
+    struct stat st;
+    int seals = fcntl(fd, F_GET_SEALS);
+    if (seals == -1) {
+        return NULL;
+    }
+    // Sem os selos o remetente ainda poderia alterar ou truncar o buffer durante a leitura
+    if ((seals & SOCKET_FDPASS_SEALS) != SOCKET_FDPASS_SEALS) {
+        errno = EPERM;
+        return NULL;
+    }
+    if (fstat(fd, &st) == -1) {
+        return NULL;
+    }
+    if ((uint64_t)st.st_size != (uint64_t)size || size == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    void *addr = mmap(NULL, size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+    return addr == MAP_FAILED ? NULL : addr;
+}
+
+int socket_fdpass_serve(int sock) {
+    pid_t pid = getpid();
+    char status_msg[256], preview[FDPASS_PREVIEW + 1];
+    uint64_t size, sum;
+
+    // 1. Buffer por descritor: nenhum byte da carga passa pelo socket
+    int fd = socket_fdpass_recv(sock, &size);
+    if (fd == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Falha ao receber o descritor: %s", strerror(errno));
+        print_json_error("socket_server", status_msg, pid);
+        return -1;
+    }
+    const char *buf = size <= SOCKET_FDPASS_MAX_SIZE ? socket_fdpass_map(fd, (size_t)size) : NULL;
+    if (!buf) {
+        snprintf(status_msg, sizeof(status_msg), "Buffer recebido recusado: %s", strerror(errno));
+        print_json_error("socket_server", status_msg, pid);
+        close(fd);
+        return -1;
+    }
+    // O selo vale também para o receptor: um mapeamento gravável tem de falhar
+    void *writable = mmap(NULL, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int write_blocked = writable == MAP_FAILED;
+    if (!write_blocked) {
+        munmap(writable, (size_t)size);
+    }
+    snprintf(status_msg, sizeof(status_msg), "Servidor mapeou %llu bytes selados (somente leitura, escrita %s).",
+             (unsigned long long)size, write_blocked ? "bloqueada" : "PERMITIDA");
+    print_json_status("socket_server", "fdpass_mapped", status_msg, pid);
+    size_t shown = size < FDPASS_PREVIEW ? (size_t)size : FDPASS_PREVIEW;
+    while (shown > 0 && shown < size && ((unsigned char)buf[shown] & 0xC0) == 0x80) {
+        shown--;                        // Não corta um caractere UTF-8 ao meio
+    }
+    memcpy(preview, buf, shown);
+    preview[shown] = '\0';
+    print_json_data("socket_server", preview, "cliente -> servidor (memfd)", pid);
+    sum = socket_fdpass_checksum(buf, (size_t)size);
+    munmap((void *)buf, (size_t)size);
+    close(fd);
+    if (!write_blocked || ipc_write_all(sock, &sum, sizeof(sum)) == -1) {
+        print_json_error("socket_server", "Buffer sem proteção de escrita ou falha ao confirmar", pid);
+        return -1;
+    }
+
+    // 2. Mesma carga copiada pelo socket, para comparação
+    uint32_t len;
+    char *copy = NULL;
+    int ok = ipc_read_frame_header(sock, &len) == 1 && (copy = malloc(len ? len : 1)) != NULL &&
+             ipc_read_all(sock, copy, len) == 0;
+    if (ok) {
+        sum = socket_fdpass_checksum(copy, len);
+        ok = ipc_write_all(sock, &sum, sizeof(sum)) == 0;
+    }
+    free(copy);
+    if (!ok) {
+        print_json_error("socket_server", "Falha na transferência por cópia", pid);
+        return -1;
+    }
+    return 0;
+}
+
+int socket_fdpass_client(int sock, size_t size, const char *pattern) {
+    pid_t pid = getpid();
+    char status_msg[256], metrics[512];
+    uint64_t sum, reply_fd = 0, reply_copy = 0;
+
+    // Os dois buffers são produzidos antes de medir: o tempo é só o da entrega ao servidor
+    int fd = socket_fdpass_create(size, pattern, &sum);
+    char *copy = size <= IPC_FRAME_MAX_PAYLOAD ? malloc(size) : NULL;
+    if (fd == -1 || !copy) {
+        snprintf(status_msg, sizeof(status_msg), "Falha ao criar os buffers: %s", strerror(errno));
+        print_json_error("socket_client", status_msg, pid);
+        if (fd != -1) close(fd);
+        free(copy);
+        return -1;
+    }
+    fill_pattern(copy, size, pattern);
+
+    // 1. memfd selado, só o descritor atravessa o socket
+    uint64_t t0 = now_ns();
+    int ok = socket_fdpass_send(sock, fd, size) == 0 && ipc_read_all(sock, &reply_fd, sizeof(reply_fd)) == 0;
+    uint64_t t1 = now_ns();
+    close(fd);
+    if (!ok) {
+        snprintf(status_msg, sizeof(status_msg), "Falha ao enviar o descritor: %s", strerror(errno));
+        print_json_error("socket_client", status_msg, pid);
+        free(copy);
+        return -1;
+    }
+    snprintf(status_msg, sizeof(status_msg), "Descritor de %zu bytes enviado por SCM_RIGHTS e confirmado.", size);
+    print_json_status("socket_client", "fdpass_sent", status_msg, pid);
+
+    // 2. A mesma carga copiada pelo socket
+    uint64_t t2 = now_ns();
+    ok = ipc_write_frame(sock, copy, size) == 0 && ipc_read_all(sock, &reply_copy, sizeof(reply_copy)) == 0;
+    uint64_t t3 = now_ns();
+    free(copy);
+    if (!ok) {
+        print_json_error("socket_client", "Falha na transferência por cópia", pid);
+        return -1;
+    }
+
+    double fd_secs = (double)(t1 - t0) / 1e9, copy_secs = (double)(t3 - t2) / 1e9;
+    int checksum_ok = reply_fd == sum && reply_copy == sum;
+    snprintf(metrics, sizeof(metrics),
+             "{\"bytes\":%zu,\"sealed\":true,\"checksum_ok\":%s,\"fd_seconds\":%.6f,\"copy_seconds\":%.6f,"
+             "\"fd_gb_per_sec\":%.4f,\"copy_gb_per_sec\":%.4f,\"speedup_vs_copy\":%.2f}",
+             size, checksum_ok ? "true" : "false", fd_secs, copy_secs,
+             fd_secs > 0 ? (double)size / fd_secs / 1e9 : 0.0,
+             copy_secs > 0 ? (double)size / copy_secs / 1e9 : 0.0,
+             fd_secs > 0 ? copy_secs / fd_secs : 0.0);
+    print_json_metrics("socket_client", "fdpass", metrics, pid);
+    if (!checksum_ok) {
+        print_json_error("socket_client", "Checksum devolvido pelo servidor não confere", pid);
+        return -1;
+    }
+    return 0;
+}
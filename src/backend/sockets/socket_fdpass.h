@@ -0,0 +1,93 @@
+/**
+ * @file socket_fdpass.h
+ * @brief Passagem de buffers compartilhados por descritor (SCM_RIGHTS) sobre o socket do demo.
+ *
+ * No caminho normal cada byte é copiado para o kernel no send() e de volta
+ * no recv(). Aqui o cliente cria um buffer com memfd_create(), preenche,
+ * sela contra escrita (F_SEAL_WRITE) e envia só o descritor numa mensagem
+ * SCM_RIGHTS pela conexão já aberta por run_server()/run_client(). O
+ * servidor confere os selos, mapeia o buffer somente leitura e lê direto
+ * das mesmas páginas: semântica de conexão de socket com transferência
+ * em massa de memória compartilhada.
+ *
+ * O selo é o que torna seguro confiar no conteúdo: depois de F_SEAL_WRITE
+ * nem o remetente consegue alterar o buffer enquanto o receptor o lê.
+ */
+
+#ifndef SOCKET_FDPASS_H
+#define SOCKET_FDPASS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Maior buffer aceito (o mesmo limite dos quadros da comparação por cópia)
+#define SOCKET_FDPASS_MAX_SIZE (256UL * 1024 * 1024)
+
+// Selos exigidos pelo receptor: conteúdo e tamanho imutáveis, selos fechados
+// (F_SEAL_* vêm de <fcntl.h> com _GNU_SOURCE)
+#define SOCKET_FDPASS_SEALS (F_SEAL_SEAL | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE)
+
+/**
+ * @brief Cria um memfd de size bytes, preenche repetindo pattern e aplica SOCKET_FDPASS_SEALS.
+ *
+ * @param size Tamanho do buffer.
+ * @param pattern Conteúdo repetido até preencher o buffer (não vazio).
+ * @param checksum Recebe o checksum do conteúdo (socket_fdpass_checksum()).
+ * @return Descritor selado, ou -1 em erro.
+ */
+int socket_fdpass_create(size_t size, const char *pattern, uint64_t *checksum);
+
+/**
+ * @brief Envia fd pelo socket numa mensagem SCM_RIGHTS; a carga é o tamanho do buffer (u64).
+ *
+ * @return 0 em sucesso, -1 em erro.
+ */
+int socket_fdpass_send(int sock, int fd, uint64_t size);
+
+/**
+ * @brief Recebe um descritor enviado por socket_fdpass_send().
+ *
+ * @param sock Socket conectado.
+ * @param size Recebe o tamanho anunciado.
+ * @return Descritor recebido, ou -1 em erro (EPROTO se a mensagem não trouxer um fd).
+ */
+int socket_fdpass_recv(int sock, uint64_t *size);
+
+/**
+ * @brief Confere os selos e o tamanho do memfd e o mapeia somente leitura.
+ *
+ * @param fd Descritor recebido.
+ * @param size Tamanho anunciado pelo remetente (tem de bater com fstat()).
+ * @return Endereço do mapeamento (liberar com munmap(addr, size)), ou NULL em erro
+ *         (EPERM se faltar algum selo, EINVAL se o tamanho divergir).
+ */
+const void *socket_fdpass_map(int fd, size_t size);
+
+/**
+ * @brief Lado servidor do modo fdpass, sobre a conexão já aceita por run_server().
+ *
+ * Recebe o memfd, confere selos e tamanho, mapeia somente leitura e devolve
+ * o checksum (u64); em seguida recebe a mesma carga copiada num quadro de
+ * ipc_io.h e devolve o checksum dela.
+ *
+ * @return 0 em sucesso, -1 em erro (já relatado em JSON).
+ */
+int socket_fdpass_serve(int sock);
+
+/**
+ * @brief Lado cliente do modo fdpass, sobre a conexão já aberta por run_client().
+ *
+ * Envia size bytes de pattern repetido primeiro como memfd selado e depois
+ * copiados pelo socket, e imprime a linha "metrics" "fdpass" comparando os dois
+ * (o tempo vai do envio à confirmação do servidor, que lê a carga inteira).
+ *
+ * @return 0 em sucesso, -1 em erro (já relatado em JSON).
+ */
+int socket_fdpass_client(int sock, size_t size, const char *pattern);
+
+/**
+ * @brief Checksum de 64 bits do buffer (soma de palavras rotacionada), lido por inteiro.
+ */
+uint64_t socket_fdpass_checksum(const void *buf, size_t len);
+
+#endif // SOCKET_FDPASS_H
@@ -0,0 +1,352 @@
+#define _GNU_SOURCE
+#include "socket_mmsg.h"
+#include "../common/json_output.h"
+#include "../common/ipc_io.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+
+/**
+ * @brief Resposta do receptor ao fim de uma execução.
+ */
+typedef struct {
+    uint64_t received;
+    uint64_t errors;            // Mensagens fora de ordem, truncadas ou de tamanho errado
+    uint64_t syscalls;
+} mmsg_report_t;
+
+/**
+ * @brief Lote pré-montado: cabeçalhos, iovecs e cargas de até batch mensagens.
+ */
+typedef struct {
+    int batch;
+    size_t size;
+    char *data;                 // batch * size bytes
+    uint32_t *headers;          // Prefixos de quadro (só SOCK_STREAM)
+    struct iovec *iov;          // Dois por mensagem: prefixo e carga
+    struct mmsghdr *msgs;
+} mmsg_batch_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static const char *type_name(int type) {
+    switch (type) {
+        case SOCKET_MMSG_STREAM: return "stream";
+        case SOCKET_MMSG_DGRAM: return "dgram";
+        default: return "seqpacket";
+    }
+}
+
+int socket_mmsg_parse_type(const char *name) {
+    if (strcmp(name, "stream") == 0) return SOCKET_MMSG_STREAM;
+    if (strcmp(name, "dgram") == 0) return SOCKET_MMSG_DGRAM;
+    if (strcmp(name, "seqpacket") == 0) return SOCKET_MMSG_SEQPACKET;
+    if (strcmp(name, "all") == 0) return SOCKET_MMSG_ALL;
+    return 0;
+}
+
+static void batch_free(mmsg_batch_t *b) {
+    free(b->data);
+    free(b->headers);
+    free(b->iov);
+    free(b->msgs);
+}
+
+// Monta os vetores uma vez; só o número de sequência muda entre lotes
+static int batch_init(mmsg_batch_t *b, int batch, size_t size, int stream) {
+    memset(b, 0, sizeof(*b));
+    b->batch = batch;
+    b->size = size;
+    b->data = malloc((size_t)batch * size);
+    b->headers = malloc(sizeof(uint32_t) * (size_t)batch);
+    b->iov = malloc(sizeof(struct iovec) * 2 * (size_t)batch);
+    b->msgs = calloc((size_t)batch, sizeof(struct mmsghdr));
+    if (!b->data || !b->headers || !b->iov || !b->msgs) {
+        batch_free(b);
+        return -1;
+    }
+    memset(b->data, 'm', (size_t)batch * size);
+    for (int i = 0; i < batch; i++) {
+        unsigned char *h = (unsigned char *)&b->headers[i];
+        h[0] = (unsigned char)size;
+        h[1] = (unsigned char)(size >> 8);
+        h[2] = (unsigned char)(size >> 16);
+        h[3] = (unsigned char)(size >> 24);
+        struct iovec *v = &b->iov[2 * i];
+        v[0].iov_base = h;
+        v[0].iov_len = IPC_FRAME_HEADER_SIZE;
+        v[1].iov_base = b->data + (size_t)i * size;
+        v[1].iov_len = size;
+        b->msgs[i].msg_hdr.msg_iov = stream ? v : v + 1;
+        b->msgs[i].msg_hdr.msg_iovlen = stream ? 2 : 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Emissor: envia cfg->messages mensagens em lotes de b->batch.
+ *
+ * @return Syscalls usados, ou -1 em erro.
+ */
+static long long mmsg_send(int fd, mmsg_batch_t *b, long messages, int stream) {
+    long long syscalls = 0;
+    size_t frame = (stream ? IPC_FRAME_HEADER_SIZE : 0) + b->size;
+
+    for (long sent = 0; sent < messages;) {
+        int n = messages - sent < b->batch ? (int)(messages - sent) : b->batch;
+        for (int i = 0; i < n; i++) {
+            uint64_t seq = (uint64_t)(sent + i);
+            memcpy(b->data + (size_t)i * b->size, &seq, sizeof(seq));
+        }
+        if (b->batch == 1) {
+            // Linha de base: um send() por mensagem, como o modo normal do socket_demo
+            struct msghdr *h = &b->msgs[0].msg_hdr;
+            ssize_t rc = sendmsg(fd, h, MSG_NOSIGNAL);
+            syscalls++;
+            if (rc == -1) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            if ((size_t)rc != frame) {
+                errno = EIO;
+                return -1;
+            }
+            sent++;
+            continue;
+        }
+        int done = 0;
+        while (done < n) {
+            int rc = sendmmsg(fd, b->msgs + done, (unsigned int)(n - done), MSG_NOSIGNAL);
+            syscalls++;
+            if (rc == -1) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            for (int i = done; i < done + rc; i++) {
+                if (b->msgs[i].msg_len != frame) {
+                    errno = EIO;
+                    return -1;
+                }
+            }
+            done += rc;
+        }
+        sent += n;
+    }
+    return syscalls;
+}
+
+// Confere uma mensagem recebida contra o próximo número de sequência esperado
+static void mmsg_check(mmsg_report_t *r, const char *data, size_t len, size_t size, int truncated) {
+    uint64_t seq;
+    memcpy(&seq, data, sizeof(seq));
+    if (truncated || len != size || seq != r->received) {
+        r->errors++;
+    }
+    r->received++;
+}
+
+/**
+ * @brief Receptor: recebe messages mensagens, conferindo ordem e tamanho.
+ */
+static int mmsg_receive(int fd, int batch, size_t size, long messages, int stream, mmsg_report_t *r) {
+    size_t frame = (stream ? IPC_FRAME_HEADER_SIZE : 0) + size;
+    char *data = malloc((size_t)batch * frame);
+    struct iovec *iov = malloc(sizeof(struct iovec) * (size_t)batch);
+    struct mmsghdr *msgs = calloc((size_t)batch, sizeof(struct mmsghdr));
+    int ok = data && iov && msgs;
+
+    for (int i = 0; ok && i < batch; i++) {
+        iov[i].iov_base = data + (size_t)i * frame;
+        iov[i].iov_len = frame;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    memset(r, 0, sizeof(*r));
+    while (ok && r->received < (uint64_t)messages) {
+        uint64_t left = (uint64_t)messages - r->received;
+        int n = left < (uint64_t)batch ? (int)left : batch;
+        if (stream) {
+            // Sem fronteiras: os quadros do lote chegam num único recv(MSG_WAITALL)
+            ssize_t rc = recv(fd, data, (size_t)n * frame, MSG_WAITALL);
+            r->syscalls++;
+            if (rc == -1 && errno == EINTR) continue;
+            if (rc != (ssize_t)((size_t)n * frame)) {
+                ok = 0;
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                const unsigned char *h = (const unsigned char *)data + (size_t)i * frame;
+                size_t len = (size_t)h[0] | (size_t)h[1] << 8 | (size_t)h[2] << 16 | (size_t)h[3] << 24;
+                mmsg_check(r, (const char *)h + IPC_FRAME_HEADER_SIZE, len, size, 0);
+            }
+        } else if (batch == 1) {
+            // MSG_TRUNC devolve o tamanho real da mensagem, mesmo se maior que o buffer
+            ssize_t rc = recv(fd, data, frame, MSG_TRUNC);
+            r->syscalls++;
+            if (rc == -1 && errno == EINTR) continue;
+            if (rc <= 0) {
+                ok = 0;
+                break;
+            }
+            mmsg_check(r, data, (size_t)rc, size, (size_t)rc > frame);
+        } else {
+            // MSG_WAITFORONE: bloqueia até a primeira mensagem e leva as que já estiverem na fila
+            int rc = recvmmsg(fd, msgs, (unsigned int)n, MSG_WAITFORONE, NULL);
+            r->syscalls++;
+            if (rc == -1 && errno == EINTR) continue;
+            if (rc <= 0) {
+                ok = 0;
+                break;
+            }
+            for (int i = 0; i < rc; i++) {
+                mmsg_check(r, data + (size_t)i * frame, msgs[i].msg_len, size,
+                           (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0);
+            }
+        }
+    }
+    free(data);
+    free(iov);
+    free(msgs);
+    return ok ? 0 : -1;
+}
+
+static int socket_kind(int type) {
+    switch (type) {
+        case SOCKET_MMSG_STREAM: return SOCK_STREAM;
+        case SOCKET_MMSG_DGRAM: return SOCK_DGRAM;
+        default: return SOCK_SEQPACKET;
+    }
+}
+
+/**
+ * @brief Uma execução: um tipo de socket, um tamanho de lote.
+ *
+ * @param msgs_per_sec Recebe a vazão medida (para o speedup do lote).
+ * @return 0 em sucesso, -1 em erro (já relatado em JSON).
+ */
+static int mmsg_pass(const socket_mmsg_config_t *cfg, int type, int batch, double baseline, double *msgs_per_sec) {
+    pid_t pid = getpid();
+    int stream = type == SOCKET_MMSG_STREAM;
+    int sv[2], buffer = SOCKET_MMSG_SOCKET_BUFFER;
+    char status_msg[256], metrics[512];
+    mmsg_batch_t b;
+    mmsg_report_t report;
+
+    if (socketpair(AF_UNIX, socket_kind(type) | SOCK_CLOEXEC, 0, sv) == -1) {
+        snprintf(status_msg, sizeof(status_msg), "Falha no socketpair(%s): %s", type_name(type), strerror(errno));
+        print_json_error("socket_mmsg", status_msg, pid);
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        setsockopt(sv[i], SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+        setsockopt(sv[i], SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    }
+    if (batch_init(&b, batch, cfg->size, stream) == -1) {
+        print_json_error("socket_mmsg", "Falha ao alocar o lote", pid);
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+
+    uint64_t start = now_ns();
+    pid_t child = fork();
+    if (child == 0) {
+        close(sv[0]);
+        int rc = mmsg_receive(sv[1], batch, cfg->size, cfg->messages, stream, &report);
+        if (ipc_write_all(sv[1], &report, sizeof(report)) == -1 || rc == -1) {
+            _exit(EXIT_FAILURE);
+        }
+        _exit(EXIT_SUCCESS);
+    }
+    close(sv[1]);
+    if (child == -1) {
+        print_json_error("socket_mmsg", "Falha no fork() do receptor", pid);
+        close(sv[0]);
+        batch_free(&b);
+        return -1;
+    }
+
+    long long sender_syscalls = mmsg_send(sv[0], &b, cfg->messages, stream);
+    int send_errno = errno;
+    int got_report = sender_syscalls >= 0 && ipc_read_all(sv[0], &report, sizeof(report)) == 0;
+    uint64_t end = now_ns();
+    int status;
+    close(sv[0]);
+    waitpid(child, &status, 0);
+    batch_free(&b);
+
+    if (!got_report || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        snprintf(status_msg, sizeof(status_msg), "Execução %s com lote %d falhou: %s", type_name(type), batch,
+                 strerror(sender_syscalls < 0 ? send_errno : errno));
+        print_json_error("socket_mmsg", status_msg, pid);
+        return -1;
+    }
+
+    double secs = (double)(end - start) / 1e9;
+    // msgs_per_syscall é a média das duas pontas: cada mensagem passa por um envio e uma recepção
+    uint64_t syscalls = (uint64_t)sender_syscalls + report.syscalls;
+    *msgs_per_sec = secs > 0 ? (double)report.received / secs : 0.0;
+    snprintf(metrics, sizeof(metrics),
+             "{\"socket_type\":\"%s\",\"batch\":%d,\"messages\":%llu,\"size\":%zu,\"errors\":%llu,\"syscalls\":%llu,"
+             "\"msgs_per_syscall\":%.2f,\"seconds\":%.6f,\"msgs_per_sec\":%.0f,\"gb_per_sec\":%.4f,"
+             "\"speedup_vs_single\":%.2f}",
+             type_name(type), batch, (unsigned long long)report.received, cfg->size,
+             (unsigned long long)report.errors, (unsigned long long)syscalls,
+             syscalls ? 2.0 * (double)report.received / (double)syscalls : 0.0, secs, *msgs_per_sec,
+             secs > 0 ? (double)report.received * (double)cfg->size / secs / 1e9 : 0.0,
+             baseline > 0 ? *msgs_per_sec / baseline : 1.0);
+    print_json_metrics("socket_mmsg", "mmsg", metrics, pid);
+
+    if (report.errors || report.received != (uint64_t)cfg->messages) {
+        snprintf(status_msg, sizeof(status_msg), "Execução %s com lote %d: %llu mensagem(ns) inválida(s).",
+                 type_name(type), batch, (unsigned long long)report.errors);
+        print_json_error("socket_mmsg", status_msg, pid);
+        return -1;
+    }
+    return 0;
+}
+
+int socket_mmsg_run(const socket_mmsg_config_t *cfg) {
+    pid_t pid = getpid();
+    char status_msg[256];
+    int failures = 0;
+
+    // O receptor pode sair antes do fim do envio em caso de erro
+    signal(SIGPIPE, SIG_IGN);
+    snprintf(status_msg, sizeof(status_msg), "Medindo %ld mensagens de %zu bytes por tipo de socket, lote 1 e lote %d.",
+             cfg->messages, cfg->size, cfg->batch);
+    print_json_status("socket_mmsg", "start", status_msg, pid);
+
+    for (int type = SOCKET_MMSG_STREAM; type <= SOCKET_MMSG_SEQPACKET; type <<= 1) {
+        double single = 0.0, batched;
+        if (!(cfg->types & type)) {
+            continue;
+        }
+        if (mmsg_pass(cfg, type, 1, 0.0, &single) == -1) {
+            failures++;
+            continue;
+        }
+        if (cfg->batch > 1 && mmsg_pass(cfg, type, cfg->batch, single, &batched) == -1) {
+            failures++;
+        }
+    }
+
+    if (failures) {
+        print_json_error("socket_mmsg", "Uma ou mais execuções falharam.", pid);
+        return 1;
+    }
+    print_json_status("socket_mmsg", "success", "Medição por tipo de socket e lote concluída.", pid);
+    return 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file socket_mmsg.h
+ * @brief Vazão de mensagens pequenas em AF_UNIX por tipo de socket e por lote (sendmmsg/recvmmsg).
+ *
+ * SOCK_DGRAM e SOCK_SEQPACKET preservam a fronteira de cada mensagem: um
+ * recv() devolve exatamente um send(), sem o prefixo de tamanho que o
+ * SOCK_STREAM exige. Com sendmmsg()/recvmmsg() um único syscall move até
+ * um lote inteiro de mensagens, o que domina o custo quando a mensagem é
+ * pequena.
+ *
+ * Cada execução usa um socketpair() e um filho receptor: o pai envia N
+ * mensagens numeradas (os 8 primeiros bytes são o número de sequência), o
+ * filho confere ordem e tamanho e devolve quantas recebeu e quantos
+ * syscalls usou. Para cada tipo é medido o lote 1 (um send()/recv() por
+ * mensagem) e o lote pedido; no SOCK_STREAM o lote é um sendmmsg() de
+ * quadros no envio e um recv(MSG_WAITALL) dos quadros do lote na recepção.
+ */
+
+#ifndef SOCKET_MMSG_H
+#define SOCKET_MMSG_H
+
+#include <stddef.h>
+
+// Padrões e limites do modo mmsg
+#define SOCKET_MMSG_DEFAULT_SIZE 64
+#define SOCKET_MMSG_DEFAULT_BATCH 32
+#define SOCKET_MMSG_MIN_SIZE 8                  // Cabe o número de sequência
+#define SOCKET_MMSG_MAX_SIZE 65536
+#define SOCKET_MMSG_MAX_BATCH 1024              // UIO_MAXIOV, limite de vlen do kernel
+
+// Buffers de envio/recepção pedidos a cada socket (o kernel limita a wmem_max/rmem_max)
+#define SOCKET_MMSG_SOCKET_BUFFER (1024 * 1024)
+
+/**
+ * @brief Tipos de socket medidos (máscara de bits).
+ */
+typedef enum {
+    SOCKET_MMSG_STREAM = 1,
+    SOCKET_MMSG_DGRAM = 2,
+    SOCKET_MMSG_SEQPACKET = 4,
+    SOCKET_MMSG_ALL = 7
+} socket_mmsg_type_t;
+
+/**
+ * @brief Configuração de socket_mmsg_run().
+ */
+typedef struct {
+    long messages;              // Mensagens por execução
+    size_t size;                // Tamanho de cada mensagem
+    int batch;                  // Mensagens por syscall no modo em lote
+    int types;                  // Máscara de socket_mmsg_type_t
+} socket_mmsg_config_t;
+
+/**
+ * @brief Mede cada tipo pedido com lote 1 e com cfg->batch e imprime uma linha "metrics" por execução.
+ *
+ * @param cfg Configuração da medição.
+ * @return 0 em sucesso, 1 em erro (já relatado em JSON).
+ */
+int socket_mmsg_run(const socket_mmsg_config_t *cfg);
+
+/**
+ * @brief Converte "stream", "dgram", "seqpacket" ou "all" na máscara correspondente.
+ *
+ * @return A máscara, ou 0 para um nome desconhecido.
+ */
+int socket_mmsg_parse_type(const char *name);
+
+#endif // SOCKET_MMSG_H
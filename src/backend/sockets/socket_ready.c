@@ -0,0 +1,124 @@
+#define _GNU_SOURCE
+#include "socket_ready.h"
+#include <errno.h>
+#include <poll.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+int socket_addr_is_abstract(const char *name) {
+    return name[0] == '@';
+}
+
+int socket_addr_init(struct sockaddr_un *addr, socklen_t *len, const char *name) {
+    size_t n = strlen(name);
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (n == 0 || (socket_addr_is_abstract(name) && n == 1)) {
+        errno = EINVAL;
+        return -1;
+    }
+    // O caminho precisa do '\0' final; o nome abstrato troca o '@' pelo '\0' inicial
+    if (n >= sizeof(addr->sun_path) + (socket_addr_is_abstract(name) ? 1 : 0)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    memcpy(addr->sun_path, name, n);
+    if (socket_addr_is_abstract(name)) {
+        // No abstrato todos os bytes até len fazem parte do nome: nada de sizeof(*addr)
+        addr->sun_path[0] = '\0';
+        *len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + n);
+    } else {
+        *len = (socklen_t)sizeof(*addr);
+    }
+    return 0;
+}
+
+int socket_ready_notify(int fd) {
+    char byte = 1;
+    ssize_t n;
+    do {
+        n = write(fd, &byte, 1);
+    } while (n == -1 && errno == EINTR);
+    return n == 1 ? 0 : -1;
+}
+
+int socket_ready_wait(int fd, int timeout_ms) {
+    uint64_t deadline = now_ns() + (uint64_t)timeout_ms * 1000000ULL;
+    struct pollfd pfd = { fd, POLLIN, 0 };
+
+    for (;;) {
+        uint64_t now = now_ns();
+        int left = now >= deadline ? 0 : (int)((deadline - now + 999999) / 1000000);
+        int rc = poll(&pfd, 1, left);
+        if (rc == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rc == -1) {
+            return -1;
+        }
+        if (rc == 0) {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        char byte;
+        ssize_t n = read(fd, &byte, 1);
+        if (n == 1) {
+            return 0;
+        }
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        // EOF: o servidor saiu (ou fechou o pipe) sem chegar ao listen()
+        if (n == 0) {
+            errno = EPIPE;
+        }
+        return -1;
+    }
+}
+
+int socket_connect_retry(int fd, const struct sockaddr_un *addr, socklen_t len, int timeout_ms, int *attempts) {
+    uint64_t deadline = now_ns() + (uint64_t)timeout_ms * 1000000ULL;
+    long backoff_us = SOCKET_READY_BACKOFF_MIN_US;
+    int tries = 0, rc;
+
+    for (;;) {
+        tries++;
+        rc = connect(fd, (const struct sockaddr *)addr, len);
+        if (rc == 0) {
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        // ENOENT: o arquivo (ou o nome abstrato) ainda não existe; ECONNREFUSED: existe, mas sem listen()
+        if (errno != ECONNREFUSED && errno != ENOENT) {
+            break;
+        }
+        uint64_t now = now_ns();
+        if (now >= deadline) {
+            errno = ETIMEDOUT;
+            break;
+        }
+        uint64_t wait_ns = (uint64_t)backoff_us * 1000ULL;
+        if (wait_ns > deadline - now) {
+            wait_ns = deadline - now;
+        }
+        struct timespec pause = { (time_t)(wait_ns / 1000000000ULL), (long)(wait_ns % 1000000000ULL) };
+        nanosleep(&pause, NULL);
+        backoff_us = backoff_us * 2 > SOCKET_READY_BACKOFF_MAX_US ? SOCKET_READY_BACKOFF_MAX_US : backoff_us * 2;
+    }
+    if (attempts) {
+        *attempts = tries;
+    }
+    return rc;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file socket_ready.h
+ * @brief Endereços AF_UNIX (caminho ou namespace abstrato), aviso de prontidão e connect() com retentativa.
+ *
+ * O cliente não precisa adivinhar quando o servidor está escutando:
+ *   - quando servidor e cliente nascem do mesmo fork(), um pipe herdado leva
+ *     um byte do servidor depois do listen(); o cliente espera nele com
+ *     poll(). Se o servidor morrer antes, o pipe fecha e o cliente vê EOF em
+ *     vez de esperar o prazo inteiro;
+ *   - sem pipe (servidor em outro processo), socket_connect_retry() repete o
+ *     connect() com espera exponencial enquanto o erro for ECONNREFUSED ou
+ *     ENOENT (socket ainda não criado ou sem listen()).
+ *
+ * Nomes iniciados por '@' vão para o namespace abstrato do Linux: o socket
+ * não existe no sistema de arquivos, some com o último descritor e dispensa
+ * o unlink() antes do bind() e no encerramento.
+ */
+
+#ifndef SOCKET_READY_H
+#define SOCKET_READY_H
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Espera exponencial do connect(): começa em 1 ms e dobra até 64 ms por tentativa
+#define SOCKET_READY_BACKOFF_MIN_US 1000
+#define SOCKET_READY_BACKOFF_MAX_US 64000
+
+// Prazo total para o servidor ficar pronto
+#define SOCKET_READY_TIMEOUT_MS 5000
+
+/**
+ * @brief Preenche um endereço AF_UNIX a partir de um caminho ou de "@nome" (namespace abstrato).
+ *
+ * @param addr Endereço a preencher.
+ * @param len Recebe o tamanho a passar para bind()/connect() (no abstrato, só até o fim do nome).
+ * @param name Caminho no sistema de arquivos, ou '@' seguido do nome abstrato.
+ * @return 0 em sucesso, -1 se o nome não couber em sun_path (ENAMETOOLONG) ou for vazio (EINVAL).
+ */
+int socket_addr_init(struct sockaddr_un *addr, socklen_t *len, const char *name);
+
+/**
+ * @brief 1 se name designa o namespace abstrato (e não há arquivo a remover).
+ */
+int socket_addr_is_abstract(const char *name);
+
+/**
+ * @brief Lado servidor: avisa pelo pipe herdado que o socket já está escutando.
+ *
+ * @param fd Ponta de escrita do pipe de prontidão.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int socket_ready_notify(int fd);
+
+/**
+ * @brief Lado cliente: espera o aviso de socket_ready_notify() por até timeout_ms.
+ *
+ * @param fd Ponta de leitura do pipe de prontidão (a de escrita já fechada no cliente).
+ * @param timeout_ms Prazo em milissegundos.
+ * @return 0 com o servidor pronto, -1 em erro (ETIMEDOUT no prazo, EPIPE se o servidor fechou o pipe sem avisar).
+ */
+int socket_ready_wait(int fd, int timeout_ms);
+
+/**
+ * @brief connect() repetido com espera exponencial enquanto o servidor ainda não escuta.
+ *
+ * Outros erros falham de imediato. Com o servidor já pronto custa um só connect().
+ *
+ * @param fd Socket ainda não conectado.
+ * @param timeout_ms Prazo total em milissegundos.
+ * @param attempts Recebe o número de connect() feitos (pode ser NULL).
+ * @return 0 conectado, -1 em erro (ETIMEDOUT se o prazo acabar).
+ */
+int socket_connect_retry(int fd, const struct sockaddr_un *addr, socklen_t len, int timeout_ms, int *attempts);
+
+#endif // SOCKET_READY_H
@@ -0,0 +1,193 @@
+# backend_comm/event_decoder.py
+"""
+Decodificador do formato binário de eventos do backend (IPC_JSON_FORMAT=binary).
+
+Cada quadro tem prefixo de tamanho; os dicionários produzidos têm as mesmas
+chaves que as linhas JSON do formato texto, então os callbacks do
+BackendManager não precisam saber qual formato está em uso. O layout está
+documentado em src/backend/common/json_output.h (json_frame_kind_t).
+"""
+
+import json
+import struct
+from typing import Dict, List
+
+# Tipos de quadro (json_frame_kind_t)
+FRAME_STATUS = 1
+FRAME_DATA = 2
+FRAME_ERROR = 3
+FRAME_METRICS = 4
+FRAME_LINE = 5
+FRAME_DEF = 6
+
+FLAG_SEQ = 0x1
+FLAG_ELAPSED = 0x2
+
+LITERAL = 0xFFFF
+
+_U32 = struct.Struct('<I')
+_U64 = struct.Struct('<Q')
+_HEADER = struct.Struct('<IBBHI')      # size, kind, flags, id, writer
+_FIXED = struct.Struct('<iIQ')         # pid, timestamp, ts_ns
+_PREFIX = struct.Struct('<HIiIQ')      # id, writer, pid, timestamp, ts_ns (a partir do byte 6)
+_EMPTY: Dict[int, str] = {}
+
+_TYPES = {
+    FRAME_STATUS: 'status',
+    FRAME_DATA: 'data',
+    FRAME_ERROR: 'error',
+    FRAME_METRICS: 'metrics',
+}
+
+
+class BinaryEventDecoder:
+    """
+    Decodificador incremental: recebe pedaços arbitrários do stdout do
+    processo e devolve os eventos completos.
+
+    As strings internadas são guardadas por writer (tid de quem escreveu),
+    já que pai e filhos compartilham o mesmo stdout com tabelas próprias.
+
+    Example:
+        decoder = BinaryEventDecoder()
+        for chunk in iter(lambda: os.read(fd, 65536), b''):
+            for event in decoder.feed(chunk):
+                print(event['type'], event['module'])
+    """
+
+    def __init__(self):
+        self._buffer = b''
+        self._strings: Dict[int, Dict[int, str]] = {}
+
+    def feed(self, chunk: bytes) -> List[dict]:
+        """
+        Acrescenta bytes ao buffer e decodifica todos os quadros completos.
+
+        Args:
+            chunk: Bytes lidos do stdout do backend
+
+        Returns:
+            list: Eventos decodificados, na ordem do stream
+        """
+        if self._buffer:
+            data = bytes(self._buffer) + chunk
+        else:
+            data = bytes(chunk)
+        events = []
+        append = events.append
+        strings_by_writer = self._strings
+        prefix = _PREFIX.unpack_from
+        u32 = _U32.unpack_from
+        pos = 0
+        end = len(data)
+
+        while end - pos >= 12:
+            size = u32(data, pos)[0]
+            stop = pos + 4 + size
+            if stop > end:
+                break
+            kind = data[pos + 4]
+
+            # Caminho comum: evento com módulo internado e sem campos opcionais
+            if FRAME_STATUS <= kind <= FRAME_METRICS and data[pos + 5] == 0 and size >= 24:
+                ident, writer, pid, timestamp, ts_ns = prefix(data, pos + 6)
+                strings = strings_by_writer.get(writer, _EMPTY)
+                if ident != LITERAL:
+                    event = {'type': _TYPES[kind], 'module': strings.get(ident, '')}
+                    p = pos + 28
+                    if kind == FRAME_STATUS:
+                        event['status'], p = _read_tag(data, p, strings)
+                        length = u32(data, p)[0]
+                        event['message'] = data[p + 4:p + 4 + length].decode('utf-8', 'replace')
+                    elif kind == FRAME_DATA:
+                        length = u32(data, p)[0]
+                        event['data'] = data[p + 4:p + 4 + length].decode('utf-8', 'replace')
+                        event['source'], p = _read_tag(data, p + 4 + length, strings)
+                    else:
+                        self._decode_fields(event, kind, data, p)
+                    if pid > 0:
+                        event['pid'] = pid
+                    event['timestamp'] = timestamp
+                    event['ts_ns'] = ts_ns
+                    append(event)
+                    pos = stop
+                    continue
+
+            event = self._decode(data, pos, stop)
+            if event is not None:
+                append(event)
+            pos = stop
+
+        self._buffer = data[pos:]
+        return events
+
+    def pending(self) -> int:
+        """Bytes de um quadro incompleto ainda no buffer."""
+        return len(self._buffer)
+
+    def _decode(self, data: bytes, start: int, stop: int):
+        _, kind, flags, ident, writer = _HEADER.unpack_from(data, start)
+        pos = start + 12
+
+        if kind == FRAME_DEF:
+            self._strings.setdefault(writer, {})[ident] = data[pos:stop].decode('utf-8', 'replace')
+            return None
+        if kind == FRAME_LINE:
+            return json.loads(data[pos:stop])
+
+        strings = self._strings.get(writer, _EMPTY)
+        if ident == LITERAL:
+            module, pos = _read_str(data, pos)
+        else:
+            module = strings.get(ident, '')
+        pid, timestamp, ts_ns = _FIXED.unpack_from(data, pos)
+        pos += 16
+        seq = elapsed = None
+        if flags & FLAG_SEQ:
+            seq = _U64.unpack_from(data, pos)[0]
+            pos += 8
+        if flags & FLAG_ELAPSED:
+            elapsed = _U64.unpack_from(data, pos)[0]
+            pos += 8
+
+        event = {'type': _TYPES.get(kind, 'raw'), 'module': module}
+        if kind == FRAME_STATUS:
+            event['status'], pos = _read_tag(data, pos, strings)
+            event['message'], pos = _read_str(data, pos)
+        elif kind == FRAME_DATA:
+            event['data'], pos = _read_str(data, pos)
+            event['source'], pos = _read_tag(data, pos, strings)
+        else:
+            self._decode_fields(event, kind, data, pos)
+        if pid > 0:
+            event['pid'] = pid
+        event['timestamp'] = timestamp
+        event['ts_ns'] = ts_ns
+        if seq is not None:
+            event['seq'] = seq
+        if elapsed is not None:
+            event['elapsed_ns'] = elapsed
+        return event
+
+    @staticmethod
+    def _decode_fields(event: dict, kind: int, data: bytes, pos: int):
+        if kind == FRAME_ERROR:
+            event['error'], pos = _read_str(data, pos)
+        elif kind == FRAME_METRICS:
+            event['name'], pos = _read_str(data, pos)
+            metrics, pos = _read_str(data, pos)
+            event['metrics'] = json.loads(metrics)
+
+
+def _read_str(data: bytes, pos: int):
+    length = _U32.unpack_from(data, pos)[0]
+    pos += 4
+    return data[pos:pos + length].decode('utf-8', 'replace'), pos + length
+
+
+def _read_tag(data: bytes, pos: int, strings: Dict[int, str]):
+    ident = data[pos] | data[pos + 1] << 8
+    pos += 2
+    if ident == LITERAL:
+        return _read_str(data, pos)
+    return strings.get(ident, ''), pos
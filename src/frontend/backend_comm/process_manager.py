@@ -15,8 +15,19 @@ import json
 import threading
 import queue
 import os
+import socket
+import struct
+import time
 from typing import Optional, Callable
 
+from .event_decoder import BinaryEventDecoder
+
+# Executáveis cujo eco de uma mensagem o ipc_daemon atende: executável -> canal
+DAEMON_CHANNELS = {"pipe_demo": "pipes", "socket_demo": "sockets", "shm_demo": "shm"}
+
+# Espera pelo socket de controle de um daemon recém-iniciado
+DAEMON_CONNECT_TIMEOUT = 2.0
+
 class BackendManager:
     """
     Gerenciador de processos do backend C com suporte a comunicação JSON.
@@ -29,16 +40,38 @@ class BackendManager:
         processes (dict): Mapeia nomes de módulos para objetos subprocess.Popen
         output_queues (dict): Filas de saída para cada módulo (não usado atualmente)
         callbacks (dict): Funções de callback para processar mensagens de cada módulo
+        event_format (str): "json" (linhas de texto) ou "binary" (quadros com
+            prefixo de tamanho, ver event_decoder.py)
+        use_daemon (bool): Encaminha as mensagens avulsas ao ipc_daemon
+        daemon_sockets (dict): Conexão de controle com o daemon por módulo
+        daemon_process (subprocess.Popen): Daemon iniciado por este gerenciador
+            (None se já estava rodando ou não foi necessário)
     """
     
-    def __init__(self):
-        """Inicializa o gerenciador de processos."""
+    def __init__(self, event_format: Optional[str] = None, use_daemon: Optional[bool] = None):
+        """
+        Inicializa o gerenciador de processos.
+        
+        Args:
+            event_format: "json" ou "binary"; se omitido, usa IPC_JSON_FORMAT
+                do ambiente (padrão "json")
+            use_daemon: Usa o ipc_daemon para pipe_demo, socket_demo e
+                shm_demo com uma mensagem; se omitido, liga a menos que
+                IPC_DAEMON=0 esteja no ambiente
+        """
         self.processes = {}
         self.output_queues = {}
         self.callbacks = {}
+        self.event_format = (event_format or os.environ.get("IPC_JSON_FORMAT", "json")).lower()
+        if use_daemon is None:
+            use_daemon = os.environ.get("IPC_DAEMON", "1") != "0"
+        self.use_daemon = use_daemon
+        self.daemon_sockets = {}
+        self.daemon_process = None
+        self.daemon_lock = threading.Lock()
     
     def start_process(self, module: str, executable: str, args: list, 
-                     callback: Callable[[dict], None]) -> bool:
+                     callback: Callable[[dict], None], interactive: bool = False) -> bool:
         """
         Inicia um processo C e configura comunicação JSON.
         
@@ -46,11 +79,19 @@ class BackendManager:
         configura captura de saída e inicia uma thread para ler
         as mensagens JSON em tempo real.
         
+        O eco de uma mensagem de pipe_demo, socket_demo ou shm_demo vai,
+        quando possível, ao ipc_daemon (iniciado na primeira vez): a
+        requisição atravessa um canal já aberto e os eventos chegam ao
+        callback pela conexão de controle, sem fork/exec por mensagem. Se
+        o daemon não puder ser usado, o processo é criado como antes.
+        
         Args:
             module: Nome identificador do módulo (ex: 'pipes', 'sockets')
             executable: Nome do executável no diretório build/
             args: Lista de argumentos para passar ao executável
             callback: Função chamada para cada mensagem JSON recebida
+            interactive: Mantém o stdin do processo aberto para send_input()
+                (ex: pipe_demo --pool, que atende uma requisição por linha)
             
         Returns:
             bool: True se o processo foi iniciado com sucesso, False caso contrário
@@ -70,6 +111,13 @@ class BackendManager:
         if module in self.processes:
             self.stop_process(module)
         
+        channel = DAEMON_CHANNELS.get(executable)
+        if (self.use_daemon and channel and not interactive and len(args) == 1
+                and not args[0].startswith("--")):
+            if self._daemon_request(module, channel, args[0], callback):
+                return True
+            # Daemon indisponível: um processo para esta mensagem
+        
         try:
             # Verificar se o executável existe
             executable_path = f"./build/{executable}"
@@ -82,12 +130,16 @@ class BackendManager:
                 return False
             
             # Iniciar processo
+            binary = self.event_format == "binary"
+            env = dict(os.environ, IPC_JSON_FORMAT="binary" if binary else "json")
             process = subprocess.Popen(
                 [executable_path] + args,
+                stdin=subprocess.PIPE if interactive else None,
                 stdout=subprocess.PIPE,
                 stderr=subprocess.PIPE,
-                text=True,
-                bufsize=1
+                text=not binary,
+                bufsize=0 if binary else 1,
+                env=env
             )
             
             self.processes[module] = process
@@ -96,7 +148,7 @@ class BackendManager:
             
             # Thread para ler saída
             output_thread = threading.Thread(
-                target=self._read_output, 
+                target=self._read_binary_output if binary else self._read_output, 
                 args=(module,),
                 daemon=True
             )
@@ -113,6 +165,184 @@ class BackendManager:
             })
             return False
     
+    def _daemon_address(self) -> str:
+        """
+        Endereço do socket de controle (mesma regra do ipc_daemon).
+        
+        Returns:
+            str: IPC_DAEMON_SOCKET ou "@ipc_daemon.<uid>"; o '@' inicial
+                vira o byte nulo do namespace abstrato
+        """
+        name = os.environ.get("IPC_DAEMON_SOCKET") or f"@ipc_daemon.{os.getuid()}"
+        return "\0" + name[1:] if name.startswith("@") else name
+    
+    def _daemon_connect(self) -> Optional[socket.socket]:
+        """
+        Conecta ao daemon, iniciando ./build/ipc_daemon se nenhum responder.
+        
+        O nome abstrato não tem permissões de arquivo: a conexão só é usada
+        se o processo do outro lado for do mesmo usuário (SO_PEERCRED).
+        
+        Returns:
+            socket.socket: Conexão de controle, ou None se o daemon não
+                existe, não ficou pronto em DAEMON_CONNECT_TIMEOUT ou o nome
+                pertence a um processo de outro usuário
+        """
+        address = self._daemon_address()
+        deadline = None
+        backoff = 0.001
+        while True:
+            sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+            try:
+                sock.connect(address)
+            except OSError:
+                sock.close()
+            else:
+                if self._daemon_peer_uid(sock) == os.getuid():
+                    return sock
+                sock.close()
+                return None
+            if deadline is None:
+                executable_path = "./build/ipc_daemon"
+                if not os.path.exists(executable_path):
+                    return None
+                if self.daemon_process is None or self.daemon_process.poll() is not None:
+                    try:
+                        self.daemon_process = subprocess.Popen(
+                            [executable_path],
+                            stdin=subprocess.DEVNULL,
+                            stdout=subprocess.DEVNULL,
+                            stderr=subprocess.DEVNULL
+                        )
+                    except OSError:
+                        return None
+                deadline = time.monotonic() + DAEMON_CONNECT_TIMEOUT
+            elif time.monotonic() >= deadline or self.daemon_process.poll() is not None:
+                return None
+            # Mesma espera exponencial do connect() do socket_demo (1 ms a 64 ms)
+            time.sleep(backoff)
+            backoff = min(backoff * 2, 0.064)
+    
+    @staticmethod
+    def _daemon_peer_uid(sock: socket.socket) -> Optional[int]:
+        """
+        UID do processo na outra ponta da conexão (struct ucred: pid, uid, gid).
+        
+        Returns:
+            int: UID do par, ou None se o kernel não informou
+        """
+        try:
+            creds = sock.getsockopt(socket.SOL_SOCKET, socket.SO_PEERCRED, struct.calcsize("3i"))
+        except OSError:
+            return None
+        _pid, uid, _gid = struct.unpack("3i", creds)
+        return uid
+    
+    def _daemon_request(self, module: str, channel: str, message: str,
+                        callback: Callable[[dict], None]) -> bool:
+        """
+        Envia uma requisição ao daemon pela conexão de controle do módulo.
+        
+        A conexão é aberta na primeira requisição e mantida; uma thread lê
+        os eventos dela e os entrega ao callback atual do módulo.
+        
+        Args:
+            module: Nome do módulo
+            channel: Canal do daemon (pipes, sockets ou shm)
+            message: Conteúdo da requisição
+            callback: Função chamada para cada evento
+            
+        Returns:
+            bool: True se a requisição foi enviada ao daemon
+        """
+        self.callbacks[module] = callback
+        with self.daemon_lock:
+            sock = self.daemon_sockets.get(module)
+            if sock is None:
+                sock = self._daemon_connect()
+                if sock is None:
+                    return False
+                self.daemon_sockets[module] = sock
+                # O formato padrão do daemon vem do ambiente dele; cada conexão escolhe o seu
+                sock.sendall(f"format {'binary' if self.event_format == 'binary' else 'json'}\n".encode())
+                threading.Thread(
+                    target=self._read_daemon_output,
+                    args=(module, sock),
+                    daemon=True
+                ).start()
+        line = message.replace("\r", " ").replace("\n", " ")
+        try:
+            sock.sendall(f"{channel} {line}\n".encode("utf-8"))
+            return True
+        except OSError:
+            self._close_daemon_socket(module, sock)
+            return False
+    
+    def _close_daemon_socket(self, module: str, sock: socket.socket):
+        """
+        Fecha a conexão de controle de um módulo (a próxima requisição reconecta).
+        """
+        with self.daemon_lock:
+            if self.daemon_sockets.get(module) is sock:
+                del self.daemon_sockets[module]
+        try:
+            sock.shutdown(socket.SHUT_RDWR)
+        except OSError:
+            pass
+        sock.close()
+    
+    def _dispatch_line(self, module: str, line: str):
+        """
+        Entrega ao callback do módulo uma linha JSON (ou "raw" se não for JSON).
+        """
+        line = line.strip()
+        if not line:
+            return
+        try:
+            data = json.loads(line)
+        except json.JSONDecodeError:
+            # Linha não é JSON válido
+            data = {
+                "type": "raw",
+                "module": module,
+                "data": line
+            }
+        callback = self.callbacks.get(module)
+        if callback:
+            callback(data)
+    
+    def _read_daemon_output(self, module: str, sock: socket.socket):
+        """
+        Lê os eventos que o daemon escreve na conexão de controle do módulo.
+        
+        No formato JSON as linhas são separadas aqui; no binário os quadros
+        vão ao BinaryEventDecoder. A thread termina quando a conexão fecha.
+        
+        Args:
+            module: Nome do módulo
+            sock: Conexão de controle
+        """
+        decoder = BinaryEventDecoder() if self.event_format == "binary" else None
+        pending = b""
+        try:
+            while True:
+                chunk = sock.recv(65536)
+                if not chunk:
+                    break
+                if decoder:
+                    for event in decoder.feed(chunk):
+                        callback = self.callbacks.get(module)
+                        if callback:
+                            callback(event)
+                    continue
+                pending += chunk
+                *lines, pending = pending.split(b"\n")
+                for line in lines:
+                    self._dispatch_line(module, line.decode("utf-8", "replace"))
+        except OSError:
+            pass
+        self._close_daemon_socket(module, sock)
+    
     def _read_output(self, module: str):
         """
         Lê saída JSON do processo C em uma thread separada.
@@ -133,18 +363,7 @@ class BackendManager:
         
         try:
             for line in process.stdout:
-                line = line.strip()
-                if line:
-                    try:
-                        data = json.loads(line)
-                        self.callbacks[module](data)
-                    except json.JSONDecodeError:
-                        # Linha não é JSON válido
-                        self.callbacks[module]({
-                            "type": "raw",
-                            "module": module,
-                            "data": line
-                        })
+                self._dispatch_line(module, line)
         except Exception as e:
             self.callbacks[module]({
                 "type": "error",
@@ -152,6 +371,82 @@ class BackendManager:
                 "error": f"Output reading error: {str(e)}"
             })
     
+    def _read_binary_output(self, module: str):
+        """
+        Lê a saída no formato binário (IPC_JSON_FORMAT=binary).
+        
+        Os bytes são lidos em blocos e entregues ao BinaryEventDecoder, que
+        devolve os mesmos dicionários do formato JSON; não há json.loads por
+        linha nem escape do lado C.
+        
+        Args:
+            module: Nome do módulo cuja saída deve ser lida
+        """
+        process = self.processes[module]
+        decoder = BinaryEventDecoder()
+        fd = process.stdout.fileno()
+        
+        try:
+            while True:
+                chunk = os.read(fd, 65536)
+                if not chunk:
+                    break
+                for event in decoder.feed(chunk):
+                    self.callbacks[module](event)
+            if decoder.pending():
+                self.callbacks[module]({
+                    "type": "error",
+                    "module": module,
+                    "error": f"Stream binário terminou com {decoder.pending()} bytes de um quadro incompleto"
+                })
+        except Exception as e:
+            self.callbacks[module]({
+                "type": "error",
+                "module": module,
+                "error": f"Output reading error: {str(e)}"
+            })
+    
+    def is_running(self, module: str) -> bool:
+        """
+        Indica se o processo de um módulo foi iniciado e ainda não terminou.
+        
+        Args:
+            module: Nome do módulo
+            
+        Returns:
+            bool: True se o processo está vivo
+        """
+        process = self.processes.get(module)
+        return process is not None and process.poll() is None
+    
+    def send_input(self, module: str, line: str) -> bool:
+        """
+        Envia uma linha ao stdin de um processo iniciado com interactive=True.
+        
+        Permite reaproveitar um backend de longa duração (ex: o pool de
+        workers do pipe_demo) em vez de criar um processo por mensagem.
+        Quebras de linha na mensagem viram espaços, já que cada linha é
+        uma requisição.
+        
+        Args:
+            module: Nome do módulo
+            line: Conteúdo da requisição
+            
+        Returns:
+            bool: True se a linha foi escrita, False se o processo não
+                aceita entrada ou já terminou
+        """
+        process = self.processes.get(module)
+        if process is None or process.stdin is None or process.poll() is not None:
+            return False
+        data = line.replace("\r", " ").replace("\n", " ") + "\n"
+        try:
+            process.stdin.write(data.encode("utf-8") if self.event_format == "binary" else data)
+            process.stdin.flush()
+            return True
+        except (BrokenPipeError, OSError, ValueError):
+            return False
+    
     def stop_process(self, module: str):
         """
         Para um processo específico e limpa recursos associados.
@@ -173,13 +468,21 @@ class BackendManager:
                 del self.output_queues[module]
             if module in self.callbacks:
                 del self.callbacks[module]
+        sock = self.daemon_sockets.get(module)
+        if sock is not None:
+            self._close_daemon_socket(module, sock)
     
     def stop_all(self):
         """
         Para todos os processos ativos e limpa todos os recursos.
         
         Útil para limpeza ao fechar a aplicação ou reiniciar
-        todos os módulos simultaneamente.
+        todos os módulos simultaneamente. Um daemon iniciado por este
+        gerenciador também é encerrado (SIGTERM: fecha os canais e sai).
         """
-        for module in list(self.processes.keys()):
-            self.stop_process(module)
\ No newline at end of file
+        for module in list(self.processes.keys()) + list(self.daemon_sockets.keys()):
+            self.stop_process(module)
+        if self.daemon_process is not None:
+            self.daemon_process.terminate()
+            self.daemon_process.wait()
+            self.daemon_process = None
\ No newline at end of file
@@ -78,17 +78,21 @@ class IPCTabs:
         self.pipe_log_area.config(state='disabled')
 
     def _send_pipe_message(self):
-        """Inicia a comunicação via pipes"""
+        """Envia a mensagem ao pool de workers de pipes (criado no primeiro envio)"""
         message = self.pipe_message_entry.get() or "Default Pipe Message"
         self.pipe_log_area.config(state='normal')
         self.pipe_log_area.delete(1.0, tk.END)
         
-        self.backend_manager.start_process(
-            module="pipes",
-            executable="pipe_demo",
-            args=[message],
-            callback=lambda data: self._update_log(self.pipe_log_area, data)
-        )
+        # Um único pipe_demo --pool atende todos os cliques: sem fork/exec por mensagem
+        if not self.backend_manager.is_running("pipes"):
+            self.backend_manager.start_process(
+                module="pipes",
+                executable="pipe_demo",
+                args=["--pool", "2"],
+                callback=lambda data: self._update_log(self.pipe_log_area, data),
+                interactive=True
+            )
+        self.backend_manager.send_input("pipes", message)
 
     def _create_shm_tab(self):
         """Cria a aba de Memória Compartilhada"""
@@ -4,7 +4,7 @@
 #include <unistd.h> // Para getpid()
 #include "json_output.h"
 
-#define BUFFER_SIZE 4096
+#define BUFFER_SIZE 65536
 
 // Function to execute a command and capture its output
 char* execute_command(const char* command) {
@@ -29,7 +29,7 @@ char* execute_command(const char* command) {
     return output;
 }
 
-void run_pipe_test() {
+int run_pipe_test() {
     const char* executable = "./pipe_demo";
     const char* test_message = "hello_from_ctest";
     char command[512];
@@ -39,7 +39,7 @@ void run_pipe_test() {
 
     if (!output) {
         print_json_error("pipe_test", "Failed to execute pipe_demo", getpid());
-        return;
+        return 1;
     }
 
     // Filtra a saída para exibir apenas os JSONs de dados, de forma mais robusta.
@@ -89,9 +89,154 @@ void run_pipe_test() {
     }
 
     free(output);
+    return status_ok ? 0 : 1;
 }
 
-int main() {
-    run_pipe_test();
+// Mensagem maior que o antigo buffer de 256 bytes: o eco precisa chegar inteiro
+int run_pipe_long_message_test() {
+    char message[3001];
+    char command[3200];
+    char expected[3100];
+
+    for (int i = 0; i < 3000; i++) {
+        message[i] = (char)('a' + i % 26);
+    }
+    message[3000] = '\0';
+    snprintf(command, sizeof(command), "./pipe_demo %s", message);
+    snprintf(expected, sizeof(expected), "\"data\":\"%s\",\"source\":\"filho -> pai (eco)\"", message);
+
+    char* output = execute_command(command);
+    if (!output) {
+        print_json_error("pipe_test", "Failed to execute pipe_demo", getpid());
+        return 1;
+    }
+    int ok = strstr(output, expected) != NULL && strstr(output, "Pai recebeu eco de 3000 bytes.") != NULL;
+    free(output);
+    if (!ok) {
+        print_json_error("pipe_test", "Long message was truncated or not echoed.", getpid());
+        return 1;
+    }
+    print_json_status("pipe_test", "test_pass", "Long message echoed intact.", getpid());
     return 0;
 }
+
+// Modo --stream: total que não é múltiplo do bloco, pipes redimensionados e métricas de vazão
+int run_pipe_stream_test() {
+    char* output = execute_command("./pipe_demo --stream 5000003 --chunk 64K --pipe-size 256K");
+    if (!output) {
+        print_json_error("pipe_test", "Failed to execute pipe_demo --stream", getpid());
+        return 1;
+    }
+    int ok = strstr(output, "\"type\":\"metrics\"") != NULL &&
+             strstr(output, "\"bytes\":5000003,\"chunk\":65536,\"frames\":77,") != NULL &&
+             strstr(output, "\"gb_per_sec\":") != NULL &&
+             strstr(output, "Filho ecoou 5000003 bytes.") != NULL &&
+             strstr(output, "\"status\":\"success\"") != NULL &&
+             strstr(output, "\"type\":\"error\"") == NULL;
+    if (!ok) {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Pipe stream test failed. Full output:\n%s", output);
+        print_json_error("pipe_test", error_msg, getpid());
+    } else {
+        print_json_status("pipe_test", "test_pass", "Pipe stream test completed successfully.", getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
+// Modo --zerocopy: a passada vmsplice/splice confere a numeração de todos os blocos ecoados
+int run_pipe_zerocopy_test() {
+    char* output = execute_command("./pipe_demo --stream 3000001 --chunk 12K --pipe-size 64K --zerocopy");
+    if (!output) {
+        print_json_error("pipe_test", "Failed to execute pipe_demo --zerocopy", getpid());
+        return 1;
+    }
+    int ok = strstr(output, "\"path\":\"copy\",\"bytes\":3000001,") != NULL &&
+             strstr(output, "\"path\":\"zerocopy\",\"bytes\":3000001,\"chunk\":12288,\"frames\":245,") != NULL &&
+             strstr(output, "\"speedup_vs_copy\":") != NULL &&
+             strstr(output, "\"status\":\"success\"") != NULL &&
+             strstr(output, "\"type\":\"error\"") == NULL;
+    if (!ok) {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Pipe zero-copy test failed. Full output:\n%s", output);
+        print_json_error("pipe_test", error_msg, getpid());
+    } else {
+        print_json_status("pipe_test", "test_pass", "Pipe zero-copy test completed successfully.", getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
+// Modo --pool: workers persistentes atendem linhas do stdin e requisições sintéticas
+int run_pipe_pool_test() {
+    int ok = 1;
+    char* output = execute_command("printf 'req_a\\nreq_b\\nreq_c\\nreq_d\\nreq_e' | ./pipe_demo --pool 2 --depth 4");
+    if (!output) {
+        print_json_error("pipe_test", "Failed to execute pipe_demo --pool", getpid());
+        return 1;
+    }
+    const char* expected[] = { "req_a", "req_b", "req_c", "req_d", "req_e" };
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+        char echo[128];
+        snprintf(echo, sizeof(echo), "\"data\":\"%s\",\"source\":\"filho -> pai (eco)\"", expected[i]);
+        ok &= strstr(output, echo) != NULL;
+    }
+    ok &= strstr(output, "\"requests\":5,") != NULL &&
+          strstr(output, "\"served\":[3,2]") != NULL &&
+          strstr(output, "Worker 1 encerrado após 2 requisições.") != NULL &&
+          strstr(output, "\"type\":\"error\"") == NULL;
+    free(output);
+
+    output = execute_command("./pipe_demo --pool 3 --depth 4 --dispatch least --requests 3000 --request-size 1K");
+    if (!output) {
+        print_json_error("pipe_test", "Failed to execute pipe_demo --pool --requests", getpid());
+        return 1;
+    }
+    ok &= strstr(output, "\"dispatch\":\"least\",\"requests\":3000,\"bytes\":3072000,") != NULL &&
+          strstr(output, "\"speedup_vs_fork\":") != NULL &&
+          strstr(output, "\"type\":\"error\"") == NULL;
+    if (!ok) {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Pipe pool test failed. Last output:\n%s", output);
+        print_json_error("pipe_test", error_msg, getpid());
+    } else {
+        print_json_status("pipe_test", "test_pass", "Pipe pool test completed successfully.", getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
+// io_uring mode: blocking baseline is always measured; the uring path only where the kernel allows it
+int run_pipe_uring_test() {
+    char* output = execute_command("./pipe_demo --uring 20000 --size 100 --depth 16");
+    if (!output) {
+        print_json_error("pipe_test", "Failed to execute pipe_demo --uring", getpid());
+        return 1;
+    }
+    int ok = strstr(output, "\"channel\":\"pipe\",\"path\":\"blocking\",\"messages\":20000,\"size\":100,\"depth\":1,"
+                            "\"read_block\":1600,\"registered_buffers\":false,\"errors\":0,") != NULL &&
+             (strstr(output, "\"path\":\"uring\",\"messages\":20000,\"size\":100,\"depth\":16,\"read_block\":1600,") != NULL ||
+              strstr(output, "\"status\":\"uring_unavailable\"") != NULL) &&
+             strstr(output, "\"status\":\"success\"") != NULL &&
+             strstr(output, "\"type\":\"error\"") == NULL;
+    if (!ok) {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Pipe io_uring test failed. Output:\n%s", output);
+        print_json_error("pipe_test", error_msg, getpid());
+    } else {
+        print_json_status("pipe_test", "test_pass", "Pipe io_uring test completed successfully.", getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
+int main() {
+    int failures = 0;
+    failures += run_pipe_test();
+    failures += run_pipe_long_message_test();
+    failures += run_pipe_stream_test();
+    failures += run_pipe_zerocopy_test();
+    failures += run_pipe_pool_test();
+    failures += run_pipe_uring_test();
+    return failures ? 1 : 0;
+}
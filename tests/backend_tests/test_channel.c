@@ -0,0 +1,267 @@
+/**
+ * @file test_channel.c
+ * @brief Teste unitário do canal com transporte plugável da libipc (ipc_channel.h)
+ *
+ * O mesmo roteiro roda sobre cada transporte registrado: um filho ecoa tudo
+ * o que recebe (em lotes) até o pai fechar o canal, e o pai confere
+ * mensagens vazias, pequenas, maiores que o buffer de leitura e maiores que
+ * o maior registro do ring (fatiadas), um lote com a ordem preservada, o
+ * erro de mensagem grande demais sem perder a sincronia do fluxo (avulsa e
+ * no meio de um lote) e o fim do canal visto pelo filho. Um segundo filho morre sem fechar o canal, e o
+ * recv do pai precisa terminar em vez de esperar para sempre.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "ipc_channel.h"
+#include "json_output.h"
+
+// Capacidade pequena para forçar fatias no ring (registro máximo ~32 KB) e pipes cheios
+#define TEST_CAPACITY (64 * 1024)
+#define TEST_MAX_MESSAGE (256 * 1024)
+#define TEST_BATCH 8
+#define TEST_BATCH_MESSAGES 100
+
+static void fill_pattern(unsigned char *buf, size_t len, unsigned seed) {
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (unsigned char)(i * 31 + seed);
+    }
+}
+
+// Filho: ecoa cada lote recebido até o fim do canal; sai com 0 se o fim foi limpo
+static int echo_child(ipc_channel_t *ch) {
+    ipc_channel_msg_t msgs[TEST_BATCH];
+    int rc;
+
+    for (int i = 0; i < TEST_BATCH; i++) {
+        msgs[i].buf = malloc(TEST_MAX_MESSAGE);
+        msgs[i].cap = TEST_MAX_MESSAGE;
+        if (!msgs[i].buf) {
+            return 1;
+        }
+    }
+    while ((rc = ipc_channel_recv_batch(ch, msgs, TEST_BATCH)) > 0) {
+        if (ipc_channel_send_batch(ch, msgs, rc) == -1) {
+            return 1;
+        }
+    }
+    for (int i = 0; i < TEST_BATCH; i++) {
+        free(msgs[i].buf);
+    }
+    return rc == 0 ? 0 : 1;
+}
+
+static int echo_one(ipc_channel_t *ch, const unsigned char *out, unsigned char *in, size_t len) {
+    size_t got = 0;
+    return ipc_channel_send(ch, out, len) == 0 &&
+           ipc_channel_recv(ch, in, TEST_MAX_MESSAGE, &got) == 1 &&
+           got == len && memcmp(out, in, len) == 0;
+}
+
+/**
+ * @brief Roda o roteiro completo sobre um transporte.
+ *
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+static int run_transport_test(const char *transport) {
+    static const size_t sizes[] = { 0, 1, 100, 4096, 70000, 200000, 65536 * 2 };
+    ipc_channel_config_t cfg = { TEST_CAPACITY };
+    ipc_channel_t ch;
+    char status_msg[256];
+    int ok = 1;
+
+    if (ipc_channel_open(&ch, transport, &cfg) != 0) {
+        snprintf(status_msg, sizeof(status_msg), "Failed to open %s channel: %s", transport, strerror(errno));
+        print_json_error("test_channel", status_msg, getpid());
+        return 1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        ipc_channel_close(&ch);
+        print_json_error("test_channel", "fork() failed", getpid());
+        return 1;
+    }
+    if (pid == 0) {
+        ipc_channel_attach(&ch, 1);
+        int rc = echo_child(&ch);
+        ipc_channel_close(&ch);
+        json_output_flush();
+        _exit(rc);
+    }
+
+    ipc_channel_attach(&ch, 0);
+    unsigned char *out = malloc(TEST_MAX_MESSAGE), *in = malloc(TEST_MAX_MESSAGE);
+    ok = out && in;
+
+    // 1. Mensagens avulsas, de vazia a fatiada
+    for (size_t i = 0; ok && i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        fill_pattern(out, sizes[i], (unsigned)i);
+        ok = echo_one(&ch, out, in, sizes[i]);
+    }
+
+    // 2. Lote: ordem preservada, devolvido em lotes de até TEST_BATCH
+    ipc_channel_msg_t batch[TEST_BATCH_MESSAGES];
+    unsigned seqs[TEST_BATCH_MESSAGES];
+    for (int i = 0; i < TEST_BATCH_MESSAGES; i++) {
+        seqs[i] = (unsigned)i;
+        batch[i].buf = &seqs[i];
+        batch[i].len = sizeof(seqs[i]);
+    }
+    if (ok) {
+        ok = ipc_channel_send_batch(&ch, batch, TEST_BATCH_MESSAGES) == 0;
+    }
+    unsigned next = 0, replies[TEST_BATCH];
+    ipc_channel_msg_t back[TEST_BATCH];
+    for (int i = 0; i < TEST_BATCH; i++) {
+        back[i].buf = &replies[i];
+        back[i].cap = sizeof(replies[i]);
+    }
+    while (ok && next < TEST_BATCH_MESSAGES) {
+        int n = ipc_channel_recv_batch(&ch, back, TEST_BATCH);
+        ok = n > 0;
+        for (int i = 0; ok && i < n; i++) {
+            ok = back[i].len == sizeof(unsigned) && replies[i] == next++;
+        }
+    }
+
+    // 3. Mensagem maior que o destino: EMSGSIZE, e a seguinte chega intacta
+    if (ok) {
+        size_t got;
+        fill_pattern(out, 1000, 7);
+        ok = ipc_channel_send(&ch, out, 1000) == 0 &&
+             ipc_channel_recv(&ch, in, 10, &got) == -1 && errno == EMSGSIZE;
+        fill_pattern(out, 300, 9);
+        ok = ok && echo_one(&ch, out, in, 300);
+    }
+
+    // 4. Lote com uma mensagem fatiada maior que o destino (mas maior que uma fatia):
+    //    o lote para antes dela, o recv seguinte dá EMSGSIZE e a última chega intacta
+    if (ok) {
+        static const size_t lens[] = { 10, 70000, 20 };
+        ipc_channel_msg_t mixed[3];
+        size_t got;
+        for (int i = 0; i < 3; i++) {
+            fill_pattern(out + i * 80000, lens[i], (unsigned)(20 + i));
+            mixed[i].buf = out + i * 80000;
+            mixed[i].len = lens[i];
+        }
+        ok = ipc_channel_send_batch(&ch, mixed, 3) == 0;
+        usleep(100000);  // deixa o eco chegar todo antes do lote
+        for (int i = 0; i < 3; i++) {
+            mixed[i].buf = in + i * 40000;
+            mixed[i].cap = 40000;
+        }
+        ok = ok && ipc_channel_recv_batch(&ch, mixed, 3) == 1 && mixed[0].len == lens[0] &&
+             memcmp(in, out, lens[0]) == 0;
+        ok = ok && ipc_channel_recv(&ch, in, 40000, &got) == -1 && errno == EMSGSIZE;
+        ok = ok && ipc_channel_recv(&ch, in, 40000, &got) == 1 && got == lens[2] &&
+             memcmp(in, out + 2 * 80000, lens[2]) == 0;
+    }
+
+    // 5. Fim do canal: o filho vê EOF e sai limpo
+    ipc_channel_close(&ch);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    free(out);
+    free(in);
+
+    if (ok) {
+        snprintf(status_msg, sizeof(status_msg), "Channel test over %s completed successfully.", transport);
+        print_json_status("test_channel", "test_pass", status_msg, getpid());
+        return 0;
+    }
+    snprintf(status_msg, sizeof(status_msg), "Channel test over %s failed.", transport);
+    print_json_error("test_channel", status_msg, getpid());
+    return 1;
+}
+
+/**
+ * @brief Filho morto por SIGKILL sem fechar o canal: o recv do pai termina (fim do canal ou erro).
+ *
+ * O filho continua zumbi durante o recv (waitpid só depois), o caso do
+ * ipc_daemon com um worker que morre no meio de uma requisição. alarm()
+ * derruba o teste se o recv não voltar.
+ *
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+static int run_dead_peer_test(const char *transport) {
+    ipc_channel_config_t cfg = { TEST_CAPACITY };
+    ipc_channel_t ch;
+    char status_msg[256], reply[16];
+    size_t got = 0;
+
+    if (ipc_channel_open(&ch, transport, &cfg) != 0) {
+        print_json_error("test_channel", "Failed to open channel for the dead peer test", getpid());
+        return 1;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        ipc_channel_close(&ch);
+        return 1;
+    }
+    if (pid == 0) {
+        ipc_channel_attach(&ch, 1);
+        raise(SIGKILL);
+        _exit(1);
+    }
+    ipc_channel_attach(&ch, 0);
+    alarm(10);
+    // O envio pode falhar (EPIPE) ou ficar no ring; o que importa é o recv voltar
+    ipc_channel_send(&ch, "ping", 4);
+    int rc = ipc_channel_recv(&ch, reply, sizeof(reply), &got);
+    alarm(0);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ipc_channel_close(&ch);
+
+    // unix: os dados não lidos pelo filho viram ECONNRESET em vez de EOF
+    if (rc != 1 && WIFSIGNALED(status)) {
+        snprintf(status_msg, sizeof(status_msg), "Dead peer test over %s completed successfully.", transport);
+        print_json_status("test_channel", "test_pass", status_msg, getpid());
+        return 0;
+    }
+    snprintf(status_msg, sizeof(status_msg), "Dead peer test over %s failed (recv = %d).", transport, rc);
+    print_json_error("test_channel", status_msg, getpid());
+    return 1;
+}
+
+/**
+ * @brief Nomes de transporte: desconhecido falha com EINVAL; IPC_CHANNEL_ENV escolhe o padrão.
+ *
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+static int run_registry_test(void) {
+    ipc_channel_t ch;
+    int ok = 1;
+
+    errno = 0;
+    ok = ipc_channel_open(&ch, "carrier_pigeon", NULL) == -1 && errno == EINVAL;
+    setenv(IPC_CHANNEL_ENV, "shm", 1);
+    ok = ok && strcmp(ipc_channel_default_transport(), "shm") == 0;
+    setenv(IPC_CHANNEL_ENV, "carrier_pigeon", 1);
+    ok = ok && strcmp(ipc_channel_default_transport(), IPC_CHANNEL_DEFAULT_TRANSPORT) == 0;
+    unsetenv(IPC_CHANNEL_ENV);
+
+    if (ok) {
+        print_json_status("test_channel", "test_pass", "Transport registry test completed successfully.", getpid());
+        return 0;
+    }
+    print_json_error("test_channel", "Transport registry test failed.", getpid());
+    return 1;
+}
+
+int main() {
+    int failures = run_registry_test();
+    const ipc_channel_ops_t *ops;
+    for (int i = 0; (ops = ipc_channel_transport(i)) != NULL; i++) {
+        failures += run_transport_test(ops->name);
+        failures += run_dead_peer_test(ops->name);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+/**
+ * @file test_daemon.c
+ * @brief Teste do ipc_daemon: socket de controle, canais aquecidos e eventos por conexão
+ *
+ * Sobe o daemon num nome abstrato próprio, manda numa única escrita uma
+ * requisição para cada canal e um comando inválido, e confere os ecos e os
+ * quatro "done". O worker do shm é morto com SIGKILL e o canal precisa
+ * voltar a ecoar com um worker novo. Uma segunda conexão pede o formato
+ * binário (sem resposta) e recebe o "pong" sem JSON em texto, mesmo com uma
+ * terceira mandando milhares de pings sem ler as respostas. Rodando como
+ * root, um filho com outro UID conecta e precisa ver a conexão fechada sem
+ * resposta. Por fim "stop" encerra o daemon e os workers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "json_output.h"
+#include "ipc_daemon.h"
+#include "socket_ready.h"
+
+#define TEST_OUTPUT_SIZE 16384
+#define TEST_TIMEOUT_MS 5000
+#define TEST_STALL_PINGS 20000
+
+// Conta ocorrências de needle nos primeiros len bytes de haystack (pode haver bytes nulos)
+static int count_occurrences(const char *haystack, size_t len, const char *needle) {
+    size_t n = strlen(needle);
+    int count = 0;
+    for (size_t i = 0; i + n <= len; i++) {
+        if (memcmp(haystack + i, needle, n) == 0) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// Lê da conexão até aparecerem `expected` ocorrências de marker (ou o prazo esgotar)
+static size_t read_until(int fd, char *out, size_t cap, const char *marker, int expected) {
+    size_t len = 0;
+    struct pollfd pfd = { fd, POLLIN, 0 };
+
+    while (len < cap - 1 && count_occurrences(out, len, marker) < expected) {
+        if (poll(&pfd, 1, TEST_TIMEOUT_MS) <= 0) {
+            break;
+        }
+        ssize_t n = read(fd, out + len, cap - 1 - len);
+        if (n <= 0) {
+            break;
+        }
+        len += (size_t)n;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+static int connect_daemon(const char *name) {
+    struct sockaddr_un addr;
+    socklen_t addr_len;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd == -1 || socket_addr_init(&addr, &addr_len, name) == -1 ||
+        socket_connect_retry(fd, &addr, addr_len, TEST_TIMEOUT_MS, NULL) == -1) {
+        if (fd != -1) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+static int write_all(int fd, const char *text) {
+    size_t len = strlen(text);
+    return write(fd, text, len) == (ssize_t)len ? 0 : -1;
+}
+
+int main() {
+    char name[64];
+    char *output = malloc(TEST_OUTPUT_SIZE);
+    int ok = output != NULL;
+
+    snprintf(name, sizeof(name), "@ipc_daemon_test.%d", (int)getpid());
+    pid_t daemon = fork();
+    if (daemon == 0) {
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        execl("./ipc_daemon", "ipc_daemon", "--socket", name, (char *)NULL);
+        _exit(127);
+    }
+
+    // 1. Uma requisição por canal e um comando inválido, todos na mesma escrita
+    int fd = ok ? connect_daemon(name) : -1;
+    ok = fd != -1 &&
+         write_all(fd, "pipes hello_daemon_pipe\nsockets hello_daemon_unix\nshm hello_daemon_shm\r\nbogus x\n") == 0;
+    size_t len = ok ? read_until(fd, output, TEST_OUTPUT_SIZE, "\"status\":\"done\"", 4) : 0;
+    ok = ok && count_occurrences(output, len, "\"status\":\"done\"") == 4 &&
+         strstr(output, "\"data\":\"hello_daemon_pipe\",\"source\":\"worker -> daemon (eco)\"") != NULL &&
+         strstr(output, "\"data\":\"hello_daemon_unix\",\"source\":\"worker -> daemon (eco)\"") != NULL &&
+         strstr(output, "\"data\":\"hello_daemon_shm\",\"source\":\"worker -> daemon (eco)\"") != NULL &&
+         strstr(output, "\"name\":\"shm_request\"") != NULL &&
+         strstr(output, "Comando desconhecido: bogus") != NULL;
+    if (!ok) {
+        char error_msg[TEST_OUTPUT_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Requisições ao daemon falharam. Saída:\n%s", output ? output : "");
+        print_json_error("daemon_test", error_msg, getpid());
+    }
+
+    // 2. Worker do shm morto: a requisição seguinte falha ou já usa o worker
+    //    recriado, mas não trava; a próxima precisa ecoar de novo
+    const char *eco = ok ? strstr(output, "\"data\":\"hello_daemon_shm\",\"source\":\"worker -> daemon (eco)\",\"pid\":") : NULL;
+    int worker = eco ? atoi(strstr(eco, "\"pid\":") + 6) : 0;
+    if (ok) {
+        ok = worker > 0 && kill(worker, SIGKILL) == 0 && write_all(fd, "shm after_kill\nshm after_restart\n") == 0;
+        len = ok ? read_until(fd, output, TEST_OUTPUT_SIZE, "\"status\":\"done\"", 2) : 0;
+        ok = ok && count_occurrences(output, len, "\"status\":\"done\"") == 2 &&
+             strstr(output, "\"status\":\"worker_restart\"") != NULL &&
+             strstr(output, "\"data\":\"after_restart\",\"source\":\"worker -> daemon (eco)\"") != NULL;
+        if (!ok) {
+            char error_msg[TEST_OUTPUT_SIZE + 64];
+            snprintf(error_msg, sizeof(error_msg), "Canal shm não se recuperou do worker morto. Saída:\n%s", output);
+            print_json_error("daemon_test", error_msg, getpid());
+        }
+    }
+
+    // 3. Segunda conexão simultânea, com eventos no formato binário, atendida
+    //    enquanto uma terceira manda milhares de pings sem ler nenhuma resposta
+    int stalled = ok ? connect_daemon(name) : -1;
+    if (stalled != -1) {
+        char *pings = malloc(TEST_STALL_PINGS * 5);
+        fcntl(stalled, F_SETFL, O_NONBLOCK);
+        for (int i = 0; pings && i < TEST_STALL_PINGS; i++) {
+            memcpy(pings + i * 5, "ping\n", 5);
+        }
+        // Parte pode não caber no socket: basta o daemon ter muito a responder
+        if (pings && write(stalled, pings, TEST_STALL_PINGS * 5) <= 0) {
+            ok = 0;
+        }
+        free(pings);
+    }
+    int fd2 = ok ? connect_daemon(name) : -1;
+    if (ok) {
+        ok = fd2 != -1 && write_all(fd2, "format binary\nping\n") == 0;
+        len = ok ? read_until(fd2, output, TEST_OUTPUT_SIZE, "done", 1) : 0;
+        ok = ok && len > 0 && output[0] != '{' && count_occurrences(output, len, "pong") == 1 &&
+             count_occurrences(output, len, "done") == 1 && count_occurrences(output, len, "\"type\"") == 0;
+        if (!ok) {
+            print_json_error("daemon_test", "Conexão em formato binário falhou.", getpid());
+        }
+    }
+    if (fd2 != -1) {
+        close(fd2);
+    }
+    if (stalled != -1) {
+        close(stalled);
+    }
+
+    // 4. Outro usuário (só dá para testar como root): conexão fechada, nenhum evento
+    if (ok && getuid() == 0) {
+        pid_t intruder = fork();
+        if (intruder == 0) {
+            char reply[64];
+            if (setuid(65534) == -1) {
+                _exit(2);
+            }
+            int ifd = connect_daemon(name);
+            if (ifd == -1 || write_all(ifd, "ping\n") == -1) {
+                _exit(ifd == -1 ? 0 : 1);   // Recusado já no connect também serve
+            }
+            _exit(read_until(ifd, reply, sizeof(reply), "pong", 1) == 0 ? 0 : 1);
+        }
+        int intruder_status = 0;
+        ok = intruder > 0 && waitpid(intruder, &intruder_status, 0) == intruder &&
+             WIFEXITED(intruder_status) && WEXITSTATUS(intruder_status) == 0;
+        if (!ok) {
+            print_json_error("daemon_test", "Conexão de outro UID não foi recusada.", getpid());
+        }
+    }
+
+    // 5. stop: o daemon fecha os canais, espera os workers e sai com 0
+    if (fd != -1) {
+        if (write_all(fd, "stop\n") == 0) {
+            read_until(fd, output, TEST_OUTPUT_SIZE, "\"status\":\"done\"", 1);
+        }
+        close(fd);
+    }
+    if (!ok && daemon > 0) {
+        kill(daemon, SIGTERM);
+    }
+    int status = 0;
+    if (daemon > 0) {
+        waitpid(daemon, &status, 0);
+    }
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    free(output);
+
+    if (ok) {
+        print_json_status("daemon_test", "test_pass", "Teste do daemon concluído com sucesso.", getpid());
+        return 0;
+    }
+    print_json_error("daemon_test", "Teste do daemon falhou.", getpid());
+    return 1;
+}
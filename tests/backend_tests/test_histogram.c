@@ -0,0 +1,86 @@
+/**
+ * @file test_histogram.c
+ * @brief Teste unitário para o histograma de latências do ipc_bench
+ * 
+ * Verifica que valores pequenos são exatos, que os percentis de uma
+ * distribuição conhecida ficam dentro da precisão do histograma e que
+ * mínimo, máximo e média são mantidos.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "histogram.h"
+#include "json_output.h"
+
+static ipc_histogram_t hist;
+
+// Erro relativo máximo esperado: uma faixa de 1/64 da potência de 2
+static int close_enough(uint64_t got, uint64_t expected) {
+    uint64_t diff = got > expected ? got - expected : expected - got;
+    return diff * 64 <= expected;
+}
+
+/**
+ * @brief Testa os percentis de 1..1.000.000 (distribuição uniforme)
+ * 
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+int run_uniform_test() {
+    int ok = 1;
+
+    ipc_hist_init(&hist);
+    if (ipc_hist_percentile(&hist, 50.0) != 0) {
+        ok = 0;
+    }
+    for (uint64_t v = 1; v <= 1000000; v++) {
+        ipc_hist_record(&hist, v);
+    }
+    if (hist.total != 1000000 || hist.min != 1 || hist.max != 1000000 ||
+        !close_enough(ipc_hist_percentile(&hist, 50.0), 500000) ||
+        !close_enough(ipc_hist_percentile(&hist, 99.0), 990000) ||
+        !close_enough(ipc_hist_percentile(&hist, 99.9), 999000) ||
+        ipc_hist_percentile(&hist, 100.0) != 1000000 ||
+        !close_enough((uint64_t)ipc_hist_mean(&hist), 500000)) {
+        ok = 0;
+    }
+
+    if (ok) {
+        print_json_status("test_histogram", "test_pass", "Uniform percentile test completed successfully.", getpid());
+        return 0;
+    }
+    print_json_error("test_histogram", "Uniform percentile test failed.", getpid());
+    return 1;
+}
+
+/**
+ * @brief Testa valores exatos abaixo de IPC_HIST_SUB_BUCKETS e valores extremos
+ * 
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+int run_edge_test() {
+    int ok = 1;
+
+    ipc_hist_init(&hist);
+    for (int i = 0; i < 99; i++) {
+        ipc_hist_record(&hist, 7);
+    }
+    ipc_hist_record(&hist, UINT64_MAX / 2);
+    if (ipc_hist_percentile(&hist, 50.0) != 7 || ipc_hist_percentile(&hist, 99.0) != 7 ||
+        ipc_hist_percentile(&hist, 100.0) != UINT64_MAX / 2) {
+        ok = 0;
+    }
+
+    if (ok) {
+        print_json_status("test_histogram", "test_pass", "Edge value test completed successfully.", getpid());
+        return 0;
+    }
+    print_json_error("test_histogram", "Edge value test failed.", getpid());
+    return 1;
+}
+
+int main() {
+    int failures = run_uniform_test();
+    failures += run_edge_test();
+    return failures ? 1 : 0;
+}
@@ -1,7 +1,13 @@
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
 #include <unistd.h> // Para getpid()
+#include <pthread.h>
+#include <sys/wait.h>
+#include <time.h>
 #include "json_output.h"
+#include "json_escape.h"
 
 // Função de apoio para testar uma chamada e mostrar no stdout o resultado esperado e obtido
 void test_print_json_status() {
@@ -21,10 +27,292 @@ void test_print_json_error() {
     print_json_error("pipes", "Erro qualquer", getpid());
 }
 
+void test_print_json_metrics() {
+    printf("=== Teste: print_json_metrics ===\n");
+    // Esperado:
+    // {"type":"metrics","module":"bench","name":"pipe_stream_8","metrics":{"p50_ns":120,"msgs_per_sec":1.5e+06},"pid":12345,"timestamp":algum_numero}
+    print_json_metrics("bench", "pipe_stream_8", "{\"p50_ns\":120,\"msgs_per_sec\":1.5e+06}", getpid());
+}
+
+// Escape em buffer do chamador, inclusive com truncamento (nunca corta um "\\x" ao meio)
+int test_json_escape_into() {
+    char out[16];
+    int ok = 1;
+    printf("=== Teste: json_escape_into ===\n");
+
+    size_t n = json_escape_into(out, sizeof(out), "a\"b\\c\nd");
+    if (n != 10 || strcmp(out, "a\\\"b\\\\c\\nd") != 0) {
+        ok = 0;
+    }
+    n = json_escape_into(out, 4, "ab\"c");
+    if (n != 5 || strcmp(out, "ab") != 0) {
+        ok = 0;
+    }
+    printf("%s\n", ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
+
+// Todas as varreduras (escalar/SSE2/AVX2) precisam achar o mesmo byte em
+// qualquer alinhamento e tamanho, inclusive controles e bytes >= 0x80
+int test_json_escape_scan() {
+    static char buf[512];
+    size_t count;
+    const json_escape_impl_t *impls = json_escape_impls(&count);
+    unsigned seed = 12345;
+    int ok = 1;
+    printf("=== Teste: json_escape_scan (%zu implementações, ativa: %s) ===\n", count, json_escape_impl_name());
+
+    for (int offset = 0; offset < 64 && ok; offset++) {
+        for (int len = 0; len < 200 && ok; len++) {
+            char *s = buf + offset;
+            for (int i = 0; i < len; i++) {
+                seed = seed * 1103515245u + 12345u;
+                unsigned r = (seed >> 16) % 64;
+                // Maioria limpa (ASCII e UTF-8), com especiais raros em posições aleatórias
+                s[i] = r == 0 ? '"' : r == 1 ? '\\' : r == 2 ? (char)(seed % 0x20 ? seed % 0x20 : 1) :
+                       r < 8 ? (char)(0x80 + r) : (char)('a' + r % 26);
+            }
+            s[len] = '\0';
+            const char *expected = impls[0].scan(s);
+            for (size_t k = 1; k < count; k++) {
+                if (impls[k].scan(s) != expected) {
+                    ok = 0;
+                }
+            }
+        }
+    }
+
+    char out[32];
+    json_escape_into(out, sizeof(out), "\x01\x1f\b");
+    if (strcmp(out, "\\u0001\\u001f\\u0008") != 0) {
+        ok = 0;
+    }
+    printf("%s\n", ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
+
+// Registro montado campo a campo, em lote com a política por tamanho
+void test_json_record_batch() {
+    printf("=== Teste: json_record_* (lote por tamanho) ===\n");
+    json_output_set_flush_policy(JSON_FLUSH_SIZE, 4096, 0);
+    for (int i = 0; i < 3; i++) {
+        json_record_begin("status", "bench");
+        json_record_string("status", "lote");
+        json_record_int("seq", i);
+        json_record_end();
+    }
+    json_output_flush();
+    json_output_set_flush_policy(JSON_FLUSH_IMMEDIATE, 0, 0);
+}
+
+// Lê um campo inteiro de uma linha JSON (0 se ausente)
+static long long json_field(const char *line, const char *key) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *p = strstr(line, pattern);
+    return p ? atoll(p + strlen(pattern)) : 0;
+}
+
+static long long clock_ns(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// ts_ns de cada relógio precisa bater com o clock_gettime correspondente (TSC
+// no domínio monotônico); seq cresce de 1 em 1 e elapsed_ns mede o intervalo
+int test_json_clocks() {
+    static const json_clock_t clocks[] = { JSON_CLOCK_REALTIME, JSON_CLOCK_MONOTONIC, JSON_CLOCK_TSC };
+    char line[512];
+    int ok = 1;
+    printf("=== Teste: ts_ns, seq e elapsed_ns ===\n");
+
+    json_output_set_fields(JSON_FIELD_SEQ | JSON_FIELD_ELAPSED);
+    for (size_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++) {
+        json_output_set_clock(clocks[c]);
+        clockid_t reference = clocks[c] == JSON_CLOCK_REALTIME ? CLOCK_REALTIME : CLOCK_MONOTONIC;
+
+        fflush(stdout);
+        FILE *capture = tmpfile();
+        int saved_stdout = dup(STDOUT_FILENO);
+        dup2(fileno(capture), STDOUT_FILENO);
+        long long before = clock_ns(reference);
+        print_json_status("clock", "info", "primeiro", 0);
+        struct timespec pause = { 0, 2000000 };
+        nanosleep(&pause, NULL);
+        print_json_status("clock", "info", "segundo", 0);
+        long long after = clock_ns(reference);
+        dup2(saved_stdout, STDOUT_FILENO);
+        close(saved_stdout);
+
+        long long ts[2] = { 0, 0 }, seq[2] = { 0, 0 }, elapsed = 0;
+        rewind(capture);
+        for (int i = 0; i < 2 && fgets(line, sizeof(line), capture); i++) {
+            ts[i] = json_field(line, "ts_ns");
+            seq[i] = json_field(line, "seq");
+            elapsed = json_field(line, "elapsed_ns");
+        }
+        fclose(capture);
+
+        // Margem de 1 ms para o arredondamento da calibração do TSC
+        if (ts[0] < before - 1000000 || ts[1] > after + 1000000 || ts[1] <= ts[0] ||
+            seq[1] != seq[0] + 1 || elapsed != ts[1] - ts[0] || elapsed < 2000000) {
+            ok = 0;
+        }
+        printf("%s: elapsed_ns=%lld\n", json_output_clock_name(), elapsed);
+    }
+    json_output_set_clock(JSON_CLOCK_REALTIME);
+    json_output_set_fields(0);
+    printf("%s\n", ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
+
+// Formato binário: DEF antes do primeiro uso de cada string, ids reaproveitados
+// depois, e os tamanhos encadeiam os quadros até o fim exato do stream
+int test_json_binary() {
+    static const int expected_kinds[] = {
+        JSON_FRAME_DEF, JSON_FRAME_DEF, JSON_FRAME_STATUS, JSON_FRAME_STATUS,
+        JSON_FRAME_DEF, JSON_FRAME_DATA, JSON_FRAME_METRICS, JSON_FRAME_LINE
+    };
+    unsigned char stream[4096];
+    int ok = 1;
+    printf("=== Teste: formato binário ===\n");
+    fflush(stdout);
+
+    FILE *capture = tmpfile();
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(fileno(capture), STDOUT_FILENO);
+    json_output_set_format(JSON_FORMAT_BINARY);
+    print_json_status("pipes", "ok", "primeira", getpid());
+    print_json_status("pipes", "ok", "segunda", getpid());
+    print_json_data("pipes", "payload", "pai -> filho", getpid());
+    print_json_metrics("pipes", "pipe_8", "{\"p50_ns\":120}", 0);
+    json_record_begin("status", "bench");
+    json_record_int("lote", 7);
+    json_record_end();
+    json_output_set_format(JSON_FORMAT_TEXT);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    rewind(capture);
+    size_t total = fread(stream, 1, sizeof(stream), capture);
+    fclose(capture);
+
+    size_t pos = 0, frames = 0;
+    while (pos + JSON_FRAME_HEADER_SIZE <= total && frames < sizeof(expected_kinds) / sizeof(expected_kinds[0])) {
+        uint32_t size = stream[pos] | stream[pos + 1] << 8 | stream[pos + 2] << 16 | (uint32_t)stream[pos + 3] << 24;
+        int kind = stream[pos + 4];
+        int id = stream[pos + 6] | stream[pos + 7] << 8;
+        if (kind != expected_kinds[frames]) {
+            ok = 0;
+        }
+        // "pipes" é o id 0 e "ok" o id 1 nos dois status
+        if (kind == JSON_FRAME_STATUS && (id != 0 || stream[pos + 28] != 1)) {
+            ok = 0;
+        }
+        if (kind == JSON_FRAME_LINE && memcmp(stream + pos + JSON_FRAME_HEADER_SIZE, "{\"type\":\"status\"", 16) != 0) {
+            ok = 0;
+        }
+        pos += 4 + size;
+        frames++;
+    }
+    if (pos != total || frames != sizeof(expected_kinds) / sizeof(expected_kinds[0])) {
+        ok = 0;
+    }
+    printf("%zu quadros, %zu bytes: %s\n", frames, total, ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
+
+#define ASYNC_THREADS 3
+#define ASYNC_EVENTS_PER_THREAD 2000
+#define ASYNC_CHILD_EVENTS 10
+
+static void *async_producer(void *arg) {
+    (void)arg;
+    for (int i = 0; i < ASYNC_EVENTS_PER_THREAD; i++) {
+        print_json_status("async", "info", "evento", 0);
+    }
+    return NULL;
+}
+
+// Modo assíncrono com stdout num arquivo: cada evento aceito vira exatamente
+// uma linha completa, inclusive os de um filho criado com a fila ativa
+int test_json_async() {
+    pthread_t threads[ASYNC_THREADS];
+    char long_text[1024];
+    char line[1024];
+    int ok = 1;
+    printf("=== Teste: modo assíncrono (fila MPSC) ===\n");
+    fflush(stdout);
+
+    FILE *capture = tmpfile();
+    int saved_stdout = dup(STDOUT_FILENO);
+    if (!capture || saved_stdout < 0) {
+        printf("FALHOU\n");
+        return 1;
+    }
+    dup2(fileno(capture), STDOUT_FILENO);
+
+    json_output_start_async(64);
+    for (int t = 0; t < ASYNC_THREADS; t++) {
+        pthread_create(&threads[t], NULL, async_producer, NULL);
+    }
+    memset(long_text, 'x', sizeof(long_text) - 1);
+    long_text[sizeof(long_text) - 1] = '\0';
+    print_json_data("async", long_text, "main", getpid());  // Não cabe no evento: truncado
+    for (int t = 0; t < ASYNC_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        for (int i = 0; i < ASYNC_CHILD_EVENTS; i++) {
+            print_json_status("async", "info", "filho", getpid());
+        }
+        exit(0);
+    }
+    waitpid(pid, NULL, 0);
+
+    json_output_flush();
+    unsigned long long dropped = json_output_async_dropped();
+    json_output_stop_async();  // Emite o aviso com os contadores (houve truncamento)
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    long expected = ASYNC_THREADS * ASYNC_EVENTS_PER_THREAD + 1 - (long)dropped + ASYNC_CHILD_EVENTS + 1;
+    long lines = 0, warnings = 0;
+    rewind(capture);
+    while (fgets(line, sizeof(line), capture)) {
+        size_t len = strlen(line);
+        if (strncmp(line, "{\"type\":", 8) != 0 || len < 3 || strcmp(line + len - 2, "}\n") != 0) {
+            ok = 0;
+        }
+        if (strstr(line, "\"warning\"")) {
+            warnings++;
+        }
+        lines++;
+    }
+    fclose(capture);
+    if (lines != expected || warnings != 1) {
+        ok = 0;
+    }
+    printf("%ld linhas (esperado %ld), %llu descartados: %s\n", lines, expected, dropped, ok ? "ok" : "FALHOU");
+    return ok ? 0 : 1;
+}
+
 int main() {
     test_print_json_status();
     test_print_json_data();
     test_print_json_error();
-    return 0;
+    test_print_json_metrics();
+    test_json_record_batch();
+    int failures = test_json_escape_into();
+    failures += test_json_escape_scan();
+    failures += test_json_clocks();
+    failures += test_json_binary();
+    failures += test_json_async();
+    return failures ? 1 : 0;
 }
 
@@ -14,8 +14,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sched.h>
+#include <errno.h>
+#include <signal.h>
 #include <sys/wait.h>
 #include "shm_handler.h"
+#include "shm_ring.h"
+#include "shm_slab.h"
+#include "shm_broadcast.h"
+#include "shm_snapshot.h"
 #include "json_output.h"
 
 /**
@@ -123,15 +130,568 @@ void run_test() {
     }
 }
 
+/**
+ * @brief Testa o modo ring SPSC entre pai (produtor) e filho (consumidor)
+ * 
+ * Envia registros de tamanhos variados (forçando wrap-around e padding no
+ * final da área de dados) e verifica no filho a ordem e o conteúdo de cada um.
+ * Com SHM_SYNC_FUTEX cada registro também é sinalizado pelo semáforo futex,
+ * exercitando tanto o caminho rápido (sem syscall) quanto o FUTEX_WAIT.
+ * 
+ * @param sync_mode SHM_SYNC_SEM (consumidor só faz polling) ou SHM_SYNC_FUTEX
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+int run_ring_test(int sync_mode) {
+    const int total = 20000;
+    shm_manager_t shm_mgr;
+
+    if (init_shm(&shm_mgr, 1) != 0 || shm_set_sync_mode(&shm_mgr, sync_mode) != 0 ||
+        shm_ring_init(&shm_mgr) != 0) {
+        print_json_error("test_shm_ring", "Parent failed to initialize ring", getpid());
+        return 1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        print_json_error("test_shm_ring", "Fork failed", getpid());
+        cleanup_shm(&shm_mgr);
+        return 1;
+    }
+
+    if (pid == 0) {
+        shm_manager_t child_shm_mgr;
+        char buffer[SHM_SIZE];
+        char expected[SHM_SIZE];
+
+        if (init_shm(&child_shm_mgr, 0) != 0 || shm_ring_init(&child_shm_mgr) != 0) {
+            print_json_error("test_shm_ring", "Child failed to attach to ring", getpid());
+            exit(1);
+        }
+        for (int i = 0; i < total; i++) {
+            ssize_t n;
+            if (sync_mode == SHM_SYNC_FUTEX && shm_sem_wait(&child_shm_mgr) != 0) {
+                print_json_error("test_shm_ring", "Child failed to wait for futex semaphore", getpid());
+                exit(1);
+            }
+            while ((n = shm_ring_read(&child_shm_mgr, buffer, sizeof(buffer))) < 0 && errno == EAGAIN) {
+                sched_yield();
+            }
+            int len = snprintf(expected, sizeof(expected), "msg-%d-%*s", i, i % 300, "");
+            if (n != len || memcmp(buffer, expected, len) != 0) {
+                char error_msg[512];
+                snprintf(error_msg, sizeof(error_msg), "Ring record %d corrupted (got %zd bytes, expected %d)", i, n, len);
+                print_json_error("test_shm_ring", error_msg, getpid());
+                cleanup_shm(&child_shm_mgr);
+                exit(1);
+            }
+        }
+        cleanup_shm(&child_shm_mgr);
+        exit(0);
+    }
+
+    char message[SHM_SIZE];
+    for (int i = 0; i < total; i++) {
+        int len = snprintf(message, sizeof(message), "msg-%d-%*s", i, i % 300, "");
+        while (shm_ring_write(&shm_mgr, message, len) != 0) {
+            if (errno != EAGAIN) {
+                print_json_error("test_shm_ring", "Parent failed to write to ring", getpid());
+                break;
+            }
+            sched_yield();
+        }
+        if (sync_mode == SHM_SYNC_FUTEX) {
+            shm_sem_post(&shm_mgr);
+        }
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    cleanup_shm(&shm_mgr);
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        print_json_status("test_shm_ring", "test_pass", sync_mode == SHM_SYNC_FUTEX ?
+                          "Ring buffer test (futex) completed successfully." :
+                          "Ring buffer test completed successfully.", getpid());
+        return 0;
+    }
+    print_json_error("test_shm_ring", "Test failed: ring consumer did not complete successfully.", getpid());
+    return 1;
+}
+
+/**
+ * @brief Testa canais independentes criados com init_shm_ex()
+ * 
+ * Cria dois segmentos nomeados lado a lado (um deles maior que SHM_SIZE),
+ * verifica que os dados não se misturam e que criar um canal já existente
+ * sem SHM_F_REPLACE falha com EEXIST em vez de destruí-lo.
+ * 
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+int run_multi_channel_test() {
+    shm_manager_t a, b, dup;
+    const size_t big = 8 * 1024 * 1024;
+    int ok = 1;
+
+    if (init_shm_ex(&a, "/ipc_test_a", 1024, SHM_F_CREATE | SHM_F_REPLACE) != 0 ||
+        init_shm_ex(&b, "/ipc_test_b", big, SHM_F_CREATE | SHM_F_REPLACE | SHM_F_POPULATE) != 0) {
+        print_json_error("test_shm_multi", "Failed to create named channels", getpid());
+        return 1;
+    }
+
+    if (b.data_size < big) {
+        ok = 0;
+    }
+    write_to_shm(&a, "canal A");
+    write_to_shm(&b, "canal B");
+    memset((char *)b.data + big - 1, 0x5a, 1);  // Toca o final do segmento grande
+    if (strcmp((char *)a.data, "canal A") != 0 || strcmp((char *)b.data, "canal B") != 0) {
+        ok = 0;
+    }
+
+    errno = 0;
+    if (init_shm_ex(&dup, "/ipc_test_a", 1024, SHM_F_CREATE) == 0 || errno != EEXIST) {
+        ok = 0;
+    }
+    if (strcmp((char *)a.data, "canal A") != 0) {
+        ok = 0;
+    }
+
+    cleanup_shm(&a);
+    cleanup_shm(&b);
+
+    if (ok) {
+        print_json_status("test_shm_multi", "test_pass", "Named channel test completed successfully.", getpid());
+        return 0;
+    }
+    print_json_error("test_shm_multi", "Named channel test failed.", getpid());
+    return 1;
+}
+
+/**
+ * @brief Testa o alocador slab com vários processos alocando e liberando
+ * 
+ * Dois filhos disputam as mesmas free lists: cada bloco recebido é marcado
+ * com o PID do dono e conferido antes de ser liberado, o que detecta um
+ * bloco entregue a dois processos ao mesmo tempo. No final o pai confere
+ * que todos os blocos voltaram às free lists, sem repetição.
+ * 
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+int run_slab_test() {
+    shm_slab_class_config_t classes[] = { { 64, 32 }, { 8192, 4 } };
+    shm_manager_t shm_mgr;
+    pid_t children[2];
+    int ok = 1;
+
+    if (init_shm_ex(&shm_mgr, "/ipc_test_slab", 256 * 1024, SHM_F_CREATE | SHM_F_REPLACE) != 0 ||
+        shm_slab_init(&shm_mgr, classes, 2) != 0) {
+        print_json_error("test_shm_slab", "Failed to create slab segment", getpid());
+        return 1;
+    }
+
+    for (int c = 0; c < 2; c++) {
+        children[c] = fork();
+        if (children[c] == 0) {
+            shm_manager_t child_mgr;
+            if (init_shm_ex(&child_mgr, "/ipc_test_slab", 0, 0) != 0 || shm_slab_init(&child_mgr, NULL, 0) != 0) {
+                exit(1);
+            }
+            pid_t me = getpid();
+            for (int i = 0; i < 20000; i++) {
+                shm_handle_t handle;
+                size_t want = (i % 5 == 0) ? 4096 : 48;
+                pid_t *block = shm_slab_alloc(&child_mgr, want, &handle);
+                if (!block) {
+                    sched_yield();
+                    continue;
+                }
+                *block = me;
+                if (i % 64 == 0) {
+                    sched_yield();
+                }
+                if (*block != me || shm_slab_ptr(&child_mgr, handle) != block ||
+                    shm_slab_block_size(&child_mgr, handle) < want) {
+                    exit(1);
+                }
+                shm_slab_free(&child_mgr, handle);
+            }
+            cleanup_shm(&child_mgr);
+            exit(0);
+        }
+    }
+    for (int c = 0; c < 2; c++) {
+        int status;
+        waitpid(children[c], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = 0;
+        }
+    }
+
+    // Todos os 36 blocos devem estar livres e ser distintos
+    shm_handle_t seen[64];
+    int total = 0;
+    shm_handle_t handle;
+    while (total < 64 && shm_slab_alloc(&shm_mgr, 1, &handle) != NULL) {
+        for (int i = 0; i < total; i++) {
+            if (seen[i] == handle) {
+                ok = 0;
+            }
+        }
+        seen[total++] = handle;
+    }
+    if (total != 36 || errno != ENOMEM) {
+        ok = 0;
+    }
+    if (shm_slab_alloc(&shm_mgr, 10000, &handle) != NULL || errno != EMSGSIZE) {
+        ok = 0;
+    }
+    cleanup_shm(&shm_mgr);
+
+    if (ok) {
+        print_json_status("test_shm_slab", "test_pass", "Slab allocator test completed successfully.", getpid());
+        return 0;
+    }
+    print_json_error("test_shm_slab", "Slab allocator test failed.", getpid());
+    return 1;
+}
+
+/**
+ * @brief Testa o canal broadcast com vários leitores e o modo drop
+ * 
+ * Três filhos leem todas as mensagens, em ordem, com backpressure. Depois,
+ * com SHM_BCAST_DROP_LAGGING, um leitor parado deve ser desligado (EPIPE)
+ * sem que o escritor bloqueie.
+ * 
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+int run_broadcast_test() {
+    const long total = 30000;
+    const int readers = 3;
+    shm_manager_t shm_mgr;
+    pid_t children[3];
+    int ok = 1;
+
+    if (init_shm_ex(&shm_mgr, "/ipc_test_bcast", 64 * 1024, SHM_F_CREATE | SHM_F_REPLACE) != 0 ||
+        shm_bcast_init(&shm_mgr, sizeof(long), 0) != 0) {
+        print_json_error("test_shm_bcast", "Failed to create broadcast segment", getpid());
+        return 1;
+    }
+
+    for (int r = 0; r < readers; r++) {
+        children[r] = fork();
+        if (children[r] == 0) {
+            shm_manager_t child_mgr;
+            if (init_shm_ex(&child_mgr, "/ipc_test_bcast", 0, 0) != 0 || shm_bcast_init(&child_mgr, 0, 0) != 0 ||
+                shm_bcast_join(&child_mgr) != 0) {
+                exit(1);
+            }
+            for (long i = 0; i < total; i++) {
+                long value;
+                ssize_t n;
+                while ((n = shm_bcast_read(&child_mgr, &value, sizeof(value))) < 0 && errno == EAGAIN) {
+                    sched_yield();
+                }
+                if (n != sizeof(value) || value != i) {
+                    exit(1);
+                }
+            }
+            exit(0);
+        }
+    }
+
+    // Espera os três leitores entrarem: quem entra depois perde mensagens
+    while (1) {
+        int joined = 0;
+        for (int i = 0; i < SHM_BCAST_MAX_READERS; i++) {
+            joined += __atomic_load_n(&shm_mgr.bcast->readers[i].state, __ATOMIC_ACQUIRE) == SHM_BCAST_READER_ACTIVE;
+        }
+        if (joined == readers) {
+            break;
+        }
+        sched_yield();
+    }
+    for (long i = 0; i < total; i++) {
+        while (shm_bcast_write(&shm_mgr, &i, sizeof(i)) != 0) {
+            sched_yield();
+        }
+    }
+    for (int r = 0; r < readers; r++) {
+        int status;
+        waitpid(children[r], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = 0;
+        }
+    }
+    cleanup_shm(&shm_mgr);
+
+    // Modo drop: o escritor dá mais de uma volta sobre um leitor parado
+    shm_manager_t writer, reader;
+    if (init_shm_ex(&writer, "/ipc_test_bcast", 16 * 1024, SHM_F_CREATE | SHM_F_REPLACE) != 0 ||
+        shm_bcast_init(&writer, sizeof(long), SHM_BCAST_DROP_LAGGING) != 0 ||
+        init_shm_ex(&reader, "/ipc_test_bcast", 0, 0) != 0 || shm_bcast_init(&reader, 0, 0) != 0 ||
+        shm_bcast_join(&reader) != 0) {
+        ok = 0;
+    } else {
+        for (long i = 0; i < (long)writer.bcast->slot_count * 3; i++) {
+            if (shm_bcast_write(&writer, &i, sizeof(i)) != 0) {
+                ok = 0;
+                break;
+            }
+        }
+        long value;
+        if (shm_bcast_read(&reader, &value, sizeof(value)) != -1 || errno != EPIPE ||
+            writer.bcast->dropped_readers != 1) {
+            ok = 0;
+        }
+        cleanup_shm(&reader);
+        cleanup_shm(&writer);
+    }
+
+    if (ok) {
+        print_json_status("test_shm_bcast", "test_pass", "Broadcast channel test completed successfully.", getpid());
+        return 0;
+    }
+    print_json_error("test_shm_bcast", "Broadcast channel test failed.", getpid());
+    return 1;
+}
+
+/**
+ * @brief Testa o modo snapshot (seqlock) com leitura concorrente à escrita
+ * 
+ * O filho lê o valor mais recente enquanto o pai o reescreve sem parar; todo
+ * valor lido precisa ter as palavras iguais (nunca rasgado) e as versões
+ * lidas nunca podem andar para trás.
+ * 
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+int run_snapshot_test() {
+    shm_manager_t shm_mgr;
+    uint64_t value[16];
+    int ok = 1;
+
+    if (init_shm_ex(&shm_mgr, "/ipc_test_snap", 4096, SHM_F_CREATE | SHM_F_REPLACE) != 0 ||
+        shm_snapshot_init(&shm_mgr) != 0) {
+        print_json_error("test_shm_snapshot", "Failed to create snapshot segment", getpid());
+        return 1;
+    }
+    if (shm_snapshot_read(&shm_mgr, value, sizeof(value), NULL) != -1 || errno != ENODATA) {
+        ok = 0;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        shm_manager_t reader;
+        uint64_t last_version = 0, version;
+        if (init_shm_ex(&reader, "/ipc_test_snap", 0, 0) != 0 || shm_snapshot_init(&reader) != 0) {
+            exit(1);
+        }
+        for (int i = 0; i < 200000; i++) {
+            if (shm_snapshot_read(&reader, value, sizeof(value), &version) != sizeof(value)) {
+                continue;
+            }
+            for (int w = 1; w < 16; w++) {
+                if (value[w] != value[0]) {
+                    exit(1);
+                }
+            }
+            if (version < last_version) {
+                exit(1);
+            }
+            last_version = version;
+        }
+        exit(0);
+    }
+
+    int status;
+    uint64_t n = 0;
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+        for (int w = 0; w < 16; w++) {
+            value[w] = n;
+        }
+        shm_snapshot_write(&shm_mgr, value, sizeof(value));
+        n++;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        ok = 0;
+    }
+    cleanup_shm(&shm_mgr);
+
+    if (ok) {
+        print_json_status("test_shm_snapshot", "test_pass", "Snapshot (seqlock) test completed successfully.", getpid());
+        return 0;
+    }
+    print_json_error("test_shm_snapshot", "Snapshot (seqlock) test failed.", getpid());
+    return 1;
+}
+
+/**
+ * @brief Testa a recuperação de um canal cujo produtor morreu
+ * 
+ * Um filho assume a posse do canal, publica registros no ring e morre com
+ * SIGKILL antes de sinalizar o último. O pai precisa detectar a morte do
+ * dono (EOWNERDEAD) em vez de bloquear, recuperar o registro em trânsito e
+ * aceitar um segundo produtor que reanexa sem resetar o ring. SHM_F_REPLACE
+ * também não pode remover um canal cujo dono está vivo.
+ * 
+ * @return 0 se o teste passou, 1 caso contrário
+ */
+int run_recovery_test() {
+    const char *name = "/ipc_test_recover";
+    shm_manager_t shm_mgr;
+    uint64_t value;
+    uint64_t expected = 0;
+    int ok = 1;
+
+    if (init_shm_ex(&shm_mgr, name, 4096, SHM_F_CREATE | SHM_F_REPLACE) != 0 ||
+        shm_set_sync_mode(&shm_mgr, SHM_SYNC_FUTEX) != 0 || shm_ring_init(&shm_mgr) != 0) {
+        print_json_error("test_shm_recover", "Failed to create recovery segment", getpid());
+        return 1;
+    }
+    shm_segment_header_t *hdr = (shm_segment_header_t *)shm_mgr.ptr;
+
+    // Espera com prazo: nada foi postado
+    if (shm_sem_timedwait(&shm_mgr, 10) != -1 || errno != ETIMEDOUT) {
+        ok = 0;
+    }
+
+    for (int generation = 0; generation < 2 && ok; generation++) {
+        int pipefd[2], gofd[2];
+        if (pipe(pipefd) != 0) {
+            ok = 0;
+            break;
+        }
+        if (pipe(gofd) != 0) {
+            close(pipefd[0]);
+            close(pipefd[1]);
+            ok = 0;
+            break;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            shm_manager_t producer;
+            close(pipefd[0]);
+            close(gofd[1]);
+            if (init_shm_ex(&producer, name, 0, SHM_F_REATTACH) != 0 || producer.is_creator ||
+                shm_ring_init(&producer) != 0 || shm_acquire_owner(&producer) != generation) {
+                exit(1);
+            }
+            // Avisa o pai de que já é o dono
+            if (write(pipefd[1], "x", 1) != 1) {
+                exit(1);
+            }
+            for (uint64_t i = 0; i < 5; i++) {
+                value = generation * 5 + i;
+                if (shm_ring_write(&producer, &value, sizeof(value)) != 0) {
+                    exit(1);
+                }
+                if (generation == 0 && i == 4) {
+                    kill(getpid(), SIGKILL);  // Morre entre a escrita e o post
+                }
+                shm_sem_post(&producer);
+            }
+            // Continua dono até o pai terminar a checagem do intruso
+            char go;
+            if (read(gofd[0], &go, 1) != 1) {
+                exit(1);
+            }
+            shm_release_owner(&producer);
+            cleanup_shm(&producer);
+            exit(0);
+        }
+        close(pipefd[1]);
+        close(gofd[0]);
+        char byte;
+        if (read(pipefd[0], &byte, 1) != 1) {
+            ok = 0;
+        }
+        close(pipefd[0]);
+
+        // O dono vivo protege o canal contra SHM_F_REPLACE de outro processo
+        if (generation == 1) {
+            pid_t other = fork();
+            if (other == 0) {
+                shm_manager_t intruder;
+                int rc = init_shm_ex(&intruder, name, 4096, SHM_F_CREATE | SHM_F_REPLACE);
+                exit(rc == -1 && errno == EBUSY ? 0 : 1);
+            }
+            int other_status;
+            waitpid(other, &other_status, 0);
+            if (!WIFEXITED(other_status) || WEXITSTATUS(other_status) != 0) {
+                ok = 0;
+            }
+            if (write(gofd[1], "x", 1) != 1) {
+                ok = 0;
+            }
+        }
+        close(gofd[1]);
+
+        int received = 0;
+        for (;;) {
+            if (shm_sem_wait_robust(&shm_mgr, 2000) == 0) {
+                if (shm_ring_read(&shm_mgr, &value, sizeof(value)) != sizeof(value) || value != expected) {
+                    ok = 0;
+                    break;
+                }
+                expected++;
+                received++;
+                continue;
+            }
+            if (errno != EOWNERDEAD) {
+                ok = 0;
+                break;
+            }
+            // Recupera o que foi publicado mas não sinalizado
+            while (shm_ring_read(&shm_mgr, &value, sizeof(value)) == sizeof(value)) {
+                if (value != expected) {
+                    ok = 0;
+                }
+                expected++;
+                received++;
+            }
+            break;
+        }
+
+        int status;
+        waitpid(pid, &status, 0);
+        if (received != 5) {
+            ok = 0;
+        }
+        if (generation == 0 && (!WIFSIGNALED(status) || WTERMSIG(status) != SIGKILL)) {
+            ok = 0;
+        }
+        if (generation == 1 && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) {
+            ok = 0;
+        }
+    }
+    if (hdr->epoch != 3) {
+        ok = 0;
+    }
+    cleanup_shm(&shm_mgr);
+
+    if (ok) {
+        print_json_status("test_shm_recover", "test_pass", "Crash recovery test completed successfully.", getpid());
+        return 0;
+    }
+    print_json_error("test_shm_recover", "Crash recovery test failed.", getpid());
+    return 1;
+}
+
 /**
  * @brief Função principal do teste
  * 
- * Ponto de entrada para o executável de teste. Chama a função
- * de teste principal e retorna 0 para indicar sucesso.
+ * Ponto de entrada para o executável de teste. Chama as funções
+ * de teste e retorna 0 para indicar sucesso.
  * 
- * @return 0 sempre (sucesso)
+ * @return 0 em sucesso, 1 se algum teste do ring falhou
  */
 int main() {
     run_test();
-    return 0;
+    int failures = run_ring_test(SHM_SYNC_SEM);
+    failures += run_ring_test(SHM_SYNC_FUTEX);
+    failures += run_multi_channel_test();
+    failures += run_slab_test();
+    failures += run_broadcast_test();
+    failures += run_snapshot_test();
+    failures += run_recovery_test();
+    return failures ? 1 : 0;
 }
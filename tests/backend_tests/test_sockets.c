@@ -4,7 +4,7 @@
 #include <unistd.h>
 #include "json_output.h"
 
-#define BUFFER_SIZE 4096
+#define BUFFER_SIZE 16384
 
 // Função para executar um comando e capturar sua saída
 char* execute_command(const char* command) {
@@ -99,7 +99,159 @@ void run_socket_test() {
     free(output);
 }
 
+// Modo --epoll: vários clientes simultâneos, quadros maiores que um recv() e eco conferido pelos clientes
+int run_socket_epoll_test() {
+    char* output = execute_command("./socket_demo --epoll 64 --messages 20 --size 70000");
+    if (!output) {
+        print_json_error("socket_test", "Falha ao executar socket_demo --epoll.", getpid());
+        return 1;
+    }
+    int ok = strstr(output, "\"clients\":64,\"messages_per_client\":20,\"size\":70000,\"connections\":64,") != NULL &&
+             strstr(output, "\"failed_clients\":0,\"protocol_errors\":0,\"messages\":1280,\"bytes\":89600000,") != NULL &&
+             strstr(output, "\"connections_per_sec\":") != NULL &&
+             strstr(output, "\"status\":\"success\"") != NULL &&
+             strstr(output, "\"type\":\"error\"") == NULL;
+    if (ok) {
+        print_json_status("socket_test", "test_pass", "Teste do servidor epoll concluído com sucesso.", getpid());
+    } else {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Teste do servidor epoll falhou. Saída completa:\n%s", output);
+        print_json_error("socket_test", error_msg, getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
+// Modo --epoll com shards: conexões distribuídas em rodízio e totais somados das threads
+int run_socket_epoll_threads_test() {
+    char* output = execute_command("./socket_demo --epoll 64 --messages 20 --size 5000 --threads 4");
+    if (!output) {
+        print_json_error("socket_test", "Falha ao executar socket_demo --epoll --threads.", getpid());
+        return 1;
+    }
+    int ok = strstr(output, "\"connections\":64,") != NULL &&
+             strstr(output, "\"failed_clients\":0,\"protocol_errors\":0,\"messages\":1280,\"bytes\":6400000,") != NULL &&
+             strstr(output, "\"threads\":4,\"thread_connections\":[16,16,16,16],"
+                            "\"thread_messages\":[320,320,320,320],") != NULL &&
+             strstr(output, "\"status\":\"success\"") != NULL &&
+             strstr(output, "\"type\":\"error\"") == NULL;
+    if (ok) {
+        print_json_status("socket_test", "test_pass", "Teste do servidor epoll com threads concluído com sucesso.", getpid());
+    } else {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Teste do servidor epoll com threads falhou. Saída completa:\n%s", output);
+        print_json_error("socket_test", error_msg, getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
+// Modo --mmsg: cada tipo de socket com lote 1 e lote 16, ordem e tamanho conferidos pelo receptor
+int run_socket_mmsg_test() {
+    static const char *expected[] = {
+        "\"socket_type\":\"stream\",\"batch\":1,\"messages\":20000,\"size\":100,\"errors\":0,\"syscalls\":40000,",
+        "\"socket_type\":\"stream\",\"batch\":16,\"messages\":20000,\"size\":100,\"errors\":0,\"syscalls\":2500,",
+        "\"socket_type\":\"dgram\",\"batch\":1,\"messages\":20000,\"size\":100,\"errors\":0,\"syscalls\":40000,",
+        "\"socket_type\":\"dgram\",\"batch\":16,\"messages\":20000,\"size\":100,\"errors\":0,",
+        "\"socket_type\":\"seqpacket\",\"batch\":1,\"messages\":20000,\"size\":100,\"errors\":0,\"syscalls\":40000,",
+        "\"socket_type\":\"seqpacket\",\"batch\":16,\"messages\":20000,\"size\":100,\"errors\":0,"
+    };
+    char* output = execute_command("./socket_demo --mmsg 20000 --size 100 --batch 16");
+    if (!output) {
+        print_json_error("socket_test", "Falha ao executar socket_demo --mmsg.", getpid());
+        return 1;
+    }
+    int ok = strstr(output, "\"status\":\"success\"") != NULL && strstr(output, "\"type\":\"error\"") == NULL;
+    for (size_t i = 0; ok && i < sizeof(expected) / sizeof(expected[0]); i++) {
+        ok = strstr(output, expected[i]) != NULL;
+    }
+    if (ok) {
+        print_json_status("socket_test", "test_pass", "Teste de sendmmsg/recvmmsg concluído com sucesso.", getpid());
+    } else {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Teste de sendmmsg/recvmmsg falhou. Saída completa:\n%s", output);
+        print_json_error("socket_test", error_msg, getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
+// Modo --fdpass: o buffer chega como memfd selado e o servidor confere o checksum pelo mapeamento
+int run_socket_fdpass_test() {
+    char* output = execute_command("./socket_demo --fdpass 1048576 \"memfd selado \"");
+    if (!output) {
+        print_json_error("socket_test", "Falha ao executar socket_demo --fdpass.", getpid());
+        return 1;
+    }
+    int ok = strstr(output, "\"data\":\"Eco do servidor: memfd selado \"") != NULL &&
+             strstr(output, "Servidor mapeou 1048576 bytes selados (somente leitura, escrita bloqueada).") != NULL &&
+             strstr(output, "\"data\":\"memfd selado memfd selado ") != NULL &&
+             strstr(output, "\"bytes\":1048576,\"sealed\":true,\"checksum_ok\":true,") != NULL &&
+             strstr(output, "\"type\":\"error\"") == NULL;
+    if (ok) {
+        print_json_status("socket_test", "test_pass", "Teste de passagem de memfd concluído com sucesso.", getpid());
+    } else {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Teste de passagem de memfd falhou. Saída completa:\n%s", output);
+        print_json_error("socket_test", error_msg, getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
+// Modo --uring: linha de base bloqueante sempre; o caminho io_uring onde o kernel permitir
+int run_socket_uring_test() {
+    char* output = execute_command("./socket_demo --uring 20000 --size 100 --depth 16");
+    if (!output) {
+        print_json_error("socket_test", "Falha ao executar socket_demo --uring.", getpid());
+        return 1;
+    }
+    int ok = strstr(output, "\"channel\":\"socket\",\"path\":\"blocking\",\"messages\":20000,\"size\":100,\"depth\":1,"
+                            "\"read_block\":1600,\"registered_buffers\":false,\"errors\":0,") != NULL &&
+             (strstr(output, "\"path\":\"uring\",\"messages\":20000,\"size\":100,\"depth\":16,\"read_block\":1600,") != NULL ||
+              strstr(output, "\"status\":\"uring_unavailable\"") != NULL) &&
+             strstr(output, "\"status\":\"success\"") != NULL &&
+             strstr(output, "\"type\":\"error\"") == NULL;
+    if (ok) {
+        print_json_status("socket_test", "test_pass", "Teste do modo io_uring concluído com sucesso.", getpid());
+    } else {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Teste do modo io_uring falhou. Saída completa:\n%s", output);
+        print_json_error("socket_test", error_msg, getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
+// Modo --abstract: nome no namespace abstrato, conexão liberada pelo aviso do servidor (sem atraso fixo)
+int run_socket_abstract_test() {
+    char* output = execute_command("./socket_demo --abstract hello_abstract_ctest");
+    if (!output) {
+        print_json_error("socket_test", "Falha ao executar socket_demo --abstract.", getpid());
+        return 1;
+    }
+    int ok = strstr(output, "Socket associado ao nome abstrato: @ipc_socket_demo.") != NULL &&
+             strstr(output, "(1 tentativa de connect)") != NULL &&
+             strstr(output, "Eco do servidor: hello_abstract_ctest") != NULL &&
+             strstr(output, "\"type\":\"error\"") == NULL;
+    if (ok) {
+        print_json_status("socket_test", "test_pass", "Teste do socket abstrato concluído com sucesso.", getpid());
+    } else {
+        char error_msg[BUFFER_SIZE + 64];
+        snprintf(error_msg, sizeof(error_msg), "Teste do socket abstrato falhou. Saída completa:\n%s", output);
+        print_json_error("socket_test", error_msg, getpid());
+    }
+    free(output);
+    return ok ? 0 : 1;
+}
+
 int main() {
     run_socket_test();
-    return 0;
+    int failures = run_socket_epoll_test();
+    failures += run_socket_epoll_threads_test();
+    failures += run_socket_mmsg_test();
+    failures += run_socket_fdpass_test();
+    failures += run_socket_uring_test();
+    failures += run_socket_abstract_test();
+    return failures;
 }
@@ -9,6 +9,9 @@ import json
 import sys
 import os
 
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__)))), "src", "frontend"))
+from backend_comm.event_decoder import BinaryEventDecoder
+
 def test_json_output(program_path, args, description):
     """Testa se um programa gera JSON válido"""
     print(f"\n=== Testando {description} ===")
@@ -144,6 +147,45 @@ def test_json_escaping():
         print(f"[ERRO] Teste de escape falhou com erro: {e}")
         return False
 
+def test_binary_output(program_path, args, description):
+    """Testa se o formato binário (IPC_JSON_FORMAT=binary) decodifica nos mesmos eventos do JSON"""
+    print(f"\n=== Testando formato binário: {description} ===")
+    
+    try:
+        text = subprocess.run([program_path] + args, capture_output=True, text=True, timeout=10)
+        binary = subprocess.run([program_path] + args, capture_output=True, timeout=10,
+                                env=dict(os.environ, IPC_JSON_FORMAT="binary"))
+        if text.returncode != 0 or binary.returncode != 0:
+            print("[ERRO] Programa falhou")
+            return False
+        
+        json_events = [json.loads(line) for line in text.stdout.splitlines() if line.strip()]
+        decoder = BinaryEventDecoder()
+        binary_events = []
+        # Pedaços pequenos para exercitar quadros cortados entre leituras
+        for i in range(0, len(binary.stdout), 7):
+            binary_events.extend(decoder.feed(binary.stdout[i:i + 7]))
+        
+        print(f"[INFO] {len(text.stdout)} bytes em JSON, {len(binary.stdout)} bytes em binário")
+        
+        # pid, message (contém pids) e os carimbos de tempo mudam entre execuções
+        def stable(event):
+            return json.dumps({k: v for k, v in event.items()
+                               if k not in ("pid", "message", "timestamp", "ts_ns")}, sort_keys=True)
+        
+        if decoder.pending():
+            print(f"[ERRO] {decoder.pending()} bytes de quadro incompleto no fim do stream")
+            return False
+        if sorted(map(stable, json_events)) != sorted(map(stable, binary_events)):
+            print(f"[ERRO] Eventos diferentes: {len(json_events)} em JSON, {len(binary_events)} em binário")
+            return False
+        print(f"[SUCESSO] {len(binary_events)} eventos idênticos nos dois formatos")
+        return True
+        
+    except Exception as e:
+        print(f"[ERRO] Teste do formato binário falhou com erro: {e}")
+        return False
+
 def main():
     """Função principal do teste"""
     print("Teste de Integração - Verificação de JSON Output")
@@ -184,6 +226,11 @@ def main():
     escape_success = test_json_escaping()
     results.append(("JSON Escaping", escape_success))
     
+    # Mesmos demos no formato binário
+    for test in tests:
+        success = test_binary_output(test["path"], test["args"], test["description"])
+        results.append((f"{test['description']} (binário)", success))
+    
     # Resumo final
     print("\n" + "=" * 50)
     print("RESUMO DOS TESTES")